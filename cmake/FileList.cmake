@@ -4,4 +4,6 @@ src/main-menu.cpp)
 
 set(FACTORY_SRC
 src/factory/font_render.cpp
-src/factory/collector.cpp)
+src/factory/collector.cpp
+src/factory/presenter.cpp
+src/factory/band-scaler.cpp)
@@ -0,0 +1,183 @@
+#include "band-scaler.h"
+#include <r-tech1/debug.h>
+
+#ifndef WINDOWS
+#include <unistd.h>
+#endif
+
+using std::endl;
+using std::vector;
+
+/* hqx looks at the 8 pixels around each pixel, xbr looks two pixels out */
+static int overlapRows(Graphics::QualityFilter filter){
+    switch (filter){
+        case Graphics::HqxFilter: return 1;
+        case Graphics::XbrFilter: return 2;
+        default: return 1;
+    }
+}
+
+/* bands thinner than this spend more time on overlap than on their own rows */
+static const int MINIMUM_ROWS = 8;
+
+BandScaler::Band::Band():
+owner(NULL),
+threaded(false),
+thread(Util::Thread::uninitializedValue),
+start(0),
+rows(0),
+above(0),
+below(0){
+}
+
+BandScaler::BandScaler(int count):
+filter(Graphics::NoFilter),
+quit(false){
+    if (count < 1){
+        count = 1;
+    }
+
+    Util::Thread::initializeSemaphore(&done, 0);
+
+    for (int i = 0; i < count; i++){
+        Band * band = new Band();
+        band->owner = this;
+        if (i > 0){
+            Util::Thread::initializeSemaphore(&band->ready, 0);
+            band->threaded = Util::Thread::createThread(&band->thread, NULL, (Util::Thread::ThreadFunction) runBand, band);
+            if (!band->threaded){
+                Global::debug(0) << "Could not create a thread for band " << i << ", it will be scaled serially" << endl;
+                Util::Thread::destroySemaphore(&band->ready);
+            }
+        }
+        bands.push_back(band);
+    }
+}
+
+BandScaler::~BandScaler(){
+    quit = true;
+    for (vector<Band*>::iterator it = bands.begin(); it != bands.end(); it++){
+        Band * band = *it;
+        if (band->threaded){
+            Util::Thread::semaphoreIncrease(&band->ready);
+            Util::Thread::joinThread(band->thread);
+            Util::Thread::destroySemaphore(&band->ready);
+        }
+        delete band;
+    }
+    Util::Thread::destroySemaphore(&done);
+}
+
+int BandScaler::getBands() const {
+    return bands.size();
+}
+
+int BandScaler::defaultBands(){
+#if !defined(WINDOWS) && defined(_SC_NPROCESSORS_ONLN)
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    if (processors < 1){
+        return 1;
+    }
+    if (processors > 8){
+        return 8;
+    }
+    return (int) processors;
+#else
+    return 2;
+#endif
+}
+
+void BandScaler::scaleSerial(const Graphics::Bitmap & input, const Graphics::Bitmap & output, Graphics::QualityFilter filter){
+    switch (filter){
+        case Graphics::HqxFilter: input.StretchHqx(output); break;
+        case Graphics::XbrFilter: input.StretchXbr(output); break;
+        default: input.Stretch(output); break;
+    }
+}
+
+void * BandScaler::runBand(void * arg){
+    Band * band = (Band*) arg;
+    BandScaler * owner = band->owner;
+    while (true){
+        Util::Thread::semaphoreDecrease(&band->ready);
+        if (owner->quit){
+            return NULL;
+        }
+        owner->scaleBand(*band);
+        Util::Thread::semaphoreIncrease(&owner->done);
+    }
+    return NULL;
+}
+
+void BandScaler::scaleBand(Band & band){
+    scaleSerial(*band.input, *band.output, filter);
+}
+
+/* Copies every band out of the input so the threads never touch the same
+ * bitmap, only resizing the band surfaces when the image size changes.
+ */
+void BandScaler::split(const Graphics::Bitmap & input, int multiple){
+    const int width = input.getWidth();
+    const int height = input.getHeight();
+    const int overlap = overlapRows(filter);
+    const int count = bands.size();
+
+    for (int i = 0; i < count; i++){
+        Band & band = *bands[i];
+        int end = height * (i + 1) / count;
+        band.start = height * i / count;
+        band.rows = end - band.start;
+        band.above = band.start < overlap ? band.start : overlap;
+        band.below = height - end < overlap ? height - end : overlap;
+
+        int total = band.rows + band.above + band.below;
+        if (band.input == NULL || band.input->getWidth() != width || band.input->getHeight() != total){
+            band.input = Util::ReferenceCount<Graphics::Bitmap>(new Graphics::Bitmap(Graphics::Bitmap::createMemoryBitmap(width, total)));
+        }
+
+        if (band.output == NULL || band.output->getWidth() != width * multiple || band.output->getHeight() != total * multiple){
+            band.output = Util::ReferenceCount<Graphics::Bitmap>(new Graphics::Bitmap(Graphics::Bitmap::createMemoryBitmap(width * multiple, total * multiple)));
+        }
+
+        Graphics::Bitmap rows(input, 0, band.start - band.above, width, total);
+        rows.Blit(0, 0, *band.input);
+    }
+}
+
+void BandScaler::scale(const Graphics::Bitmap & input, const Graphics::Bitmap & output, Graphics::QualityFilter filter){
+    const int count = bands.size();
+    const int multiple = output.getWidth() / input.getWidth();
+
+    if (count == 1 || input.getHeight() / count < MINIMUM_ROWS){
+        scaleSerial(input, output, filter);
+        return;
+    }
+
+    this->filter = filter;
+    split(input, multiple);
+
+    int waiting = 0;
+    for (int i = 0; i < count; i++){
+        if (bands[i]->threaded){
+            Util::Thread::semaphoreIncrease(&bands[i]->ready);
+            waiting += 1;
+        }
+    }
+
+    for (int i = 0; i < count; i++){
+        if (!bands[i]->threaded){
+            scaleBand(*bands[i]);
+        }
+    }
+
+    for (int i = 0; i < waiting; i++){
+        Util::Thread::semaphoreDecrease(&done);
+    }
+
+    /* put the bands back together without their overlap */
+    for (int i = 0; i < count; i++){
+        const Band & band = *bands[i];
+        Graphics::Bitmap rows(*band.output, 0, band.above * multiple, band.output->getWidth(), band.rows * multiple);
+        rows.Blit(0, band.start * multiple, output);
+    }
+}
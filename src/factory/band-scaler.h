@@ -0,0 +1,71 @@
+#ifndef _band_scaler_h
+#define _band_scaler_h
+
+#include <vector>
+
+#include <r-tech1/graphics/bitmap.h>
+#include <r-tech1/pointer.h>
+#include <r-tech1/thread.h>
+
+/* Runs the hqx and xbr filters in parallel by cutting the image into
+ * horizontal bands. Each band gets a few extra rows from its neighbours so the
+ * filter sees the same pixels it would see on the whole image, and those rows
+ * are thrown away when the bands are put back together. The output is the
+ * same as the serial filter.
+ *
+ * The calling thread does the first band and one persistent thread is made
+ * for each of the others, so a scaler should be kept around and not made
+ * every frame.
+ */
+class BandScaler{
+public:
+    BandScaler(int bands);
+    virtual ~BandScaler();
+
+    /* output has to be 2, 3 or 4 times the size of input. Any other filter
+     * than hqx or xbr is just a stretch.
+     */
+    void scale(const Graphics::Bitmap & input, const Graphics::Bitmap & output, Graphics::QualityFilter filter);
+
+    int getBands() const;
+
+    /* One band per processor */
+    static int defaultBands();
+
+    /* Scales on the calling thread */
+    static void scaleSerial(const Graphics::Bitmap & input, const Graphics::Bitmap & output, Graphics::QualityFilter filter);
+
+protected:
+    struct Band{
+        Band();
+
+        BandScaler * owner;
+        /* the first band and any band that couldn't get a thread run on
+         * the calling thread
+         */
+        bool threaded;
+        Util::Thread::Id thread;
+        Util::Thread::Semaphore ready;
+
+        /* rows of the input this band is responsible for */
+        int start;
+        int rows;
+        /* extra rows the filter looks at */
+        int above;
+        int below;
+
+        Util::ReferenceCount<Graphics::Bitmap> input;
+        Util::ReferenceCount<Graphics::Bitmap> output;
+    };
+
+    static void * runBand(void * arg);
+    void scaleBand(Band & band);
+    void split(const Graphics::Bitmap & input, int multiple);
+
+    std::vector<Band*> bands;
+    Graphics::QualityFilter filter;
+    volatile bool quit;
+    Util::Thread::Semaphore done;
+};
+
+#endif
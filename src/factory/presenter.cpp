@@ -0,0 +1,229 @@
+#include "presenter.h"
+#include "band-scaler.h"
+#include <r-tech1/configuration.h>
+#include <r-tech1/debug.h>
+
+using std::endl;
+
+Presenter::Presenter(int width, int height):
+width(width),
+height(height),
+filter(Graphics::qualityFilterName(Configuration::getQualityFilter())),
+writing(0),
+finished(1),
+inFlight(false),
+hasFrame(false),
+scaleWidth(1),
+scaleHeight(1),
+stretchedScreen(NULL),
+stretchedWidth(0),
+stretchedHeight(0),
+threaded(false),
+quit(false),
+thread(Util::Thread::uninitializedValue){
+    initialize();
+}
+
+Presenter::Presenter(int width, int height, Graphics::QualityFilter filter):
+width(width),
+height(height),
+filter(filter),
+writing(0),
+finished(1),
+inFlight(false),
+hasFrame(false),
+scaleWidth(1),
+scaleHeight(1),
+stretchedScreen(NULL),
+stretchedWidth(0),
+stretchedHeight(0),
+threaded(false),
+quit(false),
+thread(Util::Thread::uninitializedValue){
+    initialize();
+}
+
+void Presenter::initialize(){
+    if (!softwareFilter()){
+        return;
+    }
+
+    scaler = new BandScaler(BandScaler::defaultBands());
+
+    Util::Thread::initializeSemaphore(&ready, 0);
+    Util::Thread::initializeSemaphore(&done, 0);
+    threaded = Util::Thread::createThread(&thread, NULL, (Util::Thread::ThreadFunction) runUpscale, this);
+    if (!threaded){
+        /* still works, the upscale just happens in finish() */
+        Global::debug(0) << "Could not create the upscale thread" << endl;
+        Util::Thread::destroySemaphore(&ready);
+        Util::Thread::destroySemaphore(&done);
+    }
+}
+
+Presenter::~Presenter(){
+    if (threaded){
+        waitForFrame();
+        quit = true;
+        Util::Thread::semaphoreIncrease(&ready);
+        Util::Thread::joinThread(thread);
+        Util::Thread::destroySemaphore(&ready);
+        Util::Thread::destroySemaphore(&done);
+    }
+}
+
+void * Presenter::runUpscale(void * arg){
+    Presenter * presenter = (Presenter*) arg;
+    while (true){
+        Util::Thread::semaphoreDecrease(&presenter->ready);
+        if (presenter->quit){
+            return NULL;
+        }
+        presenter->upscale();
+        Util::Thread::semaphoreIncrease(&presenter->done);
+    }
+    return NULL;
+}
+
+bool Presenter::softwareFilter() const {
+    return filter == Graphics::HqxFilter || filter == Graphics::XbrFilter;
+}
+
+bool Presenter::isPipelined() const {
+    return threaded;
+}
+
+double Presenter::getScaleWidth() const {
+    return scaleWidth;
+}
+
+double Presenter::getScaleHeight() const {
+    return scaleHeight;
+}
+
+Graphics::Bitmap & Presenter::start(const Graphics::Bitmap & screen){
+    scaleWidth = (double) screen.getWidth() / width;
+    scaleHeight = (double) screen.getHeight() / height;
+
+    if (!softwareFilter()){
+        /* the stretched surface draws into the screen it was made with so
+         * only make a new one when the screen is a different one
+         */
+        if (stretched == NULL || stretchedScreen != &screen ||
+            stretchedWidth != screen.getWidth() ||
+            stretchedHeight != screen.getHeight()){
+            stretched = new Graphics::StretchedBitmap(width, height, screen, Graphics::StretchedBitmap::NoClear, filter);
+            stretchedScreen = &screen;
+            stretchedWidth = screen.getWidth();
+            stretchedHeight = screen.getHeight();
+        }
+        stretched->start();
+        return *stretched;
+    }
+
+    if (work == NULL){
+        work = new Graphics::Bitmap(width, height);
+        source = Util::ReferenceCount<Graphics::Bitmap>(new Graphics::Bitmap(Graphics::Bitmap::createMemoryBitmap(width, height)));
+    }
+
+    return *work;
+}
+
+Graphics::Bitmap & Presenter::surface(){
+    if (plain == NULL){
+        plain = new Graphics::Bitmap(width, height);
+    }
+    return *plain;
+}
+
+/* The filters only do whole multiples so scale as close to the screen as
+ * they can and stretch the rest of the way when the frame is shown.
+ */
+void Presenter::prepare(const Graphics::Bitmap & screen){
+    int multiple = screen.getWidth() / width;
+    if (screen.getHeight() / height < multiple){
+        multiple = screen.getHeight() / height;
+    }
+    if (multiple < 2){
+        multiple = 2;
+    }
+    if (multiple > 4){
+        multiple = 4;
+    }
+
+    if (scaled[0] == NULL || scaled[0]->getWidth() != width * multiple || scaled[0]->getHeight() != height * multiple){
+        for (int i = 0; i < 2; i++){
+            scaled[i] = Util::ReferenceCount<Graphics::Bitmap>(new Graphics::Bitmap(Graphics::Bitmap::createMemoryBitmap(width * multiple, height * multiple)));
+        }
+        hasFrame = false;
+    }
+}
+
+/* only the main thread calls this */
+void Presenter::waitForFrame(){
+    if (inFlight){
+        Util::Thread::semaphoreDecrease(&done);
+        inFlight = false;
+        finished = writing;
+        hasFrame = true;
+    }
+}
+
+/* runs on the upscale thread when there is one */
+void Presenter::upscale(){
+    scaler->scale(*source, *scaled[writing], filter);
+}
+
+void Presenter::show(const Graphics::Bitmap & screen){
+    if (!hasFrame){
+        return;
+    }
+
+    const Graphics::Bitmap & frame = *scaled[finished];
+    if (frame.getWidth() == screen.getWidth() && frame.getHeight() == screen.getHeight()){
+        frame.Blit(screen);
+    } else {
+        frame.Stretch(screen);
+    }
+}
+
+void Presenter::finish(const Graphics::Bitmap & screen){
+    if (!softwareFilter()){
+        if (stretched != NULL){
+            stretched->finish();
+        }
+        return;
+    }
+
+    /* the upscale thread is done with the source and one of the outputs
+     * once the last frame is finished
+     */
+    waitForFrame();
+    prepare(screen);
+    work->Blit(*source);
+    writing = 1 - finished;
+
+    if (threaded){
+        inFlight = true;
+        Util::Thread::semaphoreIncrease(&ready);
+        if (!hasFrame){
+            /* nothing to show yet so wait for this one */
+            waitForFrame();
+        }
+    } else {
+        upscale();
+        finished = writing;
+        hasFrame = true;
+    }
+
+    show(screen);
+}
+
+void Presenter::flush(const Graphics::Bitmap & screen){
+    if (!softwareFilter()){
+        return;
+    }
+
+    waitForFrame();
+    show(screen);
+}
@@ -0,0 +1,106 @@
+#ifndef _presenter_h
+#define _presenter_h
+
+#include <r-tech1/graphics/bitmap.h>
+#include <r-tech1/pointer.h>
+#include <r-tech1/thread.h>
+
+class BandScaler;
+
+/* Puts a low resolution frame on the screen. Replaces creating a
+ * Graphics::StretchedBitmap every frame:
+ *
+ *   Graphics::Bitmap & work = presenter.start(screen);
+ *   ... draw into work ...
+ *   presenter.finish(screen);
+ *
+ * The work surfaces are kept between frames. When the quality filter is one of
+ * the software upscalers (hqx or xbr) the upscale runs on a dedicated thread:
+ * frame N is scaled while the game runs logic and renders frame N+1, and
+ * finish() shows the last frame that was done. That costs one frame of
+ * latency but takes the filter off the main thread, and the filter itself is
+ * split over the processors with a BandScaler. Without a software filter
+ * the frame is stretched directly like before.
+ */
+class Presenter{
+public:
+    /* Uses the quality filter from the configuration */
+    Presenter(int width, int height);
+    Presenter(int width, int height, Graphics::QualityFilter filter);
+    virtual ~Presenter();
+
+    /* The surface to draw the next frame into, it is width x height */
+    Graphics::Bitmap & start(const Graphics::Bitmap & screen);
+
+    /* Hands the frame to the upscaler and puts a finished frame on the screen */
+    void finish(const Graphics::Bitmap & screen);
+
+    /* A width x height surface kept between frames, for a frame that is put
+     * on the screen some other way than finish(), such as a zoomed stage
+     * that only shows part of it.
+     */
+    Graphics::Bitmap & surface();
+
+    /* Scale of the presented frame relative to the work surface, for drawing
+     * overlays in screen coordinates
+     */
+    double getScaleWidth() const;
+    double getScaleHeight() const;
+
+    /* Waits for the frame in flight and shows it, so the screen has the
+     * last drawn frame. Only needed when the frames stop, such as before
+     * a fade or a screenshot.
+     */
+    void flush(const Graphics::Bitmap & screen);
+
+    /* true if frames are upscaled on the other thread */
+    bool isPipelined() const;
+
+protected:
+    void initialize();
+    bool softwareFilter() const;
+    void prepare(const Graphics::Bitmap & screen);
+    void waitForFrame();
+    void upscale();
+    void show(const Graphics::Bitmap & screen);
+
+    static void * runUpscale(void * arg);
+
+    const int width;
+    const int height;
+    const Graphics::QualityFilter filter;
+
+    /* only one of these is used depending on the filter */
+    Util::ReferenceCount<Graphics::StretchedBitmap> stretched;
+    Util::ReferenceCount<Graphics::Bitmap> work;
+
+    /* see surface() */
+    Util::ReferenceCount<Graphics::Bitmap> plain;
+
+    /* a memory copy of the frame that the upscale thread reads */
+    Util::ReferenceCount<Graphics::Bitmap> source;
+    /* the thread writes one of these while the other is shown */
+    Util::ReferenceCount<Graphics::Bitmap> scaled[2];
+    Util::ReferenceCount<BandScaler> scaler;
+    /* index of the surface being written and the last finished one */
+    int writing;
+    int finished;
+    bool inFlight;
+    bool hasFrame;
+
+    double scaleWidth;
+    double scaleHeight;
+
+    /* the screen the stretched surface was made for */
+    const Graphics::Bitmap * stretchedScreen;
+    int stretchedWidth;
+    int stretchedHeight;
+
+    bool threaded;
+    volatile bool quit;
+    Util::Thread::Id thread;
+    Util::Thread::Semaphore ready;
+    Util::Thread::Semaphore done;
+};
+
+#endif
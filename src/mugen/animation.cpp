@@ -16,7 +16,8 @@ using namespace std;
 
 namespace Mugen{
 
-static void renderCollision( const std::vector< Area > &vec, const Graphics::Bitmap &bmp, int x, int y, Graphics::Color color ){
+/* the boxes of a frame or the ones placed for this tick */
+template <class Boxes> static void renderCollision( const Boxes &vec, const Graphics::Bitmap &bmp, int x, int y, Graphics::Color color ){
     for( unsigned int i = 0; i < vec.size(); ++i ){
 	bmp.rectangle( x + vec[i].x1, y + vec[i].y1, x + vec[i].x2, y + vec[i].y2, color );
     }
@@ -265,39 +266,29 @@ static Area scaleBox(const Area & area, double x, double y){
     return scaled;
 }
 
-static vector<Area> reverseBoxes(const vector<Area> & boxes){
-    vector<Area> out;
+/* flips and scales in one pass into a list from the tick arena */
+static AreaList placeBoxes(const vector<Area> & boxes, bool reverse, double x, double y){
+    AreaList out;
+    out.reserve(boxes.size());
     for (vector<Area>::const_iterator it = boxes.begin(); it != boxes.end(); it++){
-        out.push_back(reverseBox(*it));
-    }
-
-    return out;
-}
-
-static vector<Area> scaleBoxes(const vector<Area> & boxes, double x, double y){
-    vector<Area> out;
-    for (vector<Area>::const_iterator it = boxes.begin(); it != boxes.end(); it++){
-        out.push_back(scaleBox(*it, x, y));
+        if (reverse){
+            out.push_back(scaleBox(reverseBox(*it), x, y));
+        } else {
+            out.push_back(scaleBox(*it, x, y));
+        }
     }
 
     return out;
 }
 
-
-const std::vector<Area> Animation::getDefenseBoxes(bool reverse, double xscale, double yscale) const {
+const AreaList Animation::getDefenseBoxes(bool reverse, double xscale, double yscale) const {
     Frame * frame = frames[getState().position];
-    if (reverse){
-        return scaleBoxes(reverseBoxes(frame->getDefenseBoxes()), xscale, yscale);
-    }
-    return scaleBoxes(frame->getDefenseBoxes(), xscale, yscale);
+    return placeBoxes(frame->getDefenseBoxes(), reverse, xscale, yscale);
 }
 
-const std::vector<Area> Animation::getAttackBoxes(bool reverse, double xscale, double yscale) const {
+const AreaList Animation::getAttackBoxes(bool reverse, double xscale, double yscale) const {
     Frame * frame = frames[getState().position];
-    if (reverse){
-        return scaleBoxes(reverseBoxes(frame->getAttackBoxes()), xscale, yscale);
-    }
-    return scaleBoxes(frame->getAttackBoxes(), xscale, yscale);
+    return placeBoxes(frame->getAttackBoxes(), reverse, xscale, yscale);
 }
         
 void Animation::virtualTick(){
@@ -7,6 +7,7 @@
 #include "state.h"
 #include "util.h"
 #include "character-state.h"
+#include "arena.h"
 
 namespace Graphics{
 class Bitmap;
@@ -30,6 +31,9 @@ public:
     int x1,y1,x2,y2;
 };
 
+/* Boxes moved to where a character is, only good until the end of the tick */
+typedef TickVector<Area>::type AreaList;
+
 /*
 Frame
 */
@@ -150,8 +154,8 @@ class Animation{
         /* automatically sets the effect trans type to ADDALPHA */
 	void renderReflection(bool facing, bool vfacing, int alpha, const int xaxis, const int yaxis, const Graphics::Bitmap &work, const double scalex = 1, const double scaley = 1);
 
-        virtual const std::vector<Area> getDefenseBoxes(bool reverse, double xscale, double yscale) const;
-        virtual const std::vector<Area> getAttackBoxes(bool reverse, double xscale, double yscale) const;
+        virtual const AreaList getDefenseBoxes(bool reverse, double xscale, double yscale) const;
+        virtual const AreaList getAttackBoxes(bool reverse, double xscale, double yscale) const;
 	
 	// Go forward a frame 
 	void forwardFrame();
@@ -0,0 +1,117 @@
+#include <assert.h>
+#include <r-tech1/thread.h>
+#include "arena.h"
+
+namespace PaintownUtil = ::Util;
+
+namespace Mugen{
+
+/* a tick of a normal match fits in the first block */
+static const size_t FIRST_BLOCK = 64 * 1024;
+/* enough for anything with a size that is a power of two up to this */
+static const size_t ALIGNMENT = 16;
+
+/* the arena put in use by Arena::Use, guarded by activeLock */
+static Arena * active = NULL;
+static PaintownUtil::Thread::LockObject activeLock;
+
+Arena::Arena():
+offset(0),
+usedBytes(0),
+enabled(true){
+}
+
+Arena::~Arena(){
+    for (std::vector<Block>::iterator it = blocks.begin(); it != blocks.end(); it++){
+        ::operator delete(it->memory);
+    }
+}
+
+void Arena::addBlock(size_t size){
+    Block block;
+    block.memory = static_cast<char*>(::operator new(size));
+    block.size = size;
+    blocks.push_back(block);
+    offset = 0;
+}
+
+void * Arena::allocate(size_t size){
+    size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    if (blocks.empty() || offset + size > blocks.back().size){
+        size_t next = blocks.empty() ? FIRST_BLOCK : blocks.back().size * 2;
+        while (next < size){
+            next *= 2;
+        }
+        addBlock(next);
+    }
+
+    void * out = blocks.back().memory + offset;
+    offset += size;
+    usedBytes += size;
+    return out;
+}
+
+void Arena::deallocate(void * memory){
+    /* nothing to do, reset() frees it */
+    assert(memory == NULL || owns(memory));
+}
+
+bool Arena::owns(const void * memory) const {
+    const char * where = static_cast<const char*>(memory);
+    for (std::vector<Block>::const_iterator it = blocks.begin(); it != blocks.end(); it++){
+        if (where >= it->memory && where < it->memory + it->size){
+            return true;
+        }
+    }
+    return false;
+}
+
+void Arena::reset(){
+    /* one block as big as all of them holds the next tick without growing */
+    if (blocks.size() > 1){
+        size_t total = 0;
+        for (std::vector<Block>::iterator it = blocks.begin(); it != blocks.end(); it++){
+            total += it->size;
+            ::operator delete(it->memory);
+        }
+        blocks.clear();
+        addBlock(total);
+    }
+
+    offset = 0;
+    usedBytes = 0;
+}
+
+void Arena::setEnabled(bool enabled){
+    this->enabled = enabled;
+}
+
+bool Arena::isEnabled() const {
+    return enabled;
+}
+
+size_t Arena::used() const {
+    return usedBytes;
+}
+
+Arena::Use::Use(Arena & arena){
+    activeLock.acquire();
+    active = &arena;
+}
+
+Arena::Use::~Use(){
+    active = NULL;
+    activeLock.release();
+}
+
+/* Lists are only made while a stage has its arena in use, and that thread
+ * holds activeLock, so no lock is taken here.
+ */
+Arena * Arena::current(){
+    if (active != NULL && active->isEnabled()){
+        return active;
+    }
+    return NULL;
+}
+
+}
@@ -0,0 +1,171 @@
+#ifndef _paintown_mugen_arena_h
+#define _paintown_mugen_arena_h
+
+#include <stddef.h>
+#include <new>
+#include <vector>
+
+namespace Mugen{
+
+/* Memory for lists that are thrown away before the tick is over, like the
+ * collision boxes of a character or the sprite priorities of a frame. Each
+ * stage has its own arena and puts it in use while it runs a tick or draws a
+ * frame.
+ *
+ * Allocating moves a pointer forward through a big block and freeing does
+ * nothing, the whole arena is emptied at once when the stage is done with a
+ * tick or a frame. When a block runs out another one is added, and the next
+ * reset swaps them all for one block that holds a whole tick, so after the
+ * first few ticks the arena doesn't call malloc at all.
+ *
+ * Nothing allocated from the arena may be kept past the end of the tick.
+ */
+class Arena{
+public:
+    Arena();
+    ~Arena();
+
+    void * allocate(size_t size);
+    /* only for memory from allocate(), which is freed by reset() */
+    void deallocate(void * memory);
+    bool owns(const void * memory) const;
+
+    /* forgets everything allocated so far */
+    void reset();
+
+    /* Lists made while a disabled arena is in use get their memory from
+     * operator new, so the two can be compared.
+     */
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+    /* bytes handed out since the last reset */
+    size_t used() const;
+
+    /* Puts an arena in use until it goes out of scope. Only one arena is in
+     * use at a time, a stage on another thread waits for its turn, so these
+     * don't nest.
+     */
+    class Use{
+    public:
+        Use(Arena & arena);
+        ~Use();
+
+    private:
+        Use(const Use &);
+        Use & operator=(const Use &);
+    };
+
+    /* the enabled arena in use, or NULL */
+    static Arena * current();
+
+protected:
+    void addBlock(size_t size);
+
+    struct Block{
+        char * memory;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    /* where the next allocation goes in the last block */
+    size_t offset;
+    size_t usedBytes;
+    bool enabled;
+
+private:
+    Arena(const Arena &);
+    Arena & operator=(const Arena &);
+};
+
+/* Standard allocator that takes its memory from the arena in use when it is
+ * made, or from operator new if there isn't one. Copies remember where the
+ * memory came from so it goes back to the same place.
+ */
+template <class T> class ArenaAllocator{
+public:
+    typedef T value_type;
+    typedef T * pointer;
+    typedef const T * const_pointer;
+    typedef T & reference;
+    typedef const T & const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    template <class U> struct rebind{
+        typedef ArenaAllocator<U> other;
+    };
+
+    ArenaAllocator():
+    arena(Arena::current()){
+    }
+
+    ArenaAllocator(const ArenaAllocator & copy):
+    arena(copy.arena){
+    }
+
+    template <class U> ArenaAllocator(const ArenaAllocator<U> & copy):
+    arena(copy.getArena()){
+    }
+
+    Arena * getArena() const {
+        return arena;
+    }
+
+    pointer address(reference value) const {
+        return &value;
+    }
+
+    const_pointer address(const_reference value) const {
+        return &value;
+    }
+
+    pointer allocate(size_type count, const void * = 0){
+        if (arena != NULL){
+            return static_cast<pointer>(arena->allocate(count * sizeof(T)));
+        }
+        return static_cast<pointer>(::operator new(count * sizeof(T)));
+    }
+
+    void deallocate(pointer memory, size_type){
+        if (arena != NULL){
+            arena->deallocate(memory);
+        } else {
+            ::operator delete(memory);
+        }
+    }
+
+    size_type max_size() const {
+        return size_type(-1) / sizeof(T);
+    }
+
+    void construct(pointer where, const T & value){
+        new (where) T(value);
+    }
+
+    void destroy(pointer where){
+        where->~T();
+    }
+
+private:
+    Arena * arena;
+};
+
+template <class T, class U> inline bool operator==(const ArenaAllocator<T> & a, const ArenaAllocator<U> & b){
+    return a.getArena() == b.getArena();
+}
+
+template <class T, class U> inline bool operator!=(const ArenaAllocator<T> & a, const ArenaAllocator<U> & b){
+    return a.getArena() != b.getArena();
+}
+
+/* A vector in the arena in use. C++98 has no template typedefs, so it is
+ * TickVector<int>::type.
+ */
+template <class T> struct TickVector{
+    typedef std::vector<T, ArenaAllocator<T> > type;
+};
+
+}
+
+#endif
@@ -4,6 +4,11 @@
 #include "menu.h"
 #include <r-tech1/debug.h>
 #include "game.h"
+#include "sff.h"
+#include "validate.h"
+
+#include <ctype.h>
+#include <stdlib.h>
 
 using std::vector;
 using std::string;
@@ -147,7 +152,8 @@ struct MugenInstant{
         Watch,
         Arcade,
         Script,
-        Team
+        Team,
+        Soak
     };
 
     MugenInstant():
@@ -307,6 +313,78 @@ public:
     }
 };
 
+static bool isNumber(const string & what){
+    if (what.empty()){
+        return false;
+    }
+    for (unsigned int i = 0; i < what.size(); i++){
+        if (!isdigit(what[i])){
+            return false;
+        }
+    }
+    return true;
+}
+
+class MugenSoakArgument: public Argument::Parameter {
+public:
+    MugenInstant data;
+
+    vector<string> keywords() const {
+        vector<string> out;
+        out.push_back("mugen:soak");
+        return out;
+    }
+
+    string description() const {
+        return " <player 1 name>,<player 2 name>,<stage> [draw every n ticks] [minutes] : Run watch matches as fast as possible and log leaks between matches. Nothing is drawn if n is 0, runs forever if minutes is 0 or not given";
+    }
+
+    class Run: public Argument::Action {
+    public:
+
+        Run(MugenInstant data, int renderEvery, int minutes):
+            data(data),
+            renderEvery(renderEvery),
+            minutes(minutes){
+            }
+
+        MugenInstant data;
+        int renderEvery;
+        int minutes;
+
+        void act(){
+            Util::loadMotif();
+            Global::debug(0) << "Mugen soak mode player1 '" << data.player1 << "' player2 '" << data.player2 << "' stage '" << data.stage << "' drawing every " << renderEvery << " ticks for " << minutes << " minutes" << endl;
+            Mugen::Game::startSoak(data.player1, data.player2, data.stage, renderEvery, minutes);
+        }
+    };
+
+    vector<string>::iterator parse(vector<string>::iterator current, vector<string>::iterator end, Argument::ActionRefs & actions){
+        current++;
+        if (current != end){
+            data.enabled = parseMugenInstant(*current, &data.player1, &data.player2, &data.stage);
+            data.kind = MugenInstant::Soak;
+
+            /* default to drawing one out of every 10 ticks */
+            int renderEvery = 10;
+            int minutes = 0;
+            if (current + 1 != end && isNumber(*(current + 1))){
+                current++;
+                renderEvery = atoi((*current).c_str());
+                if (current + 1 != end && isNumber(*(current + 1))){
+                    current++;
+                    minutes = atoi((*current).c_str());
+                }
+            }
+            actions.push_back(::Util::ReferenceCount<Argument::Action>(new Run(data, renderEvery, minutes)));
+        } else {
+            Global::debug(0) << "Expected an argument. Example: mugen:soak kfm,ken,falls 0 60" << endl;
+        }
+
+        return current;
+    }
+};
+
 class MugenTeamArgument: public Argument::Parameter {
 public:
     MugenInstant data;
@@ -396,6 +474,124 @@ public:
     }
 };
 
+class MugenAttractArgument: public Argument::Parameter {
+public:
+    vector<string> keywords() const {
+        vector<string> out;
+        out.push_back("mugen:attract");
+        return out;
+    }
+
+    string description() const {
+        return " : Cycle through demo matches between random characters until a button is pressed";
+    }
+
+    class Run: public Argument::Action {
+    public:
+        void act(){
+            Util::loadMotif();
+            Global::debug(0) << "Mugen attract mode" << endl;
+            Mugen::Game::startAttract();
+        }
+    };
+
+    vector<string>::iterator parse(vector<string>::iterator current, vector<string>::iterator end, Argument::ActionRefs & actions){
+        actions.push_back(::Util::ReferenceCount<Argument::Action>(new Run()));
+        return current;
+    }
+};
+
+class MugenSffArgument: public Argument::Parameter {
+public:
+    vector<string> keywords() const {
+        vector<string> out;
+        out.push_back("mugen:sff");
+        return out;
+    }
+
+    string description() const {
+        return " <list|extract|verify|bench|repack> <file.sff> [directory|output.sff] : Inspect, check or convert an sff file without starting the game";
+    }
+
+    class Run: public Argument::Action {
+    public:
+        Run(const vector<string> & arguments):
+            arguments(arguments){
+            }
+
+        vector<string> arguments;
+
+        void act(){
+            int status = Mugen::Sff::runTool(arguments);
+            if (status != 0){
+                exit(status);
+            }
+        }
+    };
+
+    vector<string>::iterator parse(vector<string>::iterator current, vector<string>::iterator end, Argument::ActionRefs & actions){
+        vector<string> arguments;
+        /* the command and the file */
+        for (int i = 0; i < 2 && current + 1 != end; i++){
+            current++;
+            arguments.push_back(*current);
+        }
+
+        /* extract and repack also need somewhere to write to */
+        if (arguments.size() == 2 && (arguments[0] == "extract" || arguments[0] == "repack") && current + 1 != end){
+            current++;
+            arguments.push_back(*current);
+        }
+
+        actions.push_back(::Util::ReferenceCount<Argument::Action>(new Run(arguments)));
+        return current;
+    }
+};
+
+class MugenValidateArgument: public Argument::Parameter {
+public:
+    vector<string> keywords() const {
+        vector<string> out;
+        out.push_back("mugen:validate");
+        return out;
+    }
+
+    string description() const {
+        return " [output.json] [threads] : Load every character and stage and write the problems found to a json file, mugen-validate.json by default";
+    }
+
+    class Run: public Argument::Action {
+    public:
+        Run(const vector<string> & arguments):
+            arguments(arguments){
+            }
+
+        vector<string> arguments;
+
+        void act(){
+            int status = Mugen::Validate::runTool(arguments);
+            if (status != 0){
+                exit(status);
+            }
+        }
+    };
+
+    vector<string>::iterator parse(vector<string>::iterator current, vector<string>::iterator end, Argument::ActionRefs & actions){
+        vector<string> arguments;
+        if (current + 1 != end && (current + 1)->find(".json") != string::npos){
+            current++;
+            arguments.push_back(*current);
+            if (current + 1 != end && isNumber(*(current + 1))){
+                current++;
+                arguments.push_back(*current);
+            }
+        }
+
+        actions.push_back(::Util::ReferenceCount<Argument::Action>(new Run(arguments)));
+        return current;
+    }
+};
+
 class MugenServerArgument: public Argument::Parameter {
 public:
     vector<string> keywords() const {
@@ -479,8 +675,12 @@ std::vector< ::Util::ReferenceCount<Argument::Parameter> > arguments(){
     all.push_back(::Util::ReferenceCount<Argument::Parameter>(new MugenTrainingArgument()));
     all.push_back(::Util::ReferenceCount<Argument::Parameter>(new MugenScriptArgument()));
     all.push_back(::Util::ReferenceCount<Argument::Parameter>(new MugenWatchArgument()));
+    all.push_back(::Util::ReferenceCount<Argument::Parameter>(new MugenSoakArgument()));
     all.push_back(::Util::ReferenceCount<Argument::Parameter>(new MugenTeamArgument()));
     all.push_back(::Util::ReferenceCount<Argument::Parameter>(new MugenArcadeArgument()));
+    all.push_back(::Util::ReferenceCount<Argument::Parameter>(new MugenAttractArgument()));
+    all.push_back(::Util::ReferenceCount<Argument::Parameter>(new MugenSffArgument()));
+    all.push_back(::Util::ReferenceCount<Argument::Parameter>(new MugenValidateArgument()));
 
     all.push_back(::Util::ReferenceCount<Argument::Parameter>(new MugenServerArgument()));
     all.push_back(::Util::ReferenceCount<Argument::Parameter>(new MugenClientArgument()));
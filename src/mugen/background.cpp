@@ -5,6 +5,7 @@
 #include <cstring>
 #include <string>
 #include <list>
+#include <set>
 #include <algorithm>
 #include "globals.h"
 #include <r-tech1/debug.h>
@@ -284,6 +285,10 @@ void BackgroundElement::reset(){
     /* TODO: set velocity to its original velocity and whatever else */
 }
 
+bool BackgroundElement::isStatic() const {
+    return getVelocityX() == 0 && getVelocityY() == 0 && !getSinX().moves() && !getSinY().moves();
+}
+
 void BackgroundElement::act(){
     x += getVelocityX();
     y += getVelocityY();
@@ -687,6 +692,10 @@ void AnimationElement::setAnimation(PaintownUtil::ReferenceCount<Animation> anim
 AnimationElement::~AnimationElement(){
 }
 
+bool AnimationElement::isStatic() const {
+    return false;
+}
+
 void AnimationElement::act(){
     if (!getEnabled()){
         return;
@@ -1721,7 +1730,8 @@ Background::Background(const Filesystem::AbsolutePath &file, const std::string &
 file(file),
 header(header),
 debug(false),
-clearColor(Graphics::MaskColor()){
+clearColor(Graphics::MaskColor()),
+cacheStatic(false){
     TimeDifference diff;
     diff.startTime();
     AstRef parsed(Mugen::Util::parseDef(file));
@@ -1928,12 +1938,15 @@ clearColor(Graphics::MaskColor()){
         out << "Error while parsing " << file.path() << " " << fail.getFullReason();
         throw MugenException(out.str(), __FILE__, __LINE__);
     }
+
+    findStaticLayers();
 }
 
 Background::Background(const AstRef & parsed, const string & header, const Mugen::SpriteMap & sprites):
 header(header),
 debug(false),
-clearColor(Graphics::MaskColor()){
+clearColor(Graphics::MaskColor()),
+cacheStatic(false){
     // for linked position in backgrounds
     BackgroundElement * priorElement = NULL;
     /* use the sprites that are passed in unless the background has a def
@@ -2083,6 +2096,8 @@ clearColor(Graphics::MaskColor()){
         out << "Error while parsing " << file.path() << " " << fail.getFullReason();
         throw MugenException(out.str(), __FILE__, __LINE__);
     }
+
+    findStaticLayers();
 }
 
 Background::~Background(){
@@ -2143,6 +2158,19 @@ void Background::act(){
 }
 
 void Background::renderBackground(int x, int y, const Graphics::Bitmap &bmp, Graphics::Bitmap::Filter * filter){
+    /* an opaque layer already has the clear color in it */
+    if (!cacheStatic || filter != NULL || backgroundLayers.empty() || !backgroundLayers.front().opaque){
+        clear(bmp);
+    }
+
+    renderElements(backgrounds, backgroundLayers, x, y, bmp, filter);
+}
+
+void Background::renderForeground(int x, int y, const Graphics::Bitmap &bmp, Graphics::Bitmap::Filter * filter){
+    renderElements(foregrounds, foregroundLayers, x, y, bmp, filter);
+}
+
+void Background::clear(const Graphics::Bitmap & bmp){
     if (clearColor != Graphics::MaskColor()){
 	bmp.fill(clearColor);
     }
@@ -2150,17 +2178,133 @@ void Background::renderBackground(int x, int y, const Graphics::Bitmap &bmp, Gra
     if (debug){
 	bmp.fill(Graphics::MaskColor());
     }
+}
 
-    for( vector< BackgroundElement *>::iterator i = backgrounds.begin(); i != backgrounds.end(); ++i ){
-	BackgroundElement *element = *i;
-	element->render(x, y, bmp, filter);
+void Background::enableStaticCache(bool enable){
+    cacheStatic = enable;
+    if (!enable){
+        /* free the bitmaps */
+        for (vector<CachedLayer>::iterator it = backgroundLayers.begin(); it != backgroundLayers.end(); it++){
+            it->bitmap = PaintownUtil::ReferenceCount<Graphics::Bitmap>(NULL);
+        }
+        for (vector<CachedLayer>::iterator it = foregroundLayers.begin(); it != foregroundLayers.end(); it++){
+            it->bitmap = PaintownUtil::ReferenceCount<Graphics::Bitmap>(NULL);
+        }
     }
 }
 
-void Background::renderForeground(int x, int y, const Graphics::Bitmap &bmp, Graphics::Bitmap::Filter * filter){
-    for( vector< BackgroundElement *>::iterator i = foregrounds.begin(); i != foregrounds.end(); ++i ){
-	BackgroundElement *element = *i;
-	element->render(x, y, bmp, filter);
+static bool cacheable(BackgroundElement * element, const set<BackgroundElement *> & controlled, bool opaque){
+    if (controlled.find(element) != controlled.end() || !element->isStatic()){
+        return false;
+    }
+
+    /* Translucent elements blend with whatever is under them, which is only
+     * known if the layer starts with the clear color.
+     */
+    return opaque || element->getTrans() == None;
+}
+
+/* Splits the elements into runs that can be drawn from a cached bitmap. A
+ * single plain sprite is cheaper to draw than a full screen bitmap so runs
+ * are only kept if they save some work.
+ */
+static vector<CachedLayer> findLayers(const vector<BackgroundElement *> & elements, const set<BackgroundElement *> & controlled, bool filled){
+    vector<CachedLayer> layers;
+    unsigned int start = 0;
+    while (start < elements.size()){
+        bool opaque = start == 0 && filled;
+        bool worthIt = opaque;
+        unsigned int end = start;
+        while (end < elements.size() && cacheable(elements[end], controlled, opaque)){
+            BackgroundElement * element = elements[end];
+            /* tiles and parallax lines are drawn piece by piece */
+            if (element->getTile().x != 0 || element->getTile().y != 0 || dynamic_cast<ParallaxElement*>(element) != NULL){
+                worthIt = true;
+            }
+            end += 1;
+        }
+
+        if (end - start > 1){
+            worthIt = true;
+        }
+
+        if (end > start){
+            if (worthIt){
+                layers.push_back(CachedLayer(start, end, opaque));
+            }
+            start = end;
+        } else {
+            start += 1;
+        }
+    }
+
+    return layers;
+}
+
+void Background::findStaticLayers(){
+    /* anything a controller touches can change at any time */
+    set<BackgroundElement *> controlled;
+    for (vector<BackgroundController *>::iterator it = controllers.begin(); it != controllers.end(); it++){
+        const vector<BackgroundElement *> & elements = (*it)->getElements();
+        controlled.insert(elements.begin(), elements.end());
+    }
+
+    backgroundLayers = findLayers(backgrounds, controlled, clearColor != Graphics::MaskColor() || debug);
+    foregroundLayers = findLayers(foregrounds, controlled, false);
+
+    unsigned int cached = 0;
+    for (vector<CachedLayer>::iterator it = backgroundLayers.begin(); it != backgroundLayers.end(); it++){
+        cached += it->end - it->start;
+    }
+    for (vector<CachedLayer>::iterator it = foregroundLayers.begin(); it != foregroundLayers.end(); it++){
+        cached += it->end - it->start;
+    }
+    Global::debug(1) << "Background " << header << " has " << cached << " static elements out of " << (backgrounds.size() + foregrounds.size()) << endl;
+}
+
+void Background::renderElements(const vector<BackgroundElement *> & elements, vector<CachedLayer> & layers, int x, int y, const Graphics::Bitmap & bmp, Graphics::Bitmap::Filter * filter){
+    /* the cached bitmaps were made without a filter */
+    bool useLayers = cacheStatic && filter == NULL;
+    vector<CachedLayer>::iterator layer = layers.begin();
+    unsigned int index = 0;
+    while (index < elements.size()){
+        if (useLayers && layer != layers.end() && layer->start == index){
+            renderLayer(*layer, elements, x, y, bmp);
+            index = layer->end;
+            layer++;
+        } else {
+            elements[index]->render(x, y, bmp, filter);
+            index += 1;
+        }
+    }
+}
+
+void Background::renderLayer(CachedLayer & layer, const vector<BackgroundElement *> & elements, int x, int y, const Graphics::Bitmap & bmp){
+    if (layer.bitmap == NULL ||
+        layer.cameraX != x ||
+        layer.cameraY != y ||
+        layer.bitmap->getWidth() != bmp.getWidth() ||
+        layer.bitmap->getHeight() != bmp.getHeight()){
+
+        layer.bitmap = PaintownUtil::ReferenceCount<Graphics::Bitmap>(new Graphics::Bitmap(bmp.getWidth(), bmp.getHeight()));
+        if (layer.opaque){
+            clear(*layer.bitmap);
+        } else {
+            layer.bitmap->clearToMask();
+        }
+
+        for (unsigned int index = layer.start; index < layer.end; index++){
+            elements[index]->render(x, y, *layer.bitmap, NULL);
+        }
+
+        layer.cameraX = x;
+        layer.cameraY = y;
+    }
+
+    if (layer.opaque){
+        layer.bitmap->Blit(0, 0, bmp);
+    } else {
+        layer.bitmap->draw(0, 0, bmp);
     }
 }
 
@@ -27,6 +27,11 @@ struct Sin {
 
     double get() const;
 
+    /* false if get() always returns 0 */
+    inline bool moves() const {
+        return amp != 0 && period != 0;
+    }
+
     double amp;
     double period;
     double offset;
@@ -213,6 +218,9 @@ class BackgroundElement: public Element {
 
         virtual void reset();
 
+        //! True if the element looks the same every tick as long as the camera doesn't move
+        virtual bool isStatic() const;
+
     private:
         //! get linked element
         BackgroundElement *getLinkedElement();
@@ -277,6 +285,7 @@ public:
     virtual void act();
     virtual void render(int x, int y, const Graphics::Bitmap &, Graphics::Bitmap::Filter * filter = NULL);
     virtual void setAnimation(PaintownUtil::ReferenceCount<Animation> animation);
+    virtual bool isStatic() const;
 private:
     PaintownUtil::ReferenceCount<Animation> animation;
 };
@@ -410,6 +419,30 @@ class BackgroundController{
 	std::vector < Controller *> controllers;
 };
 
+/*! A run of elements that never change, rendered once into a bitmap that is
+ * drawn in their place until the camera moves.
+ */
+struct CachedLayer{
+    CachedLayer(unsigned int start, unsigned int end, bool opaque):
+    start(start),
+    end(end),
+    opaque(opaque),
+    cameraX(0),
+    cameraY(0){
+    }
+
+    //! Elements [start, end) of the list
+    unsigned int start;
+    unsigned int end;
+
+    //! Includes the clear color, so it can be blitted without a mask
+    bool opaque;
+
+    PaintownUtil::ReferenceCount<Graphics::Bitmap> bitmap;
+    int cameraX;
+    int cameraY;
+};
+
 /*! Our Background */
 class Background{
     public:
@@ -434,7 +467,16 @@ class Background{
             return temp;
         }
 
+        /*! Draw elements that never change from a bitmap that is only rendered
+         * once. Only worth it if the camera doesn't move, like in menus.
+         */
+        virtual void enableStaticCache(bool enable);
+
     private:
+        void findStaticLayers();
+        void clear(const Graphics::Bitmap & bmp);
+        void renderElements(const std::vector<BackgroundElement *> & elements, std::vector<CachedLayer> & layers, int cameraX, int cameraY, const Graphics::Bitmap & bmp, Graphics::Bitmap::Filter * filter);
+        void renderLayer(CachedLayer & layer, const std::vector<BackgroundElement *> & elements, int cameraX, int cameraY, const Graphics::Bitmap & bmp);
 	
 	//! File where background is in
         Filesystem::AbsolutePath file;
@@ -470,6 +512,13 @@ class Background{
 
         //! Controllers
         std::vector< BackgroundController *> controllers;
+
+        //! Use the cached layers when rendering
+        bool cacheStatic;
+
+        //! Static runs of elements found at load
+        std::vector<CachedLayer> backgroundLayers;
+        std::vector<CachedLayer> foregroundLayers;
 };
     
 }
@@ -0,0 +1,73 @@
+#include "camera-bounds.h"
+#include "character-state.h"
+
+static const int DEFAULT_WIDTH = 320;
+static const int DEFAULT_HEIGHT = 240;
+
+namespace Mugen{
+
+CameraBounds::CameraBounds():
+screenLeft(0),
+screenRight(0),
+screenUp(0),
+screenDown(0),
+offScreenLeft(0),
+offScreenRight(0),
+tension(0),
+screenLeftTension(0),
+screenRightTension(0),
+follow(0){
+}
+
+void CameraBounds::setLimits(int boundLeft, int boundRight, int tension, double verticalFollow){
+    offScreenLeft = boundLeft - DEFAULT_WIDTH / 2;
+    offScreenRight = boundRight + DEFAULT_WIDTH / 2;
+    this->tension = tension;
+    follow = verticalFollow * 3.2;
+    screenLeftTension = screenLeft + tension;
+    screenRightTension = screenRight - tension;
+}
+
+/* the same rounding the stage always used for the edges */
+void CameraBounds::update(double cameraX, double cameraY){
+    screenLeft = (int)(cameraX - DEFAULT_WIDTH / 2);
+    screenRight = (int)(cameraX + DEFAULT_WIDTH / 2);
+    screenUp = (int) cameraY;
+    screenDown = (int)(cameraY + DEFAULT_HEIGHT);
+    screenLeftTension = screenLeft + tension;
+    screenRightTension = screenRight - tension;
+}
+
+void CameraBounds::clearScreenBounds(){
+    screenBounds.clear();
+}
+
+void CameraBounds::setScreenBound(const CharacterId & id, bool offScreen, bool panX, bool panY){
+    for (unsigned int i = 0; i < screenBounds.size(); i++){
+        Entry & entry = screenBounds[i];
+        if (entry.id == id){
+            entry.offScreen = offScreen;
+            entry.panX = panX;
+            entry.panY = panY;
+            return;
+        }
+    }
+
+    Entry entry;
+    entry.id = id;
+    entry.offScreen = offScreen;
+    entry.panX = panX;
+    entry.panY = panY;
+    screenBounds.push_back(entry);
+}
+
+void CameraBounds::setScreenBounds(const std::map<CharacterId, ScreenBound> & bounds){
+    screenBounds.clear();
+    for (std::map<CharacterId, ScreenBound>::const_iterator it = bounds.begin(); it != bounds.end(); it++){
+        if (it->second.enabled){
+            setScreenBound(it->first, it->second.offScreen, it->second.panX, it->second.panY);
+        }
+    }
+}
+
+}
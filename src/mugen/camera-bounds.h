@@ -0,0 +1,132 @@
+#ifndef _paintown_mugen_camera_bounds_h
+#define _paintown_mugen_camera_bounds_h
+
+#include <map>
+#include <vector>
+#include "common.h"
+
+namespace Mugen{
+
+struct ScreenBound;
+
+/* The edges of the screen, the tension lines that start moving the camera
+ * and the ScreenBound settings of the current tick, worked out once so the
+ * many questions the triggers, controllers and the camera ask about them
+ * every tick are answered with a couple of loads.
+ *
+ * The stage updates the edges every time the camera moves, so they are right
+ * in the middle of a tick too. ScreenBound settings are kept in a short flat
+ * list that is emptied at the start of every tick without freeing it; only a
+ * few characters ever use ScreenBound at the same time.
+ */
+class CameraBounds{
+public:
+    CameraBounds();
+
+    /* the left and right bound of the camera, the tension and the vertical
+     * follow from the stage definition
+     */
+    void setLimits(int boundLeft, int boundRight, int tension, double verticalFollow);
+
+    /* the camera moved */
+    void update(double cameraX, double cameraY);
+
+    /* the start of a tick, ScreenBound only lasts for the tick it was used on */
+    void clearScreenBounds();
+    void setScreenBound(const CharacterId & id, bool offScreen, bool panX, bool panY);
+    /* replaces the ScreenBound settings, when the stage state is restored */
+    void setScreenBounds(const std::map<CharacterId, ScreenBound> & bounds);
+
+    /* Edges of the screen for a character, which is the whole stage if it
+     * used ScreenBound with value = 0.
+     */
+    inline int left(const CharacterId & id) const {
+        const Entry * entry = find(id);
+        return entry != NULL && entry->offScreen ? offScreenLeft : screenLeft;
+    }
+
+    inline int right(const CharacterId & id) const {
+        const Entry * entry = find(id);
+        return entry != NULL && entry->offScreen ? offScreenRight : screenRight;
+    }
+
+    /* A character closer than the tension to an edge of its screen pulls the
+     * camera along when it moves.
+     */
+    inline int leftTension(const CharacterId & id) const {
+        const Entry * entry = find(id);
+        return entry != NULL && entry->offScreen ? offScreenLeft + tension : screenLeftTension;
+    }
+
+    inline int rightTension(const CharacterId & id) const {
+        const Entry * entry = find(id);
+        return entry != NULL && entry->offScreen ? offScreenRight - tension : screenRightTension;
+    }
+
+    /* how far the camera moves up or down on a tick it follows a character */
+    inline double followStep() const {
+        return follow;
+    }
+
+    /* edges of the visible screen */
+    inline int left() const {
+        return screenLeft;
+    }
+
+    inline int right() const {
+        return screenRight;
+    }
+
+    inline int up() const {
+        return screenUp;
+    }
+
+    inline int down() const {
+        return screenDown;
+    }
+
+    /* whether the character moves the camera horizontally or vertically */
+    inline bool panX(const CharacterId & id) const {
+        const Entry * entry = find(id);
+        return entry == NULL || entry->panX;
+    }
+
+    inline bool panY(const CharacterId & id) const {
+        const Entry * entry = find(id);
+        return entry == NULL || entry->panY;
+    }
+
+protected:
+    struct Entry{
+        CharacterId id;
+        bool offScreen;
+        bool panX;
+        bool panY;
+    };
+
+    inline const Entry * find(const CharacterId & id) const {
+        for (unsigned int i = 0; i < screenBounds.size(); i++){
+            if (screenBounds[i].id == id){
+                return &screenBounds[i];
+            }
+        }
+        return NULL;
+    }
+
+    int screenLeft;
+    int screenRight;
+    int screenUp;
+    int screenDown;
+    int offScreenLeft;
+    int offScreenRight;
+    int tension;
+    int screenLeftTension;
+    int screenRightTension;
+    double follow;
+
+    std::vector<Entry> screenBounds;
+};
+
+}
+
+#endif
@@ -7,6 +7,7 @@
 #include "sound.h"
 #include "config.h"
 #include "util.h"
+#include "factory/presenter.h"
 
 #include <r-tech1/graphics/bitmap.h>
 #include <r-tech1/timedifference.h>
@@ -527,7 +528,6 @@ StageMenu::~StageMenu(){
 }
 
 void StageMenu::act(){
-    PaintownUtil::Thread::ScopedLock scoped(lock);
     if (!enabled){
         return;
     }
@@ -535,7 +535,6 @@ void StageMenu::act(){
 }
 
 void StageMenu::draw(const Graphics::Bitmap & work){
-    PaintownUtil::Thread::ScopedLock scoped(lock);
     if (!enabled){
         return;
     }
@@ -548,23 +547,41 @@ void StageMenu::draw(const Graphics::Bitmap & work){
 }
 
 void StageMenu::add(const Filesystem::AbsolutePath & stage){
-    PaintownUtil::Thread::ScopedLock scoped(lock);
     try {
-        for (std::vector<Filesystem::AbsolutePath>::iterator i = stages.begin(); i != stages.end(); ++i){
-            const Filesystem::AbsolutePath & check = *i;
-            if (stage == check){
-                return;
-            }
-        }
         AstRef parsed(Util::parseDef(stage));
-        const std::string & name = Util::probeDef(parsed, "info", "name");
-        stages.push_back(stage);
-        names.push_back(name);
+        add(stage, Util::probeDef(parsed, "info", "name"));
     } catch (const MugenException & ex){
         Global::debug(2) << "Warning! Tried to load file: '" << stage.path() << "'. Message: " << ex.getReason() << std::endl;
     }
 }
 
+void StageMenu::add(const Filesystem::AbsolutePath & stage, const std::string & name){
+    for (std::vector<Filesystem::AbsolutePath>::iterator i = stages.begin(); i != stages.end(); ++i){
+        const Filesystem::AbsolutePath & check = *i;
+        if (stage == check){
+            return;
+        }
+    }
+    stages.push_back(stage);
+    names.push_back(name);
+}
+
+void StageMenu::remove(const Filesystem::AbsolutePath & stage){
+    for (unsigned int i = 0; i < stages.size(); i++){
+        if (stages[i] == stage){
+            stages.erase(stages.begin() + i);
+            names.erase(names.begin() + i);
+            if (stages.size() == 0){
+                random = true;
+                current = 0;
+            } else if (current >= stages.size()){
+                current = stages.size() - 1;
+            }
+            return;
+        }
+    }
+}
+
 bool StageMenu::up(){
     return false;
 }
@@ -574,7 +591,6 @@ bool StageMenu::down(){
 }
 
 bool StageMenu::left(){
-    PaintownUtil::Thread::ScopedLock scoped(lock);
     if (!enabled || finished){
         return false;
     }
@@ -593,7 +609,6 @@ bool StageMenu::left(){
 }
 
 bool StageMenu::right(){
-    PaintownUtil::Thread::ScopedLock scoped(lock);
     if (!enabled || finished){
         return false;
     }
@@ -2808,7 +2823,8 @@ void CharacterSelect::cursorsAct(){
 }
 
 void CharacterSelect::act(){
-    PaintownUtil::Thread::ScopedLock scoped(lock);
+    applyChanges();
+
     for (std::vector< PaintownUtil::ReferenceCount<Cell> >::iterator i = cells.begin(); i != cells.end(); ++i){
         PaintownUtil::ReferenceCount<Cell> cell = *i;
         cell->act();
@@ -3055,7 +3071,6 @@ void CharacterSelect::drawCursors(int xOffset, int yOffset, const Graphics::Bitm
 }
 
 void CharacterSelect::draw(const Graphics::Bitmap & work){
-    PaintownUtil::Thread::ScopedLock scoped(lock);
     // Render Background
     background->renderBackground(0, 0, work);
     
@@ -3091,7 +3106,6 @@ void CharacterSelect::draw(const Graphics::Bitmap & work){
 }
 
 void CharacterSelect::setMode(const Mugen::GameType & game, const PlayerType & player){
-    PaintownUtil::Thread::ScopedLock scoped(lock);
     if (game == Mugen::Undefined){
         return;
     }
@@ -3125,7 +3139,6 @@ void CharacterSelect::setMode(const Mugen::GameType & game, const PlayerType & p
 }
 
 void CharacterSelect::up(unsigned int cursor){
-    PaintownUtil::Thread::ScopedLock scoped(lock);
     if (cursor == 0){
         player1.up();
     } else if (cursor == 1){
@@ -3134,7 +3147,6 @@ void CharacterSelect::up(unsigned int cursor){
 }
 
 void CharacterSelect::down(unsigned int cursor){
-    PaintownUtil::Thread::ScopedLock scoped(lock);
     if (cursor == 0){
         player1.down();
     } else if (cursor == 1){
@@ -3143,7 +3155,6 @@ void CharacterSelect::down(unsigned int cursor){
 }
 
 void CharacterSelect::left(unsigned int cursor){
-    PaintownUtil::Thread::ScopedLock scoped(lock);
     if (cursor == 0){
         player1.left();
     } else if (cursor == 1){
@@ -3152,7 +3163,6 @@ void CharacterSelect::left(unsigned int cursor){
 }
 
 void CharacterSelect::right(unsigned int cursor){
-    PaintownUtil::Thread::ScopedLock scoped(lock);
     if (cursor == 0){
         player1.right();
     } else if (cursor == 1){
@@ -3161,7 +3171,6 @@ void CharacterSelect::right(unsigned int cursor){
 }
 
 void CharacterSelect::select(unsigned int cursor, int act){
-    PaintownUtil::Thread::ScopedLock scoped(lock);
     if (cursor == 0){
         try {
             player1.select(act);
@@ -3182,37 +3191,118 @@ void CharacterSelect::select(unsigned int cursor, int act){
 }
 
 bool CharacterSelect::uniqueCharacter(const Filesystem::AbsolutePath definitionPath) const {
-    PaintownUtil::Thread::ScopedLock scoped(lock);
-    for (std::vector<PaintownUtil::ReferenceCount<Cell> >::const_iterator it = cells.begin(); it != cells.end(); it++){
-        PaintownUtil::ReferenceCount<Cell> cell = *it;
-        if (cell->getCharacter().getDef() == definitionPath){
-            return false;
-        }
+    PaintownUtil::Thread::ScopedLock scoped(pendingLock);
+    return definitions.find(definitionPath) == definitions.end();
+}
+
+/* Fills in the name of the stage and returns true if the path is a stage. Does
+ * the parsing on the thread that adds the stage rather than the one that
+ * draws the select screen.
+ */
+static bool probeStage(const Filesystem::AbsolutePath & stage, std::string & name){
+    /* Check if it looks like a character, in which case ignore the stage */
+    try{
+        Util::probeDef(stage, "files", "cns");
+        return false;
+    } catch (const MugenException & fail){
     }
-    return true;
+
+    try{
+        /* Make sure its a real stage */
+        name = Util::probeDef(stage, "info", "name");
+        return true;
+    } catch (const MugenException & fail){
+        return false;
+    }
+}
+
+CharacterSelect::RosterChange::RosterChange(Operation operation, const Filesystem::AbsolutePath & path, const std::string & name):
+operation(operation),
+path(path),
+name(name){
+}
+
+CharacterSelect::RosterChange::RosterChange(const Mugen::ArcadeData::CharacterInfo & character, const std::string & stageName):
+operation(AddCharacter),
+path(character.getDef()),
+name(stageName),
+character(character){
 }
 
 bool CharacterSelect::addCharacter(const Mugen::ArcadeData::CharacterInfo & character){
-    PaintownUtil::Thread::ScopedLock scoped(lock);
-    // Check if the character exists
-    /*
-    for (std::vector<Mugen::ArcadeData::CharacterInfo>::iterator i = characters.begin(); i != characters.end(); ++i){
-        const Mugen::ArcadeData::CharacterInfo & check = *i;
-        if (character == check){
-            return false;
+    std::string stageName;
+    if (character.getIncludeStage() && !character.getStage().isEmpty() && !probeStage(character.getStage(), stageName)){
+        stageName = "";
+    }
+
+    PaintownUtil::Thread::ScopedLock scoped(pendingLock);
+    pending.push_back(RosterChange(character, stageName));
+    return definitions.insert(character.getDef()).second;
+}
+
+void CharacterSelect::applyChanges(){
+    std::vector<RosterChange> batch;
+    {
+        PaintownUtil::Thread::ScopedLock scoped(pendingLock);
+        batch.swap(pending);
+    }
+
+    for (std::vector<RosterChange>::iterator it = batch.begin(); it != batch.end(); it++){
+        const RosterChange & change = *it;
+        switch (change.operation){
+            case RosterChange::AddCharacter: {
+                placeCharacter(change.character, change.name);
+                break;
+            }
+            case RosterChange::RemoveCharacter: {
+                unplaceCharacter(change.path);
+                break;
+            }
+            case RosterChange::AddStage: {
+                stages.add(change.path, change.name);
+                break;
+            }
+            case RosterChange::RemoveStage: {
+                stages.remove(change.path);
+                break;
+            }
         }
-    }*/
+    }
+}
 
+void CharacterSelect::removeCharacter(const Filesystem::AbsolutePath & definition){
+    PaintownUtil::Thread::ScopedLock scoped(pendingLock);
+    pending.push_back(RosterChange(RosterChange::RemoveCharacter, definition, ""));
+    definitions.erase(definition);
+}
 
+void CharacterSelect::unplaceCharacter(const Filesystem::AbsolutePath & definition){
+    for (std::vector<PaintownUtil::ReferenceCount<Cell> >::iterator it = cells.begin(); it != cells.end(); it++){
+        PaintownUtil::ReferenceCount<Cell> cell = *it;
+        if (!cell->isEmpty() && !cell->isRandom() && !cell->isUnused() && cell->getCharacter().getDef() == definition){
+            /* the next character that is added can go here */
+            cell->setUnused();
+        }
+    }
+
+    for (std::vector<Mugen::ArcadeData::CharacterInfo>::iterator it = characters.begin(); it != characters.end(); /**/){
+        if (it->getDef() == definition){
+            it = characters.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
+
+bool CharacterSelect::placeCharacter(const Mugen::ArcadeData::CharacterInfo & character, const std::string & stageName){
     /* Find an unused cell if available */
     for (unsigned int i = 0; i < nextCell && i < cells.size(); i++){
         PaintownUtil::ReferenceCount<Cell> cell = cells[i];
         if (cell->isUnused()){
             characters.push_back(character);
             // Include stage if required
-            if (character.getIncludeStage()){
-                /* We hold the lock so call doAddStage directly */
-                doAddStage(character.getStage());
+            if (stageName != ""){
+                stages.add(character.getStage(), stageName);
             }
 
             cell->setCharacter(character);
@@ -3225,9 +3315,8 @@ bool CharacterSelect::addCharacter(const Mugen::ArcadeData::CharacterInfo & char
         // Add to list
         characters.push_back(character);
         // Include stage if required
-        if (character.getIncludeStage()){
-            /* We hold the lock so call doAddStage directly */
-            doAddStage(character.getStage());
+        if (stageName != ""){
+            stages.add(character.getStage(), stageName);
         }
         // Add to current cell
         cells[nextCell]->setCharacter(character);
@@ -3244,9 +3333,8 @@ bool CharacterSelect::addCharacter(const Mugen::ArcadeData::CharacterInfo & char
             if (cell->isRandom()){
                 characters.push_back(character);
                 // Include stage if required
-                if (character.getIncludeStage()){
-                    /* We hold the lock so call doAddStage directly */
-                    doAddStage(character.getStage());
+                if (stageName != ""){
+                    stages.add(character.getStage(), stageName);
                 }
 
                 cell->setCharacter(character);
@@ -3258,7 +3346,6 @@ bool CharacterSelect::addCharacter(const Mugen::ArcadeData::CharacterInfo & char
 }
 
 void CharacterSelect::addEmpty(){
-    PaintownUtil::Thread::ScopedLock scoped(lock);
     if (nextCell < cells.size()){
         cells[nextCell]->setEmpty();
         nextCell++;
@@ -3266,7 +3353,6 @@ void CharacterSelect::addEmpty(){
 }
 
 void CharacterSelect::addUnused(){
-    PaintownUtil::Thread::ScopedLock scoped(lock);
     if (nextCell < cells.size()){
         cells[nextCell]->setUnused();
         nextCell++;
@@ -3274,7 +3360,6 @@ void CharacterSelect::addUnused(){
 }
 
 void CharacterSelect::addRandom(){
-    PaintownUtil::Thread::ScopedLock scoped(lock);
     if (nextCell < cells.size()){
         cells[nextCell]->setRandom();
         nextCell++;
@@ -3282,28 +3367,30 @@ void CharacterSelect::addRandom(){
 }
     
 int CharacterSelect::stageCount() const {
-    PaintownUtil::Thread::ScopedLock scoped(lock);
-    return stages.getStages().size();
-}
-
-/* Only call this if you hold the lock */
-void CharacterSelect::doAddStage(const Filesystem::AbsolutePath & stage){
-    /* Check if it looks like a character, in which case ignore the stage */
-    try{
-        Util::probeDef(stage, "files", "cns");
-    } catch (const MugenException & fail){
-        try{
-            /* Make sure its a real stage */
-            Util::probeDef(stage, "info", "name");
-            stages.add(stage);
-        } catch (const MugenException & fail){
+    const std::vector<Filesystem::AbsolutePath> & shown = stages.getStages();
+    std::set<Filesystem::AbsolutePath> all(shown.begin(), shown.end());
+    PaintownUtil::Thread::ScopedLock scoped(pendingLock);
+    for (std::vector<RosterChange>::const_iterator it = pending.begin(); it != pending.end(); it++){
+        if (it->operation == RosterChange::AddStage){
+            all.insert(it->path);
+        } else if (it->operation == RosterChange::RemoveStage){
+            all.erase(it->path);
         }
     }
+    return all.size();
 }
 
 void CharacterSelect::addStage(const Filesystem::AbsolutePath & stage){
-    PaintownUtil::Thread::ScopedLock scoped(lock);
-    doAddStage(stage);
+    std::string name;
+    if (probeStage(stage, name)){
+        PaintownUtil::Thread::ScopedLock scoped(pendingLock);
+        pending.push_back(RosterChange(RosterChange::AddStage, stage, name));
+    }
+}
+
+void CharacterSelect::removeStage(const Filesystem::AbsolutePath & stage){
+    PaintownUtil::Thread::ScopedLock scoped(pendingLock);
+    pending.push_back(RosterChange(RosterChange::RemoveStage, stage, ""));
 }
 
 Mugen::ArcadeData::MatchPath CharacterSelect::getArcadePath(){
@@ -3581,7 +3668,9 @@ public:
         owner(owner),
         going(true),
         check(going, lock.getLock()),
-        thread(PaintownUtil::Thread::uninitializedValue){
+        thread(PaintownUtil::Thread::uninitializedValue),
+        nextCharacter(0),
+        nextStage(0){
             if (!PaintownUtil::Thread::createThread(&thread, NULL, (PaintownUtil::Thread::ThreadFunction) doProcess, this)){
                 Global::debug(0) << "Could not create processing thread" << std::endl;
             }
@@ -3599,14 +3688,43 @@ public:
             stop();
         }
     
+        /* A path that was found or removed. Both go through the same queue
+         * so a character that is removed and copied back ends up added.
+         */
+        struct Change{
+            Change(const Filesystem::AbsolutePath & path, bool removed):
+            path(path),
+            removed(removed){
+            }
+
+            Filesystem::AbsolutePath path;
+            bool removed;
+        };
+
+        static void queue(std::vector<Change> & changes, const std::vector<Filesystem::AbsolutePath> & paths, bool removed){
+            for (std::vector<Filesystem::AbsolutePath>::const_iterator it = paths.begin(); it != paths.end(); it++){
+                changes.push_back(Change(*it, removed));
+            }
+        }
+
         virtual void receiveCharacters(const std::vector<Filesystem::AbsolutePath> & paths){
             PaintownUtil::Thread::ScopedLock scoped(lock);
-            characters.insert(characters.end(), paths.begin(), paths.end());
+            queue(characters, paths, false);
         }
 
         virtual void receiveStages(const std::vector<Filesystem::AbsolutePath> & paths){
             PaintownUtil::Thread::ScopedLock scoped(lock);
-            stages.insert(stages.end(), paths.begin(), paths.end());
+            queue(stages, paths, false);
+        }
+
+        virtual void removeCharacters(const std::vector<Filesystem::AbsolutePath> & paths){
+            PaintownUtil::Thread::ScopedLock scoped(lock);
+            queue(characters, paths, true);
+        }
+
+        virtual void removeStages(const std::vector<Filesystem::AbsolutePath> & paths){
+            PaintownUtil::Thread::ScopedLock scoped(lock);
+            queue(stages, paths, true);
         }
 
         static void * doProcess(void * self_){
@@ -3615,34 +3733,49 @@ public:
             return NULL;
         }
 
+        /* Once the current batch is used up take everything that was
+         * received since, so the lock is only held for a swap.
+         */
         bool maybeAddCharacter(){
-            Filesystem::AbsolutePath path;
-            {
+            if (nextCharacter == characterBatch.size()){
+                characterBatch.clear();
+                nextCharacter = 0;
                 PaintownUtil::Thread::ScopedLock scoped(lock);
-                if (characters.size() > 0){
-                    path = characters.front();
-                    characters.erase(characters.begin());
+                characterBatch.swap(characters);
+            }
+
+            if (nextCharacter < characterBatch.size()){
+                const Change & change = characterBatch[nextCharacter];
+                if (change.removed){
+                    owner.removeCharacter(change.path);
                 } else {
-                    return false;
+                    owner.addCharacter(change.path);
                 }
+                nextCharacter += 1;
+                return true;
             }
-            owner.addCharacter(path);
-            return true;
+            return false;
         }
 
         bool maybeAddStage(){
-            Filesystem::AbsolutePath path;
-            {
+            if (nextStage == stageBatch.size()){
+                stageBatch.clear();
+                nextStage = 0;
                 PaintownUtil::Thread::ScopedLock scoped(lock);
-                if (stages.size() > 0){
-                    path = stages.front();
-                    stages.erase(stages.begin());
+                stageBatch.swap(stages);
+            }
+
+            if (nextStage < stageBatch.size()){
+                const Change & change = stageBatch[nextStage];
+                if (change.removed){
+                    owner.removeStage(change.path);
                 } else {
-                    return false;
+                    owner.addStage(change.path);
                 }
+                nextStage += 1;
+                return true;
             }
-            owner.addStage(path);
-            return true;
+            return false;
         }
 
         /* Actually process the characters/stages. Interleave them
@@ -3677,8 +3810,14 @@ public:
         PaintownUtil::ThreadBoolean check;
 
         PaintownUtil::Thread::Id thread;
-        std::vector<Filesystem::AbsolutePath> characters;
-        std::vector<Filesystem::AbsolutePath> stages;
+        std::vector<Change> characters;
+        std::vector<Change> stages;
+
+        /* only used by the processing thread */
+        std::vector<Change> characterBatch;
+        unsigned int nextCharacter;
+        std::vector<Change> stageBatch;
+        unsigned int nextStage;
     };
 
     Subscriber subscription;
@@ -3819,6 +3958,24 @@ public:
     void addStage(const Filesystem::AbsolutePath & path){
         select.addStage(path);
     }
+
+    void removeCharacter(const Filesystem::AbsolutePath & path){
+        if (Storage::isContainer(path)){
+            /* the def that addCharacter found inside the container */
+            std::string where = Path::removeExtension(path.getFilename().path());
+            Filesystem::AbsolutePath def = path.getDirectory().join(Filesystem::RelativePath(where)).join(Filesystem::RelativePath(where + ".def"));
+            if (!select.uniqueCharacter(def)){
+                select.removeCharacter(def);
+                Storage::instance().removeOverlay(path, path.getDirectory());
+            }
+        } else {
+            select.removeCharacter(path);
+        }
+    }
+
+    void removeStage(const Filesystem::AbsolutePath & path){
+        select.removeStage(path);
+    }
     
     bool done(){
         PaintownUtil::Thread::ScopedLock scoped(lock);
@@ -3905,17 +4062,18 @@ public:
 class SelectDraw: public PaintownUtil::Draw {
 public:
     SelectDraw(Mugen::CharacterSelect & select):
-    select(select){
+    select(select),
+    presenter(DEFAULT_SELECT_WIDTH, DEFAULT_SELECT_HEIGHT){
     }
     
     Mugen::CharacterSelect & select;
+    Presenter presenter;
 
     void draw(const Graphics::Bitmap & buffer){
         // buffer.clear();
-        Graphics::StretchedBitmap work(DEFAULT_SELECT_WIDTH, DEFAULT_SELECT_HEIGHT, buffer, Graphics::StretchedBitmap::NoClear, Graphics::qualityFilterName(::Configuration::getQualityFilter()));
-        work.start();
+        Graphics::Bitmap & work = presenter.start(buffer);
         select.draw(work);
-        work.finish();
+        presenter.finish(buffer);
         // buffer.BlitToScreen();
     }
 };
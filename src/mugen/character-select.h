@@ -1,6 +1,7 @@
 #ifndef mugen_character_select_h
 #define mugen_character_select_h
 
+#include <set>
 #include <vector>
 
 #include "background.h"
@@ -287,6 +288,10 @@ public:
     
     //! Add stage
     virtual void add(const Filesystem::AbsolutePath &);
+    //! Add stage whose name is already known
+    virtual void add(const Filesystem::AbsolutePath &, const std::string & name);
+    //! Remove stage
+    virtual void remove(const Filesystem::AbsolutePath &);
     
     //! Up
     bool up();
@@ -335,8 +340,6 @@ protected:
     bool enabled;
     //! Is finished
     bool finished;
-    //! Thread lock
-    PaintownUtil::Thread::LockObject lock;
 };
 
 //! Sound types
@@ -531,8 +534,12 @@ public:
     virtual void right(unsigned int cursor);
     //! Make current selection
     virtual void select(unsigned int cursor, int act = 0);
-    //! Add Character
+    /* Add a character from any thread, it is put in a cell on the next act().
+     * Returns false if a character with the same def was already added.
+     */
     virtual bool addCharacter(const Mugen::ArcadeData::CharacterInfo &);
+    /* Remove the character with the given def from any thread */
+    virtual void removeCharacter(const Filesystem::AbsolutePath & definition);
     //! Add Empty slot
     virtual void addEmpty();
 
@@ -541,9 +548,13 @@ public:
 
     //! Make slot a random selector
     virtual void addRandom();
-    //! Add stage
+    /* Add a stage from any thread, it shows up in the stage menu on the next act() */
     virtual void addStage(const Filesystem::AbsolutePath &);
-    /* Number of stages */
+    /* Remove a stage from any thread */
+    virtual void removeStage(const Filesystem::AbsolutePath &);
+    /* Number of stages once the stages added or removed since the last
+     * act() are in the stage menu. Doesn't change the stage menu.
+     */
     virtual int stageCount() const;
     //! Get Arcade Match
     virtual Mugen::ArcadeData::MatchPath getArcadePath();
@@ -590,7 +601,7 @@ public:
         this->titleOverride = title;
     }
     
-    /* true if no cell uses the given definitionPath */
+    /* true if no character with the given definitionPath has been added */
     bool uniqueCharacter(const Filesystem::AbsolutePath definitionPath) const;
 
     void setPlayer1ActiveCursor(PaintownUtil::ReferenceCount<Animation> cursor);
@@ -614,8 +625,40 @@ protected:
     void drawPlayer2Cursor(int x, int y, Gui::SelectListInterface::CursorState state, const Graphics::Bitmap &, bool blink=false) const;
     void drawCursors(int xOffset, int yOffset, const Graphics::Bitmap & work) const;
 
-    /* Adds a stage without taking the lock */
-    void doAddStage(const Filesystem::AbsolutePath & stage);
+    /* Characters and stages that were added or removed by other threads but
+     * aren't on the screen yet. Only the thread that runs act() takes them
+     * out, so the cells and the stage menu are never touched by two threads
+     * and act() and draw() don't need a lock. They are applied in the order
+     * they were made so a character that is added and then removed stays out.
+     */
+    struct RosterChange{
+        enum Operation{
+            AddCharacter,
+            RemoveCharacter,
+            AddStage,
+            RemoveStage
+        };
+
+        RosterChange(Operation operation, const Filesystem::AbsolutePath & path, const std::string & name);
+        RosterChange(const Mugen::ArcadeData::CharacterInfo & character, const std::string & stageName);
+
+        Operation operation;
+        /* the def of the character or stage */
+        Filesystem::AbsolutePath path;
+        /* name of the stage, for a character the name of its stage or empty
+         * if the stage isn't included
+         */
+        std::string name;
+        /* only for AddCharacter */
+        Mugen::ArcadeData::CharacterInfo character;
+    };
+
+    /* Moves the pending changes into the cells and the stage menu */
+    void applyChanges();
+    /* Empties the cells that hold the character */
+    void unplaceCharacter(const Filesystem::AbsolutePath & definition);
+    /* Puts a character in a cell, returns false if there was no room */
+    bool placeCharacter(const Mugen::ArcadeData::CharacterInfo & character, const std::string & stageName);
 
     //! Parse select file
     void parseSelect();
@@ -671,8 +714,11 @@ protected:
     Player player1, player2;
     //! Canceled?
     bool canceled;
-    //! Thread Lock
-    PaintownUtil::Thread::LockObject lock;
+    //! Guards pending and definitions
+    PaintownUtil::Thread::LockObject pendingLock;
+    std::vector<RosterChange> pending;
+    //! Every character def that was added, placed or not
+    std::set<Filesystem::AbsolutePath> definitions;
     //! Demo moves left
     int demoLeftTime, demoRightTime;
     int demoLeftRemaining, demoRightRemaining;
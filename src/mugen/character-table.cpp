@@ -0,0 +1,119 @@
+#include "character-table.h"
+#include "character.h"
+
+using std::vector;
+
+namespace Mugen{
+
+/* enough for two teams and a screen full of helpers */
+static const unsigned int INITIAL_SLOTS = 64;
+
+CharacterTable::Slot::Slot():
+id(-1),
+character(NULL){
+}
+
+CharacterTable::CharacterTable():
+slots(INITIAL_SLOTS),
+count(0){
+}
+
+unsigned int CharacterTable::home(int id) const {
+    /* ids are handed out one after another so they spread out on their own */
+    return ((unsigned int) id) & (slots.size() - 1);
+}
+
+void CharacterTable::insert(const Slot & slot){
+    unsigned int mask = slots.size() - 1;
+    unsigned int index = home(slot.id);
+    while (slots[index].character != NULL && slots[index].id != slot.id){
+        index = (index + 1) & mask;
+    }
+
+    if (slots[index].character == NULL){
+        count += 1;
+    }
+    slots[index] = slot;
+}
+
+void CharacterTable::grow(){
+    vector<Slot> old;
+    old.swap(slots);
+    slots.resize(old.size() * 2);
+    count = 0;
+    for (vector<Slot>::iterator it = old.begin(); it != old.end(); it++){
+        if (it->character != NULL){
+            insert(*it);
+        }
+    }
+}
+
+void CharacterTable::add(Character * character){
+    /* keep at least half the slots free so a lookup rarely looks at more
+     * than one or two of them
+     */
+    if ((count + 1) * 2 > slots.size()){
+        grow();
+    }
+
+    Slot slot;
+    slot.id = character->getId().intValue();
+    slot.character = character;
+    insert(slot);
+}
+
+Character * CharacterTable::find(const CharacterId & id) const {
+    int raw = id.intValue();
+    unsigned int mask = slots.size() - 1;
+    unsigned int index = home(raw);
+    while (slots[index].character != NULL){
+        if (slots[index].id == raw){
+            return slots[index].character;
+        }
+        index = (index + 1) & mask;
+    }
+    return NULL;
+}
+
+void CharacterTable::remove(const CharacterId & id){
+    int raw = id.intValue();
+    unsigned int mask = slots.size() - 1;
+    unsigned int index = home(raw);
+    while (slots[index].character != NULL && slots[index].id != raw){
+        index = (index + 1) & mask;
+    }
+
+    if (slots[index].character == NULL){
+        return;
+    }
+
+    slots[index] = Slot();
+    count -= 1;
+
+    /* Move later entries of the same run back into the hole so a lookup never
+     * stops at a free slot before reaching the entry it wants.
+     */
+    unsigned int hole = index;
+    unsigned int next = (index + 1) & mask;
+    while (slots[next].character != NULL){
+        unsigned int want = home(slots[next].id);
+        /* distance from where the entry wants to be to where it is and to the hole */
+        if (((next - want) & mask) >= ((next - hole) & mask)){
+            slots[hole] = slots[next];
+            slots[next] = Slot();
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+}
+
+void CharacterTable::clear(){
+    slots.assign(INITIAL_SLOTS, Slot());
+    count = 0;
+}
+
+unsigned int CharacterTable::size() const {
+    return count;
+}
+
+}
@@ -0,0 +1,51 @@
+#ifndef _paintown_mugen_character_table_h
+#define _paintown_mugen_character_table_h
+
+#include <vector>
+#include "common.h"
+
+namespace Mugen{
+
+class Character;
+
+/* Finds the characters on the stage by id without looking at all of them.
+ *
+ * The stage hands out ids in order and never reuses one, so the low bits of an
+ * id pick a slot and the rest of the id is the generation of that slot. A slot
+ * only answers for the exact id that was put in it, so the id of a helper that
+ * is gone finds nothing even after a newer helper took over its slot.
+ */
+class CharacterTable{
+public:
+    CharacterTable();
+
+    void add(Character * character);
+    void remove(const CharacterId & id);
+
+    /* NULL if nothing with that id is on the stage */
+    Character * find(const CharacterId & id) const;
+
+    void clear();
+    unsigned int size() const;
+
+protected:
+    struct Slot{
+        Slot();
+
+        int id;
+        /* NULL if the slot is free */
+        Character * character;
+    };
+
+    unsigned int home(int id) const;
+    void grow();
+    void insert(const Slot & slot);
+
+    /* always a power of two */
+    std::vector<Slot> slots;
+    unsigned int count;
+};
+
+}
+
+#endif
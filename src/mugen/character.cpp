@@ -18,6 +18,7 @@
 #include <r-tech1/funcs.h>
 #include <r-tech1/font.h>
 #include <r-tech1/parameter.h>
+#include <r-tech1/thread.h>
 #include <r-tech1/file-system.h>
 #include <r-tech1/timedifference.h>
 #include <r-tech1/debug.h>
@@ -47,6 +48,8 @@
 #include <r-tech1/input/input-manager.h>
 
 #include "parse-cache.h"
+#include "profile.h"
+#include "trace.h"
 #include "parser/all.h"
 #include "ast/all.h"
 
@@ -57,7 +60,25 @@ static const int REGENERATE_TIME = 40;
 
 namespace Mugen{
 
-PaintownUtil::Parameter<Filesystem::RelativePath> stateFileParameter;
+/* gcc, clang and mingw all have __thread */
+static __thread const CurrentStateFile * currentStateFile = NULL;
+
+CurrentStateFile::CurrentStateFile(const Filesystem::RelativePath & file):
+file(file),
+previous(currentStateFile){
+    currentStateFile = this;
+}
+
+CurrentStateFile::~CurrentStateFile(){
+    currentStateFile = previous;
+}
+
+std::string CurrentStateFile::path(){
+    if (currentStateFile == NULL){
+        return "";
+    }
+    return currentStateFile->file.path();
+}
 
 namespace StateType{
 
@@ -811,9 +832,9 @@ void Character::loadCmdFile(const Filesystem::RelativePath & path){
 
                 DefaultWalker walker(defaultTime, defaultBufferTime);
                 section->walk(walker);
-            } else if (PaintownUtil::matchRegex(head, PaintownUtil::Regex("statedef"))){
+            } else if (Util::scanStateHeader(head).kind == Util::StateHeader::Definition){
                 currentState = parseStateDefinition(section, full, out);
-            } else if (PaintownUtil::matchRegex(head, PaintownUtil::Regex("state "))){
+            } else if (Util::scanStateHeader(head).kind == Util::StateHeader::Controller){
                 if (currentState != NULL){
                     currentState->addController(parseState(section));
                 } else {
@@ -853,10 +874,8 @@ void Character::loadCmdFile(const Filesystem::RelativePath & path){
     mergeStates(getLocalData().states, out);
 }
 
-static bool isStateDefSection(string name){
-    name = Util::fixCase(name);
-    return PaintownUtil::matchRegex(name, PaintownUtil::Regex("state ")) ||
-           PaintownUtil::matchRegex(name, PaintownUtil::Regex("statedef "));
+static bool isStateDefSection(const string & name){
+    return Util::scanStateHeader(name).kind != Util::StateHeader::Other;
 }
 
 static AttackType::Attribute parseAttribute(const string & kind, const string & action){
@@ -981,6 +1000,22 @@ static RuntimeValue extractVariable(const map<int, RuntimeValue> & stuff, int in
     return RuntimeValue(0);
 }
 
+static const RuntimeValue * lookupVariable(const map<int, RuntimeValue> & stuff, int index){
+    map<int, RuntimeValue>::const_iterator found = stuff.find(index);
+    if (found != stuff.end()){
+        return &(*found).second;
+    }
+    return NULL;
+}
+
+const RuntimeValue * Character::findVariable(int index) const {
+    return lookupVariable(getStateData().variables, index);
+}
+
+const RuntimeValue * Character::findFloatVariable(int index) const {
+    return lookupVariable(getStateData().floatVariables, index);
+}
+
 RuntimeValue Character::getVariable(int index) const {
     return extractVariable(getStateData().variables, index);
 }
@@ -1455,11 +1490,7 @@ void Character::loadCnsFile(const Filesystem::RelativePath & path){
 }
 
 PaintownUtil::ReferenceCount<State> Character::parseStateDefinition(Ast::Section * section, const Filesystem::AbsolutePath & path, map<int, PaintownUtil::ReferenceCount<State> > & stateMap){
-    std::string head = section->getName();
-    /* this should really be head = Mugen::Util::fixCase(head) */
-    head = Util::fixCase(head);
-
-    int state = atoi(PaintownUtil::captureRegex(head, PaintownUtil::Regex("statedef *(-?[0-9]+)"), 0).c_str());
+    int state = Util::scanStateHeader(section->getName()).state;
     class StateWalker: public Ast::Walker {
         public:
             StateWalker(PaintownUtil::ReferenceCount<State> definition, const Filesystem::AbsolutePath & path):
@@ -1559,112 +1590,15 @@ PaintownUtil::ReferenceCount<State> Character::parseStateDefinition(Ast::Section
     return definition;
 }
         
-static map<string, StateController::Type> types;
-static bool typesSetup = false;
-
 StateController * Character::parseState(Ast::Section * section){
-    std::string head = section->getName();
-    head = Util::fixCase(head);
-
-    string name = PaintownUtil::captureRegex(head, PaintownUtil::Regex("state *-?[0-9]+ *, *(.*)"), 0);
-    int state = atoi(PaintownUtil::captureRegex(head, PaintownUtil::Regex("state *(-?[0-9]+)"), 0).c_str());
+    Util::StateHeader header = Util::scanStateHeader(section->getName());
+    const string & name = header.name;
+    int state = header.state;
 
     class StateControllerWalker: public Ast::Walker {
     public:
         StateControllerWalker():
         type(StateController::Unknown){
-            if (!typesSetup){
-                typesSetup = true;
-                types["afterimage"] = StateController::AfterImage;
-                types["afterimagetime"] = StateController::AfterImageTime;
-                types["allpalfx"] = StateController::AllPalFX;
-                types["angleadd"] = StateController::AngleAdd;
-                types["angledraw"] = StateController::AngleDraw;
-                types["anglemul"] = StateController::AngleMul;
-                types["angleset"] = StateController::AngleSet;
-                types["appendtoclipboard"] = StateController::AppendToClipboard;
-                types["assertspecial"] = StateController::AssertSpecial;
-                types["attackdist"] = StateController::AttackDist;
-                types["attackmulset"] = StateController::AttackMulSet;
-                types["bgpalfx"] = StateController::BGPalFX;
-                types["bindtoparent"] = StateController::BindToParent;
-                types["bindtoroot"] = StateController::BindToRoot;
-                types["bindtotarget"] = StateController::BindToTarget;
-                types["changeanim"] = StateController::ChangeAnim;
-                types["changeanim2"] = StateController::ChangeAnim2;
-                types["changestate"] = StateController::ChangeState;
-                types["clearclipboard"] = StateController::ClearClipboard;
-                types["ctrlset"] = StateController::CtrlSet;
-                types["defencemulset"] = StateController::DefenceMulSet;
-                types["destroyself"] = StateController::DestroySelf;
-                types["displaytoclipboard"] = StateController::DisplayToClipboard;
-                types["envcolor"] = StateController::EnvColor;
-                types["envshake"] = StateController::EnvShake;
-                types["explod"] = StateController::Explod;
-                types["explodbindtime"] = StateController::ExplodBindTime;
-                types["forcefeedback"] = StateController::ForceFeedback;
-                types["fallenvshake"] = StateController::FallEnvShake;
-                types["gamemakeanim"] = StateController::GameMakeAnim;
-                types["gravity"] = StateController::Gravity;
-                types["helper"] = StateController::Helper;
-                types["hitadd"] = StateController::HitAdd;
-                types["hitby"] = StateController::HitBy;
-                types["hitdef"] = StateController::HitDef;
-                types["hitfalldamage"] = StateController::HitFallDamage;
-                types["hitfallset"] = StateController::HitFallSet;
-                types["hitfallvel"] = StateController::HitFallVel;
-                types["hitoverride"] = StateController::HitOverride;
-                types["hitvelset"] = StateController::HitVelSet;
-                types["lifeadd"] = StateController::LifeAdd;
-                types["lifeset"] = StateController::LifeSet;
-                types["makedust"] = StateController::MakeDust;
-                types["modifyexplod"] = StateController::ModifyExplod;
-                types["movehitreset"] = StateController::MoveHitReset;
-                types["nothitby"] = StateController::NotHitBy;
-                types["null"] = StateController::Null;
-                types["offset"] = StateController::Offset;
-                types["palfx"] = StateController::PalFX;
-                types["parentvaradd"] = StateController::ParentVarAdd;
-                types["parentvarset"] = StateController::ParentVarSet;
-                types["pause"] = StateController::Pause;
-                types["playerpush"] = StateController::PlayerPush;
-                types["playsnd"] = StateController::PlaySnd;
-                types["posadd"] = StateController::PosAdd;
-                types["posfreeze"] = StateController::PosFreeze;
-                types["posset"] = StateController::PosSet;
-                types["poweradd"] = StateController::PowerAdd;
-                types["powerset"] = StateController::PowerSet;
-                types["projectile"] = StateController::Projectile;
-                types["removeexplod"] = StateController::RemoveExplod;
-                types["reversaldef"] = StateController::ReversalDef;
-                types["screenbound"] = StateController::ScreenBound;
-                types["selfstate"] = StateController::SelfState;
-                types["sprpriority"] = StateController::SprPriority;
-                types["statetypeset"] = StateController::StateTypeSet;
-                types["sndpan"] = StateController::SndPan;
-                types["stopsnd"] = StateController::StopSnd;
-                types["superpause"] = StateController::SuperPause;
-                types["targetbind"] = StateController::TargetBind;
-                types["targetdrop"] = StateController::TargetDrop;
-                types["targetfacing"] = StateController::TargetFacing;
-                types["targetlifeadd"] = StateController::TargetLifeAdd;
-                types["targetpoweradd"] = StateController::TargetPowerAdd;
-                types["targetstate"] = StateController::TargetState;
-                types["targetveladd"] = StateController::TargetVelAdd;
-                types["targetvelset"] = StateController::TargetVelSet;
-                types["trans"] = StateController::Trans;
-                types["turn"] = StateController::Turn;
-                types["varadd"] = StateController::VarAdd;
-                types["varrandom"] = StateController::VarRandom;
-                types["varrangeset"] = StateController::VarRangeSet;
-                types["varset"] = StateController::VarSet;
-                types["veladd"] = StateController::VelAdd;
-                types["velmul"] = StateController::VelMul;
-                types["velset"] = StateController::VelSet;
-                types["width"] = StateController::Width;
-                types["zoom"] = StateController::Zoom;
-                types["debug"] = StateController::Debug;
-            }
         }
 
         StateController::Type type;
@@ -1675,10 +1609,8 @@ StateController * Character::parseState(Ast::Section * section){
                 simple.view() >> type;
                 type = Mugen::Util::fixCase(type);
                 
-                if (types.find(type) != types.end()){
-                    map<string, StateController::Type>::iterator what = types.find(type);
-                    this->type = (*what).second;
-                } else {
+                this->type = StateController::typeFromName(type);
+                if (this->type == StateController::Unknown){
                     Global::debug(0) << "Unknown state controller type " << type << endl;
                 }
             }
@@ -1729,7 +1661,7 @@ static Filesystem::AbsolutePath findStateFile(const Filesystem::AbsolutePath & b
 void Character::loadStateFile(const Filesystem::AbsolutePath & base, const string & path){
     Filesystem::AbsolutePath full = findStateFile(base, path);
     MessageQueue::info("Reading " + Storage::instance().cleanse(full).path());
-    PaintownUtil::Parameter<Filesystem::RelativePath> currentFile(stateFileParameter, Storage::instance().cleanse(full));
+    CurrentStateFile currentFile(Storage::instance().cleanse(full));
     // string full = Filesystem::find(base + "/" + PaintownUtil::trim(path));
     /* st can use the Cmd parser */
     AstRef parsed(Util::parseCmd(full));
@@ -1738,11 +1670,11 @@ void Character::loadStateFile(const Filesystem::AbsolutePath & base, const strin
     for (Ast::AstParse::section_iterator section_it = parsed->getSections()->begin(); section_it != parsed->getSections()->end(); section_it++){
         Ast::Section * section = *section_it;
         std::string head = section->getName();
-        head = Util::fixCase(head);
+        Util::StateHeader::Kind kind = Util::scanStateHeader(head).kind;
 
-        if (PaintownUtil::matchRegex(head, PaintownUtil::Regex("statedef"))){
+        if (kind == Util::StateHeader::Definition){
             currentState = parseStateDefinition(section, full, out);
-        } else if (PaintownUtil::matchRegex(head, PaintownUtil::Regex("state "))){
+        } else if (kind == Util::StateHeader::Controller){
             if (currentState != NULL){
                 StateController * controller = parseState(section);
                 if (controller != NULL){
@@ -2185,6 +2117,13 @@ void Character::loadGraphics(int palette){
         /* ignore palette */
     }
 
+    /* Only the sprites that use the act palette change so there is no need to
+     * read the sff again. Their bitmaps are made when they are next drawn.
+     */
+    if (!getLocalData().sprites.empty() && Util::applyPalette(finalPalette, getLocalData().sprites)){
+        return;
+    }
+
     getLocalData().sprites = SpriteMap();
 
     Util::readSprites(Storage::instance().lookupInsensitive(getLocalData().baseDir, Filesystem::RelativePath(getLocalData().sffFile)), finalPalette, getLocalData().sprites, true);
@@ -3405,7 +3344,10 @@ bool Character::doStates(Mugen::Stage & stage, const vector<string> & active, in
         FullEnvironment environment(stage, *this, active);
         for (vector<StateController*>::const_iterator it = controllers.begin(); it != controllers.end(); it++){
             StateController * controller = *it;
-            Global::debug(2 * !controller->getDebug()) << "State " << stateNumber << " check state controller " << controller->getName() << endl;
+            if (controller->getDebug()){
+                Global::debug(0) << "State " << stateNumber << " check state controller " << controller->getName() << endl;
+            }
+            MUGEN_TRACE(2, Trace::ControllerCheck, getId().intValue(), stateNumber, controller->getId(), 0, controller->getName());
 
 #if 0
             /* more debugging */
@@ -3427,14 +3369,22 @@ bool Character::doStates(Mugen::Stage & stage, const vector<string> & active, in
 #endif
 
             try{
-                if (controller->canTrigger(environment)){
+                bool triggered = false;
+                {
+                    Profile::Scope triggerTime(Profile::Triggers);
+                    triggered = controller->canTrigger(environment);
+                }
+                if (triggered){
                     /* check if the controller's persistent values allow it
                      * to be activated.
                      */
                     if (controller->persistentOk()){
-                        Global::debug(2, getDisplayName()) << "Activate controller " << controller->getName() << std::endl;
+                        MUGEN_TRACE(1, Trace::ControllerActivate, getId().intValue(), stateNumber, controller->getId(), 0, controller->getName());
                         /* activate may modify the current state */
-                        controller->activate(stage, *this, active);
+                        {
+                            Profile::Scope controllerTime(Profile::Controllers);
+                            controller->activate(stage, *this, active);
+                        }
 
                         /* 8/27/2012 - the mugen docs say this about negative states:
                          *   For each tick of game-time, MUGEN makes a single pass through each of the special states, from top to bottom, in order of increasing state number (-3, -2, then -1). For each state controller encountered, its condition-type triggers are evaluated and, if they are satisfied, the controller is executed. Then processing proceeds to the next state controller in the state. A state transition (ChangeState) in any of the special states will update the player's current state number, but will not abort processing of the special states. After all the state controllers in the special states have been checked, the player's current state is processed, again from top to bottom. If a state transition is made out of the current state, the rest of the state controllers (if any) in the current state are skipped, and processing continues from the beginning of the new state. When the end of the current state is reached and no state transition is made, processing halts for this tick.
@@ -4042,18 +3992,18 @@ void Character::doTurn(Mugen::Stage & stage){
     reverseFacing();
 }
 
-const vector<Area> Character::getAttackBoxes() const {
+const AreaList Character::getAttackBoxes() const {
     if (getCurrentAnimation() != NULL){
         return getCurrentAnimation()->getAttackBoxes(getFacing() == FacingLeft, getLocalData().xscale, getLocalData().yscale);
     }
-    return vector<Area>();
+    return AreaList();
 }
 
-const vector<Area> Character::getDefenseBoxes() const {
+const AreaList Character::getDefenseBoxes() const {
     if (getCurrentAnimation() != NULL){
         return getCurrentAnimation()->getDefenseBoxes(getFacing() == FacingLeft, getLocalData().xscale, getLocalData().yscale);
     }
-    return vector<Area>();
+    return AreaList();
 }
 
 const std::string Character::getAttackName(){
@@ -47,7 +47,25 @@ namespace Mugen{
 class Sound;
 class Sprite;
 class Animation;
-extern PaintownUtil::Parameter<Filesystem::RelativePath> stateFileParameter;
+
+/* The state file this thread is reading, for messages. Team members are
+ * loaded on their own threads so every thread keeps its own.
+ */
+class CurrentStateFile{
+public:
+    explicit CurrentStateFile(const Filesystem::RelativePath & file);
+    ~CurrentStateFile();
+
+    /* empty when this thread isn't reading a state file */
+    static std::string path();
+
+private:
+    CurrentStateFile(const CurrentStateFile &);
+    CurrentStateFile & operator=(const CurrentStateFile &);
+
+    const Filesystem::RelativePath file;
+    const CurrentStateFile * previous;
+};
 
 class Behavior;
 class Stage;
@@ -705,6 +723,9 @@ public:
         virtual RuntimeValue getVariable(int index) const;
         virtual RuntimeValue getFloatVariable(int index) const;
         virtual RuntimeValue getSystemVariable(int index) const;
+        /* the variable itself, or NULL if it was never set (which reads as 0) */
+        const RuntimeValue * findVariable(int index) const;
+        const RuntimeValue * findFloatVariable(int index) const;
 
         virtual inline Physics::Type getCurrentPhysics() const {
             return getStateData().currentPhysics;
@@ -886,8 +907,9 @@ public:
             return getStateData().hitState;
         }
 
-        const std::vector<Area> getAttackBoxes() const;
-        const std::vector<Area> getDefenseBoxes() const;
+        /* placed for this tick, see AreaList */
+        const AreaList getAttackBoxes() const;
+        const AreaList getDefenseBoxes() const;
 
         /* paused from an attack */
         virtual bool isPaused() const;
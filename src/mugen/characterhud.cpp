@@ -473,20 +473,28 @@ void Bar::act(Mugen::Character & character){
 }
 
 void Bar::render(Element::Layer layer, const Graphics::Bitmap & bmp){
+    draw(layer, bmp, position.x, position.y, damage, currentHealth);
+}
+
+void Bar::renderFull(Element::Layer layer, const Graphics::Bitmap & bmp, int offsetX, int offsetY){
+    draw(layer, bmp, position.x + offsetX, position.y + offsetY, maxHealth, maxHealth);
+}
+
+void Bar::draw(Element::Layer layer, const Graphics::Bitmap & bmp, int x, int y, int damage, int health){
     if (type != None){
         // Background is full range
-        back0.render(layer, position.x, position.y, bmp);
+        back0.render(layer, x, y, bmp);
         // This is a container just render it normally 
-        back1.render(layer, position.x, position.y, bmp);
+        back1.render(layer, x, y, bmp);
 
         /* Q: how is range.x supposed to be used? isn't it always 0? */
         /* TODO: show the damage number */
-        middle.render(layer, position.x, position.y, bmp, (int)(damage * range.y / maxHealth));
+        middle.render(layer, x, y, bmp, (int)(damage * range.y / maxHealth));
 
-        double width = currentHealth * range.y / maxHealth;
+        double width = health * range.y / maxHealth;
         if ((int) width > 0){
             /* Don't draw a bar with width of 0 */
-            front.render(layer, position.x, position.y, bmp, (int) width);
+            front.render(layer, x, y, bmp, (int) width);
         }
 
 #if 0
@@ -508,7 +516,7 @@ void Bar::render(Element::Layer layer, const Graphics::Bitmap & bmp){
         bmp.setClipRect(0,0,bmp.getWidth(),bmp.getHeight());
 #endif
         // Counter Number for powerbars
-        counter.render(layer, position.x, position.y, bmp);
+        counter.render(layer, x, y, bmp);
     }
 }
 
@@ -962,6 +970,10 @@ void Round::doWin(Mugen::Stage & stage, Mugen::Character & winner, Mugen::Charac
     WinGame win;
     win.type = winType;
     win.perfect = winner.getHealth() == winner.getMaxHealth();
+    win.life = winner.getHealth();
+    if (stage.getGameInfo() != NULL && Mugen::Data::getInstance().getTime() > 0){
+        win.timeLeft = stage.getGameInfo()->getGameTime();
+    }
     winner.addWin(win);
 
     /* If the loser still has health then its a loss by time and they should go into
@@ -1513,6 +1525,14 @@ FightElement &WinIcon::getPlayer2Win(const WinGame::WinType &win){
 }
 
 GameInfo::GameInfo(const Filesystem::AbsolutePath & fightFile){
+    for (int i = 0; i < 2; i++){
+        turnsSpacing[i].y = 10;
+        turnsWaiting[i] = -1;
+        waitingBars[i] = NULL;
+    }
+    lifeBars.push_back(&player1LifeBar);
+    lifeBars.push_back(&player2LifeBar);
+
     Filesystem::AbsolutePath baseDir = fightFile.getDirectory();
     const Filesystem::AbsolutePath ourDefFile = Mugen::Util::fixFileName(baseDir, fightFile.getFilename().path());
     
@@ -1574,7 +1594,7 @@ GameInfo::GameInfo(const Filesystem::AbsolutePath & fightFile){
         // Get animations so we can set up the lifebars
         parseAnimations(parsed);
 
-    } else if (head == "Lifebar"){
+    } else if (head == "Lifebar" || head == "Simul Lifebar" || head == "Turns Lifebar"){
         class BarWalk: public Ast::Walker{
             public:
                 BarWalk(GameInfo & self, Mugen::SpriteMap & sprites, std::map<int, PaintownUtil::ReferenceCount<Animation> > & animations, std::vector<Font *> & fonts):
@@ -1588,12 +1608,30 @@ GameInfo::GameInfo(const Filesystem::AbsolutePath & fightFile){
                 Mugen::SpriteMap & sprites;
                 std::map<int, PaintownUtil::ReferenceCount<Animation> > & animations;
                 std::vector<Font *> & fonts;
+                /* the bar each pN prefix of the section goes to */
+                std::map<std::string, Bar*> bars;
+                /* where pN.teammate.spacing goes, only in [Turns Lifebar] */
+                std::map<std::string, Mugen::Point*> spacing;
 
                 virtual void onAttributeSimple(const Ast::AttributeSimple & simple){
-                    if (PaintownUtil::matchRegex(simple.toString(), PaintownUtil::Regex("p1"))){
-                        getBar(simple,"p1", self.player1LifeBar);
-                    } else if (PaintownUtil::matchRegex(simple.toString(), PaintownUtil::Regex("p2"))){
-                        getBar(simple,"p2", self.player2LifeBar);
+                    const std::string name = PaintownUtil::lowerCaseAll(simple.idString());
+                    for (std::map<std::string, Mugen::Point*>::iterator it = spacing.begin(); it != spacing.end(); it++){
+                        if (name == it->first + ".teammate.spacing"){
+                            int x = 0, y = 0;
+                            try{
+                                simple.view() >> x >> y;
+                            } catch (const Ast::Exception & e){
+                            }
+                            it->second->x = x;
+                            it->second->y = y;
+                            return;
+                        }
+                    }
+
+                    for (std::map<std::string, Bar*>::iterator it = bars.begin(); it != bars.end(); it++){
+                        if (name.compare(0, it->first.size() + 1, it->first + ".") == 0){
+                            getBar(simple, it->first, *it->second);
+                        }
                     }
                 }
 
@@ -1623,6 +1661,20 @@ GameInfo::GameInfo(const Filesystem::AbsolutePath & fightFile){
         };
 
         BarWalk walk(*this, sprites, animations, fonts);
+        if (head == "Lifebar"){
+            walk.bars["p1"] = &player1LifeBar;
+            walk.bars["p2"] = &player2LifeBar;
+        } else if (head == "Simul Lifebar"){
+            walk.bars["p1"] = &simulLifeBars[0];
+            walk.bars["p2"] = &simulLifeBars[1];
+            walk.bars["p3"] = &simulLifeBars[2];
+            walk.bars["p4"] = &simulLifeBars[3];
+        } else {
+            walk.bars["p1"] = &turnsLifeBars[0];
+            walk.bars["p2"] = &turnsLifeBars[1];
+            walk.spacing["p1"] = &turnsSpacing[0];
+            walk.spacing["p2"] = &turnsSpacing[1];
+        }
         section->walk(walk);
     } else if (head == "Powerbar"){
             class BarWalk: public Ast::Walker{
@@ -2174,9 +2226,56 @@ GameInfo::~GameInfo(){
     }*/
 }
 
+void GameInfo::setTurns(int player, int waiting){
+    if (player == 1 || player == 2){
+        turnsWaiting[player - 1] = waiting;
+    }
+}
+
+/* Picks the bars for everyone on the stage. A simul team shows each member
+ * with the [Simul Lifebar] bars and a team that fights in turns uses the
+ * [Turns Lifebar] bars, with a full bar under the fighter for each member
+ * still waiting. Bars a fight.def doesn't have fall back to [Lifebar], which
+ * only shows the team leaders.
+ */
+void GameInfo::actLifeBars(Mugen::Stage & stage, Mugen::Character & player1, Mugen::Character & player2){
+    lifeBars.clear();
+    Mugen::Character * leaders[2] = {&player1, &player2};
+    Bar * single[2] = {&player1LifeBar, &player2LifeBar};
+    const Mugen::Stage::teams sides[2] = {Mugen::Stage::Player1Side, Mugen::Stage::Player2Side};
+    const std::vector<Mugen::Character *> players = stage.getPlayers();
+    for (int side = 0; side < 2; side++){
+        waitingBars[side] = NULL;
+
+        std::vector<Mugen::Character *> team;
+        for (std::vector<Mugen::Character *>::const_iterator it = players.begin(); it != players.end(); it++){
+            if ((*it)->getAlliance() == sides[side]){
+                team.push_back(*it);
+            }
+        }
+
+        if (team.size() > 1 && simulLifeBars[side].getType() != Bar::None){
+            for (unsigned int member = 0; member < team.size() && member < 2; member++){
+                Bar & bar = simulLifeBars[side + member * 2];
+                bar.act(*team[member]);
+                lifeBars.push_back(&bar);
+            }
+        } else {
+            Bar * bar = single[side];
+            if (turnsWaiting[side] >= 0 && turnsLifeBars[side].getType() != Bar::None){
+                bar = &turnsLifeBars[side];
+            }
+            bar->act(*leaders[side]);
+            lifeBars.push_back(bar);
+            if (turnsWaiting[side] > 0){
+                waitingBars[side] = bar;
+            }
+        }
+    }
+}
+
 void GameInfo::act(Mugen::Stage & stage, Mugen::Character & player1, Mugen::Character & player2){
-    player1LifeBar.act(player1);
-    player2LifeBar.act(player2);
+    actLifeBars(stage, player1, player2);
     player1PowerBar.act(player1);
     player2PowerBar.act(player2);
     player1Face.act(player1);
@@ -2204,10 +2303,18 @@ void GameInfo::act(Mugen::Stage & stage, Mugen::Character & player1, Mugen::Char
 }
 
 void GameInfo::render(const Element::Layer & layer, const Graphics::Bitmap &bmp){
-    player1LifeBar.render(layer,bmp);
-
     // Program received signal SIGFPE, Arithmetic exception.
-    player2LifeBar.render(layer,bmp);
+    for (std::vector<Bar*>::iterator it = lifeBars.begin(); it != lifeBars.end(); it++){
+        (*it)->render(layer, bmp);
+    }
+
+    for (int side = 0; side < 2; side++){
+        if (waitingBars[side] != NULL){
+            for (int member = 1; member <= turnsWaiting[side]; member++){
+                waitingBars[side]->renderFull(layer, bmp, turnsSpacing[side].x * member, turnsSpacing[side].y * member);
+            }
+        }
+    }
 
     player1PowerBar.render(layer, bmp);
     player2PowerBar.render(layer, bmp);
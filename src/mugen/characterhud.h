@@ -156,6 +156,10 @@ class Bar{
 	
 	virtual void act(Character &);
 	virtual void render(Element::Layer layer, const Graphics::Bitmap &);
+        /* A team member waiting for its turn hasn't been hit yet, so its bar
+         * is full. Drawn offset from where the bar normally goes.
+         */
+        virtual void renderFull(Element::Layer layer, const Graphics::Bitmap &, int offsetX, int offsetY);
 
         enum Type{
             None,
@@ -173,6 +177,10 @@ class Bar{
         virtual inline void setType(Type type){
             this->type = type;
         }
+
+        virtual inline Type getType() const {
+            return type;
+        }
 	
 	virtual inline void setPosition(int x, int y){
 	    this->position.x = x;
@@ -217,6 +225,8 @@ class Bar{
 	}
 	
     private:
+        void draw(Element::Layer layer, const Graphics::Bitmap &, int x, int y, int damage, int health);
+
         //! Position of this Bar
 	Mugen::Point position;
 	
@@ -829,6 +839,11 @@ class GameInfo{
 
         virtual void setGameTime(int time);
 
+        /* Player 1 or 2 fights in turns and has this many members waiting
+         * after the one that is fighting now.
+         */
+        virtual void setTurns(int player, int waiting);
+
         virtual inline const Round & getRound() const {
             return roundControl;
         }
@@ -840,10 +855,23 @@ class GameInfo{
     private:
         
         void parseAnimations(const PaintownUtil::ReferenceCount<Ast::AstParse> & parsed);
+        void actLifeBars(Mugen::Stage & stage, Mugen::Character & player1, Mugen::Character & player2);
 	
 	//! Player Data
 	Bar player1LifeBar;
         Bar player2LifeBar;
+        //! [Simul Lifebar], p1 and p2 for the first member of each team, p3 and p4 for the second
+        Bar simulLifeBars[4];
+        //! [Turns Lifebar], p1 and p2
+        Bar turnsLifeBars[2];
+        //! Turns: how far apart the bars of the members waiting for their turn are
+        Mugen::Point turnsSpacing[2];
+        //! Turns: members waiting for their turn, -1 if the team doesn't fight in turns
+        int turnsWaiting[2];
+        //! Life bars act() picked for the characters on the stage
+        std::vector<Bar*> lifeBars;
+        //! Bars the members waiting for their turn are drawn with
+        Bar * waitingBars[2];
 	Bar player1PowerBar;
         Bar player2PowerBar;
 	Face player1Face;
@@ -1,5 +1,6 @@
 #include "ast/all.h"
 #include "command.h"
+#include "trace.h"
 #include <r-tech1/debug.h>
 
 using namespace std;
@@ -755,7 +756,7 @@ bool Command::interpret(const Ast::Key * key, const Input & keys, const Input &
 bool Command::handle(Input keys){
     if (successTime > 0){
         successTime -= 1;
-        Global::debug(1) << "Pressed " << name << endl;
+        MUGEN_TRACE(1, Trace::CommandPressed, 0, successTime, 0, 0, name);
         return true;
     }
 
@@ -786,7 +787,7 @@ bool Command::handle2(Input keys){
     
     if (successTime > 0){
         successTime -= 1;
-        Global::debug(1) << "Pressed " << name << endl;
+        MUGEN_TRACE(1, Trace::CommandPressed, 0, successTime, 0, 0, name);
         return true;
     }
 
@@ -896,7 +897,7 @@ bool Command::handle2(Input keys){
             // needRelease = NULL;
             holder = 0;
             successTime = bufferTime - 1;
-            Global::debug(1) << "Pressed " << name << endl;
+            MUGEN_TRACE(1, Trace::CommandPressed, 0, successTime, 0, 0, name);
             return true;
         }
     }
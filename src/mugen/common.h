@@ -190,11 +190,17 @@ struct WinGame{
 
     WinGame():
     type(Normal),
-    perfect(false){
+    perfect(false),
+    life(0),
+    timeLeft(-1){
     }
 
     WinType type;
     bool perfect;
+    /* life the winner had left, Turns carries it over to the next bout */
+    double life;
+    /* seconds left on the round clock, -1 if the clock was off */
+    int timeLeft;
 
 };
 
@@ -190,6 +190,7 @@ Win
 #include <string>
 #include "config.h"
 #include "projectile.h"
+#include "perfect-hash.h"
 
 namespace PaintownUtil = ::Util;
 using std::string;
@@ -498,13 +499,18 @@ const Mugen::Stage & EmptyEnvironment::getStage() const {
     throw MugenException("Cannot get a stage from an empty environment", __FILE__, __LINE__);
 }
 
-const std::vector<std::string> EmptyEnvironment::getCommands() const {
+const std::vector<std::string> & EmptyEnvironment::getCommands() const {
     throw MugenException("Cannot get commands from an empty environment", __FILE__, __LINE__);
 }
     
 RuntimeValue EmptyEnvironment::getArg1() const {
     throw MugenException("Cannot get arg1 from an empty environment", __FILE__, __LINE__);
 }
+
+const std::vector<std::string> & FullEnvironment::noCommands(){
+    static std::vector<std::string> empty;
+    return empty;
+}
                         
 template<class ReturnType> Compiler::Value * getCharacterField(ReturnType (Character::*getter)() const, const std::string & name){
     class CharacterGetter: public Compiler::Value {
@@ -550,6 +556,800 @@ void runtimeError(const std::string & fail, const std::string & where, int line)
 
 namespace{
 
+/* names that can be used on their own in a trigger, like `time' */
+namespace IdentifierName{
+    enum Type{
+        E,
+        ID,
+        Command,
+        Anim,
+        AILevel,
+        Alive,
+        NumProj,
+        IsHelper,
+        NumHelper,
+        NumEnemy,
+        NumPartner,
+        P1Name,
+        Name,
+        P2Name,
+        P3Name,
+        P4Name,
+        AuthorName,
+        Facing,
+        BackEdgeBodyDist,
+        BackEdgeDist,
+        FrontEdgeBodyDist,
+        FrontEdgeDist,
+        HitDefAttrState,
+        HitDefAttrAttribute,
+        Life,
+        LifeMax,
+        MatchNo,
+        MatchOver,
+        MoveType,
+        P2MoveType,
+        Random,
+        RoundNo,
+        RoundsExisted,
+        I,
+        H,
+        P2StateNo,
+        HitCount,
+        UniqHitCount,
+        P2StateType,
+        WinTime,
+        WinKO,
+        WinPerfect,
+        Win,
+        Lose,
+        LoseKO,
+        LoseTime,
+        DrawGame,
+        RoundState,
+        MoveContact,
+        MoveReversed,
+        NumTarget,
+        InGuardDist,
+        AnimTime,
+        PalNo,
+        MoveHit,
+        NumExplod,
+        GameTime,
+        HitShakeOver,
+        HitOver,
+        CanRecover,
+        HitFall,
+        Time,
+        StateTime,
+        StateType,
+        Ctrl,
+        HitPauseTime,
+        MoveGuarded,
+        StateNo,
+        P2Life,
+        Power,
+        PowerMax,
+        InternalExtraJumps,
+        InternalAirJumpHeight,
+        PrevStateNo,
+        IsHomeTeam,
+        TeamSide,
+        Pi,
+        TicksPerSecond,
+        Count
+    };
+}
+
+/* in the same order as the enum */
+static const char * const identifierNamesList[] = {
+    "e",
+    "id",
+    "command",
+    "anim",
+    "ailevel",
+    "alive",
+    "numproj",
+    "ishelper",
+    "numhelper",
+    "numenemy",
+    "numpartner",
+    "p1name",
+    "name",
+    "p2name",
+    "p3name",
+    "p4name",
+    "authorname",
+    "facing",
+    "backedgebodydist",
+    "backedgedist",
+    "frontedgebodydist",
+    "frontedgedist",
+    "hitdefattr:state",
+    "hitdefattr:attribute",
+    "life",
+    "lifemax",
+    "matchno",
+    "matchover",
+    "movetype",
+    "p2movetype",
+    "random",
+    "roundno",
+    "roundsexisted",
+    "i",
+    "h",
+    "p2stateno",
+    "hitcount",
+    "uniqhitcount",
+    "p2statetype",
+    "wintime",
+    "winko",
+    "winperfect",
+    "win",
+    "lose",
+    "loseko",
+    "losetime",
+    "drawgame",
+    "roundstate",
+    "movecontact",
+    "movereversed",
+    "numtarget",
+    "inguarddist",
+    "animtime",
+    "palno",
+    "movehit",
+    "numexplod",
+    "gametime",
+    "hitshakeover",
+    "hitover",
+    "canrecover",
+    "hitfall",
+    "time",
+    "statetime",
+    "statetype",
+    "ctrl",
+    "hitpausetime",
+    "moveguarded",
+    "stateno",
+    "p2life",
+    "power",
+    "powermax",
+    "internal:extra-jumps",
+    "internal:airjump-height",
+    "prevstateno",
+    "ishometeam",
+    "teamside",
+    "pi",
+    "tickspersecond"
+};
+
+static const PerfectHash identifierNames(identifierNamesList, IdentifierName::Count);
+
+/* what can go in const(...) */
+namespace ConstName{
+    enum Type{
+        DataLife,
+        DataPower,
+        DataLieDownTime,
+        DataDefence,
+        DataAttack,
+        DataFallDefenceMul,
+        DataAirJuggle,
+        DataSparkNo,
+        DataGuardSparkNo,
+        DataKOEcho,
+        DataIntPersistIndex,
+        DataFloatPersistIndex,
+        MovementAirJumpNum,
+        MovementAirJumpHeight,
+        MovementYAccel,
+        MovementCrouchFriction,
+        MovementCrouchFrictionThreshold,
+        MovementStandFriction,
+        MovementStandFrictionThreshold,
+        MovementJumpChangeAnimThreshold,
+        MovementAirGetHitGroundLevel,
+        VelocityWalkBackX,
+        VelocityWalkFwdX,
+        VelocityRunFwdX,
+        VelocityRunFwdY,
+        VelocityJumpNeuX,
+        VelocityJumpY,
+        VelocityRunJumpY,
+        VelocityRunJumpBackX,
+        VelocityRunBackX,
+        VelocityRunBackY,
+        VelocityJumpBackX,
+        VelocityJumpFwdX,
+        VelocityRunJumpFwdX,
+        MovementAirGetHitAirRecoverYAccel,
+        VelocityAirGetHitAirRecoverMulX,
+        VelocityAirGetHitAirRecoverMulY,
+        VelocityAirGetHitGroundRecoverX,
+        VelocityAirGetHitGroundRecoverY,
+        VelocityAirGetHitAirRecoverAddX,
+        VelocityAirGetHitAirRecoverAddY,
+        VelocityAirGetHitAirRecoverUp,
+        VelocityAirGetHitAirRecoverDown,
+        VelocityAirGetHitAirRecoverFwd,
+        VelocityAirGetHitAirRecoverBack,
+        VelocityAirJumpNeuX,
+        VelocityAirJumpY,
+        VelocityAirJumpBackX,
+        VelocityAirJumpFwdX,
+        SizeXScale,
+        SizeYScale,
+        SizeGroundBack,
+        SizeGroundFront,
+        SizeAirBack,
+        SizeAirFront,
+        SizeHeight,
+        SizeAttackDist,
+        SizeProjAttackDist,
+        SizeProjDoScale,
+        SizeHeadPosX,
+        SizeHeadPosY,
+        SizeMidPosX,
+        SizeMidPosY,
+        SizeShadowOffset,
+        SizeDrawOffsetX,
+        SizeDrawOffsetY,
+        Count
+    };
+}
+
+/* in the same order as the enum */
+static const char * const constNamesList[] = {
+    "data.life",
+    "data.power",
+    "data.liedown.time",
+    "data.defence",
+    "data.attack",
+    "data.fall.defence_mul",
+    "data.airjuggle",
+    "data.sparkno",
+    "data.guard.sparkno",
+    "data.ko.echo",
+    "data.intpersistindex",
+    "data.floatpersistindex",
+    "movement.airjump.num",
+    "movement.airjump.height",
+    "movement.yaccel",
+    "movement.crouch.friction",
+    "movement.crouch.friction.threshold",
+    "movement.stand.friction",
+    "movement.stand.friction.threshold",
+    "movement.jump.changeanim.threshold",
+    "movement.air.gethit.groundlevel",
+    "velocity.walk.back.x",
+    "velocity.walk.fwd.x",
+    "velocity.run.fwd.x",
+    "velocity.run.fwd.y",
+    "velocity.jump.neu.x",
+    "velocity.jump.y",
+    "velocity.runjump.y",
+    "velocity.runjump.back.x",
+    "velocity.run.back.x",
+    "velocity.run.back.y",
+    "velocity.jump.back.x",
+    "velocity.jump.fwd.x",
+    "velocity.runjump.fwd.x",
+    "movement.air.gethit.airrecover.yaccel",
+    "velocity.air.gethit.airrecover.mul.x",
+    "velocity.air.gethit.airrecover.mul.y",
+    "velocity.air.gethit.groundrecover.x",
+    "velocity.air.gethit.groundrecover.y",
+    "velocity.air.gethit.airrecover.add.x",
+    "velocity.air.gethit.airrecover.add.y",
+    "velocity.air.gethit.airrecover.up",
+    "velocity.air.gethit.airrecover.down",
+    "velocity.air.gethit.airrecover.fwd",
+    "velocity.air.gethit.airrecover.back",
+    "velocity.airjump.neu.x",
+    "velocity.airjump.y",
+    "velocity.airjump.back.x",
+    "velocity.airjump.fwd.x",
+    "size.xscale",
+    "size.yscale",
+    "size.ground.back",
+    "size.ground.front",
+    "size.air.back",
+    "size.air.front",
+    "size.height",
+    "size.attack.dist",
+    "size.proj.attack.dist",
+    "size.proj.doscale",
+    "size.head.pos.x",
+    "size.head.pos.y",
+    "size.mid.pos.x",
+    "size.mid.pos.y",
+    "size.shadowoffset",
+    "size.draw.offset.x",
+    "size.draw.offset.y"
+};
+
+static const PerfectHash constNames(constNamesList, ConstName::Count);
+
+/* names that take arguments, like `var(3)' */
+namespace FunctionName{
+    enum Type{
+        Const,
+        Asin,
+        Sin,
+        Atan,
+        Tan,
+        Abs,
+        Exp,
+        PlayerIDExist,
+        ProjHit,
+        ProjGuarded,
+        ProjContact,
+        Ln,
+        Log,
+        NumProjID,
+        ProjHitTime,
+        ProjContactTime,
+        ProjCancelTime,
+        ProjGuardedTime,
+        IsHelper,
+        NumHelper,
+        Floor,
+        IfElse,
+        GetHitVar,
+        TeamModeNotEqual,
+        TeamMode,
+        Var,
+        FVar,
+        SysFVar,
+        SysVar,
+        SelfAnimExist,
+        Ceil,
+        Acos,
+        Cos,
+        AnimExist,
+        AnimElemTime,
+        NumExplod,
+        AnimElemNo,
+        NumTarget,
+        Count
+    };
+}
+
+/* in the same order as the enum */
+static const char * const functionNamesList[] = {
+    "const",
+    "asin",
+    "sin",
+    "atan",
+    "tan",
+    "abs",
+    "exp",
+    "playeridexist",
+    "projhit",
+    "projguarded",
+    "projcontact",
+    "ln",
+    "log",
+    "numprojid",
+    "projhittime",
+    "projcontacttime",
+    "projcanceltime",
+    "projguardedtime",
+    "ishelper",
+    "numhelper",
+    "floor",
+    "ifelse",
+    "gethitvar",
+    "teammode!=",
+    "teammode",
+    "var",
+    "fvar",
+    "sysfvar",
+    "sysvar",
+    "selfanimexist",
+    "ceil",
+    "acos",
+    "cos",
+    "animexist",
+    "animelemtime",
+    "numexplod",
+    "animelemno",
+    "numtarget"
+};
+
+static const PerfectHash functionNames(functionNamesList, FunctionName::Count);
+
+/* names made of two words, like `vel x' */
+namespace KeywordName{
+    enum Type{
+        VelX,
+        VelY,
+        HitVelX,
+        HitVelY,
+        ScreenPosY,
+        ScreenPosX,
+        PosY,
+        PosX,
+        P2BodyDistX,
+        P2BodyDistY,
+        ParentDistX,
+        ParentDistY,
+        P2DistX,
+        P2DistY,
+        RootDistX,
+        RootDistY,
+        Count
+    };
+}
+
+/* in the same order as the enum */
+static const char * const keywordNamesList[] = {
+    "vel x",
+    "vel y",
+    "hitvel x",
+    "hitvel y",
+    "screenpos y",
+    "screenpos x",
+    "pos y",
+    "pos x",
+    "p2bodydist x",
+    "p2bodydist y",
+    "parentdist x",
+    "parentdist y",
+    "p2dist x",
+    "p2dist y",
+    "rootdist x",
+    "rootdist y"
+};
+
+static const PerfectHash keywordNames(keywordNamesList, KeywordName::Count);
+
+/* Most triggers compare one thing about the character with a constant, like
+ * `stateno = 200', `time >= 3', `var(2) != 0', `animelem = 4' or
+ * `command = "x"'. Rather than evaluating both sides to RuntimeValues and
+ * comparing those, these compile to a single node that reads the value from
+ * the character and compares it with the constant right there.
+ */
+/* Characters are compiled on the loader threads too, so the counts are only
+ * changed with atomic operations.
+ */
+static volatile bool fuseComparisons = true;
+static volatile unsigned int comparisonCount = 0;
+static volatile unsigned int fusedCount = 0;
+
+/* the same results the comparison operators of RuntimeValue give */
+struct CompareEquals{
+    static inline bool compare(double value, double constant){
+        return fabs(value - constant) < 0.0000001;
+    }
+
+    static inline bool compare(const RuntimeValue & value, const RuntimeValue & constant){
+        return value == constant;
+    }
+};
+
+struct CompareUnequals{
+    static inline bool compare(double value, double constant){
+        return !(fabs(value - constant) < 0.0000001);
+    }
+
+    static inline bool compare(const RuntimeValue & value, const RuntimeValue & constant){
+        return !(value == constant);
+    }
+};
+
+struct CompareGreaterThan{
+    static inline bool compare(double value, double constant){
+        return value > constant;
+    }
+
+    static inline bool compare(const RuntimeValue & value, const RuntimeValue & constant){
+        return value > constant;
+    }
+};
+
+struct CompareGreaterThanEquals{
+    static inline bool compare(double value, double constant){
+        return value >= constant;
+    }
+
+    static inline bool compare(const RuntimeValue & value, const RuntimeValue & constant){
+        return value >= constant;
+    }
+};
+
+struct CompareLessThan{
+    static inline bool compare(double value, double constant){
+        return value < constant;
+    }
+
+    static inline bool compare(const RuntimeValue & value, const RuntimeValue & constant){
+        return value < constant;
+    }
+};
+
+struct CompareLessThanEquals{
+    static inline bool compare(double value, double constant){
+        return value <= constant;
+    }
+
+    static inline bool compare(const RuntimeValue & value, const RuntimeValue & constant){
+        return value <= constant;
+    }
+};
+
+/* The values a fused comparison can read. `index' is the argument of the
+ * trigger, if it has one.
+ */
+struct ReadStateNo{
+    static inline double read(const Environment & environment, int){
+        return environment.getCharacter().getCurrentState();
+    }
+};
+
+struct ReadStateTime{
+    static inline double read(const Environment & environment, int){
+        return environment.getCharacter().getStateTime();
+    }
+};
+
+struct ReadAnimElemTime{
+    static inline double read(const Environment & environment, int index){
+        PaintownUtil::ReferenceCount<Animation> animation = environment.getCharacter().getCurrentAnimation();
+        if (animation == NULL){
+            runtimeError("Current animation is NULL", __FILE__, __LINE__);
+        }
+        return animation->animationElementElapsed(index);
+    }
+};
+
+/* `field <compare> number' */
+template <class Field, class Compare>
+class FusedNumber: public Value {
+public:
+    FusedNumber(int index, double constant, const std::string & text):
+    index(index),
+    constant(constant),
+    text(text){
+    }
+
+    const int index;
+    const double constant;
+    /* what the comparison looked like before it was fused */
+    const std::string text;
+
+    Value * copy() const {
+        return new FusedNumber(index, constant, text);
+    }
+
+    std::string toString() const {
+        return text;
+    }
+
+    RuntimeValue evaluate(const Environment & environment) const {
+        return RuntimeValue(Compare::compare(Field::read(environment, index), constant));
+    }
+};
+
+/* `var(index) <compare> number', or fvar. A variable that was never set is 0,
+ * and one that holds something other than a number is compared the slow way.
+ */
+template <class Compare>
+class FusedVariable: public Value {
+public:
+    FusedVariable(int index, bool floating, double constant, const std::string & text):
+    index(index),
+    floating(floating),
+    constant(constant),
+    text(text){
+    }
+
+    const int index;
+    const bool floating;
+    const double constant;
+    const std::string text;
+
+    Value * copy() const {
+        return new FusedVariable(index, floating, constant, text);
+    }
+
+    std::string toString() const {
+        return text;
+    }
+
+    RuntimeValue evaluate(const Environment & environment) const {
+        const Character & character = environment.getCharacter();
+        const RuntimeValue * value = floating ? character.findFloatVariable(index) : character.findVariable(index);
+        if (value == NULL){
+            return RuntimeValue(Compare::compare(0.0, constant));
+        }
+
+        switch (value->type){
+            case RuntimeValue::Double: return RuntimeValue(Compare::compare(value->double_value, constant));
+            case RuntimeValue::Bool: return RuntimeValue(Compare::compare(value->bool_value ? 1.0 : 0.0, constant));
+            default: return RuntimeValue(Compare::compare(*value, RuntimeValue(constant)));
+        }
+    }
+};
+
+/* `command = "name"', true if the command is one of the active ones */
+class FusedCommand: public Value {
+public:
+    FusedCommand(const std::string & name, bool equals, const std::string & text):
+    name(name),
+    equals(equals),
+    text(text){
+    }
+
+    const std::string name;
+    const bool equals;
+    const std::string text;
+
+    Value * copy() const {
+        return new FusedCommand(name, equals, text);
+    }
+
+    std::string toString() const {
+        return text;
+    }
+
+    RuntimeValue evaluate(const Environment & environment) const {
+        const std::vector<std::string> & commands = environment.getCommands();
+        for (std::vector<std::string>::const_iterator it = commands.begin(); it != commands.end(); it++){
+            if (*it == name){
+                return RuntimeValue(equals);
+            }
+        }
+        return RuntimeValue(!equals);
+    }
+};
+
+/* What one side of a comparison is, as far as fusing goes */
+class ComparisonOperand: public Ast::Walker {
+public:
+    enum Kind{
+        Other,
+        ConstantNumber,
+        ConstantString,
+        StateNo,
+        StateTime,
+        Command,
+        Variable,
+        FloatVariable,
+        AnimElemTime
+    };
+
+    ComparisonOperand(const Ast::Value * value):
+    kind(Other),
+    number(0),
+    index(0){
+        value->walk(*this);
+    }
+
+    Kind kind;
+    double number;
+    std::string string;
+    int index;
+
+    virtual void onNumber(const Ast::Number & value){
+        kind = ConstantNumber;
+        value.view() >> number;
+    }
+
+    virtual void onString(const Ast::String & value){
+        kind = ConstantString;
+        value.view() >> string;
+    }
+
+    virtual void onIdentifier(const Ast::Identifier & identifier){
+        const int name = identifierNames.find(identifier.toLowerString());
+        if (name == IdentifierName::StateNo){
+            kind = StateNo;
+        } else if (name == IdentifierName::Time || name == IdentifierName::StateTime){
+            kind = StateTime;
+        } else if (name == IdentifierName::Command){
+            kind = Command;
+        }
+    }
+
+    /* only with a plain number for the argument */
+    virtual void onFunction(const Ast::Function & function){
+        const int name = functionNames.find(function.getName());
+        if ((name != FunctionName::Var && name != FunctionName::FVar && name != FunctionName::AnimElemTime) ||
+            function.getArg1() == NULL){
+            return;
+        }
+
+        ComparisonOperand argument(function.getArg1());
+        if (argument.kind != ConstantNumber){
+            return;
+        }
+
+        index = (int) argument.number;
+        if (name == FunctionName::Var){
+            kind = Variable;
+        } else if (name == FunctionName::FVar){
+            kind = FloatVariable;
+        } else {
+            kind = AnimElemTime;
+        }
+    }
+};
+
+static bool isComparison(Ast::ExpressionInfix::InfixType type){
+    switch (type){
+        case Ast::ExpressionInfix::Equals:
+        case Ast::ExpressionInfix::Unequals:
+        case Ast::ExpressionInfix::GreaterThan:
+        case Ast::ExpressionInfix::GreaterThanEquals:
+        case Ast::ExpressionInfix::LessThan:
+        case Ast::ExpressionInfix::LessThanEquals: return true;
+        default: return false;
+    }
+}
+
+/* `1 < time' is `time > 1' */
+static Ast::ExpressionInfix::InfixType flipComparison(Ast::ExpressionInfix::InfixType type){
+    switch (type){
+        case Ast::ExpressionInfix::GreaterThan: return Ast::ExpressionInfix::LessThan;
+        case Ast::ExpressionInfix::GreaterThanEquals: return Ast::ExpressionInfix::LessThanEquals;
+        case Ast::ExpressionInfix::LessThan: return Ast::ExpressionInfix::GreaterThan;
+        case Ast::ExpressionInfix::LessThanEquals: return Ast::ExpressionInfix::GreaterThanEquals;
+        default: return type;
+    }
+}
+
+template <class Compare>
+static Value * fuseNumber(const ComparisonOperand & field, double constant, const std::string & text){
+    switch (field.kind){
+        case ComparisonOperand::StateNo: return new FusedNumber<ReadStateNo, Compare>(0, constant, text);
+        case ComparisonOperand::StateTime: return new FusedNumber<ReadStateTime, Compare>(0, constant, text);
+        case ComparisonOperand::AnimElemTime: return new FusedNumber<ReadAnimElemTime, Compare>(field.index, constant, text);
+        case ComparisonOperand::Variable: return new FusedVariable<Compare>(field.index, false, constant, text);
+        case ComparisonOperand::FloatVariable: return new FusedVariable<Compare>(field.index, true, constant, text);
+        default: return NULL;
+    }
+}
+
+/* The fused node for `left <type> right', or NULL if the comparison isn't one
+ * of the shapes above. `text' is how the unfused comparison prints itself.
+ */
+static Value * fuseComparison(const Ast::ExpressionInfix & expression, const std::string & text){
+    Ast::ExpressionInfix::InfixType type = expression.getExpressionType();
+    ComparisonOperand left(expression.getLeft());
+    ComparisonOperand right(expression.getRight());
+
+    if (type == Ast::ExpressionInfix::Equals || type == Ast::ExpressionInfix::Unequals){
+        bool equals = type == Ast::ExpressionInfix::Equals;
+        if (left.kind == ComparisonOperand::Command && right.kind == ComparisonOperand::ConstantString){
+            return new FusedCommand(right.string, equals, text);
+        }
+        if (left.kind == ComparisonOperand::ConstantString && right.kind == ComparisonOperand::Command){
+            return new FusedCommand(left.string, equals, text);
+        }
+    }
+
+    const ComparisonOperand * field = &left;
+    double constant = right.number;
+    if (left.kind == ComparisonOperand::ConstantNumber){
+        field = &right;
+        constant = left.number;
+        type = flipComparison(type);
+    } else if (right.kind != ComparisonOperand::ConstantNumber){
+        return NULL;
+    }
+
+    switch (type){
+        case Ast::ExpressionInfix::Equals: return fuseNumber<CompareEquals>(*field, constant, text);
+        case Ast::ExpressionInfix::Unequals: return fuseNumber<CompareUnequals>(*field, constant, text);
+        case Ast::ExpressionInfix::GreaterThan: return fuseNumber<CompareGreaterThan>(*field, constant, text);
+        case Ast::ExpressionInfix::GreaterThanEquals: return fuseNumber<CompareGreaterThanEquals>(*field, constant, text);
+        case Ast::ExpressionInfix::LessThan: return fuseNumber<CompareLessThan>(*field, constant, text);
+        case Ast::ExpressionInfix::LessThanEquals: return fuseNumber<CompareLessThanEquals>(*field, constant, text);
+        default: return NULL;
+    }
+}
+
 class CompileWalker: public Ast::Walker {
 public:
     CompileWalker():
@@ -780,11 +1580,13 @@ public:
             }
         };
 
-        if (identifier == "e"){
+        const int name = identifierNames.find(identifier.toLowerString());
+
+        if (name == IdentifierName::E){
             return compile(exp(1.0));
         }
 
-        if (identifier == "id"){
+        if (name == IdentifierName::ID){
             class ID: public Value{
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -803,7 +1605,7 @@ public:
             return new ID();
         }
 
-        if (identifier == "command"){
+        if (name == IdentifierName::Command){
             class Command: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -822,7 +1624,7 @@ public:
             return new Command();
         }
         
-        if (identifier == "anim"){
+        if (name == IdentifierName::Anim){
             class Animation: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -842,7 +1644,7 @@ public:
         }
 
         /* Mugen 1.0 */
-        if (identifier == "ailevel"){
+        if (name == IdentifierName::AILevel){
             class AILevel: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -862,7 +1664,7 @@ public:
             return new AILevel();
         }
         
-        if (identifier == "alive"){
+        if (name == IdentifierName::Alive){
             class Alive: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -895,11 +1697,11 @@ public:
         }
         */
 
-        if (identifier == "numproj"){
+        if (name == IdentifierName::NumProj){
             class NumProj: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
-                    return RuntimeValue((int) environment.getStage().findProjectile(0, &environment.getCharacter()).size());
+                    return RuntimeValue((int) environment.getStage().countProjectiles(0, &environment.getCharacter()));
                 }
 
                 Value * copy() const {
@@ -910,7 +1712,7 @@ public:
             return new NumProj();
         }
 
-        if (identifier == "ishelper"){
+        if (name == IdentifierName::IsHelper){
             class IsHelper: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -925,7 +1727,7 @@ public:
             return new IsHelper();
         }
         
-        if (identifier == "numhelper"){
+        if (name == IdentifierName::NumHelper){
             class NumHelper: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -944,18 +1746,18 @@ public:
             return new NumHelper();
         }
 
-        if (identifier == "numenemy"){
+        if (name == IdentifierName::NumEnemy){
             /* FIXME: return more than 1 in team mode */
             return compile(1);
         }
 
-        if (identifier == "numpartner"){
+        if (name == IdentifierName::NumPartner){
             /* FIXME: return 1 in team mode */
             return compile(0);
         }
 
-        if (identifier == "p1name" ||
-            identifier == "name"){
+        if (name == IdentifierName::P1Name ||
+            name == IdentifierName::Name){
             class P1Name: public Value{
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -970,7 +1772,7 @@ public:
             return new P1Name();
         }
 
-        if (identifier == "p2name"){
+        if (name == IdentifierName::P2Name){
             class P2Name: public Value{
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -986,7 +1788,7 @@ public:
             return new P2Name();
         }
 
-        if (identifier == "p3name"){
+        if (name == IdentifierName::P3Name){
             class P3Name: public Value{
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1002,7 +1804,7 @@ public:
             return new P3Name();
         }
 
-        if (identifier == "p4name"){
+        if (name == IdentifierName::P4Name){
             class P4Name: public Value{
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1018,7 +1820,7 @@ public:
             return new P4Name();
         }
 
-        if (identifier == "authorname"){
+        if (name == IdentifierName::AuthorName){
             class AuthorName: public Value{
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1033,7 +1835,7 @@ public:
             return new AuthorName();
         }
 
-        if (identifier == "facing"){
+        if (name == IdentifierName::Facing){
             class Facing: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1053,7 +1855,7 @@ public:
             return new Facing();
         }
 
-        if (identifier == "backedgebodydist"){
+        if (name == IdentifierName::BackEdgeBodyDist){
             class BackEdgeBodyDist: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1073,7 +1875,7 @@ public:
             return new BackEdgeBodyDist();
         }
 
-        if (identifier == "backedgedist"){
+        if (name == IdentifierName::BackEdgeDist){
             class BackEdgeDist: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1095,7 +1897,7 @@ public:
             return new BackEdgeDist();
         }
 
-        if (identifier == "frontedgebodydist"){
+        if (name == IdentifierName::FrontEdgeBodyDist){
             class FrontEdgeBodyDist: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1115,7 +1917,7 @@ public:
             return new FrontEdgeBodyDist();
         }
 
-        if (identifier == "frontedgedist"){
+        if (name == IdentifierName::FrontEdgeDist){
             class FrontEdgeDist: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1135,7 +1937,7 @@ public:
             return new FrontEdgeDist();
         }
 
-        if (identifier == "hitdefattr:state"){
+        if (name == IdentifierName::HitDefAttrState){
             class HitDefAttrState: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1151,7 +1953,7 @@ public:
             return new HitDefAttrState();
         }
 
-        if (identifier == "hitdefattr:attribute"){
+        if (name == IdentifierName::HitDefAttrAttribute){
             class HitDefAttrAttribute: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1171,7 +1973,7 @@ public:
             return new HitDefAttrAttribute();
         }
 
-        if (identifier == "life"){
+        if (name == IdentifierName::Life){
             class Life: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1190,7 +1992,7 @@ public:
             return new Life();
         }
 
-        if (identifier == "lifemax"){
+        if (name == IdentifierName::LifeMax){
             class LifeMax: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1210,7 +2012,7 @@ public:
 
         }
 
-        if (identifier == "matchno"){
+        if (name == IdentifierName::MatchNo){
             class Wins: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1226,7 +2028,7 @@ public:
             return new Wins();
         }
 
-        if (identifier == "matchover"){
+        if (name == IdentifierName::MatchOver){
             class Over: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1241,7 +2043,7 @@ public:
             return new Over();
         }
 
-        if (identifier == "movetype"){
+        if (name == IdentifierName::MoveType){
             class MoveType: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1260,7 +2062,7 @@ public:
             return new MoveType();
         }
 
-        if (identifier == "p2movetype"){
+        if (name == IdentifierName::P2MoveType){
             class MoveType2: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1280,7 +2082,7 @@ public:
             return new MoveType2();
         }
 
-        if (identifier == "random"){
+        if (name == IdentifierName::Random){
             class Random: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1296,7 +2098,7 @@ public:
             return new Random();
         }
 
-        if (identifier == "roundno"){
+        if (name == IdentifierName::RoundNo){
             class RoundNumber: public Value {
                 public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1316,7 +2118,7 @@ public:
             return new RoundNumber();
         }
 
-        if (identifier == "roundsexisted"){
+        if (name == IdentifierName::RoundsExisted){
             class RoundsExisted: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1336,7 +2138,7 @@ public:
             return new RoundsExisted();
         }
 
-        if (identifier == "I"){
+        if (name == IdentifierName::I){
             class JustI: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1351,7 +2153,7 @@ public:
             return new JustI();
         }
 
-        if (identifier == "H"){
+        if (name == IdentifierName::H){
             class JustH: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1369,7 +2171,7 @@ public:
             return new JustH();
         }
 
-        if (identifier == "p2stateno"){
+        if (name == IdentifierName::P2StateNo){
             class P2StateNo: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1385,7 +2187,7 @@ public:
             return new P2StateNo();
         }
 
-        if (identifier == "hitcount"){
+        if (name == IdentifierName::HitCount){
             class HitCount: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1404,7 +2206,7 @@ public:
             return new HitCount();
         }
 
-        if (identifier == "uniqhitcount"){
+        if (name == IdentifierName::UniqHitCount){
             class UniqueHitCount: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1421,7 +2223,7 @@ public:
 
         }
 
-        if (identifier == "p2statetype"){
+        if (name == IdentifierName::P2StateType){
             class P2StateType: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1437,7 +2239,7 @@ public:
             return new P2StateType();
         }
 
-        if (identifier == "wintime"){
+        if (name == IdentifierName::WinTime){
             class WinTime: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1452,7 +2254,7 @@ public:
             return new WinTime();
         }
 
-        if (identifier == "winko"){
+        if (name == IdentifierName::WinKO){
             class Winko: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1467,7 +2269,7 @@ public:
             return new Winko();
         }
 
-        if (identifier == "winperfect"){
+        if (name == IdentifierName::WinPerfect){
             class WinPerfect: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1482,7 +2284,7 @@ public:
             return new WinPerfect();
         }
 
-        if (identifier == "win"){
+        if (name == IdentifierName::Win){
             class Win: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1497,7 +2299,7 @@ public:
             return new Win();
         }
 
-        if (identifier == "lose"){
+        if (name == IdentifierName::Lose){
             class Lose: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1512,7 +2314,7 @@ public:
             return new Lose();
         }
         
-        if (identifier == "loseko"){
+        if (name == IdentifierName::LoseKO){
             class LoseKO: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1527,7 +2329,7 @@ public:
             return new LoseKO();
         }
         
-        if (identifier == "losetime"){
+        if (name == IdentifierName::LoseTime){
             class LoseTime: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1542,12 +2344,12 @@ public:
             return new LoseTime();
         }
 
-        if (identifier == "drawgame"){
+        if (name == IdentifierName::DrawGame){
             /* FIXME */
             return compile(0);
         }
 
-        if (identifier == "roundstate"){
+        if (name == IdentifierName::RoundState){
             class RoundState: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1581,7 +2383,7 @@ public:
             return new RoundState();
         }
 
-        if (identifier == "movecontact"){
+        if (name == IdentifierName::MoveContact){
             class MoveContact: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1605,7 +2407,7 @@ public:
             return new MoveContact();
         }
         
-        if (identifier == "movereversed"){
+        if (name == IdentifierName::MoveReversed){
             class MoveReversed: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1624,7 +2426,7 @@ public:
             return new MoveReversed();
         }
 
-        if (identifier == "numtarget"){
+        if (name == IdentifierName::NumTarget){
             class NumTarget: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1645,7 +2447,7 @@ public:
             return new NumTarget();
         }
 
-        if (identifier == "inguarddist"){
+        if (name == IdentifierName::InGuardDist){
             class InGuardDist: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1665,7 +2467,7 @@ public:
             return new InGuardDist();
         }
 
-        if (identifier == "animtime"){
+        if (name == IdentifierName::AnimTime){
             class AnimTime: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1690,7 +2492,7 @@ public:
             return new AnimTime();
         }
 
-        if (identifier == "palno"){
+        if (name == IdentifierName::PalNo){
             class PalNo: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1705,7 +2507,7 @@ public:
             return new PalNo();
         }
 
-        if (identifier == "movehit"){
+        if (name == IdentifierName::MoveHit){
             class MoveHit: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1722,11 +2524,11 @@ public:
         }
 
 
-        if (identifier == "numexplod"){
+        if (name == IdentifierName::NumExplod){
             class NumExplod: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
-                    return RuntimeValue((int) environment.getStage().findExplode(0, (&environment.getCharacter())).size());
+                    return RuntimeValue((int) environment.getStage().countExplods(0, &environment.getCharacter()));
                 }
 
                 Value * copy() const {
@@ -1737,7 +2539,7 @@ public:
             return new NumExplod();
         }
         
-        if (identifier == "gametime"){
+        if (name == IdentifierName::GameTime){
             class GameTime: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1752,7 +2554,7 @@ public:
             return new GameTime();
         }
 
-        if (identifier == "hitshakeover"){
+        if (name == IdentifierName::HitShakeOver){
             class HitShakeOver: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1771,7 +2573,7 @@ public:
             return new HitShakeOver();
         }
 
-        if (identifier == "hitover"){
+        if (name == IdentifierName::HitOver){
             class HitOver: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1786,7 +2588,7 @@ public:
             return new HitOver();
         }
 
-        if (identifier == "canrecover"){
+        if (name == IdentifierName::CanRecover){
             class CanRecover: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1801,7 +2603,7 @@ public:
             return new CanRecover();
         }
 
-        if (identifier == "hitfall"){
+        if (name == IdentifierName::HitFall){
             class HitFall: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1820,7 +2622,7 @@ public:
         /* the mugen docs don't say anything about `statetime' but its
          * most likely the same thing as `time'
          */
-        if (identifier == "time" || identifier == "statetime"){
+        if (name == IdentifierName::Time || name == IdentifierName::StateTime){
             class Time: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1845,7 +2647,7 @@ public:
         
         /* end things that might go away */
 
-        if (identifier == "statetype"){
+        if (name == IdentifierName::StateType){
             class StateType: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1866,7 +2668,7 @@ public:
         }
 
         /* true if the player has control */
-        if (identifier == "ctrl"){
+        if (name == IdentifierName::Ctrl){
             class Ctrl: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1885,7 +2687,7 @@ public:
             return new Ctrl();
         }
 
-        if (identifier == "HitPauseTime"){
+        if (name == IdentifierName::HitPauseTime){
             class HitPauseTime: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1900,7 +2702,7 @@ public:
             return new HitPauseTime();
         }
 
-        if (identifier == "MoveGuarded"){
+        if (name == IdentifierName::MoveGuarded){
             class MoveGuarded: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1922,7 +2724,7 @@ public:
 
         /* god I need a drink */
 
-        if (identifier == "stateno"){
+        if (name == IdentifierName::StateNo){
             class StateNo: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1941,7 +2743,7 @@ public:
             return new StateNo();
         }
 
-        if (identifier == "p2life"){
+        if (name == IdentifierName::P2Life){
             class P2Life: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1957,7 +2759,7 @@ public:
             return new P2Life();
         }
 
-        if (identifier == "power"){
+        if (name == IdentifierName::Power){
             class Power: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -1976,12 +2778,12 @@ public:
             return new Power();
         }
         
-        if (identifier == "powermax"){
+        if (name == IdentifierName::PowerMax){
             /* TODO Findout if there is a setting somewhere in MUGEN that contains this info */
             return compile(3000);
         }
         
-        if (identifier == "internal:extra-jumps"){
+        if (name == IdentifierName::InternalExtraJumps){
             class ExtraJumps: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -2000,7 +2802,7 @@ public:
             return new ExtraJumps();
         }
 
-        if (identifier == "internal:airjump-height"){
+        if (name == IdentifierName::InternalAirJumpHeight){
             class AirJump: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -2019,7 +2821,7 @@ public:
             return new AirJump();
         }
 
-        if (identifier == "prevstateno"){
+        if (name == IdentifierName::PrevStateNo){
             class PrevStateNo: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -2038,21 +2840,21 @@ public:
             return new PrevStateNo();
         }
 
-        if (identifier == "ishometeam"){
+        if (name == IdentifierName::IsHomeTeam){
             /* FIXME */
             return compile(0);
         }
         
-        if (identifier == "teamside"){
+        if (name == IdentifierName::TeamSide){
             /* FIXME */
             return compile(1);
         }
 
-        if (identifier == "pi"){
+        if (name == IdentifierName::Pi){
             return compile(PaintownUtil::pi);
         }
         
-        if (identifier == "tickspersecond"){
+        if (name == IdentifierName::TicksPerSecond){
             return compile(Mugen::Data::getInstance().getGameSpeed());
         }
 
@@ -2550,7 +3352,9 @@ public:
             }
         };
 
-        if (function == "const"){
+        const int name = functionNames.find(function.getName());
+
+        if (name == FunctionName::Const){
             class ConstWalker: public Ast::Walker {
             public:
                 ConstWalker():
@@ -2560,28 +3364,30 @@ public:
                 Value * compiled;
 
                 Value * compileConst(const Ast::Identifier & identifier){
-                    if (identifier == "data.life"){
+                    const int name = constNames.find(identifier.toLowerString());
+
+                    if (name == ConstName::DataLife){
                         return getCharacterField(&Character::getMaxHealth, identifier.toLowerString());
                     }
                     
-                    if (identifier == "data.power"){
+                    if (name == ConstName::DataPower){
                         return getCharacterField(&Character::getPower, identifier.toLowerString());
                     }
 
-                    if (identifier == "data.liedown.time"){
+                    if (name == ConstName::DataLieDownTime){
                         /* FIXME */
                         return compile(0);
                     }
                     
-                    if (identifier == "data.defence"){
+                    if (name == ConstName::DataDefence){
                         return getCharacterField(&Character::getDefense, identifier.toLowerString());
                     }
 
-                    if (identifier == "data.attack"){
+                    if (name == ConstName::DataAttack){
                         return getCharacterField(&Character::getAttack, identifier.toLowerString());
                     }
 
-                    if (identifier == "data.fall.defence_mul"){
+                    if (name == ConstName::DataFallDefenceMul){
                         class DefenseMul: public Value {
                         public:
                             RuntimeValue evaluate(const Environment & environment) const {
@@ -2596,11 +3402,11 @@ public:
                         return new DefenseMul();
                     }
 
-                    if (identifier == "data.airjuggle"){
+                    if (name == ConstName::DataAirJuggle){
                         return getCharacterField(&Character::getJugglePoints, identifier.toLowerString());
                     }
 
-                    if (identifier == "data.sparkno"){
+                    if (name == ConstName::DataSparkNo){
                         class SparkNo: public Value {
                         public:
                             RuntimeValue evaluate(const Environment & environment) const {
@@ -2616,7 +3422,7 @@ public:
                         return new SparkNo();
                     }
 
-                    if (identifier == "data.guard.sparkno"){
+                    if (name == ConstName::DataGuardSparkNo){
                         class GuardSparkNo: public Value {
                         public:
                             RuntimeValue evaluate(const Environment & environment) const {
@@ -2632,107 +3438,107 @@ public:
                         return new GuardSparkNo();
                     }
 
-                    if (identifier == "data.ko.echo"){
+                    if (name == ConstName::DataKOEcho){
                         return getCharacterField(&Character::getKoEcho, identifier.toLowerString());
                     }
 
-                    if (identifier == "data.intpersistindex"){
+                    if (name == ConstName::DataIntPersistIndex){
                         return getCharacterField(&Character::getIntPersistIndex, identifier.toLowerString());
                     }
 
-                    if (identifier == "data.floatpersistindex"){
+                    if (name == ConstName::DataFloatPersistIndex){
                         return getCharacterField(&Character::getFloatPersistIndex, identifier.toLowerString());
                     }
 
-                    if (identifier == "movement.airjump.num"){
+                    if (name == ConstName::MovementAirJumpNum){
                         return getCharacterField(&Character::getExtraJumps, identifier.toLowerString());
                     }
 
-                    if (identifier == "movement.airjump.height"){
+                    if (name == ConstName::MovementAirJumpHeight){
                         return getCharacterField(&Character::getAirJumpHeight, identifier.toLowerString());
                     }
 
-                    if (identifier == "movement.yaccel"){
+                    if (name == ConstName::MovementYAccel){
                         return getCharacterField(&Character::getGravity, identifier.toLowerString());
                     }
                     
-                    if (identifier == "movement.crouch.friction"){
+                    if (name == ConstName::MovementCrouchFriction){
                         return getCharacterField(&Character::getCrouchingFriction, identifier.toLowerString());
                     }
 
-                    if (identifier == "movement.crouch.friction.threshold"){
+                    if (name == ConstName::MovementCrouchFrictionThreshold){
                         return getCharacterField(&Character::getCrouchingFrictionThreshold, identifier.toLowerString());
                     }
 
-                    if (identifier == "movement.stand.friction"){
+                    if (name == ConstName::MovementStandFriction){
                         return getCharacterField(&Character::getStandingFriction, identifier.toLowerString());
                     }
 
-                    if (identifier == "movement.stand.friction.threshold"){
+                    if (name == ConstName::MovementStandFrictionThreshold){
                         return getCharacterField(&Character::getStandingFrictionThreshold, identifier.toLowerString());
                     }
 
-                    if (identifier == "movement.jump.changeanim.threshold"){
+                    if (name == ConstName::MovementJumpChangeAnimThreshold){
                         return getCharacterField(&Character::getJumpChangeAnimationThreshold, identifier.toLowerString());
                     }
 
-                    if (identifier == "movement.air.gethit.groundlevel"){
+                    if (name == ConstName::MovementAirGetHitGroundLevel){
                         return getCharacterField(&Character::getAirGetHitGroundLevel, identifier.toLowerString());
                     }
 
-                    if (identifier == "velocity.walk.back.x"){
+                    if (name == ConstName::VelocityWalkBackX){
                         return getCharacterField(&Character::getWalkBackX, identifier.toLowerString());
                     }
 
-                    if (identifier == "velocity.walk.fwd.x"){
+                    if (name == ConstName::VelocityWalkFwdX){
                         return getCharacterField(&Character::getWalkForwardX, identifier.toLowerString());
                     }
 
-                    if (identifier == "velocity.run.fwd.x"){
+                    if (name == ConstName::VelocityRunFwdX){
                         return getCharacterField(&Character::getRunForwardX, identifier.toLowerString());
                     }
 
-                    if (identifier == "velocity.run.fwd.y"){
+                    if (name == ConstName::VelocityRunFwdY){
                         return getCharacterField(&Character::getRunForwardY, identifier.toLowerString());
                     }
 
-                    if (identifier == "velocity.jump.neu.x"){
+                    if (name == ConstName::VelocityJumpNeuX){
                         return getCharacterField(&Character::getNeutralJumpingX, identifier.toLowerString());
                     }
 
-                    if (identifier == "velocity.jump.y" ||
+                    if (name == ConstName::VelocityJumpY ||
                         /* HACK: mugen docs don't say runjump.y is the same as
                          * jump.y, but some characters use it anyway (Gouki)
                          */
-                        identifier == "velocity.runjump.y"){
+                        name == ConstName::VelocityRunJumpY){
                         return getCharacterField(&Character::getNeutralJumpingY, identifier.toLowerString());
                     }
 
-                    if (identifier == "velocity.runjump.back.x"){
+                    if (name == ConstName::VelocityRunJumpBackX){
                         return getCharacterField(&Character::getRunJumpBack, identifier.toLowerString());
                     }
 
-                    if (identifier == "velocity.run.back.x"){
+                    if (name == ConstName::VelocityRunBackX){
                         return getCharacterField(&Character::getRunBackX, identifier.toLowerString());
                     }
 
-                    if (identifier == "velocity.run.back.y"){
+                    if (name == ConstName::VelocityRunBackY){
                         return getCharacterField(&Character::getRunBackY, identifier.toLowerString());
                     }
 
-                    if (identifier == "velocity.jump.back.x"){
+                    if (name == ConstName::VelocityJumpBackX){
                         return getCharacterField(&Character::getJumpBack, identifier.toLowerString());
                     }
 
-                    if (identifier == "velocity.jump.fwd.x"){
+                    if (name == ConstName::VelocityJumpFwdX){
                         return getCharacterField(&Character::getJumpForward, identifier.toLowerString());
                     }
 
-                    if (identifier == "velocity.runjump.fwd.x"){
+                    if (name == ConstName::VelocityRunJumpFwdX){
                         return getCharacterField(&Character::getRunJumpForward, identifier.toLowerString());
                     }
                        
-                    if (identifier == "movement.air.gethit.airrecover.yaccel"){
+                    if (name == ConstName::MovementAirGetHitAirRecoverYAccel){
                         return getCharacterField(&Character::getAirHitRecoverYAccel, identifier.toLowerString());
                     }
 
@@ -2747,103 +3553,103 @@ public:
                        movement.down.bounce.groundlevel: Returns value of the "down.bounce.groundlevel" parameter. (float)
                        movement.down.friction.threshold: Returns value of the "down.friction.threshold" parameter. (float)
                        */
-                    if (identifier == "velocity.air.gethit.airrecover.mul.x"){
+                    if (name == ConstName::VelocityAirGetHitAirRecoverMulX){
                         return getCharacterField(&Character::getAirHitRecoverMultiplierX, identifier.toLowerString());
                     }
 
-                    if (identifier == "velocity.air.gethit.airrecover.mul.y"){
+                    if (name == ConstName::VelocityAirGetHitAirRecoverMulY){
                         return getCharacterField(&Character::getAirHitRecoverMultiplierY, identifier.toLowerString());
                     }
 
-                    if (identifier == "velocity.air.gethit.groundrecover.x"){
+                    if (name == ConstName::VelocityAirGetHitGroundRecoverX){
                         return getCharacterField(&Character::getAirHitGroundRecoverX, identifier.toLowerString());
                     }
                     
-                    if (identifier == "velocity.air.gethit.groundrecover.y"){
+                    if (name == ConstName::VelocityAirGetHitGroundRecoverY){
                         return getCharacterField(&Character::getAirHitGroundRecoverY, identifier.toLowerString());
                     }
 
-                    if (identifier == "velocity.air.gethit.airrecover.add.x"){
+                    if (name == ConstName::VelocityAirGetHitAirRecoverAddX){
                         return getCharacterField(&Character::getAirHitRecoverAddX, identifier.toLowerString());
                     }
                     
-                    if (identifier == "velocity.air.gethit.airrecover.add.y"){
+                    if (name == ConstName::VelocityAirGetHitAirRecoverAddY){
                         return getCharacterField(&Character::getAirHitRecoverAddY, identifier.toLowerString());
                     }
                      
-                    if (identifier == "velocity.air.gethit.airrecover.up"){
+                    if (name == ConstName::VelocityAirGetHitAirRecoverUp){
                         return getCharacterField(&Character::getAirHitRecoverUp, identifier.toLowerString());
                     }
                     
-                    if (identifier == "velocity.air.gethit.airrecover.down"){
+                    if (name == ConstName::VelocityAirGetHitAirRecoverDown){
                         return getCharacterField(&Character::getAirHitRecoverDown, identifier.toLowerString());
                     }
 
-                    if (identifier == "velocity.air.gethit.airrecover.fwd"){
+                    if (name == ConstName::VelocityAirGetHitAirRecoverFwd){
                         return getCharacterField(&Character::getAirHitRecoverForward, identifier.toLowerString());
                     }
                     
-                    if (identifier == "velocity.air.gethit.airrecover.back"){
+                    if (name == ConstName::VelocityAirGetHitAirRecoverBack){
                         return getCharacterField(&Character::getAirHitRecoverBack, identifier.toLowerString());
                     }
                      
-                    if (identifier == "velocity.airjump.neu.x"){
+                    if (name == ConstName::VelocityAirJumpNeuX){
                         return getCharacterField(&Character::getAirJumpNeutralX, identifier.toLowerString());
                     }
 
-                    if (identifier == "velocity.airjump.y"){
+                    if (name == ConstName::VelocityAirJumpY){
                         return getCharacterField(&Character::getAirJumpNeutralY, identifier.toLowerString());
                     }
 
-                    if (identifier == "velocity.airjump.back.x"){
+                    if (name == ConstName::VelocityAirJumpBackX){
                         return getCharacterField(&Character::getAirJumpBack, identifier.toLowerString());
                     }
 
-                    if (identifier == "velocity.airjump.fwd.x"){
+                    if (name == ConstName::VelocityAirJumpFwdX){
                         return getCharacterField(&Character::getAirJumpForward, identifier.toLowerString());
                     }
                     
-                    if (identifier == "size.xscale"){
+                    if (name == ConstName::SizeXScale){
                         return getCharacterField(&Character::getXScale, identifier.toLowerString());
                     }
                     
-                    if (identifier == "size.yscale"){
+                    if (name == ConstName::SizeYScale){
                         return getCharacterField(&Character::getYScale, identifier.toLowerString());
                     }
                     
-                    if (identifier == "size.ground.back"){
+                    if (name == ConstName::SizeGroundBack){
                         return getCharacterField(&Character::getGroundBack, identifier.toLowerString());
                     }
 
-                    if (identifier == "size.ground.front"){
+                    if (name == ConstName::SizeGroundFront){
                         return getCharacterField(&Character::getGroundFront, identifier.toLowerString());
                     }
 
-                    if (identifier == "size.air.back"){
+                    if (name == ConstName::SizeAirBack){
                         return getCharacterField(&Character::getAirBack, identifier.toLowerString());
                     }
 
-                    if (identifier == "size.air.front"){
+                    if (name == ConstName::SizeAirFront){
                         return getCharacterField(&Character::getAirFront, identifier.toLowerString());
                     }
 
-                    if (identifier == "size.height"){
+                    if (name == ConstName::SizeHeight){
                         return getCharacterField(&Character::getHeight, identifier.toLowerString());
                     }
 
-                    if (identifier == "size.attack.dist"){
+                    if (name == ConstName::SizeAttackDist){
                         return getCharacterField(&Character::getAttackDistance, identifier.toLowerString());
                     }
 
-                    if (identifier == "size.proj.attack.dist"){
+                    if (name == ConstName::SizeProjAttackDist){
                         return getCharacterField(&Character::getProjectileAttackDistance, identifier.toLowerString());
                     }
 
-                    if (identifier == "size.proj.doscale"){
+                    if (name == ConstName::SizeProjDoScale){
                         return getCharacterField(&Character::getProjectileScale, identifier.toLowerString());
                     }
 
-                    if (identifier == "size.head.pos.x"){
+                    if (name == ConstName::SizeHeadPosX){
                         class HeadPosX: public Value {
                         public:
                             RuntimeValue evaluate(const Environment & environment) const {
@@ -2863,7 +3669,7 @@ public:
                         return new HeadPosX();
                     }
 
-                    if (identifier == "size.head.pos.y"){
+                    if (name == ConstName::SizeHeadPosY){
                         class HeadPosY: public Value {
                         public:
                             RuntimeValue evaluate(const Environment & environment) const {
@@ -2883,7 +3689,7 @@ public:
                         return new HeadPosY();
                     }
 
-                    if (identifier == "size.mid.pos.x"){
+                    if (name == ConstName::SizeMidPosX){
                         class MidPosX: public Value {
                         public:
                             RuntimeValue evaluate(const Environment & environment) const {
@@ -2903,7 +3709,7 @@ public:
                         return new MidPosX();
                     }
                     
-                    if (identifier == "size.mid.pos.y"){
+                    if (name == ConstName::SizeMidPosY){
                         class MidPosY: public Value {
                         public:
                             RuntimeValue evaluate(const Environment & environment) const {
@@ -2924,12 +3730,12 @@ public:
 
                     }
                     
-                    if (identifier == "size.shadowoffset"){
+                    if (name == ConstName::SizeShadowOffset){
                         /* TODO */
                         return compile(0);
                     }
 
-                    if (identifier == "size.draw.offset.x"){
+                    if (name == ConstName::SizeDrawOffsetX){
                         class DrawOffsetX: public Value {
                         public:
                             RuntimeValue evaluate(const Environment & environment) const {
@@ -2949,7 +3755,7 @@ public:
                         return new DrawOffsetX();
                     }
 
-                    if (identifier == "size.draw.offset.y"){
+                    if (name == ConstName::SizeDrawOffsetY){
                         class DrawOffsetY: public Value {
                         public:
                             RuntimeValue evaluate(const Environment & environment) const {
@@ -2985,27 +3791,27 @@ public:
             return walker.compiled;
         }
 
-        if (function == "asin"){
+        if (name == FunctionName::Asin){
             return new MetaCircularArg1("asin", asin, compile(function.getArg1()));
         }
         
-        if (function == "sin"){
+        if (name == FunctionName::Sin){
             return new MetaCircularArg1("sin", sin, compile(function.getArg1()));
         }
         
-        if (function == "atan"){
+        if (name == FunctionName::Atan){
             return new MetaCircularArg1("atan", atan, compile(function.getArg1()));
         }
         
-        if (function == "tan"){
+        if (name == FunctionName::Tan){
             return new MetaCircularArg1("tan", tan, compile(function.getArg1()));
         }
 
-        if (function == "abs"){
+        if (name == FunctionName::Abs){
             return new MetaCircularArg1("abs", fabs, compile(function.getArg1()));
         }
         
-        if (function == "exp"){
+        if (name == FunctionName::Exp){
             return new MetaCircularArg1("exp", exp, compile(function.getArg1()));
         }
 
@@ -3015,7 +3821,7 @@ public:
         }
         */
 
-        if (function == "playeridexist"){
+        if (name == FunctionName::PlayerIDExist){
             class PlayerIdExist: public Value {
             public:
                 PlayerIdExist(Value * id):
@@ -3041,7 +3847,7 @@ public:
             return new PlayerIdExist(compile(function.getArg1()));
         }
 
-        if (function == "projhit"){
+        if (name == FunctionName::ProjHit){
             class ProjHit: public Value {
             public:
                 ProjHit(Value * id, Value * value, Value * compare):
@@ -3138,9 +3944,9 @@ public:
                      * is opposite between projhit = 0 and projhit = 1.
                      */
 
-                    vector<Projectile*> projectiles = environment.getStage().findProjectile(id, &environment.getCharacter());
+                    const vector<Projectile*> & projectiles = environment.getStage().getProjectiles(id, &environment.getCharacter());
                     bool found = false;
-                    for (vector<Projectile*>::iterator it = projectiles.begin(); it != projectiles.end(); it++){
+                    for (vector<Projectile*>::const_iterator it = projectiles.begin(); it != projectiles.end(); it++){
                         Projectile * projectile = *it;
                         /* For projectiles that never hit their lastHitTicks will be 0
                          * so in theory there is an *ultra* small chance that this code
@@ -3166,7 +3972,7 @@ public:
                                compile(function.getArg3()));
         }
 
-        if (function == "projguarded"){
+        if (name == FunctionName::ProjGuarded){
             /* Very similar to ProjHit */
             class ProjGuarded: public Value {
             public:
@@ -3207,9 +4013,9 @@ public:
                     int id = (int) this->id->evaluate(environment).toNumber();
                     bool hit = (int) this->value->evaluate(environment).toBool();
                     
-                    vector<Projectile*> projectiles = environment.getStage().findProjectile(id, &environment.getCharacter());
+                    const vector<Projectile*> & projectiles = environment.getStage().getProjectiles(id, &environment.getCharacter());
                     bool found = false;
-                    for (vector<Projectile*>::iterator it = projectiles.begin(); it != projectiles.end(); it++){
+                    for (vector<Projectile*>::const_iterator it = projectiles.begin(); it != projectiles.end(); it++){
                         Projectile * projectile = *it;
                         found = found || didGuard(environment, projectile, hit);
                     }
@@ -3223,7 +4029,7 @@ public:
                                    compile(function.getArg3()));
         }
 
-        if (function == "projcontact"){
+        if (name == FunctionName::ProjContact){
             class ProjContact: public Value {
             public:
                 ProjContact(Value * id, Value * value, Value * compare):
@@ -3263,9 +4069,9 @@ public:
                     int id = (int) this->id->evaluate(environment).toNumber();
                     bool hit = (int) this->value->evaluate(environment).toBool();
                     
-                    vector<Projectile*> projectiles = environment.getStage().findProjectile(id, &environment.getCharacter());
+                    const vector<Projectile*> & projectiles = environment.getStage().getProjectiles(id, &environment.getCharacter());
                     bool found = false;
-                    for (vector<Projectile*>::iterator it = projectiles.begin(); it != projectiles.end(); it++){
+                    for (vector<Projectile*>::const_iterator it = projectiles.begin(); it != projectiles.end(); it++){
                         Projectile * projectile = *it;
                         found = found || didHit(environment, projectile, hit);
                     }
@@ -3279,7 +4085,7 @@ public:
                                    compile(function.getArg3()));
         }
 
-        if (function == "ln"){
+        if (name == FunctionName::Ln){
             class Ln: public Value {
             public: 
                 Ln(Value * argument):
@@ -3313,7 +4119,7 @@ public:
             return new Ln(compile(function.getArg1()));
         }
 
-        if (function == "log"){
+        if (name == FunctionName::Log){
             class Log : public Value {
             public: 
                 Log(Value * arg1, Value * arg2):
@@ -3355,7 +4161,7 @@ public:
             return new Log(compile(function.getArg1()),compile(function.getArg2()));
         }
 
-        if (function == "numprojid"){
+        if (name == FunctionName::NumProjID){
             class NumProjId: public Value {
             public:
                 NumProjId(Value * id):
@@ -3363,7 +4169,7 @@ public:
                 }
 
                 RuntimeValue evaluate(const Environment & environment) const {
-                    return RuntimeValue((int) environment.getStage().findProjectile((int) id->evaluate(environment).toNumber(), &environment.getCharacter()).size());
+                    return RuntimeValue((int) environment.getStage().countProjectiles((int) id->evaluate(environment).toNumber(), &environment.getCharacter()));
                 }
 
                 virtual ~NumProjId(){
@@ -3380,7 +4186,7 @@ public:
             return new NumProjId(compile(function.getArg1()));
         }
 
-        if (function == "projhittime"){
+        if (name == FunctionName::ProjHitTime){
             class ProjHitTime: public Value {
             public: 
                 ProjHitTime(Value * arg1):
@@ -3402,7 +4208,7 @@ public:
                  * and when there are multiple.
                  * If there are multiple then return a vector of ints.
                  */
-                RuntimeValue projHit(const Stage & stage, const vector<Projectile*> projectiles) const {
+                RuntimeValue projHit(const Stage & stage, const vector<Projectile*> & projectiles) const {
                     if (projectiles.size() == 0){
                         return RuntimeValue(-1);
                     } else if (projectiles.size() == 1){
@@ -3437,9 +4243,9 @@ public:
                 RuntimeValue evaluate(const Environment & environment) const {
                     int id = (int) arg1->evaluate(environment).toNumber();
                     if (id <= 0){
-                        return projHit(environment.getStage(), environment.getStage().findProjectile(0, &environment.getCharacter()));
+                        return projHit(environment.getStage(), environment.getStage().getProjectiles(0, &environment.getCharacter()));
                     } else {
-                        return projHit(environment.getStage(), environment.getStage().findProjectile(id, &environment.getCharacter()));
+                        return projHit(environment.getStage(), environment.getStage().getProjectiles(id, &environment.getCharacter()));
                     }
                 }
             };
@@ -3447,17 +4253,17 @@ public:
             return new ProjHitTime(compile(function.getArg1()));
         }
 
-        if (function == "projhit"){
+        if (name == FunctionName::ProjHit){
             /* FIXME */
             return compile(0);
         }
 
-        if (function == "projcontacttime"){
+        if (name == FunctionName::ProjContactTime){
             /* FIXME */
             return compile(-1);
         }
         
-        if (function == "projcanceltime"){
+        if (name == FunctionName::ProjCancelTime){
             class ProjCancelTime: public Value {
             public: 
                 ProjCancelTime(Value * arg1):
@@ -3479,7 +4285,7 @@ public:
                  * and when there are multiple.
                  * If there are multiple then return a vector of ints.
                  */
-                RuntimeValue projCancel(const Stage & stage, const vector<Projectile*> projectiles) const {
+                RuntimeValue projCancel(const Stage & stage, const vector<Projectile*> & projectiles) const {
                     if (projectiles.size() == 0){
                         return RuntimeValue(-1);
                     } else if (projectiles.size() == 1){
@@ -3514,9 +4320,9 @@ public:
                 RuntimeValue evaluate(const Environment & environment) const {
                     int id = (int) arg1->evaluate(environment).toNumber();
                     if (id <= 0){
-                        return projCancel(environment.getStage(), environment.getStage().findProjectile(0, &environment.getCharacter()));
+                        return projCancel(environment.getStage(), environment.getStage().getProjectiles(0, &environment.getCharacter()));
                     } else {
-                        return projCancel(environment.getStage(), environment.getStage().findProjectile(id, &environment.getCharacter()));
+                        return projCancel(environment.getStage(), environment.getStage().getProjectiles(id, &environment.getCharacter()));
                     }
                 }
             };
@@ -3524,17 +4330,17 @@ public:
             return new ProjCancelTime(compile(function.getArg1()));
         }
        
-        if (function == "projguardedtime"){
+        if (name == FunctionName::ProjGuardedTime){
             /* FIXME */
             return compile(-1);
         }
 
-        if (function == "ishelper"){
+        if (name == FunctionName::IsHelper){
             /* FIXME */
             return compile(0);
         }
 
-        if (function == "numhelper"){
+        if (name == FunctionName::NumHelper){
             class NumHelper: public Value {
             public:
                 NumHelper(Value * argument):
@@ -3558,15 +4364,14 @@ public:
                 }
 
                 RuntimeValue evaluate(const Environment & environment) const {
-                    std::vector<Mugen::Helper*> helpers = environment.getStage().findHelpers(&environment.getCharacter(), (int) argument->evaluate(environment).toNumber());
-                    return RuntimeValue((int) helpers.size());
+                    return RuntimeValue(environment.getStage().countHelpers(&environment.getCharacter(), (int) argument->evaluate(environment).toNumber()));
                 }
             };
 
             return new NumHelper(compile(function.getArg1()));
         }
 
-        if (function == "floor"){
+        if (name == FunctionName::Floor){
             class FunctionFloor: public Value {
             public:
                 FunctionFloor(Value * argument):
@@ -3591,7 +4396,7 @@ public:
             return new FunctionFloor(compile(function.getArg1()));
         }
 
-        if (function == "ifelse"){
+        if (name == FunctionName::IfElse){
             class FunctionIfElse: public Value{
             public:
                 FunctionIfElse(Value * condition, Value * then, Value * else_):
@@ -3630,7 +4435,7 @@ public:
                                       compile(function.getArg3()));
         }
 
-        if (function == "gethitvar"){
+        if (name == FunctionName::GetHitVar){
             class HitVar: public Value {
             public:
                 HitVar(){
@@ -4010,12 +4815,12 @@ public:
             compileError("Unknown gethitvar variable " + var, __FILE__, __LINE__);
         }
 
-        if (function == "teammode!="){
+        if (name == FunctionName::TeamModeNotEqual){
             /* FIXME */
             return compile(0);
         }
         
-        if (function == "teammode"){
+        if (name == FunctionName::TeamMode){
             /* FIXME compare if current mode is single, simul or turns return 1 otherwise return 0 */
             class TeamMode: public Value {
             public:
@@ -4066,7 +4871,7 @@ public:
         }
 
         /* it would be nice to combine var/fvar/sysvar */
-        if (function == "var"){
+        if (name == FunctionName::Var){
             class FunctionVar: public Value{
             public:
                 FunctionVar(int index):
@@ -4096,7 +4901,7 @@ public:
             return new FunctionVar(index);
         }
 
-        if (function == "fvar"){
+        if (name == FunctionName::FVar){
             class FunctionFVar: public Value {
             public:
                 FunctionFVar(int index):
@@ -4126,7 +4931,7 @@ public:
             return new FunctionFVar(index);
         }
         
-        if (function == "sysfvar"){
+        if (name == FunctionName::SysFVar){
             class FunctionSysFVar: public Value{
             public:
                 FunctionSysFVar(int index):
@@ -4150,7 +4955,7 @@ public:
             return new FunctionSysFVar(index);
         }
 
-        if (function == "sysvar"){
+        if (name == FunctionName::SysVar){
             class FunctionSysVar: public Value{
             public:
                 FunctionSysVar(int index):
@@ -4180,7 +4985,7 @@ public:
             return new FunctionSysVar(index);
         }
 
-        if (function == "selfanimexist"){
+        if (name == FunctionName::SelfAnimExist){
             class SelfAnimExist: public Value {
             public:
                 SelfAnimExist(Value * animation):
@@ -4214,7 +5019,7 @@ public:
             return new SelfAnimExist(compile(function.getArg1()));
         }
 
-        if (function == "ceil"){
+        if (name == FunctionName::Ceil){
             class Ceil: public Value {
             public:
                 Ceil(Value * argument):
@@ -4239,15 +5044,15 @@ public:
             return new Ceil(compile(function.getArg1()));
         }
         
-        if (function == "acos"){
+        if (name == FunctionName::Acos){
             return new MetaCircularArg1("acos", acos, compile(function.getArg1()));
         }
         
-        if (function == "cos"){
+        if (name == FunctionName::Cos){
             return new MetaCircularArg1("cos", cos, compile(function.getArg1()));
         }
 
-        if (function == "animexist"){
+        if (name == FunctionName::AnimExist){
             class AnimExist: public Value {
             public:
                 AnimExist(Value * animation):
@@ -4279,7 +5084,7 @@ public:
          *
          * (reminder: first element of an action is element 1, not 0)
          */
-        if (function == "animelemtime"){
+        if (name == FunctionName::AnimElemTime){
             class FunctionAnimElemTime: public Value {
             public:
                 FunctionAnimElemTime(Value * index):
@@ -4375,7 +5180,7 @@ public:
         }
         */
 
-        if (function == "numexplod"){
+        if (name == FunctionName::NumExplod){
             class NumExplod: public Value{
             public:
                 NumExplod(Value * id):
@@ -4393,14 +5198,14 @@ public:
                 }
 
                 RuntimeValue evaluate(const Environment & environment) const {
-                    return RuntimeValue((int) environment.getStage().findExplode((int) id->evaluate(environment).toNumber(), &environment.getCharacter()).size());
+                    return RuntimeValue((int) environment.getStage().countExplods((int) id->evaluate(environment).toNumber(), &environment.getCharacter()));
                 }
             };
 
             return new NumExplod(compile(function.getArg1()));
         }
 
-        if (function == "animelemno"){
+        if (name == FunctionName::AnimElemNo){
             class AnimElemNo: public Value{
             public:
                 AnimElemNo(Value * index):
@@ -4432,7 +5237,7 @@ public:
             return new AnimElemNo(compile(function.getArg1()));
         }
 
-        if (function == "numtarget"){
+        if (name == FunctionName::NumTarget){
             class NumTarget: public Value{
             public:
                 NumTarget(Value * index):
@@ -4558,7 +5363,9 @@ public:
     }
 
     Value * compileKeyword(const Ast::Keyword & keyword){
-        if (keyword == "vel x"){
+        const int name = keywordNames.find(keyword.toString());
+
+        if (name == KeywordName::VelX){
             class VelX: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -4577,7 +5384,7 @@ public:
             return new VelX();
         }
 
-        if (keyword == "vel y"){
+        if (name == KeywordName::VelY){
             class VelY: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -4596,7 +5403,7 @@ public:
             return new VelY();
         }
         
-        if (keyword == "hitvel x"){
+        if (name == KeywordName::HitVelX){
             class HitVelX: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -4611,7 +5418,7 @@ public:
             return new HitVelX();
         }
         
-        if (keyword == "hitvel y"){
+        if (name == KeywordName::HitVelY){
             class HitVelY: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -4626,7 +5433,7 @@ public:
             return new HitVelY();
         }
 
-        if (keyword == "screenpos y"){
+        if (name == KeywordName::ScreenPosY){
             class ScreenPosY: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -4649,7 +5456,7 @@ public:
             return new ScreenPosY();
         }
 
-        if (keyword == "screenpos x"){
+        if (name == KeywordName::ScreenPosX){
             class ScreenPosX: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -4664,7 +5471,7 @@ public:
             return new ScreenPosX();
         }
         
-        if (keyword == "pos y"){
+        if (name == KeywordName::PosY){
             class PosY: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -4683,7 +5490,7 @@ public:
             return new PosY();
         }
 
-        if (keyword == "pos x"){
+        if (name == KeywordName::PosX){
             class PosX: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -4702,7 +5509,7 @@ public:
             return new PosX();
         }
         
-        if (keyword == "p2bodydist x"){
+        if (name == KeywordName::P2BodyDistX){
             class P2BodyDistX: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -4726,7 +5533,7 @@ public:
             return new P2BodyDistX();
         }
 
-        if (keyword == "p2bodydist y"){
+        if (name == KeywordName::P2BodyDistY){
             class P2BodyDistY: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -4746,7 +5553,7 @@ public:
             return new P2BodyDistY();
         }
 
-        if (keyword == "parentdist x"){
+        if (name == KeywordName::ParentDistX){
             class ParentDistX: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -4771,7 +5578,7 @@ public:
             return new ParentDistX();
         }
 
-        if (keyword == "parentdist y"){
+        if (name == KeywordName::ParentDistY){
             class ParentDistY: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -4796,7 +5603,7 @@ public:
             return new ParentDistY();
         }
 
-        if (keyword == "p2dist x"){
+        if (name == KeywordName::P2DistX){
             class P2DistX: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -4819,7 +5626,7 @@ public:
             return new P2DistX();
         }
 
-        if (keyword == "p2dist y"){
+        if (name == KeywordName::P2DistY){
             class P2DistY: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -4836,7 +5643,7 @@ public:
             return new P2DistY();
         }
 
-        if (keyword == "rootdist x"){
+        if (name == KeywordName::RootDistX){
             /* This trigger is only valid for helper-type characters. RootDist returns the distance from the helper to its root. The root is the main player character who owns the helper: for instance, if you select Kumquat to play with, and Kumquat spawns a helper named Kiwi, who in turn spawns a helper named Penguin, then Penguin's root is Kumquat, and Penguin is a descendant of Kumquat. RootDist works similarly to P2Dist.
              * For comparing the Y-distance, RootDist gives the difference in the heights of the players' Y-axes. A negative value means that the root is above its descendant.
              *
@@ -4859,7 +5666,7 @@ public:
             return new RootDistX();
         }
         
-        if (keyword == "rootdist y"){
+        if (name == KeywordName::RootDistY){
             class RootDistY: public Value {
             public:
                 RuntimeValue evaluate(const Environment & environment) const {
@@ -5078,7 +5885,20 @@ public:
             }
         };
 
-        return new Infix(compile(expression.getLeft()), compile(expression.getRight()), expression.getExpressionType());
+        Value * infix = new Infix(compile(expression.getLeft()), compile(expression.getRight()), expression.getExpressionType());
+        if (isComparison(expression.getExpressionType())){
+            __sync_add_and_fetch(&comparisonCount, 1);
+            if (fuseComparisons){
+                Value * fused = fuseComparison(expression, infix->toString());
+                if (fused != NULL){
+                    __sync_add_and_fetch(&fusedCount, 1);
+                    delete infix;
+                    return fused;
+                }
+            }
+        }
+
+        return infix;
 
         /*
         std::ostringstream out;
@@ -5181,5 +6001,22 @@ Value * copy(Value * value){
     return NULL;
 }
 
+void enableFusedComparisons(bool enable){
+    fuseComparisons = enable;
+}
+
+unsigned int comparisonsCompiled(){
+    return __sync_add_and_fetch(&comparisonCount, 0);
+}
+
+unsigned int comparisonsFused(){
+    return __sync_add_and_fetch(&fusedCount, 0);
+}
+
+void resetComparisonCounts(){
+    __sync_and_and_fetch(&comparisonCount, 0);
+    __sync_and_and_fetch(&fusedCount, 0);
+}
+
 }
 }
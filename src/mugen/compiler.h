@@ -212,7 +212,7 @@ public:
 
     virtual const Character & getCharacter() const = 0;
     virtual const Mugen::Stage & getStage() const = 0;
-    virtual const std::vector<std::string> getCommands() const = 0;
+    virtual const std::vector<std::string> & getCommands() const = 0;
 
     virtual RuntimeValue getArg1() const = 0;
 
@@ -230,19 +230,22 @@ public:
 
     virtual const Character & getCharacter() const;
     virtual const Mugen::Stage & getStage() const;
-    virtual const std::vector<std::string> getCommands() const;
+    virtual const std::vector<std::string> & getCommands() const;
     virtual RuntimeValue getArg1() const;
 };
 
+/* Environments are made for every state and every redirection, so the
+ * commands are not copied. They have to outlive the environment.
+ */
 class FullEnvironment: public Environment {
 public:
-    FullEnvironment(const Mugen::Stage & stage, const Character & character, const std::vector<std::string> commands):
+    FullEnvironment(const Mugen::Stage & stage, const Character & character, const std::vector<std::string> & commands):
     stage(stage),
     character(character),
     commands(commands){
     }
 
-    FullEnvironment(const Mugen::Stage & stage, const Character & character, const std::vector<std::string> commands, const RuntimeValue & arg1):
+    FullEnvironment(const Mugen::Stage & stage, const Character & character, const std::vector<std::string> & commands, const RuntimeValue & arg1):
     stage(stage),
     character(character),
     commands(commands),
@@ -251,7 +254,8 @@ public:
 
     FullEnvironment(const Mugen::Stage & stage, const Character & character):
     stage(stage),
-    character(character){
+    character(character),
+    commands(noCommands()){
     }
 
     /*
@@ -277,14 +281,16 @@ public:
 	return stage;
     }
 
-    virtual inline const std::vector<std::string> getCommands() const {
+    virtual inline const std::vector<std::string> & getCommands() const {
         return commands;
     }
 
 protected:
+    static const std::vector<std::string> & noCommands();
+
     const Mugen::Stage & stage;
     const Character & character;
-    std::vector<std::string> commands;
+    const std::vector<std::string> & commands;
     RuntimeValue arg1;
 };
 
@@ -324,6 +330,20 @@ namespace Compiler{
     Value * compile(int immediate);
     Value * compile(double immediate);
     Value * copy(Value * value);
+
+    /* Comparisons with a constant, like `stateno = 200' or `command = "x"',
+     * compile to one node that reads the value and compares it directly.
+     * Turning that off compiles them like any other expression, so the two
+     * can be compared.
+     */
+    void enableFusedComparisons(bool enable);
+
+    /* comparisons compiled since the last reset on any thread, and how many
+     * were fused
+     */
+    unsigned int comparisonsCompiled();
+    unsigned int comparisonsFused();
+    void resetComparisonCounts();
 }
 
 }
@@ -0,0 +1,269 @@
+#include "directory-watch.h"
+#include "profile.h"
+
+#include <r-tech1/debug.h>
+#include <r-tech1/funcs.h>
+#include <r-tech1/file-system.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+#include <string>
+#include <vector>
+
+namespace PaintownUtil = ::Util;
+
+using std::endl;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace Mugen{
+
+/* how often every file is looked at when inotify isn't available */
+static const uint64_t POLL_INTERVAL = 5000;
+
+static uint64_t currentMilliseconds(){
+    return Profile::currentMicroseconds() / 1000;
+}
+
+DirectoryWatch::DirectoryWatch(const vector<Filesystem::AbsolutePath> & roots, const vector<string> & extensions, uint64_t quietMilliseconds):
+roots(roots),
+extensions(extensions),
+quiet(quietMilliseconds),
+/* scan once at the start in case something changed between the search and
+ * the watch starting
+ */
+dirty(true),
+lastChange(currentMilliseconds()),
+notify(-1),
+lastPoll(0),
+lastFingerprint(0){
+#ifdef __linux__
+    notify = inotify_init();
+    if (notify != -1){
+        watchDirectories();
+    }
+#endif
+
+    if (notify == -1){
+        startPolling();
+    }
+}
+
+DirectoryWatch::~DirectoryWatch(){
+#ifdef __linux__
+    if (notify != -1){
+        close(notify);
+    }
+#endif
+}
+
+void DirectoryWatch::setKnown(const vector<Filesystem::AbsolutePath> & files){
+    known.clear();
+    known.insert(files.begin(), files.end());
+}
+
+bool DirectoryWatch::isNotified() const {
+    return notify != -1;
+}
+
+void DirectoryWatch::startPolling(){
+#ifdef __linux__
+    if (notify != -1){
+        close(notify);
+        notify = -1;
+    }
+#endif
+    Global::debug(1) << "Polling for new characters and stages every " << (POLL_INTERVAL / 1000) << " seconds" << endl;
+    lastPoll = currentMilliseconds();
+    lastFingerprint = fingerprint();
+}
+
+bool DirectoryWatch::check(int timeout, vector<Filesystem::AbsolutePath> & added, vector<Filesystem::AbsolutePath> & removed){
+    if (isNotified()){
+        waitNotified(timeout);
+    } else {
+        waitPolled(timeout);
+    }
+
+    /* A poll only notices a change every POLL_INTERVAL, so wait until one
+     * poll has seen nothing change before trusting that things are quiet.
+     */
+    uint64_t wait = isNotified() || quiet > POLL_INTERVAL ? quiet : POLL_INTERVAL;
+    if (!dirty || currentMilliseconds() - lastChange < wait){
+        return false;
+    }
+    dirty = false;
+
+    vector<Filesystem::AbsolutePath> found = scan();
+    set<Filesystem::AbsolutePath> current(found.begin(), found.end());
+    for (set<Filesystem::AbsolutePath>::iterator it = current.begin(); it != current.end(); it++){
+        if (known.find(*it) == known.end()){
+            added.push_back(*it);
+        }
+    }
+
+    for (set<Filesystem::AbsolutePath>::iterator it = known.begin(); it != known.end(); it++){
+        if (current.find(*it) == current.end()){
+            removed.push_back(*it);
+        }
+    }
+
+    known.swap(current);
+    return added.size() > 0 || removed.size() > 0;
+}
+
+vector<Filesystem::AbsolutePath> DirectoryWatch::scan(){
+    vector<Filesystem::AbsolutePath> found;
+    for (vector<Filesystem::AbsolutePath>::const_iterator root = roots.begin(); root != roots.end(); root++){
+        for (vector<string>::const_iterator extension = extensions.begin(); extension != extensions.end(); extension++){
+            try{
+                vector<Filesystem::AbsolutePath> files = Storage::instance().getFilesRecursive(*root, string("*.") + *extension);
+                found.insert(found.end(), files.begin(), files.end());
+            } catch (const Filesystem::NotFound & fail){
+            }
+        }
+    }
+    return found;
+}
+
+/* Changes if any file under the roots is added, removed or written to */
+uint64_t DirectoryWatch::fingerprint(){
+    uint64_t total = 0;
+    for (vector<Filesystem::AbsolutePath>::const_iterator root = roots.begin(); root != roots.end(); root++){
+        vector<Filesystem::AbsolutePath> files;
+        try{
+            files = Storage::instance().getFilesRecursive(*root, "*");
+        } catch (const Filesystem::NotFound & fail){
+        }
+
+        for (vector<Filesystem::AbsolutePath>::iterator it = files.begin(); it != files.end(); it++){
+            const string & path = it->path();
+            for (string::const_iterator letter = path.begin(); letter != path.end(); letter++){
+                total = total * 31 + (unsigned char) *letter;
+            }
+
+            struct stat information;
+            if (stat(path.c_str(), &information) == 0){
+                total = total * 31 + (uint64_t) information.st_size;
+                total = total * 31 + (uint64_t) information.st_mtime;
+            }
+        }
+    }
+    return total;
+}
+
+void DirectoryWatch::waitPolled(int timeout){
+    uint64_t now = currentMilliseconds();
+    if (now - lastPoll < POLL_INTERVAL){
+        PaintownUtil::rest(timeout);
+        return;
+    }
+
+    lastPoll = now;
+    uint64_t next = fingerprint();
+    if (next != lastFingerprint){
+        lastFingerprint = next;
+        dirty = true;
+        lastChange = now;
+    }
+}
+
+void DirectoryWatch::waitNotified(int timeout){
+#ifdef __linux__
+    struct pollfd wait;
+    wait.fd = notify;
+    wait.events = POLLIN;
+    wait.revents = 0;
+    if (poll(&wait, 1, timeout) <= 0 || !(wait.revents & POLLIN)){
+        return;
+    }
+
+    union{
+        struct inotify_event event;
+        char bytes[4096];
+    } buffer;
+
+    ssize_t length = read(notify, buffer.bytes, sizeof(buffer.bytes));
+    if (length <= 0){
+        return;
+    }
+
+    dirty = true;
+    lastChange = currentMilliseconds();
+
+    /* a new directory has to be watched before the files in it get copied */
+    bool newDirectory = false;
+    for (char * position = buffer.bytes; position < buffer.bytes + length; ){
+        struct inotify_event * event = (struct inotify_event *) position;
+        if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO))){
+            newDirectory = true;
+        }
+        position += sizeof(struct inotify_event) + event->len;
+    }
+
+    if (newDirectory){
+        watchDirectories();
+    }
+#endif
+}
+
+void DirectoryWatch::watchDirectories(){
+    for (vector<Filesystem::AbsolutePath>::const_iterator root = roots.begin(); root != roots.end(); root++){
+        if (!watchDirectory(root->path())){
+            /* probably ran out of inotify watches */
+            Global::debug(0) << "Could not watch " << root->path() << " for changes" << endl;
+            startPolling();
+            return;
+        }
+    }
+}
+
+/* Watches the directory and everything under it. Watching a directory twice
+ * is harmless, inotify just hands back the same watch.
+ */
+bool DirectoryWatch::watchDirectory(const string & path){
+#ifdef __linux__
+    const uint32_t events = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+    if (inotify_add_watch(notify, path.c_str(), events) == -1){
+        /* the directory doesn't exist (yet), nothing to watch */
+        return errno == ENOENT || errno == ENOTDIR;
+    }
+
+    DIR * directory = opendir(path.c_str());
+    if (directory == NULL){
+        return true;
+    }
+
+    bool ok = true;
+    struct dirent * entry;
+    while (ok && (entry = readdir(directory)) != NULL){
+        string name = entry->d_name;
+        if (name == "." || name == ".."){
+            continue;
+        }
+
+        string full = path + "/" + name;
+        struct stat information;
+        /* lstat so a symlink loop can't recurse forever */
+        if (lstat(full.c_str(), &information) == 0 && S_ISDIR(information.st_mode)){
+            ok = watchDirectory(full);
+        }
+    }
+    closedir(directory);
+    return ok;
+#else
+    return false;
+#endif
+}
+
+}
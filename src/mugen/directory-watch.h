@@ -0,0 +1,65 @@
+#ifndef _paintown_mugen_directory_watch_h
+#define _paintown_mugen_directory_watch_h
+
+#include <stdint.h>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <r-tech1/file-system.h>
+
+namespace Mugen{
+
+/* Notices files with the given extensions appearing in or disappearing from a
+ * set of directories. Uses inotify where it is available and otherwise looks
+ * at every file under the directories every few seconds.
+ *
+ * Changes are only reported once nothing under the directories has changed for
+ * a while, so a character that is still being copied doesn't show up with half
+ * of its files.
+ */
+class DirectoryWatch{
+public:
+    DirectoryWatch(const std::vector<Filesystem::AbsolutePath> & roots, const std::vector<std::string> & extensions, uint64_t quietMilliseconds);
+    virtual ~DirectoryWatch();
+
+    /* files that were already found, they won't be reported as added */
+    void setKnown(const std::vector<Filesystem::AbsolutePath> & files);
+
+    /* Waits up to timeout milliseconds for something to change. Returns true
+     * and fills in added and removed if there are changes to report.
+     */
+    bool check(int timeout, std::vector<Filesystem::AbsolutePath> & added, std::vector<Filesystem::AbsolutePath> & removed);
+
+    /* false if the directories are being polled */
+    bool isNotified() const;
+
+protected:
+    std::vector<Filesystem::AbsolutePath> scan();
+    uint64_t fingerprint();
+    void waitNotified(int timeout);
+    void waitPolled(int timeout);
+    void startPolling();
+    void watchDirectories();
+    bool watchDirectory(const std::string & path);
+
+    const std::vector<Filesystem::AbsolutePath> roots;
+    const std::vector<std::string> extensions;
+    const uint64_t quiet;
+
+    std::set<Filesystem::AbsolutePath> known;
+
+    /* something changed since the last scan */
+    bool dirty;
+    uint64_t lastChange;
+
+    /* inotify descriptor, -1 when polling */
+    int notify;
+
+    uint64_t lastPoll;
+    uint64_t lastFingerprint;
+};
+
+}
+
+#endif
@@ -2,6 +2,7 @@
 #include "animation.h"
 #include "stage.h"
 #include "character.h"
+#include "explod-store.h"
 #include <r-tech1/graphics/bitmap.h>
 
 namespace Mugen{
@@ -33,6 +34,10 @@ void Effect::superPauseStart(){
 
 void Effect::superPauseEnd(){
 }
+
+bool Effect::isBatched() const {
+    return false;
+}
     
 int Effect::getSpritePriority() const {
     return spritePriority;
@@ -106,79 +111,111 @@ static void computePosition(double posX, double posY, const Character * owner, c
     }
 }
 
-ExplodeEffect::ExplodeEffect(const Character * owner, const Mugen::Stage & stage, ::Util::ReferenceCount<Animation> animation, int id, int x, int y, double velocityX, double velocityY, double accelerationX, double accelerationY, int removeTime, int bindTime, PositionType positionType, int posX, int posY, double scaleX, double scaleY, int spritePriority, bool superMove, int superMoveTime, bool horizontalFlip, bool verticalFlip, bool ownPalette, bool removeOnHit):
+ExplodeEffect::ExplodeEffect(const Character * owner, Mugen::Stage & stage, ::Util::ReferenceCount<Animation> animation, int id, int x, int y, double velocityX, double velocityY, double accelerationX, double accelerationY, int removeTime, int bindTime, PositionType positionType, int posX, int posY, double scaleX, double scaleY, int spritePriority, bool superMove, int superMoveTime, bool horizontalFlip, bool verticalFlip, bool ownPalette, bool removeOnHit):
 Effect(owner, animation, id, x, y, scaleX, scaleY, spritePriority),
 stage(stage),
-velocityX(velocityX),
-velocityY(velocityY),
-accelerationX(accelerationX),
-accelerationY(accelerationY),
-removeTime(removeTime),
-bindTime(bindTime),
+store(stage.getExplods()),
+row(0),
 positionType(positionType),
 posX(posX),
 posY(posY),
-frozen(false),
 superMovePersist(superMove),
-superMoveTime(superMoveTime),
 horizontalFlip(horizontalFlip),
 verticalFlip(verticalFlip),
 ownPalette(ownPalette),
-removeOnHit(removeOnHit),
 hitCount(owner->getWasHitCount()),
 shouldRemove(false){
+    store.add(this, x, y, velocityX, velocityY, accelerationX, accelerationY, removeTime, bindTime, superMoveTime, horizontalFlip, removeOnHit);
 }
 
+ExplodeEffect::~ExplodeEffect(){
+    store.remove(row);
+}
 
+double ExplodeEffect::getX() const {
+    return store.positionX[row];
+}
 
-void ExplodeEffect::logic(){
-    if (removeOnHit){
-        shouldRemove = owner->getWasHitCount() > hitCount;
-    }
+double ExplodeEffect::getY() const {
+    return store.positionY[row];
+}
 
-    if (!frozen){
-        Effect::logic();
-
-        /* either stopped or not set at all.
-         * FIXME: sort of a hack.. find a more elegant solution
-         */
-        if (bindTime == 0 || bindTime == -2){
-            int reverse = horizontalFlip ? -1 : 1;
-            x += velocityX * reverse;
-            y += velocityY;
-            velocityX += accelerationX * reverse;
-            velocityY += accelerationY;
-        } else {
-        }
+void ExplodeEffect::setX(double x){
+    store.positionX[row] = x;
+}
 
-        if (removeTime > 0){
-            removeTime -= 1;
-        }
-    } else {
-        if (superMoveTime > 0){
-            superMoveTime -= 1;
-            /* If we run out of super move time then we should freeze */
-            if (superMoveTime == 0){
-                frozen = true;
-            }
-        }
-    }
+void ExplodeEffect::setY(double y){
+    store.positionY[row] = y;
+}
 
-    /* FIXME: should we do the bind even if we are frozen? */
-    if (bindTime != 0){
-        /* bindTime could be negative in which case its active forever */
-        if (bindTime > 0){
-            bindTime -= 1;
-        }
+void ExplodeEffect::setVelocityX(double x){
+    store.velocityX[row] = x;
+}
 
-        /* -2 is the default bindtime that means it wasn't set in the explod.
-         * if the bindtime is -1 then it should act indefinetely.
-         */
-        if (bindTime != -2){
-            /* FIXME: should we always use the same horizontalFlip here? */
-            computePosition(posX, posY, owner, stage, positionType, horizontalFlip, x, y);
-        }
-    }
+double ExplodeEffect::getVelocityX() const {
+    return store.velocityX[row];
+}
+
+void ExplodeEffect::setVelocityY(double y){
+    store.velocityY[row] = y;
+}
+
+double ExplodeEffect::getVelocityY() const {
+    return store.velocityY[row];
+}
+
+void ExplodeEffect::setAccelerationX(double x){
+    store.accelerationX[row] = x;
+}
+
+double ExplodeEffect::getAccelerationX() const {
+    return store.accelerationX[row];
+}
+
+void ExplodeEffect::setAccelerationY(double y){
+    store.accelerationY[row] = y;
+}
+
+double ExplodeEffect::getAccelerationY() const {
+    return store.accelerationY[row];
+}
+
+void ExplodeEffect::setBindTime(int time){
+    store.bindTime[row] = time;
+}
+
+void ExplodeEffect::setRemoveTime(int time){
+    store.removeTime[row] = time;
+}
+
+int ExplodeEffect::getRemoveTime() const {
+    return store.removeTime[row];
+}
+
+void ExplodeEffect::setRow(unsigned int row){
+    this->row = row;
+}
+
+void ExplodeEffect::checkOwnerHit(){
+    shouldRemove = owner->getWasHitCount() > hitCount;
+}
+
+void ExplodeEffect::animate(){
+    Effect::logic();
+}
+
+void ExplodeEffect::bind(){
+    /* FIXME: should we always use the same horizontalFlip here? */
+    computePosition(posX, posY, owner, stage, positionType, horizontalFlip, store.positionX[row], store.positionY[row]);
+}
+
+/* the stage moves all of the explods at once with ExplodStore::logic */
+bool ExplodeEffect::isBatched() const {
+    return true;
+}
+
+void ExplodeEffect::logic(){
+    store.logic(row);
 }
 
 void ExplodeEffect::draw(const Graphics::Bitmap & work, int cameraX, int cameraY){
@@ -190,25 +227,25 @@ bool ExplodeEffect::isDead(){
         return true;
     }
 
-    switch (removeTime){
+    switch (getRemoveTime()){
         case -2: return Effect::isDead();
         case -1: return false;
-        default : return removeTime == 0;
+        default : return getRemoveTime() == 0;
     }
 
     return true;
 }
 
 void ExplodeEffect::superPauseStart(){
-    if (!superMovePersist && superMoveTime == 0){
-        frozen = true;
+    if (!superMovePersist && store.superMoveTime[row] == 0){
+        store.frozen[row] = true;
     }
 }
 
 void ExplodeEffect::superPauseEnd(){
     /* Unfreeze no matter what */
-    frozen = false;
-    superMoveTime = 0;
+    store.frozen[row] = false;
+    store.superMoveTime[row] = 0;
 }
 
 }
@@ -29,6 +29,11 @@ public:
     virtual void superPauseStart();
     virtual void superPauseEnd();
 
+    /* true if the stage runs the logic for this effect together with the
+     * others of its kind instead of calling logic
+     */
+    virtual bool isBatched() const;
+
     virtual inline double getX() const {
         return x;
     }
@@ -67,77 +72,58 @@ public:
     virtual ~Spark();
 };
 
+class ExplodStore;
+
+/* The position, velocity and timers live in the stage's ExplodStore so the
+ * stage can move all the explods together, this reads and writes them there.
+ */
 class ExplodeEffect: public Effect {
     public:
-        ExplodeEffect(const Character * owner, const Mugen::Stage & stage, ::Util::ReferenceCount<Animation> animation, int id, int x, int y, double velocityX, double velocityY, double accelerationX, double accelerationY, int removeTime, int bindTime, PositionType positionType, int posX, int posY, double scaleX, double scaleY, int spritePriority, bool superMove, int superMoveTime, bool horizontalFlip, bool verticalFlip, bool ownPalette, bool removeOnHit);
-
-        void setVelocityX(double x){
-            velocityX = x;
-        }
-
-        double getVelocityX() const {
-            return velocityX;
-        }
-
-        void setVelocityY(double y){
-            velocityY = y;
-        }
-        
-        double getVelocityY() const {
-            return velocityY;
-        }
-
-        void setAccelerationX(double x){
-            accelerationX = x;
-        }
-
-        void setBindTime(int time){
-            bindTime = time;
-        }
-
-        double getAccelerationX() const {
-            return accelerationX;
-        }
-
-        void setAccelerationY(double y){
-            accelerationY = y;
-        }
-
-        double getAccelerationY() const {
-            return accelerationY;
-        }
-
-        void setRemoveTime(int time){
-            removeTime = time;
-        }
-
-        int getRemoveTime() const {
-            return removeTime;
-        }
+        ExplodeEffect(const Character * owner, Mugen::Stage & stage, ::Util::ReferenceCount<Animation> animation, int id, int x, int y, double velocityX, double velocityY, double accelerationX, double accelerationY, int removeTime, int bindTime, PositionType positionType, int posX, int posY, double scaleX, double scaleY, int spritePriority, bool superMove, int superMoveTime, bool horizontalFlip, bool verticalFlip, bool ownPalette, bool removeOnHit);
+
+        virtual double getX() const;
+        virtual double getY() const;
+        virtual void setX(double x);
+        virtual void setY(double y);
+
+        void setVelocityX(double x);
+        double getVelocityX() const;
+        void setVelocityY(double y);
+        double getVelocityY() const;
+        void setAccelerationX(double x);
+        double getAccelerationX() const;
+        void setAccelerationY(double y);
+        double getAccelerationY() const;
+        void setBindTime(int time);
+        void setRemoveTime(int time);
+        int getRemoveTime() const;
     
         virtual void superPauseStart();
         virtual void superPauseEnd();
         virtual void logic();
         virtual void draw(const Graphics::Bitmap & work, int cameraX, int cameraY);
         virtual bool isDead();
+        virtual bool isBatched() const;
+
+        /* for ExplodStore */
+        void setRow(unsigned int row);
+        void checkOwnerHit();
+        void animate();
+        void bind();
+
+        virtual ~ExplodeEffect();
 
         const Mugen::Stage & stage;
-        double velocityX;
-        double velocityY;
-        double accelerationX;
-        double accelerationY;
-        int removeTime;
-        int bindTime;
+        ExplodStore & store;
+        /* where the numbers for this explod are in the store */
+        unsigned int row;
         PositionType positionType;
         const int posX;
         const int posY;
-        bool frozen;
         const bool superMovePersist;
-        int superMoveTime;
         const bool horizontalFlip;
         const bool verticalFlip;
         const bool ownPalette;
-        const bool removeOnHit;
         const unsigned int hitCount;
         bool shouldRemove;
 
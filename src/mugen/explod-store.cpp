@@ -0,0 +1,129 @@
+#include "explod-store.h"
+#include "effect.h"
+
+namespace Mugen{
+
+ExplodStore::ExplodStore(){
+}
+
+void ExplodStore::add(ExplodeEffect * effect, double x, double y, double velocityX, double velocityY, double accelerationX, double accelerationY, int removeTime, int bindTime, int superMoveTime, bool horizontalFlip, bool removeOnHit){
+    effect->setRow(effects.size());
+    effects.push_back(effect);
+    positionX.push_back(x);
+    positionY.push_back(y);
+    this->velocityX.push_back(velocityX);
+    this->velocityY.push_back(velocityY);
+    this->accelerationX.push_back(accelerationX);
+    this->accelerationY.push_back(accelerationY);
+    direction.push_back(horizontalFlip ? -1 : 1);
+    this->removeTime.push_back(removeTime);
+    this->bindTime.push_back(bindTime);
+    this->superMoveTime.push_back(superMoveTime);
+    frozen.push_back(false);
+    this->removeOnHit.push_back(removeOnHit);
+}
+
+template <class Value>
+static void moveRow(std::vector<Value> & values, unsigned int to){
+    values[to] = values.back();
+    values.pop_back();
+}
+
+void ExplodStore::remove(unsigned int row){
+    moveRow(effects, row);
+    moveRow(positionX, row);
+    moveRow(positionY, row);
+    moveRow(velocityX, row);
+    moveRow(velocityY, row);
+    moveRow(accelerationX, row);
+    moveRow(accelerationY, row);
+    moveRow(direction, row);
+    moveRow(removeTime, row);
+    moveRow(bindTime, row);
+    moveRow(superMoveTime, row);
+    moveRow(frozen, row);
+    moveRow(removeOnHit, row);
+
+    if (row < effects.size()){
+        effects[row]->setRow(row);
+    }
+}
+
+unsigned int ExplodStore::size() const {
+    return effects.size();
+}
+
+void ExplodStore::logic(){
+    step(0, size());
+}
+
+void ExplodStore::logic(unsigned int row){
+    step(row, row + 1);
+}
+
+/* Each row goes through the same steps in the same order as it would on its
+ * own, the rows just don't look at each other.
+ */
+void ExplodStore::step(unsigned int first, unsigned int last){
+    for (unsigned int row = first; row < last; row++){
+        if (removeOnHit[row]){
+            effects[row]->checkOwnerHit();
+        }
+    }
+
+    for (unsigned int row = first; row < last; row++){
+        if (!frozen[row]){
+            effects[row]->animate();
+        }
+    }
+
+    /* either stopped or not set at all.
+     * FIXME: sort of a hack.. find a more elegant solution
+     */
+    for (unsigned int row = first; row < last; row++){
+        if (!frozen[row] && (bindTime[row] == 0 || bindTime[row] == -2)){
+            positionX[row] += velocityX[row] * direction[row];
+            positionY[row] += velocityY[row];
+            velocityX[row] += accelerationX[row] * direction[row];
+            velocityY[row] += accelerationY[row];
+        }
+    }
+
+    for (unsigned int row = first; row < last; row++){
+        if (!frozen[row]){
+            if (removeTime[row] > 0){
+                removeTime[row] -= 1;
+            }
+        } else if (superMoveTime[row] > 0){
+            superMoveTime[row] -= 1;
+            /* If we run out of super move time then we should freeze */
+            if (superMoveTime[row] == 0){
+                frozen[row] = true;
+            }
+        }
+    }
+
+    /* FIXME: should we do the bind even if we are frozen? */
+    bound.clear();
+    for (unsigned int row = first; row < last; row++){
+        if (bindTime[row] != 0){
+            /* bindTime could be negative in which case its active forever */
+            if (bindTime[row] > 0){
+                bindTime[row] -= 1;
+            }
+
+            /* -2 is the default bindtime that means it wasn't set in the explod.
+             * if the bindtime is -1 then it should act indefinetely.
+             */
+            if (bindTime[row] != -2){
+                bound.push_back(row);
+            }
+        }
+    }
+
+    for (std::vector<unsigned int>::iterator it = bound.begin(); it != bound.end(); it++){
+        effects[*it]->bind();
+    }
+}
+
+}
@@ -0,0 +1,62 @@
+#ifndef _paintown_mugen_explod_store_h
+#define _paintown_mugen_explod_store_h
+
+#include <vector>
+
+namespace Mugen{
+
+class ExplodeEffect;
+
+/* The moving parts of every explod on the stage, one array per field, so a
+ * tick can move hundreds of explods by walking a few arrays instead of
+ * visiting each explod on the heap.
+ *
+ * An ExplodeEffect keeps the row its numbers are in and reads and writes them
+ * through the store. Removing a row moves the last row into its place, so the
+ * arrays never have holes in them and the row of an explod can change.
+ */
+class ExplodStore{
+public:
+    ExplodStore();
+
+    /* gives the explod a row and tells it which one */
+    void add(ExplodeEffect * effect, double x, double y, double velocityX, double velocityY, double accelerationX, double accelerationY, int removeTime, int bindTime, int superMoveTime, bool horizontalFlip, bool removeOnHit);
+    void remove(unsigned int row);
+
+    /* One tick for every explod. The animations, explods that go away when
+     * their owner is hit and explods bound to a position go through the
+     * ExplodeEffect, the rest is done here.
+     */
+    void logic();
+
+    /* One tick for a single explod */
+    void logic(unsigned int row);
+
+    unsigned int size() const;
+
+    /* read and written by ExplodeEffect with its row */
+    std::vector<double> positionX;
+    std::vector<double> positionY;
+    std::vector<double> velocityX;
+    std::vector<double> velocityY;
+    std::vector<double> accelerationX;
+    std::vector<double> accelerationY;
+    /* -1 for explods that are flipped horizontally, 1 otherwise */
+    std::vector<double> direction;
+    std::vector<int> removeTime;
+    std::vector<int> bindTime;
+    std::vector<int> superMoveTime;
+    std::vector<char> frozen;
+    std::vector<char> removeOnHit;
+
+protected:
+    void step(unsigned int first, unsigned int last);
+
+    std::vector<ExplodeEffect*> effects;
+    /* rows that are bound to a position this tick, kept to save allocating */
+    std::vector<unsigned int> bound;
+};
+
+}
+
+#endif
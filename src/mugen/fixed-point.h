@@ -0,0 +1,106 @@
+#ifndef _paintown_mugen_fixed_point_h
+#define _paintown_mugen_fixed_point_h
+
+#include <stdint.h>
+#include <math.h>
+
+namespace Mugen{
+
+/* A number with 16 bits after the point kept in an integer, so adding and
+ * multiplying gives the same answer no matter which compiler or which
+ * optimization flags built the game.
+ *
+ * Every FixedPoint turns into a double without any rounding, which lets the
+ * stage keep positions and velocities as doubles and still be exact.
+ */
+class FixedPoint{
+public:
+    static const int FractionBits = 16;
+    static const int64_t One = 1 << FractionBits;
+
+    FixedPoint():
+    value(0){
+    }
+
+    /* rounds to the nearest 1/65536 */
+    explicit FixedPoint(double what):
+    value((int64_t) floor(what * One + 0.5)){
+    }
+
+    static FixedPoint fromRaw(int64_t raw){
+        FixedPoint out;
+        out.value = raw;
+        return out;
+    }
+
+    int64_t raw() const {
+        return value;
+    }
+
+    double toDouble() const {
+        return (double) value / One;
+    }
+
+    /* true if the double is already a multiple of 1/65536 */
+    static bool exact(double what){
+        return FixedPoint(what).toDouble() == what;
+    }
+
+    FixedPoint operator+(const FixedPoint & him) const {
+        return fromRaw(value + him.value);
+    }
+
+    FixedPoint operator-(const FixedPoint & him) const {
+        return fromRaw(value - him.value);
+    }
+
+    FixedPoint operator-() const {
+        return fromRaw(-value);
+    }
+
+    /* rounds half way values up */
+    FixedPoint operator*(const FixedPoint & him) const {
+        return fromRaw((value * him.value + One / 2) >> FractionBits);
+    }
+
+    FixedPoint & operator+=(const FixedPoint & him){
+        value += him.value;
+        return *this;
+    }
+
+    FixedPoint & operator-=(const FixedPoint & him){
+        value -= him.value;
+        return *this;
+    }
+
+    bool operator==(const FixedPoint & him) const {
+        return value == him.value;
+    }
+
+    bool operator!=(const FixedPoint & him) const {
+        return value != him.value;
+    }
+
+    bool operator<(const FixedPoint & him) const {
+        return value < him.value;
+    }
+
+    bool operator<=(const FixedPoint & him) const {
+        return value <= him.value;
+    }
+
+    bool operator>(const FixedPoint & him) const {
+        return value > him.value;
+    }
+
+    bool operator>=(const FixedPoint & him) const {
+        return value >= him.value;
+    }
+
+protected:
+    int64_t value;
+};
+
+}
+
+#endif
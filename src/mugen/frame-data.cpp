@@ -0,0 +1,201 @@
+#include <r-tech1/graphics/bitmap.h>
+#include <r-tech1/font.h>
+#include "frame-data.h"
+#include "character.h"
+#include "animation.h"
+#include "stage.h"
+#include "factory/font_render.h"
+
+#include <vector>
+
+using std::vector;
+using std::map;
+
+namespace Mugen{
+
+static const int DEFAULT_WIDTH = 320;
+
+FrameData::FrameData():
+tick(0),
+attacking(false),
+moves(0),
+sinceActive(0),
+contact(None),
+attackerFree(0),
+defenderFree(0),
+defenderStunned(false),
+defenderHit(false),
+defenderHits(0){
+}
+
+void FrameData::startMove(const Character & attacker){
+    attacking = true;
+    move = MoveData();
+    move.state = attacker.getCurrentState();
+    sinceActive = 0;
+    contact = None;
+    attackerFree = 0;
+    defenderFree = 0;
+    defenderStunned = false;
+}
+
+void FrameData::finishMove(){
+    attacking = false;
+    move.recovery = sinceActive;
+    sinceActive = 0;
+    moves += 1;
+    attackerFree = tick;
+    checkAdvantage();
+}
+
+void FrameData::checkAdvantage(){
+    if (contact == None || attackerFree == 0 || defenderFree == 0){
+        return;
+    }
+
+    Advantage & advantage = contact == Hit ? hitAdvantage : blockAdvantage;
+    advantage.valid = true;
+    advantage.frames = (int) defenderFree - (int) attackerFree;
+
+    /* only report the advantage once per move */
+    contact = None;
+}
+
+void FrameData::update(const Character & attacker, const Character & defender){
+    /* Hitpause freezes both characters so it doesn't count towards the
+     * length of the move.
+     */
+    if (attacker.isPaused()){
+        return;
+    }
+
+    tick += 1;
+
+    bool nowAttacking = attacker.getMoveType() == Mugen::Move::Attack;
+    if (nowAttacking && !attacking){
+        startMove(attacker);
+    }
+
+    if (attacking){
+        if (!nowAttacking){
+            finishMove();
+        } else if (!attacker.getAttackBoxes().empty()){
+            if (move.hasActive){
+                /* gaps between two active periods are still part of the active frames */
+                move.active += sinceActive;
+            }
+            move.hasActive = true;
+            move.active += 1;
+            sinceActive = 0;
+        } else if (move.hasActive){
+            sinceActive += 1;
+        } else {
+            move.startup += 1;
+        }
+    }
+
+    /* Only a rising edge of the hit state or a new hit counts as contact so
+     * that a defender still reeling from an earlier attack is not credited to
+     * this one.
+     */
+    bool hit = defender.getMoveType() == Mugen::Move::Hit;
+    unsigned int hits = defender.getWasHitCount();
+    if (attacking && ((hit && !defenderHit) || hits != defenderHits)){
+        contact = defender.getHitState().guarded ? Block : Hit;
+        defenderStunned = true;
+        defenderFree = 0;
+    }
+    defenderHit = hit;
+    defenderHits = hits;
+
+    if (defenderStunned && !hit && defender.hasControl()){
+        defenderStunned = false;
+        defenderFree = tick;
+        checkAdvantage();
+    }
+}
+
+FrameDataObserver::FrameDataObserver(){
+}
+
+FrameDataObserver::~FrameDataObserver(){
+}
+
+void FrameDataObserver::beforeLogic(Stage & stage){
+}
+
+void FrameDataObserver::afterLogic(Stage & stage){
+    vector<Character*> players = stage.getPlayers();
+    for (vector<Character*>::iterator it = players.begin(); it != players.end(); it++){
+        Character * player = *it;
+        Character * enemy = stage.getEnemy(player);
+        if (enemy != NULL){
+            data[player].update(*player, *enemy);
+        }
+    }
+}
+
+const FrameData * FrameDataObserver::getFrameData(const Character * who) const {
+    map<const Character*, FrameData>::const_iterator find = data.find(who);
+    if (find != data.end()){
+        return &find->second;
+    }
+    return NULL;
+}
+
+static void drawBoxes(const AreaList & boxes, int x, int y, const Graphics::Bitmap & work, Graphics::Color color){
+    for (AreaList::const_iterator it = boxes.begin(); it != boxes.end(); it++){
+        const Area & area = *it;
+        work.rectangle(x + area.x1, y + area.y1, x + area.x2, y + area.y2, color);
+    }
+}
+
+static void drawAdvantage(FontRender * render, const ::Font & font, int x, int y, Graphics::Color color, const char * name, const FrameData::Advantage & advantage){
+    if (advantage.valid){
+        render->addMessage(font, x, y, color, Graphics::MaskColor(), "%s %+d", name, advantage.frames);
+    } else {
+        render->addMessage(font, x, y, color, Graphics::MaskColor(), "%s -", name);
+    }
+}
+
+void FrameDataObserver::draw(const Stage & stage, const Graphics::Bitmap & work){
+    int cameraX = (int)(stage.getCameraX() - DEFAULT_WIDTH / 2);
+    int cameraY = (int) stage.getCameraY();
+
+    const ::Font & font = ::Font::getDefaultFont(14, 14);
+    FontRender * render = FontRender::getInstance();
+    Graphics::Color white = Graphics::makeColor(255, 255, 255);
+
+    vector<Character*> players = stage.getPlayers();
+    for (vector<Character*>::iterator it = players.begin(); it != players.end(); it++){
+        const Character * player = *it;
+        int x = (int) player->getX() - cameraX;
+        int y = (int) player->getRY() - cameraY;
+        drawBoxes(player->getDefenseBoxes(), x, y, work, Graphics::makeColor(0, 0, 255));
+        drawBoxes(player->getAttackBoxes(), x, y, work, Graphics::makeColor(255, 0, 0));
+
+        const FrameData * frames = getFrameData(player);
+        if (frames == NULL || (frames->getMoves() == 0 && !frames->inMove())){
+            continue;
+        }
+
+        /* The text is rendered on the screen which is twice the size of the
+         * stage, same as the player debug information.
+         */
+        const FrameData::MoveData & move = frames->getMove();
+        int textX = 1;
+        if (player->getAlliance() == Mugen::Stage::Player2Side){
+            textX = 640 - font.textLength("Startup 00 Active 00 Recovery 00") - 1;
+        }
+        int textY = 480 - font.getHeight() * 4 - 2;
+        render->addMessage(font, textX, textY, white, Graphics::MaskColor(), "State %d Total %d", move.state, move.total());
+        textY += font.getHeight();
+        render->addMessage(font, textX, textY, white, Graphics::MaskColor(), "Startup %d Active %d Recovery %d", move.startup, move.active, move.recovery);
+        textY += font.getHeight();
+        drawAdvantage(render, font, textX, textY, white, "On hit", frames->getHitAdvantage());
+        textY += font.getHeight();
+        drawAdvantage(render, font, textX, textY, white, "On block", frames->getBlockAdvantage());
+    }
+}
+
+}
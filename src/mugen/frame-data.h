@@ -0,0 +1,144 @@
+#ifndef _paintown_mugen_frame_data_h
+#define _paintown_mugen_frame_data_h
+
+#include <map>
+#include "stage.h"
+
+namespace Graphics{
+class Bitmap;
+}
+
+namespace Mugen{
+
+class Character;
+
+/* Measures the frame data of the moves a character performs against an
+ * opponent. Everything is computed incrementally from the state the character
+ * is in at the end of each tick so nothing has to be replayed or stored.
+ *
+ *  startup  - ticks before the first tick with an attack box (clsn1)
+ *  active   - ticks from the first attack box to the last attack box
+ *  recovery - ticks after the last attack box until the move is over
+ *
+ * startup + active + recovery is always the total length of the move.
+ * Advantage is the number of ticks the attacker can act before the defender,
+ * so a negative number means the attacker is at a disadvantage.
+ */
+class FrameData{
+public:
+    FrameData();
+
+    struct MoveData{
+        MoveData():
+            state(-1),
+            startup(0),
+            active(0),
+            recovery(0),
+            hasActive(false){
+            }
+
+        int state;
+        int startup;
+        int active;
+        int recovery;
+        /* false if the move never had an attack box */
+        bool hasActive;
+
+        inline int total() const {
+            return startup + active + recovery;
+        }
+    };
+
+    struct Advantage{
+        Advantage():
+            valid(false),
+            frames(0){
+            }
+
+        bool valid;
+        int frames;
+    };
+
+    /* Call once per logic tick after the stage has run */
+    void update(const Character & attacker, const Character & defender);
+
+    /* The move in progress, or the last one that finished */
+    inline const MoveData & getMove() const {
+        return move;
+    }
+
+    inline bool inMove() const {
+        return attacking;
+    }
+
+    /* number of moves that have completed */
+    inline unsigned int getMoves() const {
+        return moves;
+    }
+
+    inline const Advantage & getHitAdvantage() const {
+        return hitAdvantage;
+    }
+
+    inline const Advantage & getBlockAdvantage() const {
+        return blockAdvantage;
+    }
+
+protected:
+    void startMove(const Character & attacker);
+    void finishMove();
+    void checkAdvantage();
+
+    enum Contact{
+        None,
+        Hit,
+        Block
+    };
+
+    /* counts ticks that were not spent in hitpause */
+    unsigned int tick;
+
+    bool attacking;
+    MoveData move;
+    unsigned int moves;
+    /* ticks since the last attack box was seen */
+    int sinceActive;
+
+    /* contact made by the current move */
+    Contact contact;
+    /* tick the attacker could act again, 0 if not yet */
+    unsigned int attackerFree;
+    /* tick the defender could act again, 0 if not yet */
+    unsigned int defenderFree;
+    bool defenderStunned;
+    /* defender state on the previous tick */
+    bool defenderHit;
+    unsigned int defenderHits;
+
+    Advantage hitAdvantage;
+    Advantage blockAdvantage;
+};
+
+/* Training mode overlay. Tracks frame data for every player against their
+ * opponent and draws clsn1/clsn2 boxes along with the numbers. Only does work
+ * while it is attached to a stage so it costs nothing when turned off.
+ */
+class FrameDataObserver: public StageObserver {
+public:
+    FrameDataObserver();
+    virtual ~FrameDataObserver();
+
+    virtual void beforeLogic(Stage & stage);
+    virtual void afterLogic(Stage & stage);
+    virtual void draw(const Stage & stage, const Graphics::Bitmap & work);
+
+    /* Data for a given player, NULL if that player has not been seen yet */
+    const FrameData * getFrameData(const Character * who) const;
+
+protected:
+    std::map<const Character*, FrameData> data;
+};
+
+}
+
+#endif
@@ -2,8 +2,10 @@
 #include "game.h"
 
 #include <stdio.h>
+#include <algorithm>
 #include <ostream>
 #include <sstream>
+#include <map>
 #include "globals.h"
 #include <r-tech1/font.h>
 #include <r-tech1/token.h>
@@ -36,10 +38,15 @@
 #include "network.h"
 #include "parse-cache.h"
 #include "config.h"
+#include "frame-data.h"
+#include "profile.h"
+#include "helper.h"
 
 #include "options.h"
 
 #include "versus.h"
+#include "factory/font_render.h"
+#include "factory/presenter.h"
 
 namespace PaintownUtil = ::Util;
 
@@ -47,17 +54,23 @@ using namespace Mugen;
 using std::vector;
 using std::string;
 using std::ostringstream;
+using std::map;
 
 Game::Game(const PlayerType & playerType, const GameType & gameType, const Filesystem::AbsolutePath & systemFile):
 playerType(playerType),
 gameType(gameType),
 systemFile(systemFile),
-motifDirectory(systemFile.getDirectory()){
+motifDirectory(systemFile.getDirectory()),
+demos(NULL){
 }
 
 Game::~Game(){
 }
 
+void Game::setDemos(DemoQueue & demos){
+    this->demos = &demos;
+}
+
 void Game::run(Searcher & searcher){
     // ParseCache cache;
     /* Make sure searcher is running */
@@ -83,12 +96,11 @@ void Game::run(Searcher & searcher){
                 break;
             }
             case TeamArcade: {
-                //select.run("Team Arcade" , 1, true, &screen);
-                startDemo(searcher);
+                doArcade(searcher);
                 break;
             }
             case TeamVersus: {
-                //gameInfo = select.run("Team Versus" , 2, true, &screen);
+                doVersus(searcher);
                 break;
             }
             case TeamCoop: {
@@ -136,6 +148,7 @@ RunMatchOptions::RunMatchOptions():
     ticker(0),
     endTime(-1),
     demoMode(false),
+    interrupted(false),
     player1Behavior(NULL),
     player2Behavior(NULL){
         fader.setState(Gui::FadeTool::EndFade);
@@ -146,6 +159,7 @@ RunMatchOptions::RunMatchOptions(int endTime):
     ticker(0),
     endTime(endTime),
     demoMode(endTime != -1),
+    interrupted(false),
     player1Behavior(NULL),
     player2Behavior(NULL){
         fader.setFadeInTime(1);
@@ -156,6 +170,7 @@ RunMatchOptions::RunMatchOptions(const RunMatchOptions & copy):
     ticker(copy.ticker),
     endTime(copy.endTime),
     demoMode(copy.demoMode),
+    interrupted(copy.interrupted),
     player1Behavior(copy.player1Behavior),
     player2Behavior(copy.player2Behavior){
         fader.setFadeInTime(1);
@@ -166,6 +181,7 @@ RunMatchOptions::RunMatchOptions(const RunMatchOptions & copy):
         ticker = copy.ticker;
         endTime = copy.endTime;
         demoMode = copy.demoMode;
+        interrupted = copy.interrupted;
         player1Behavior = copy.player1Behavior;
         player2Behavior = copy.player2Behavior;
         fader.setFadeInTime(1);
@@ -177,6 +193,7 @@ RunMatchOptions::RunMatchOptions(const RunMatchOptions & copy):
         if (demoMode){
             if (InputManager::anyInput() && fader.getState() != Gui::FadeTool::FadeOut){
                 ticker = endTime;
+                interrupted = true;
                 fader.setState(Gui::FadeTool::FadeOut);
             }
             if (ticker < endTime){
@@ -187,6 +204,9 @@ RunMatchOptions::RunMatchOptions(const RunMatchOptions & copy):
             }
             fader.act();
             if (fader.getState() == Gui::FadeTool::EndFade){
+                if (interrupted){
+                    throw Exception::Return(__FILE__, __LINE__);
+                }
                 throw QuitGameException();
             }
         }
@@ -322,82 +342,177 @@ static Character * makeCharacter(const std::string & name, bool random, std::vec
 class CharacterTeam{
 public:
     CharacterTeam(const Mugen::ArcadeData::CharacterCollection & collection, const Stage::teams & side):
-    collection(collection),
-    side(side){
-        loaded[0] = loaded[1] = loaded[2] = loaded[3] = false;
-        switch (collection.getType()){
+    type(collection.getType()),
+    turn(0),
+    matchWins(0),
+    behavior(NULL),
+    partnerBehavior(Mugen::Data::getInstance().getDifficulty()){
+        infos.push_back(collection.getFirst());
+        switch (type){
             case Mugen::ArcadeData::CharacterCollection::Turns4:
-                fourth = PaintownUtil::ReferenceCount<Character>(new Character(collection.getFourth().getDef(), side));
             case Mugen::ArcadeData::CharacterCollection::Turns3:
-                third = PaintownUtil::ReferenceCount<Character>(new Character(collection.getThird().getDef(), side));
             case Mugen::ArcadeData::CharacterCollection::Turns2:
             case Mugen::ArcadeData::CharacterCollection::Simultaneous:
-                second = PaintownUtil::ReferenceCount<Character>(new Character(collection.getSecond().getDef(), side));
-            default:
-            case Mugen::ArcadeData::CharacterCollection::Single:
-                first = PaintownUtil::ReferenceCount<Character>(new Character(collection.getFirst().getDef(), side));
+                infos.push_back(collection.getSecond());
                 break;
-        }
-    }
-    
-    void load(){
-        switch (collection.getType()){
-            case Mugen::ArcadeData::CharacterCollection::Turns4:
-                if (!loaded[3]){
-                    fourth->load(collection.getFourth().getAct());
-                    loaded[3] = true;
-                }
-            case Mugen::ArcadeData::CharacterCollection::Turns3:
-                if (!loaded[2]){
-                    third->load(collection.getThird().getAct());
-                    loaded[2] = true;
-                }
-            case Mugen::ArcadeData::CharacterCollection::Turns2:
-            case Mugen::ArcadeData::CharacterCollection::Simultaneous:
-                if (!loaded[1]){
-                    second->load(collection.getSecond().getAct());
-                    loaded[1] = true;
-                }
             default:
-            case Mugen::ArcadeData::CharacterCollection::Single:
-                if (!loaded[0]){
-                    first->load(collection.getFirst().getAct());
-                    loaded[0] = true;
-                }
                 break;
         }
+        if (type == Mugen::ArcadeData::CharacterCollection::Turns3 ||
+            type == Mugen::ArcadeData::CharacterCollection::Turns4){
+            infos.push_back(collection.getThird());
+        }
+        if (type == Mugen::ArcadeData::CharacterCollection::Turns4){
+            infos.push_back(collection.getFourth());
+        }
+
+        for (vector<Mugen::ArcadeData::CharacterInfo>::iterator it = infos.begin(); it != infos.end(); it++){
+            members.push_back(PaintownUtil::ReferenceCount<Character>(new Character(it->getDef(), side)));
+        }
+    }
+
+    /* Only ever called once per member, possibly from different threads for
+     * different members.
+     */
+    void loadMember(unsigned int index){
+        members[index]->load(infos[index].getAct());
+    }
+
+    unsigned int size() const {
+        return members.size();
+    }
+
+    Character & getMember(unsigned int index){
+        return *members[index];
     }
     
     Character & getFirst(){
-        return *first;
+        return *members[0];
     }
-    
-    Character & getSecond(){
-        return *second;
+
+    bool isTurns() const {
+        return type == Mugen::ArcadeData::CharacterCollection::Turns2 ||
+               type == Mugen::ArcadeData::CharacterCollection::Turns3 ||
+               type == Mugen::ArcadeData::CharacterCollection::Turns4;
     }
-    
-    Character & getThird(){
-        return *third;
+
+    /* The members on the stage right now start at getTurn(). A simul team
+     * fights all at once so it only has one turn.
+     */
+    unsigned int getTurn() const {
+        return turn;
     }
-    
-    Character & getFourth(){
-        return *fourth;
+
+    unsigned int getFighterCount() const {
+        if (isTurns()){
+            return 1;
+        }
+        return size();
+    }
+
+    Character & getFighter(unsigned int index){
+        return getMember(turn + index);
+    }
+
+    /* The fighters lost, move on to the next member */
+    void nextTurn(){
+        turn += getFighterCount();
+    }
+
+    bool hasFighters() const {
+        return turn < size();
+    }
+
+    /* Partners of a simul team are controlled by the computer */
+    void setBehavior(Behavior * behavior){
+        this->behavior = behavior;
+        resetBehavior();
+    }
+
+    /* A finished match leaves the characters with the behavior of its
+     * round so this has to be done before each match.
+     */
+    void resetBehavior(){
+        for (unsigned int index = 0; index < size(); index++){
+            if (index > 0 && type == Mugen::ArcadeData::CharacterCollection::Simultaneous){
+                members[index]->setBehavior(&partnerBehavior);
+            } else {
+                members[index]->setBehavior(behavior);
+            }
+        }
+    }
+
+    int getMatchWins() const {
+        return matchWins;
+    }
+
+    void addMatchWin(){
+        matchWins += 1;
+    }
+
+    /* Sum of the matches won by each member */
+    int getMemberMatchWins() const {
+        int total = 0;
+        for (vector<PaintownUtil::ReferenceCount<Character> >::const_iterator it = members.begin(); it != members.end(); it++){
+            total += (*it)->getMatchWins();
+        }
+        return total;
     }
     
 protected:
-    const Mugen::ArcadeData::CharacterCollection & collection;
-    const Stage::teams & side;
-    bool loaded[4];
-    PaintownUtil::ReferenceCount<Character> first;
-    PaintownUtil::ReferenceCount<Character> second;
-    PaintownUtil::ReferenceCount<Character> third;
-    PaintownUtil::ReferenceCount<Character> fourth;
+    const Mugen::ArcadeData::CharacterCollection::Type type;
+    unsigned int turn;
+    int matchWins;
+    vector<Mugen::ArcadeData::CharacterInfo> infos;
+    vector<PaintownUtil::ReferenceCount<Character> > members;
+    Behavior * behavior;
+    LearningAIBehavior partnerBehavior;
 };
 
+/* Loads a single member of a team */
+class MemberLoader: public PaintownUtil::Future<int> {
+public:
+    MemberLoader(CharacterTeam & team, unsigned int index):
+        team(team),
+        index(index),
+        finished(false){
+    }
+
+    CharacterTeam & team;
+    const unsigned int index;
+    /* Set once compute is over, whether the member loaded or not */
+    PaintownUtil::Thread::LockObject finishedLock;
+    volatile bool finished;
+
+    virtual void compute(){
+        try{
+            team.loadMember(index);
+        } catch (...){
+            finishedLock.lockAndSignal(finished, true);
+            throw;
+        }
+        finishedLock.lockAndSignal(finished, true);
+    }
+
+    /* Blocks until the member is loaded or failed to load */
+    void waitFinished(){
+        finishedLock.wait(finished);
+    }
+
+    virtual ~MemberLoader(){
+        waitFinished();
+    }
+};
+
+/* Loads every member of both teams at the same time. The future finishes when
+ * all of them are loaded but the match only has to wait for the members that
+ * fight first, the others keep loading while the match is going on.
+ */
 class PlayerLoader: public PaintownUtil::Future<int> {
 public:
     PlayerLoader(CharacterTeam & player1, CharacterTeam & player2):
         alive(true),
+        started(false),
         player1(player1),
         player2(player2){
             /* compute is a virtual function, is the virtual table set up
@@ -406,33 +521,60 @@ public:
             // start();
     }
 
+    /* Shared by all the member loaders so common files like common1.cns are
+     * only parsed once. It is created and destroyed on the thread that owns
+     * the loader so it stays valid for anything loading while members are
+     * still being loaded in the background, like the stage.
+     */
+    ParseCache cache;
     /* Communicate that the thread is dead */
     PaintownUtil::Thread::LockObject lock;
     volatile bool alive;
+    volatile bool started;
     CharacterTeam & player1;
     CharacterTeam & player2;
+    vector<PaintownUtil::ReferenceCount<MemberLoader> > loaders1;
+    vector<PaintownUtil::ReferenceCount<MemberLoader> > loaders2;
 
     virtual bool checkDead(){
         PaintownUtil::Thread::ScopedLock scoped(lock);
         return !alive;
     }
 
-    virtual void compute(){
-        ParseCache cache;
+    static void startMembers(CharacterTeam & team, vector<PaintownUtil::ReferenceCount<MemberLoader> > & loaders){
+        for (unsigned int index = 0; index < team.size(); index++){
+            PaintownUtil::ReferenceCount<MemberLoader> loader(new MemberLoader(team, index));
+            loader->start();
+            loaders.push_back(loader);
+        }
+    }
 
-        if (checkDead()){
-            return;
+    static void waitMembers(const vector<PaintownUtil::ReferenceCount<MemberLoader> > & loaders){
+        for (vector<PaintownUtil::ReferenceCount<MemberLoader> >::const_iterator it = loaders.begin(); it != loaders.end(); it++){
+            (*it)->waitFinished();
         }
-        
-        // Load player 1
-        player1.load();
+    }
 
-        if (checkDead()){
-            return;
+    virtual void compute(){
+        if (!checkDead()){
+            PaintownUtil::Thread::ScopedLock scoped(lock);
+            startMembers(player1, loaders1);
+            startMembers(player2, loaders2);
         }
 
-        // Load player 2
-        player2.load();
+        /* wakes up waitFor, even if nothing was started */
+        lock.lockAndSignal(started, true);
+
+        waitMembers(loaders1);
+        waitMembers(loaders2);
+
+        /* Everything is done so this just rethrows the first load error */
+        for (vector<PaintownUtil::ReferenceCount<MemberLoader> >::iterator it = loaders1.begin(); it != loaders1.end(); it++){
+            (*it)->get();
+        }
+        for (vector<PaintownUtil::ReferenceCount<MemberLoader> >::iterator it = loaders2.begin(); it != loaders2.end(); it++){
+            (*it)->get();
+        }
         // NOTE is this needed anymore?
 #ifdef WII
         /* FIXME: this is a hack, im not sure why its even required but fopen() will hang on sfp_lock_acquire
@@ -448,6 +590,34 @@ public:
 #endif
     }
 
+    /* Blocks until one member of a team is loaded, throws if it failed */
+    void waitFor(const CharacterTeam & team, unsigned int index){
+        lock.wait(started);
+
+        PaintownUtil::ReferenceCount<MemberLoader> member;
+        {
+            PaintownUtil::Thread::ScopedLock scoped(lock);
+            const vector<PaintownUtil::ReferenceCount<MemberLoader> > & loaders = &team == &player1 ? loaders1 : loaders2;
+            if (index >= loaders.size()){
+                throw MugenException("No such team member", __FILE__, __LINE__);
+            }
+            member = loaders[index];
+        }
+
+        /* get blocks until the member is done */
+        member->get();
+    }
+
+    /* Waits for the members that are about to fight */
+    void waitForFighters(){
+        for (unsigned int index = 0; index < player1.getFighterCount(); index++){
+            waitFor(player1, player1.getTurn() + index);
+        }
+        for (unsigned int index = 0; index < player2.getFighterCount(); index++){
+            waitFor(player2, player2.getTurn() + index);
+        }
+    }
+
     virtual ~PlayerLoader(){
         lock.acquire();
         alive = false;
@@ -496,16 +666,20 @@ void prepareStage(PaintownUtil::ReferenceCount<PlayerLoader> playerLoader, Mugen
 
             virtual void load(){
                 try{
-                    /* future */
-                    int ok = playerLoader->get();
-
-                    
-                    /*! FIXME 
-                    * this is only handling one on one matches, it will need to accomodate teams at a later point 
-                    */
+                    /* Only the fighters have to be ready, members that
+                     * fight later on keep loading in the background.
+                     */
+                    playerLoader->waitForFighters();
+
+                    CharacterTeam & player1 = playerLoader->player1;
+                    CharacterTeam & player2 = playerLoader->player2;
+                    for (unsigned int index = 0; index < player1.getFighterCount(); index++){
+                        stage.addPlayer1(&player1.getFighter(index));
+                    }
+                    for (unsigned int index = 0; index < player2.getFighterCount(); index++){
+                        stage.addPlayer2(&player2.getFighter(index));
+                    }
                     // Load stage
-                    stage.addPlayer1(&playerLoader->player1.getFirst());
-                    stage.addPlayer2(&playerLoader->player2.getFirst());
                     stage.load();
                 } catch (const MugenException & fail){
                     this->fail = new MugenException(fail);
@@ -536,6 +710,117 @@ void prepareStage(PaintownUtil::ReferenceCount<PlayerLoader> playerLoader, Mugen
     }
 }
 
+/* Turns: the winner of a bout goes into the next one with the life it had
+ * left plus the recovery from mugen.cfg, a part of its maximum life that grows
+ * with the time that was left on the clock.
+ */
+static double turnsLife(const Character & winner, const WinGame & win){
+    Mugen::Data & data = Mugen::Data::getInstance();
+    double percent = data.getTurnsRecoveryBase();
+    if (win.timeLeft > 0 && data.getTime() > 0){
+        percent += data.getTurnsRecoveryBonus() * (double) win.timeLeft / data.getTime();
+    }
+
+    double life = win.life + winner.getMaxHealth() * percent / 100;
+    if (life > winner.getMaxHealth()){
+        return winner.getMaxHealth();
+    }
+    return life;
+}
+
+/* The fighters of a team that won the bout that just ended */
+static void keepWinners(CharacterTeam & team, map<Character*, double> & life){
+    for (unsigned int index = 0; index < team.getFighterCount(); index++){
+        Character & fighter = team.getFighter(index);
+        if (fighter.getWins().size() > 0){
+            life[&fighter] = turnsLife(fighter, fighter.getWins().back());
+        }
+    }
+}
+
+/* Plays a match between the two teams of a loader. Single and simul teams fight
+ * one match on one stage. If either team fights in turns the match is a series
+ * of one round bouts and the team that loses a bout sends in its next member,
+ * which has been loading in the background since the match started. The
+ * winner of a bout stays in with the life it has left. The team that is left
+ * standing gets the match win.
+ */
+static PaintownUtil::ReferenceCount<Mugen::Stage> runTeamMatch(PaintownUtil::ReferenceCount<PlayerLoader> loader, const Filesystem::AbsolutePath & stagePath, const RunMatchOptions & options, PaintownUtil::ReferenceCount<StageObserver> observer = PaintownUtil::ReferenceCount<StageObserver>(NULL)){
+    CharacterTeam & player1 = loader->player1;
+    CharacterTeam & player2 = loader->player2;
+    bool turns = player1.isTurns() || player2.isTurns();
+
+    /* The stage of the last bout, used for the continue screen */
+    PaintownUtil::ReferenceCount<Mugen::Stage> stage;
+    /* life the winners of the last bout start the next one with */
+    map<Character*, double> winnerLife;
+    while (player1.hasFighters() && player2.hasFighters()){
+        int wins1 = player1.getMemberMatchWins();
+        int wins2 = player2.getMemberMatchWins();
+
+        for (unsigned int index = 0; index < player1.getFighterCount(); index++){
+            player1.getFighter(index).clearWins();
+        }
+        for (unsigned int index = 0; index < player2.getFighterCount(); index++){
+            player2.getFighter(index).clearWins();
+        }
+        player1.resetBehavior();
+        player2.resetBehavior();
+
+        stage = PaintownUtil::ReferenceCount<Mugen::Stage>(new Mugen::Stage(stagePath));
+        prepareStage(loader, *stage);
+        if (turns){
+            stage->getGameInfo()->setWins(1, 0);
+            if (player1.isTurns()){
+                stage->getGameInfo()->setTurns(1, player1.size() - player1.getTurn() - 1);
+            }
+            if (player2.isTurns()){
+                stage->getGameInfo()->setTurns(2, player2.size() - player2.getTurn() - 1);
+            }
+        }
+        if (observer != NULL){
+            stage->setObserver(observer);
+        }
+        stage->reset();
+        for (map<Character*, double>::iterator it = winnerLife.begin(); it != winnerLife.end(); it++){
+            it->first->setHealth(it->second);
+        }
+        Game::runMatch(stage.raw(), "", options);
+
+        bool won1 = player1.getMemberMatchWins() > wins1;
+        bool won2 = player2.getMemberMatchWins() > wins2;
+
+        if (!turns){
+            if (won1){
+                player1.addMatchWin();
+            } else if (won2){
+                player2.addMatchWin();
+            }
+            return stage;
+        }
+
+        winnerLife.clear();
+        keepWinners(player1, winnerLife);
+        keepWinners(player2, winnerLife);
+
+        /* a draw costs both sides their fighter */
+        if (!won1){
+            player1.nextTurn();
+        }
+        if (!won2){
+            player2.nextTurn();
+        }
+    }
+
+    if (player1.hasFighters()){
+        player1.addMatchWin();
+    } else if (player2.hasFighters()){
+        player2.addMatchWin();
+    }
+
+    return stage;
+}
+
 /* Does the setup work to start a game (arcade, watch, training, etc)
  */
 class StartGameMode{
@@ -606,7 +891,14 @@ public:
             stage->addPlayer2(players[1].raw());
         }
 
-        /* TODO: handle players 3 and 4 */
+        /* players 3 and 4 are the simul partners of players 1 and 2 */
+        if (players.size() > 2){
+            stage->addPlayer1(players[2].raw());
+        }
+
+        if (players.size() > 3){
+            stage->addPlayer2(players[3].raw());
+        }
     }
 
     virtual void run() = 0;
@@ -675,6 +967,10 @@ void Game::startNetworkVersus(const string & player1Name, const string & player2
         timer.endTime();
         out << timer.printTime(" took") << std::endl;
     }
+    /* only keeps rounding differences between the two ends small, the world
+     * snapshots the server sends are what keep them in step
+     */
+    stage.setFixedPhysics(true);
 
     startNetworkVersus1(player1, player2, stage, server, host, port);
 
@@ -704,6 +1000,7 @@ public:
 
         options.setBehavior(&player1Behavior, NULL);
 
+        stage->setObserver(PaintownUtil::ReferenceCount<StageObserver>(new FrameDataObserver()));
         stage->reset();
         int time = Mugen::Data::getInstance().getTime();
         Mugen::Data::getInstance().setTime(-1);
@@ -749,6 +1046,133 @@ void Game::startWatch(const std::string & player1Name, const std::string & playe
     watch.run();
 }
 
+/* Runs a match without waiting for the game clock. The ticks run back to
+ * back and the stage is drawn once every renderEvery ticks so the match can
+ * still be watched and quit with ESC. With renderEvery 0 nothing is drawn at
+ * all. Stops when the match is over or the deadline passes.
+ * Returns false if the match was quit early.
+ */
+static bool runUncapped(Mugen::Stage & stage, int renderEvery, uint64_t deadline, unsigned int & ticks, uint64_t & logicTime){
+    InputMap<Mugen::Keys> input = Mugen::getPlayer1Keys();
+    PaintownUtil::ReferenceCount<Presenter> presenter;
+    if (renderEvery > 0){
+        presenter = PaintownUtil::ReferenceCount<Presenter>(new Presenter(320, 240));
+    }
+
+    while (!stage.isMatchOver()){
+        uint64_t start = Profile::currentMicroseconds();
+        stage.logic();
+        logicTime += Profile::currentMicroseconds() - start;
+        ticks += 1;
+
+        if (renderEvery > 0 && ticks % renderEvery == 0){
+            InputManager::poll();
+            vector<InputMap<Mugen::Keys>::InputEvent> events = InputManager::getEvents(input, InputSource(true));
+            for (vector<InputMap<Mugen::Keys>::InputEvent>::iterator it = events.begin(); it != events.end(); it++){
+                if (it->enabled && it->out == Mugen::Esc){
+                    return false;
+                }
+            }
+
+            const Graphics::Bitmap & screen = *Graphics::getScreenBuffer();
+            Graphics::Bitmap & work = presenter->start(screen);
+            stage.render(&work);
+            presenter->finish(screen);
+            FontRender::getInstance()->render(&screen);
+            screen.BlitToScreen();
+        }
+
+        /* reading the clock is cheap compared to a tick but not free */
+        if (deadline != 0 && ticks % 1000 == 0 && System::currentSeconds() >= deadline){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* AI against AI over and over with the same characters for finding leaks.
+ * Every match gets a fresh copy of the stage, and after it is gone the memory
+ * usage, helpers that were never deleted and the average time per tick are
+ * logged and compared to the first match.
+ */
+class StartSoak: public StartGameMode {
+public:
+    StartSoak(const std::string & player1Name,
+              const std::string & player2Name,
+              const std::string & stageName,
+              int renderEvery,
+              int minutes):
+    StartGameMode(player1Name, player2Name, stageName),
+    stageName(stageName),
+    renderEvery(renderEvery),
+    minutes(minutes){
+    }
+
+    const std::string stageName;
+    const int renderEvery;
+    const int minutes;
+
+    virtual void run(){
+        LearningAIBehavior player1Behavior(30);
+        LearningAIBehavior player2Behavior(30);
+
+        /* Sounds would be played many times faster than normal */
+        Sound::disableSounds();
+
+        uint64_t deadline = minutes > 0 ? System::currentSeconds() + minutes * 60 : 0;
+        unsigned long firstMemory = System::memoryUsage();
+        unsigned long lastMemory = firstMemory;
+        double firstTickTime = 0;
+
+        for (int match = 1; true; match++){
+            if (stage == NULL){
+                stage = new Stage(Storage::instance().find(Filesystem::RelativePath("mugen/stages/" + stageName + ".def")));
+                stage->addPlayer1(getPlayer1().raw());
+                stage->addPlayer2(getPlayer2().raw());
+                stage->load();
+            }
+
+            /* The last round left the characters with its dummy behavior */
+            getPlayer1()->clearWins();
+            getPlayer2()->clearWins();
+            getPlayer1()->setBehavior(&player1Behavior);
+            getPlayer2()->setBehavior(&player2Behavior);
+            stage->reset();
+
+            unsigned int ticks = 0;
+            uint64_t logicTime = 0;
+            bool finished = runUncapped(*stage, renderEvery, deadline, ticks, logicTime);
+            int helpersLeft = stage->countHelpers();
+
+            /* Anything the match allocated should go away with the stage */
+            stage = NULL;
+
+            double tickTime = ticks > 0 ? logicTime / 1000.0 / ticks : 0;
+            if (match == 1){
+                firstTickTime = tickTime;
+            }
+            double drift = firstTickTime > 0 ? (tickTime - firstTickTime) * 100 / firstTickTime : 0;
+            unsigned long memory = System::memoryUsage();
+
+            Global::stream_type & out = Global::debug(0);
+            out << "Soak match " << match << ": " << ticks << " ticks, " << tickTime << "ms per tick (" << (drift >= 0 ? "+" : "") << drift << "% since the first match)";
+            out << ", memory " << PaintownUtil::niceSize(memory) << " (" << ((long) memory - (long) firstMemory) / 1024 << "k since the first match, " << ((long) memory - (long) lastMemory) / 1024 << "k since the last)";
+            out << ", helpers at the end " << helpersLeft << ", leaked helpers " << Helper::getLiveCount() << std::endl;
+            lastMemory = memory;
+
+            if (!finished){
+                return;
+            }
+        }
+    }
+};
+
+void Game::startSoak(const std::string & player1Name, const std::string & player2Name, const std::string & stageName, int renderEvery, int minutes){
+    StartSoak soak(player1Name, player2Name, stageName, renderEvery, minutes);
+    soak.run();
+}
+
 class StartTeam: public StartGameMode {
 public:
     StartTeam(const std::string & player1Name,
@@ -760,13 +1184,16 @@ public:
     }
 
     virtual void run(){
-        /* FIXME: implement team stuff. Set up stage to be in team mode */
+        /* Player 1 and 3 against player 2 and 4 in simul mode */
         LearningAIBehavior player1Behavior(30);
         LearningAIBehavior player2Behavior(30);
+        LearningAIBehavior player3Behavior(30);
+        LearningAIBehavior player4Behavior(30);
 
-        // Set regenerative health
         getPlayer1()->setBehavior(&player1Behavior);
         getPlayer2()->setBehavior(&player2Behavior);
+        players[2]->setBehavior(&player3Behavior);
+        players[3]->setBehavior(&player4Behavior);
 
         stage->reset();
         Game::runMatch(stage.raw());
@@ -813,6 +1240,205 @@ void Game::startScript(const std::string & player1Name, const string & player1Sc
     script.run();
 }
 
+/* A random demo match for attract mode. The characters, the stage and its
+ * sounds are loaded by a single background thread so that the match that is
+ * already playing keeps most of the cpu. Nothing is put in a parse cache so
+ * the only memory a match holds on to is its own.
+ */
+class Mugen::AttractMatch: public PaintownUtil::Future<int> {
+public:
+    AttractMatch(const vector<Filesystem::AbsolutePath> & characters, const vector<Filesystem::AbsolutePath> & stages):
+        alive(true),
+        finished(false),
+        characters(characters),
+        stages(stages),
+        behavior1(Data::getInstance().getDifficulty()),
+        behavior2(Data::getInstance().getDifficulty()){
+    }
+
+    PaintownUtil::Thread::LockObject lock;
+    volatile bool alive;
+    /* Set once compute is over, whether the match loaded or not */
+    PaintownUtil::Thread::LockObject finishedLock;
+    volatile bool finished;
+    /* copies because makeCharacter removes the paths that fail to load */
+    vector<Filesystem::AbsolutePath> characters;
+    vector<Filesystem::AbsolutePath> stages;
+    LearningAIBehavior behavior1;
+    LearningAIBehavior behavior2;
+    PaintownUtil::ReferenceCount<Character> player1;
+    PaintownUtil::ReferenceCount<Character> player2;
+    /* declared after the players so it goes away before they do */
+    PaintownUtil::ReferenceCount<Stage> stage;
+
+    /* Stop loading as soon as possible once the owner is gone */
+    void checkAlive(){
+        PaintownUtil::Thread::ScopedLock scoped(lock);
+        if (!alive){
+            throw MugenException("Attract match was canceled", __FILE__, __LINE__);
+        }
+    }
+
+    /* Makes the loading thread give up at the next check, doesn't wait */
+    void cancel(){
+        PaintownUtil::Thread::ScopedLock scoped(lock);
+        alive = false;
+    }
+
+    virtual void compute(){
+        try{
+            load();
+        } catch (...){
+            finishedLock.lockAndSignal(finished, true);
+            throw;
+        }
+        finishedLock.lockAndSignal(finished, true);
+    }
+
+    void load(){
+        player1 = PaintownUtil::ReferenceCount<Character>(makeCharacter("_", true, characters));
+        checkAlive();
+        player2 = PaintownUtil::ReferenceCount<Character>(makeCharacter("_", true, characters));
+        checkAlive();
+
+        player1->setBehavior(&behavior1);
+        player2->setBehavior(&behavior2);
+
+        stage = new Stage(stages[PaintownUtil::rnd(stages.size())]);
+        stage->addPlayer1(player1.raw());
+        stage->addPlayer2(player2.raw());
+        checkAlive();
+        stage->load();
+    }
+
+    /* The thread uses the players and the stage until compute returns, so
+     * wait for that before they go away.
+     */
+    virtual ~AttractMatch(){
+        cancel();
+        finishedLock.wait(finished);
+    }
+};
+
+static PaintownUtil::ReferenceCount<AttractMatch> startAttractMatch(const vector<Filesystem::AbsolutePath> & characters, const vector<Filesystem::AbsolutePath> & stages){
+    PaintownUtil::ReferenceCount<AttractMatch> match(new AttractMatch(characters, stages));
+    match->start();
+    return match;
+}
+
+/* Waits for the match to finish loading, false if it couldn't be loaded */
+static bool waitForAttractMatch(const PaintownUtil::ReferenceCount<AttractMatch> & match){
+    try{
+        match->get();
+        return true;
+    } catch (const MugenException & fail){
+        Global::debug(0) << "Could not load attract match: " << fail.getReason() << std::endl;
+    } catch (const LoadException & fail){
+        Global::debug(0) << "Could not load attract match: " << fail.getTrace() << std::endl;
+    } catch (const Filesystem::NotFound & fail){
+        Global::debug(0) << "Could not load attract match: " << fail.getTrace() << std::endl;
+    }
+    return false;
+}
+
+DemoQueue::DemoQueue(){
+}
+
+DemoQueue::~DemoQueue(){
+    /* cancel everything first so they all wind down at the same time */
+    drop();
+    for (vector<PaintownUtil::ReferenceCount<AttractMatch> >::iterator it = dropped.begin(); it != dropped.end(); it++){
+        (*it)->cancel();
+    }
+    dropped.clear();
+}
+
+PaintownUtil::ReferenceCount<AttractMatch> DemoQueue::next(const vector<Filesystem::AbsolutePath> & characters, const vector<Filesystem::AbsolutePath> & stages){
+    reap();
+    PaintownUtil::ReferenceCount<AttractMatch> current = queued;
+    if (current == NULL){
+        current = startAttractMatch(characters, stages);
+    }
+    queued = startAttractMatch(characters, stages);
+    return current;
+}
+
+void DemoQueue::drop(){
+    reap();
+    if (queued != NULL){
+        queued->cancel();
+        dropped.push_back(queued);
+        queued = PaintownUtil::ReferenceCount<AttractMatch>(NULL);
+    }
+}
+
+void DemoQueue::reap(){
+    for (vector<PaintownUtil::ReferenceCount<AttractMatch> >::iterator it = dropped.begin(); it != dropped.end(); ){
+        if ((*it)->isDone()){
+            it = dropped.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
+
+void Game::startAttract(){
+    int endTime = 1500;
+    try{
+        AstRef parsed(Mugen::Util::parseDef(Data::getInstance().getMotif()));
+        std::string temp = Util::probeDef(parsed, "demo mode", "fight.endtime");
+        if (!temp.empty()){
+            endTime = atoi(temp.c_str());
+        }
+    } catch (const MugenException & fail){
+        Global::debug(0) << "Could not read the demo mode settings: " << fail.getReason() << std::endl;
+    }
+
+    std::vector<Filesystem::AbsolutePath> characters = Storage::instance().getFilesRecursive(Storage::instance().find(Filesystem::RelativePath("mugen/chars/")), "*.def");
+    std::vector<Filesystem::AbsolutePath> zipCharacters = Storage::instance().getContainerFilesRecursive(Storage::instance().find(Filesystem::RelativePath("mugen/chars/")));
+    characters.insert(characters.end(), zipCharacters.begin(), zipCharacters.end());
+    std::vector<Filesystem::AbsolutePath> stages = Storage::instance().getFilesRecursive(Storage::instance().find(Filesystem::RelativePath("mugen/stages/")), "*.def");
+    if (characters.empty() || stages.empty()){
+        throw MugenException("No characters or stages for attract mode", __FILE__, __LINE__);
+    }
+
+    /* Give up if nothing can be loaded instead of spinning forever */
+    const int maxFailures = 5;
+    int failures = 0;
+
+    PaintownUtil::ReferenceCount<AttractMatch> next = startAttractMatch(characters, stages);
+    while (true){
+        /* At most two matches are held at a time, the one that is playing and
+         * the one that is loading. The previous match was released when the
+         * last iteration ended.
+         */
+        PaintownUtil::ReferenceCount<AttractMatch> current = next;
+        bool loaded = waitForAttractMatch(current);
+
+        next = startAttractMatch(characters, stages);
+
+        if (!loaded){
+            failures += 1;
+            if (failures >= maxFailures){
+                throw MugenException("Could not load any attract matches", __FILE__, __LINE__);
+            }
+            continue;
+        }
+        failures = 0;
+
+        current->stage->reset();
+        try{
+            InputManager::waitForClear();
+            runMatch(current->stage.raw(), "", RunMatchOptions(endTime));
+        } catch (const QuitGameException & ex){
+            /* The demo ran out of time, go on to the next one */
+        } catch (const Exception::Return & ex){
+            /* Someone pressed a button */
+            return;
+        }
+    }
+}
+
 void Game::doTraining(Searcher & searcher){
     int time = Mugen::Data::getInstance().getTime();
     Mugen::Data::getInstance().setTime(-1);
@@ -871,12 +1497,12 @@ void Game::doTraining(Searcher & searcher){
         RunMatchOptions options;
         
         if (playerType == Player1){
-            player1.getFirst().setBehavior(&behavior);
-            player2.getFirst().setBehavior(&dummyBehavior);
+            player1.setBehavior(&behavior);
+            player2.setBehavior(&dummyBehavior);
             options.setBehavior(&behavior, NULL);
         } else {
-            player1.getFirst().setBehavior(&dummyBehavior);
-            player2.getFirst().setBehavior(&behavior);
+            player1.setBehavior(&dummyBehavior);
+            player2.setBehavior(&behavior);
             options.setBehavior(NULL, &behavior);
         }
         player1.getFirst().setRegeneration(true);
@@ -884,6 +1510,8 @@ void Game::doTraining(Searcher & searcher){
         Mugen::Stage stage(select.getStage());
         // Prepares stage
         prepareStage(loader, stage);
+        /* show hitboxes and frame data, can be turned off in the console */
+        stage.setObserver(PaintownUtil::ReferenceCount<StageObserver>(new FrameDataObserver()));
         stage.reset();
         searcher.pause();
         try {
@@ -915,7 +1543,6 @@ void Game::doWatch(Searcher & searcher){
         if (select.wasCanceled()){
             return;
         }
-        //! FIXME Get first for now, later support team/turns
         Mugen::ArcadeData::CharacterCollection player1Collection(Mugen::ArcadeData::CharacterCollection::Single);
         Mugen::ArcadeData::CharacterCollection player2Collection(Mugen::ArcadeData::CharacterCollection::Single);
         if (playerType == Mugen::Player1){
@@ -942,15 +1569,11 @@ void Game::doWatch(Searcher & searcher){
             }
         }
         
-        player1.getFirst().setBehavior(&player1AIBehavior);
-        player2.getFirst().setBehavior(&player2AIBehavior);
-        Mugen::Stage stage(select.getStage());
-        // Prepare stage
-        prepareStage(loader, stage);
-        stage.reset();
+        player1.setBehavior(&player1AIBehavior);
+        player2.setBehavior(&player2AIBehavior);
         searcher.pause();
         try {
-            runMatch(&stage);
+            runTeamMatch(loader, select.getStage(), RunMatchOptions());
         } catch (const Exception::Return & ex){
         } catch (const QuitGameException & ex){
         }
@@ -1122,6 +1745,9 @@ static PaintownUtil::ReferenceCount<Mugen::CharacterSelect> doSelectScreen(const
         PaintownUtil::rest(1);
     }
 
+    /* puts what was found since the last frame in the stage menu */
+    select->act();
+
     return select;
     
 }
@@ -1184,7 +1810,7 @@ Mugen::ArcadeData::CharacterCollection & chooseEnemyCollection(PlayerType type,
 }
 
 /* Returns true if the player wins the match */
-bool runArcade(const Filesystem::AbsolutePath & systemFile, ArcadeData::CharacterCollection & playerCollection, ArcadeData::CharacterCollection & enemyCollection, HumanBehavior & behavior, InputMap<Keys> & keys1, InputMap<Keys> & keys2, RunMatchOptions & options, Searcher & searcher, PlayerType playerType, InputMap<Keys> & playerKeys){
+bool runArcade(const Filesystem::AbsolutePath & systemFile, const GameType & gameType, ArcadeData::CharacterCollection & playerCollection, ArcadeData::CharacterCollection & enemyCollection, HumanBehavior & behavior, InputMap<Keys> & keys1, InputMap<Keys> & keys2, RunMatchOptions & options, Searcher & searcher, PlayerType playerType, InputMap<Keys> & playerKeys){
     Filesystem::AbsolutePath musicOverride;
     LearningAIBehavior AIBehavior(Mugen::Data::getInstance().getDifficulty());
 
@@ -1199,32 +1825,28 @@ bool runArcade(const Filesystem::AbsolutePath & systemFile, ArcadeData::Characte
         PaintownUtil::ReferenceCount<CharacterTeam> player(new CharacterTeam(playerCollection, Stage::Player1Side));
         PaintownUtil::ReferenceCount<CharacterTeam> enemy(PaintownUtil::ReferenceCount<CharacterTeam>(new CharacterTeam(enemyCollection, Stage::Player2Side)));
 
-        player->getFirst().setBehavior(&behavior);
-        enemy->getFirst().setBehavior(&AIBehavior);
+        player->setBehavior(&behavior);
+        enemy->setBehavior(&AIBehavior);
 
         PaintownUtil::ReferenceCount<PlayerLoader> loader = preLoadCharacters(*player, *enemy);
         showLoadPlayers(systemFile, playerCollection, enemyCollection, keys1, keys2);
 
         Global::debug(0) << "Load stage " << stagePath.path() << std::endl;
         // FIXME use override music later
-        Mugen::Stage stage(stagePath);
-        prepareStage(loader, stage);
-        stage.reset();
-
-        int wins = player->getFirst().getMatchWins();
+        PaintownUtil::ReferenceCount<Mugen::Stage> stage;
         searcher.pause();
         try{
-            Game::runMatch(&stage, "", options);
+            stage = runTeamMatch(loader, stagePath, options);
         } catch (...){
             searcher.start();
             throw;
         }
 
-        if (player->getFirst().getMatchWins() > wins){
+        if (player->getMatchWins() > 0){
             return true;
         } else {
-            if (stage.doContinue(playerType, playerKeys)){
-                PaintownUtil::ReferenceCount<Mugen::CharacterSelect> select = doSelectScreen(systemFile, Arcade, characterSelectType(playerType), searcher, keys1, keys2);
+            if (stage->doContinue(playerType, playerKeys)){
+                PaintownUtil::ReferenceCount<Mugen::CharacterSelect> select = doSelectScreen(systemFile, gameType, characterSelectType(playerType), searcher, keys1, keys2);
 
                 if (playerType == Mugen::Player1){
                     playerCollection = select->getPlayer1().getCollection();
@@ -1256,9 +1878,13 @@ void Game::doArcade(Searcher & searcher){
     RunMatchOptions options;
 
     {
-        PaintownUtil::ReferenceCount<Mugen::CharacterSelect> select = doSelectScreen(systemFile, Arcade, characterSelectType(playerType), searcher, keys1, keys2);
+        PaintownUtil::ReferenceCount<Mugen::CharacterSelect> select = doSelectScreen(systemFile, gameType == TeamArcade ? TeamArcade : Arcade, characterSelectType(playerType), searcher, keys1, keys2);
 
-        match = select->getArcadePath();
+        if (gameType == TeamArcade){
+            match = select->getTeamArcadePath();
+        } else {
+            match = select->getArcadePath();
+        }
 
         switch (playerType){
             case Mugen::Player1: {
@@ -1294,7 +1920,7 @@ void Game::doArcade(Searcher & searcher){
         while (!quit){
             enemyCollection = match.next();
             
-            quit = ! runArcade(systemFile, playerCollection, enemyCollection, behavior, keys1, keys2, options, searcher, playerType, playerKeys);
+            quit = ! runArcade(systemFile, gameType == TeamArcade ? TeamArcade : Arcade, playerCollection, enemyCollection, behavior, keys1, keys2, options, searcher, playerType, playerKeys);
 
             if (!quit && !match.hasMore()){
                 screens.playEnding(playerKeys);
@@ -1312,7 +1938,7 @@ void Game::doVersus(Searcher & searcher){
     while (true){
         Mugen::CharacterSelect select(systemFile);
         select.init();
-        select.setMode(Mugen::Versus, Mugen::CharacterSelect::Both);
+        select.setMode(gameType == TeamVersus ? Mugen::TeamVersus : Mugen::Versus, Mugen::CharacterSelect::Both);
         InputMap<Mugen::Keys> keys1 = Mugen::getPlayer1Keys();
         InputMap<Mugen::Keys> keys2 = Mugen::getPlayer2Keys();
         HumanBehavior behavior1 = HumanBehavior(keys1, getPlayer1InputLeft());
@@ -1348,14 +1974,11 @@ void Game::doVersus(Searcher & searcher){
             }
         }
         
-        player1.getFirst().setBehavior(&behavior1);
-        player2.getFirst().setBehavior(&behavior2);
-        Mugen::Stage stage(select.getStage());
-        prepareStage(loader, stage);
-        stage.reset();
+        player1.setBehavior(&behavior1);
+        player2.setBehavior(&behavior2);
         searcher.pause();
         try {
-            runMatch(&stage, "", options);
+            runTeamMatch(loader, select.getStage(), options);
         } catch (const Exception::Return & ex){
         } catch (const QuitGameException & ex){
         }
@@ -1482,14 +2105,18 @@ void Game::doNetworkVersus(bool isServer, Searcher & searcher){
                 }
             }
             if (isServer){
-                player1.getFirst().setBehavior(player1LocalBehavior.raw());
-                player2.getFirst().setBehavior(player2RemoteBehavior.raw());
+                player1.setBehavior(player1LocalBehavior.raw());
+                player2.setBehavior(player2RemoteBehavior.raw());
             } else {
-                player1.getFirst().setBehavior(player1RemoteBehavior.raw());
-                player2.getFirst().setBehavior(player2LocalBehavior.raw());
+                player1.setBehavior(player1RemoteBehavior.raw());
+                player2.setBehavior(player2LocalBehavior.raw());
             }
             Mugen::Stage stage(select.getStage());
             prepareStage(loader, stage);
+            /* only keeps rounding differences between the two ends small, the
+             * world snapshots the server sends are what keep them in step
+             */
+            stage.setFixedPhysics(true);
             stage.reset();
             
             if (isServer){
@@ -1515,6 +2142,19 @@ void Game::doNetworkVersus(bool isServer, Searcher & searcher){
 #endif
 }
 
+/* false if the versus screen was canceled */
+static bool showDemoVersus(const Filesystem::AbsolutePath & systemFile, const Mugen::ArcadeData::CharacterCollection & player1, const Mugen::ArcadeData::CharacterCollection & player2){
+    InputMap<Mugen::Keys> keys1;
+    InputMap<Mugen::Keys> keys2;
+    InputManager::waitForClear();
+    VersusMenu versus(systemFile, true);
+    versus.init(player1, player2);
+    PaintownUtil::ReferenceCount<PaintownUtil::Logic> logic = versus.getLogic(keys1, keys2);
+    PaintownUtil::ReferenceCount<PaintownUtil::Draw> draw = versus.getDraw();
+    PaintownUtil::standardLoop(*logic, *draw);
+    return !versus.wasCanceled();
+}
+
 void Game::startDemo(Searcher & searcher){
     
     // Display select screen?
@@ -1602,14 +2242,24 @@ void Game::startDemo(Searcher & searcher){
                 }
             }
 
-            const Filesystem::AbsolutePath getCharacter(){
+            void removeCharacter(const Filesystem::AbsolutePath & path){
                 PaintownUtil::Thread::ScopedLock scoped(lock);
-                return allCharacters[PaintownUtil::rnd(allCharacters.size())];
+                remove(allCharacters, path);
             }
 
-            const Filesystem::AbsolutePath getStage(){
+            void removeStage(const Filesystem::AbsolutePath & path){
                 PaintownUtil::Thread::ScopedLock scoped(lock);
-                return allStages[PaintownUtil::rnd(allStages.size())];
+                remove(allStages, path);
+            }
+
+            std::vector<Filesystem::AbsolutePath> getCharacters(){
+                PaintownUtil::Thread::ScopedLock scoped(lock);
+                return allCharacters;
+            }
+
+            std::vector<Filesystem::AbsolutePath> getStages(){
+                PaintownUtil::Thread::ScopedLock scoped(lock);
+                return allStages;
             }
             
             bool isEmpty(){
@@ -1618,6 +2268,13 @@ void Game::startDemo(Searcher & searcher){
             }
             
         private:
+            static void remove(std::vector<Filesystem::AbsolutePath> & paths, const Filesystem::AbsolutePath & path){
+                std::vector<Filesystem::AbsolutePath>::iterator found = std::find(paths.begin(), paths.end(), path);
+                if (found != paths.end()){
+                    paths.erase(found);
+                }
+            }
+
             std::vector<Filesystem::AbsolutePath> allCharacters;
             std::vector<Filesystem::AbsolutePath> allStages;
             PaintownUtil::Thread::LockObject lock;
@@ -1647,6 +2304,18 @@ void Game::startDemo(Searcher & searcher){
                     collections.addStage(path);
                 }
             }
+
+            virtual void removeCharacters(const std::vector<Filesystem::AbsolutePath> & paths){
+                for (std::vector<Filesystem::AbsolutePath>::const_iterator it = paths.begin(); it != paths.end(); it++){
+                    collections.removeCharacter(*it);
+                }
+            }
+
+            virtual void removeStages(const std::vector<Filesystem::AbsolutePath> & paths){
+                for (std::vector<Filesystem::AbsolutePath>::const_iterator it = paths.begin(); it != paths.end(); it++){
+                    collections.removeStage(*it);
+                }
+            }
         } subscription(collections);
         
         class WithSubscription{
@@ -1688,9 +2357,6 @@ void Game::startDemo(Searcher & searcher){
             }
         } withSubscription(searcher, subscription);
         
-        Filesystem::AbsolutePath path1;
-        Filesystem::AbsolutePath path2;
-        
         uint64_t currentTime = System::currentSeconds();
         Global::debug(1) << "Waiting for search..." << std::endl;
         int i = 0;
@@ -1703,16 +2369,43 @@ void Game::startDemo(Searcher & searcher){
             Global::debug(1) << "Time elapsed: " << i << std::endl;
         }
         
-        path1 = collections.getCharacter();
-        path2 = collections.getCharacter();
-        
-        Global::debug(1) << "Got player1: " << path1.path() << std::endl;
-        Global::debug(1) << "Got player2: " << path2.path() << std::endl;
-        
-        player1Collection.setFirst(Mugen::ArcadeData::CharacterInfo(path1));
-        player2Collection.setFirst(Mugen::ArcadeData::CharacterInfo(path2));
-        
-        stagePath = collections.getStage();
+        /* Random demos go through attract mode. The one that was queued by
+         * the last demo has been loading since then, and the one after this
+         * starts loading now.
+         */
+        std::vector<Filesystem::AbsolutePath> characters = collections.getCharacters();
+        std::vector<Filesystem::AbsolutePath> stages = collections.getStages();
+        PaintownUtil::ReferenceCount<AttractMatch> current;
+        if (demos != NULL){
+            current = demos->next(characters, stages);
+        } else {
+            current = startAttractMatch(characters, stages);
+        }
+
+        if (!waitForAttractMatch(current)){
+            return;
+        }
+
+        Global::debug(1) << "Got player1: " << current->player1->getLocation().path() << std::endl;
+        Global::debug(1) << "Got player2: " << current->player2->getLocation().path() << std::endl;
+
+        if (showVersusScreen){
+            player1Collection.setFirst(Mugen::ArcadeData::CharacterInfo(current->player1->getLocation()));
+            player2Collection.setFirst(Mugen::ArcadeData::CharacterInfo(current->player2->getLocation()));
+            if (!showDemoVersus(systemFile, player1Collection, player2Collection)){
+                return;
+            }
+        }
+
+        current->stage->reset();
+        searcher.pause();
+        try {
+            InputManager::waitForClear();
+            runMatch(current->stage.raw(), "", RunMatchOptions(endTime));
+        } catch (const Exception::Return & ex){
+        } catch (const QuitGameException & ex){
+        }
+        return;
     }
     
     // Prepares futures
@@ -1720,21 +2413,13 @@ void Game::startDemo(Searcher & searcher){
     CharacterTeam player2(player2Collection, Stage::Player2Side);
     PaintownUtil::ReferenceCount<PlayerLoader> loader = preLoadCharacters(player1, player2);
     
-    if (showVersusScreen){
-        InputManager::waitForClear();
-        VersusMenu versus(systemFile, true);
-        versus.init(player1Collection, player2Collection);
-        PaintownUtil::ReferenceCount<PaintownUtil::Logic> logic = versus.getLogic(keys1, keys2);
-        PaintownUtil::ReferenceCount<PaintownUtil::Draw> draw = versus.getDraw();
-        PaintownUtil::standardLoop(*logic, *draw);
-        if (versus.wasCanceled()){
-            return;
-        }
+    if (showVersusScreen && !showDemoVersus(systemFile, player1Collection, player2Collection)){
+        return;
     }
     
     // Load it up
-    player1.getFirst().setBehavior(&behavior1);
-    player2.getFirst().setBehavior(&behavior2);
+    player1.setBehavior(&behavior1);
+    player2.setBehavior(&behavior2);
     Mugen::Stage stage(stagePath);
     prepareStage(loader, stage);
     stage.reset();
@@ -1846,24 +2531,24 @@ void Game::doSurvival(Searcher & searcher){
             if (!playerLoaded){
                 player1 = PaintownUtil::ReferenceCount<CharacterTeam>(new CharacterTeam(player1Collection, Stage::Player1Side));
                 ourPlayer = player1;
-                player1->getFirst().setBehavior(&behavior);
+                player1->setBehavior(&behavior);
                 playerLoaded = true;
                 options.setBehavior(&behavior, NULL);
             }
             
             player2 = PaintownUtil::ReferenceCount<CharacterTeam>(new CharacterTeam(player2Collection, Stage::Player2Side));
-            player2->getFirst().setBehavior(&AIBehavior);
+            player2->setBehavior(&AIBehavior);
         } else {
             if (!playerLoaded){
                 player2 = PaintownUtil::ReferenceCount<CharacterTeam>(new CharacterTeam(player2Collection, Stage::Player2Side));
                 ourPlayer = player2;
-                player2->getFirst().setBehavior(&behavior);
+                player2->setBehavior(&behavior);
                 playerLoaded = true;
                 options.setBehavior(NULL, &behavior);
             }
             
             player1 = PaintownUtil::ReferenceCount<CharacterTeam>(new CharacterTeam(player1Collection, Stage::Player1Side));
-            player1->getFirst().setBehavior(&AIBehavior);
+            player1->setBehavior(&AIBehavior);
         }
         
         PaintownUtil::ReferenceCount<PlayerLoader> loader = preLoadCharacters(*player1, *player2);
@@ -1888,7 +2573,7 @@ void Game::doSurvival(Searcher & searcher){
         try {
             searcher.pause();
             runMatch(&stage, "", options);
-            if (ourPlayer->getFirst().getMatchWins()> wins){
+            if (ourPlayer->getMemberMatchWins() > wins){
                 wins++;
                 // Reset player for next match
                 ourPlayer->getFirst().resetPlayer();
@@ -2,9 +2,12 @@
 #define paintown_mugen_game_h
 
 #include <string>
+#include <vector>
 
 #include "util.h"
 #include <r-tech1/gui/fadetool.h>
+#include <r-tech1/pointer.h>
+#include <r-tech1/file-system.h>
 
 namespace Graphics{
 class Bitmap;
@@ -16,6 +19,7 @@ class HumanBehavior;
 class Searcher;
 class CharacterSelect;
 class Stage;
+class AttractMatch;
 
 class RunMatchOptions{
 public:
@@ -35,11 +39,41 @@ protected:
     int ticker;
     int endTime;
     bool demoMode;
+    /* demo was stopped by a player rather than running out of time */
+    bool interrupted;
     Gui::FadeTool fader;
     HumanBehavior * player1Behavior;
     HumanBehavior * player2Behavior;
 };
 
+/* The demo the menu plays next. It loads in the background while the title
+ * screen and the demo before it are up. The menu owns it, so nothing is left
+ * loading or holding on to a stage once the menu is gone.
+ */
+class DemoQueue{
+public:
+    DemoQueue();
+    /* stops anything that is still loading and waits for it */
+    ~DemoQueue();
+
+    /* The queued demo, or one that starts loading now if none is queued.
+     * The demo after it starts loading right away.
+     */
+    PaintownUtil::ReferenceCount<AttractMatch> next(const std::vector<Filesystem::AbsolutePath> & characters, const std::vector<Filesystem::AbsolutePath> & stages);
+
+    /* Tells the queued demo to stop loading and returns without waiting for
+     * it. It is released by a later reap once its thread is over.
+     */
+    void drop();
+
+    /* releases the dropped demos whose threads are over */
+    void reap();
+
+protected:
+    PaintownUtil::ReferenceCount<AttractMatch> queued;
+    std::vector<PaintownUtil::ReferenceCount<AttractMatch> > dropped;
+};
+
 /* Our game definition, this is to facilitate running a game */
 class Game {
     public:
@@ -48,6 +82,9 @@ class Game {
 
         //! Runs everything
         virtual void run(Searcher & searcher);
+
+        /* demo mode takes its matches from here */
+        virtual void setDemos(DemoQueue & demos);
         
         /* in run-match.cpp */
         static void runMatch(Mugen::Stage * stage, const std::string & musicOverride = "", RunMatchOptions options = RunMatchOptions());
@@ -59,6 +96,15 @@ class Game {
         static void startArcade(const std::string & player1, const std::string & player2, const std::string & stage);
         /* start a watch match */
         static void startWatch(const std::string & player1Name, const std::string & player2Name, const std::string & stageName);
+        /* AI against AI as fast as possible, logging leaks between matches.
+         * Draws one out of every renderEvery ticks, or nothing if it is 0.
+         * Stops after the given minutes or never if that is 0.
+         */
+        static void startSoak(const std::string & player1Name, const std::string & player2Name, const std::string & stageName, int renderEvery, int minutes);
+        /* cycle through demo matches between random characters until a
+         * player presses something
+         */
+        static void startAttract();
         /* start a team match */
         static void startTeam(const std::string & player1Name, const std::string & player2Name, const std::string & player3Name, const std::string & player4Name, const std::string & stageName);
         /* start a scripted match */
@@ -87,6 +133,8 @@ class Game {
         Filesystem::AbsolutePath systemFile;
         //! Motif Base Directory
         Filesystem::AbsolutePath motifDirectory;
+        //! Demos queued by the menu, NULL if there is no menu
+        DemoQueue * demos;
 };
 
 }
@@ -7,6 +7,12 @@ using namespace std;
 
 namespace Mugen{
 
+/* Helpers are also created while characters load on other threads, so the
+ * count is only changed with atomic operations. gcc, clang and mingw all have
+ * the __sync builtins.
+ */
+volatile int Helper::liveCount = 0;
+
 Helper::Helper(Character * owner, const Character * root, int id, const string & name):
 Character(*owner),
 owner(owner->getId()),
@@ -18,9 +24,15 @@ name(owner->getName() + " " + name + " (helper)"){
     getLocalData().animations = owner->getAnimations();
     getLocalData().sounds = owner->getSounds();
     getLocalData().commonSounds = owner->getCommonSounds();
+    __sync_add_and_fetch(&liveCount, 1);
 }
 
 Helper::~Helper(){
+    __sync_sub_and_fetch(&liveCount, 1);
+}
+
+int Helper::getLiveCount(){
+    return __sync_add_and_fetch(&liveCount, 0);
 }
     
 void Helper::destroyed(Stage & stage){
@@ -37,6 +37,11 @@ public:
         
     virtual void roundEnd(Mugen::Stage & stage);
 
+    /* Number of helpers that have not been deleted yet, soak tests use
+     * this to find helpers that leak.
+     */
+    static int getLiveCount();
+
     using Character::getRoot;
     virtual CharacterId getRoot() const {
         return root;
@@ -57,6 +62,8 @@ protected:
     /* Id of the helper according to mugen script */
     int id;
     std::string name;
+
+    static volatile int liveCount;
 };
 
 }
@@ -0,0 +1,122 @@
+#include "hit-queue.h"
+#include <algorithm>
+#include <ctype.h>
+
+using std::string;
+using std::vector;
+
+namespace Mugen{
+
+HitPriority::Type HitPriority::parse(const string & type){
+    string lower = type;
+    for (unsigned int i = 0; i < lower.size(); i++){
+        lower[i] = tolower((unsigned char) lower[i]);
+    }
+
+    if (lower == "miss"){
+        return Miss;
+    }
+
+    if (lower == "dodge"){
+        return Dodge;
+    }
+
+    return Hit;
+}
+
+HitCandidate::HitCandidate(Kind kind, Character * attacker, Character * defender, int priority, HitPriority::Type type):
+kind(kind),
+attacker(attacker),
+defender(defender),
+projectile(NULL),
+other(NULL),
+touched(true),
+priority(priority),
+type(type),
+attackerId(0),
+defenderId(0){
+}
+
+/* guards and hits of the same priority are mixed together */
+static int rank(HitCandidate::Kind kind){
+    switch (kind){
+        case HitCandidate::Reversal: return 0;
+        case HitCandidate::ProjectileCancel: return 1;
+        case HitCandidate::Guard:
+        case HitCandidate::Hit: return 2;
+        case HitCandidate::ProjectileHit: return 3;
+    }
+    return 3;
+}
+
+/* strict ordering for stable_sort, so equal hits stay in the order they were added */
+static bool before(const HitCandidate & a, const HitCandidate & b){
+    if (rank(a.kind) != rank(b.kind)){
+        return rank(a.kind) < rank(b.kind);
+    }
+
+    if (a.priority != b.priority){
+        return a.priority > b.priority;
+    }
+
+    if (a.attackerId != b.attackerId){
+        return a.attackerId < b.attackerId;
+    }
+
+    return a.defenderId < b.defenderId;
+}
+
+HitQueue::HitQueue(){
+}
+
+void HitQueue::add(const HitCandidate & hit){
+    hits.push_back(hit);
+}
+
+void HitQueue::clear(){
+    hits.clear();
+}
+
+bool HitQueue::empty() const {
+    return hits.empty();
+}
+
+bool HitQueue::winsTrade(const HitCandidate & mine, const HitCandidate & his){
+    if (mine.priority != his.priority){
+        return mine.priority > his.priority;
+    }
+
+    if (mine.type == HitPriority::Hit){
+        return his.type == HitPriority::Hit || his.type == HitPriority::Miss;
+    }
+
+    return false;
+}
+
+vector<HitCandidate> HitQueue::resolve() const {
+    vector<HitCandidate> out;
+    for (vector<HitCandidate>::const_iterator it = hits.begin(); it != hits.end(); it++){
+        const HitCandidate & hit = *it;
+        bool connects = true;
+        if (hit.kind == HitCandidate::Hit){
+            for (vector<HitCandidate>::const_iterator other = hits.begin(); other != hits.end(); other++){
+                if (other->kind == HitCandidate::Hit &&
+                    other->attacker == hit.defender &&
+                    other->defender == hit.attacker &&
+                    !winsTrade(hit, *other)){
+                    connects = false;
+                    break;
+                }
+            }
+        }
+
+        if (connects){
+            out.push_back(hit);
+        }
+    }
+
+    std::stable_sort(out.begin(), out.end(), before);
+    return out;
+}
+
+}
@@ -0,0 +1,112 @@
+#ifndef _paintown_mugen_hit_queue_h
+#define _paintown_mugen_hit_queue_h
+
+#include <string>
+#include <vector>
+
+namespace Mugen{
+
+class Character;
+class Projectile;
+
+namespace HitPriority{
+
+/* The priority class of a hitdef, which decides what happens when two hits
+ * with the same priority trade.
+ */
+enum Type{
+    Hit,
+    Miss,
+    Dodge
+};
+
+/* `hit', `miss' or `dodge' in any case, anything else is Hit */
+Type parse(const std::string & type);
+
+/* The hitdef default for hit_prior */
+const int Default = 4;
+
+}
+
+/* A hit that was found while looking for collisions and hasn't been applied
+ * to anyone yet.
+ */
+struct HitCandidate{
+    enum Kind{
+        /* the defender reverses the attacker's hitdef */
+        Reversal,
+        /* the attacker's projectile runs into the defender's projectile */
+        ProjectileCancel,
+        /* the attacker's hitdef connects or comes within guard distance and
+         * the defender guards it
+         */
+        Guard,
+        /* the attacker's hitdef connects */
+        Hit,
+        /* the attacker's projectile connects with the defender, who might
+         * guard it
+         */
+        ProjectileHit
+    };
+
+    HitCandidate(Kind kind, Character * attacker, Character * defender, int priority, HitPriority::Type type);
+
+    Kind kind;
+    Character * attacker;
+    Character * defender;
+
+    /* the attacker's projectile for ProjectileHit and ProjectileCancel */
+    Projectile * projectile;
+    /* the defender's projectile for ProjectileCancel */
+    Projectile * other;
+
+    /* for Guard, the attack boxes touched the defender rather than only
+     * coming within guard distance
+     */
+    bool touched;
+
+    /* hit_prior of the hitdef, or the projpriority for a projectile cancel */
+    int priority;
+    HitPriority::Type type;
+
+    /* Ids of the attacker and defender, used to order hits of the same
+     * priority without depending on the order of the stage's lists.
+     */
+    int attackerId;
+    int defenderId;
+};
+
+/* Collects every hit of a tick before any of them are applied, then hands
+ * them back in the order they should be applied with the hits that lose a
+ * trade left out.
+ *
+ * Reversals go first, then projectiles canceling each other, then hitdefs
+ * and guards from the highest priority down, then projectiles hitting
+ * characters. Hits of the same kind and priority go by the attacker's id and
+ * then the defender's id, and after that in the order they were added.
+ */
+class HitQueue{
+public:
+    HitQueue();
+
+    void add(const HitCandidate & hit);
+    void clear();
+    bool empty() const;
+
+    /* When two characters hit each other the higher priority hit wins. With
+     * the same priority the classes decide: Hit vs Hit both hit, Hit vs Miss
+     * only the Hit connects and anything else means both miss. A hit that
+     * misses leaves the hitdef enabled.
+     */
+    std::vector<HitCandidate> resolve() const;
+
+    /* true if `mine' still connects when it trades with `his' */
+    static bool winsTrade(const HitCandidate & mine, const HitCandidate & his);
+
+protected:
+    std::vector<HitCandidate> hits;
+};
+
+}
+
+#endif
@@ -29,6 +29,7 @@
 
 #include "globals.h"
 #include "factory/font_render.h"
+#include "factory/presenter.h"
 #include "parse-cache.h"
 
 #include <r-tech1/input/input-manager.h>
@@ -495,6 +496,8 @@ done(false){
                 section->walk(walker);
             } else if (PaintownUtil::matchRegex(head, PaintownUtil::Regex("^titlebgdef"))){
                 background = PaintownUtil::ReferenceCount<Background>(new Background(ourDefFile, "titlebg"));
+                /* the menu never moves the camera */
+                background->enableStaticCache(true);
             } else if (head == "select info"){ 
                 //selectInfoFile = ourDefFile;
             } else if (head == "selectbgdef" ){ /* Ignore for now */ }
@@ -619,6 +622,7 @@ void Menu::act(){
         }
         case MainMenu:{
             background->act();
+            demos.reap();
             
             list->act();
             
@@ -637,6 +641,7 @@ void Menu::act(){
             if (fader.getState() == Gui::FadeTool::EndFade){
                 try{
                     Game demo(Mugen::Player1, Mugen::Demo, Data::getInstance().getMotif());
+                    demo.setDemos(demos);
                     demo.run(searcher);
                 } catch (const Exception::Return & re){
                     /* */
@@ -661,8 +666,10 @@ void Menu::act(){
 }
 
 void Menu::draw(const Graphics::Bitmap & work){
-    Graphics::StretchedBitmap workArea(320, 240, work, Graphics::StretchedBitmap::NoClear, Graphics::qualityFilterName(::Configuration::getQualityFilter()));
-    workArea.start();
+    if (presenter == NULL){
+        presenter = PaintownUtil::ReferenceCount<Presenter>(new Presenter(320, 240));
+    }
+    Graphics::Bitmap & workArea = presenter->start(work);
     
     // Backgrounds
     background->renderBackground(0, 0, workArea);
@@ -682,7 +689,7 @@ void Menu::draw(const Graphics::Bitmap & work){
         fader.draw(workArea);
     }
     
-    workArea.finish();
+    presenter->finish(work);
 }
 
 void Menu::up(){
@@ -703,6 +710,8 @@ void Menu::enter(){
     if (list->getCurrent()->isRunnable()){
         ticks = 0;
         sounds.play(Done);
+        /* the next demo would only take memory and cpu from what runs now */
+        demos.drop();
         list->getCurrent()->run();
     }
 }
@@ -9,6 +9,7 @@
 #include <r-tech1/gui/scroll-list.h>
 #include <r-tech1/language-string.h>
 #include "search.h"
+#include "game.h"
 
 /*
 #include "menu/menu.h"
@@ -23,6 +24,7 @@
 
 class MugenAnimation;
 class MugenSection;
+class Presenter;
 
 namespace Ast{
     class Section;
@@ -132,12 +134,18 @@ namespace Mugen{
         
         //! Max cycles of demo before displaying next intro
         int nextIntroCycle;
+
+        //! Demos loading in the background, cleared when the menu goes away
+        DemoQueue demos;
         
         //! Searcher
         Searcher & searcher;
         
         //! is done?
         bool done;
+
+        //! Puts the 320x240 frame on the screen, made on the first draw
+        PaintownUtil::ReferenceCount<Presenter> presenter;
     };
 
     /*! run the mugen menu */
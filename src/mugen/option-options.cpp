@@ -15,6 +15,7 @@
 #include "parse-cache.h"
 #include "search.h"
 #include "widgets.h"
+#include "factory/presenter.h"
 
 #include <ostream>
 #include <vector>
@@ -801,6 +802,8 @@ recalculateHeight(160){
         } else if (head == "OptionBGdef"){ 
             /* Background management */
             background = PaintownUtil::ReferenceCount<Background>(new Background(systemFile, "optionbg"));
+            /* the menu never moves the camera */
+            background->enableStaticCache(true);
         }
     }
 
@@ -891,8 +894,10 @@ void OptionMenu::act(){
 }
 
 void OptionMenu::draw(const Graphics::Bitmap & work){
-    Graphics::StretchedBitmap workArea(320, 240, work, Graphics::StretchedBitmap::NoClear, Graphics::qualityFilterName(::Configuration::getQualityFilter()));
-    workArea.start();
+    if (presenter == NULL){
+        presenter = PaintownUtil::ReferenceCount<Presenter>(new Presenter(320, 240));
+    }
+    Graphics::Bitmap & workArea = presenter->start(work);
     
     // Backgrounds
     if (renderBackground){
@@ -935,7 +940,7 @@ void OptionMenu::draw(const Graphics::Bitmap & work){
         fader.draw(workArea);
     }
     
-    workArea.finish();
+    presenter->finish(work);
 }
 
 void OptionMenu::drawList(const Graphics::Bitmap & work){
@@ -985,10 +990,7 @@ void OptionMenu::drawInfo(int x, int y, const std::string & text, const Graphics
     list.getFont().draw(x, y, text, work);
 }
 
-void OptionMenu::drawInfoWithBackground(const std::string & title, int x, int y, const std::string & text, const Graphics::Bitmap & work){
-    Graphics::StretchedBitmap workArea(320, 240, work, Graphics::StretchedBitmap::NoClear, Graphics::qualityFilterName(::Configuration::getQualityFilter()));
-    workArea.start();
-    
+void OptionMenu::drawInfoWithBackground(const std::string & title, int x, int y, const std::string & text, const Graphics::Bitmap & workArea){
     // Backgrounds
     background->renderBackground(0, 0, workArea);
     
@@ -1005,8 +1007,6 @@ void OptionMenu::drawInfoWithBackground(const std::string & title, int x, int y,
     if (fadeEnabled){
         fader.draw(workArea);
     }
-    
-    workArea.finish();
 }
 
 void OptionMenu::updateList(const std::vector<PaintownUtil::ReferenceCount<Gui::ScrollItem> > & newList){
@@ -2011,7 +2011,8 @@ public:
         title(title),
         escaped(false),
         width(menu.getFont().getWidth(defaultText)+20),
-        height(menu.getFont().getHeight()){
+        height(menu.getFont().getHeight()),
+        presenter(320, 240){
             input.setText(defaultText);
             input.setWidth(width);
             input.addHook(Keyboard::Key_ENTER, submit, &input);
@@ -2029,6 +2030,8 @@ public:
     int width;
     int height;
 
+    Presenter presenter;
+
     double ticks(double system){
         return Util::gameTicks(system);
     }
@@ -2049,11 +2052,10 @@ public:
     }
 
     void draw(const Graphics::Bitmap & screen){
-        Graphics::StretchedBitmap stretch(320,240, screen);
-        stretch.start();
-        menu.drawInfoWithBackground(title, 0,0, "", stretch);
-        input.draw(160-width/2, 120+height/2, menu.getFont(), stretch);
-        stretch.finish();
+        Graphics::Bitmap & work = presenter.start(screen);
+        menu.drawInfoWithBackground(title, 0,0, "", work);
+        input.draw(160-width/2, 120+height/2, menu.getFont(), work);
+        presenter.finish(screen);
         // screen.BlitToScreen();
     }
 };
@@ -330,7 +330,7 @@ public:
     virtual void draw(const Graphics::Bitmap &);
     virtual void drawList(const Graphics::Bitmap &);
     virtual void drawInfo(int x, int y, const std::string &, const Graphics::Bitmap &);
-    /*! Draws the background and some info
+    /*! Draws the background and some info into a 320x240 surface
      *  - 1st string - title
      *  - x, y - location of info
      *  - 2nd string - info text
@@ -473,6 +473,8 @@ private:
     //! Screen capture (can be updated and will render when Mugen::Background is disabled)
     PaintownUtil::ReferenceCount<Graphics::Bitmap> screenCapture;
     
+    //! Puts the 320x240 frame on the screen, made on the first draw and not shared by copies
+    PaintownUtil::ReferenceCount<Presenter> presenter;
 };
 
 /*! Run Mugen Options Menu */
@@ -0,0 +1,123 @@
+#ifndef _paintown_mugen_owner_index_h
+#define _paintown_mugen_owner_index_h
+
+#include <map>
+#include <vector>
+#include <algorithm>
+
+namespace Mugen{
+
+/* Groups the things on the stage (explods, projectiles, helpers) by the
+ * character that owns them and by their id, so triggers like NumExplod can
+ * count or find them without looking at everything on the stage.
+ *
+ * The lists keep the order the stage keeps the things in, so anything that
+ * picks the first match gets the same one as a search through the stage.
+ */
+template <class Owner, class Thing>
+class OwnerIndex{
+public:
+    OwnerIndex(){
+    }
+
+    void add(const Owner & owner, int id, Thing * thing){
+        Owned & owned = index[owner];
+        owned.all.push_back(thing);
+        owned.byId[id].push_back(thing);
+    }
+
+    /* for things the stage puts in front of everything else */
+    void addFront(const Owner & owner, int id, Thing * thing){
+        Owned & owned = index[owner];
+        owned.all.insert(owned.all.begin(), thing);
+        std::vector<Thing*> & same = owned.byId[id];
+        same.insert(same.begin(), thing);
+    }
+
+    /* does nothing if the thing isn't in the index */
+    void remove(const Owner & owner, int id, Thing * thing){
+        typename std::map<Owner, Owned>::iterator found = index.find(owner);
+        if (found == index.end()){
+            return;
+        }
+
+        Owned & owned = found->second;
+        erase(owned.all, thing);
+        typename std::map<int, std::vector<Thing*> >::iterator same = owned.byId.find(id);
+        if (same != owned.byId.end()){
+            erase(same->second, thing);
+            if (same->second.empty()){
+                owned.byId.erase(same);
+            }
+        }
+
+        if (owned.all.empty()){
+            index.erase(found);
+        }
+    }
+
+    /* forget everything the owner has */
+    void removeOwner(const Owner & owner){
+        index.erase(owner);
+    }
+
+    /* The lists belong to the index, so don't add or remove anything on the
+     * stage while going through one.
+     */
+    const std::vector<Thing*> & getAll(const Owner & owner) const {
+        typename std::map<Owner, Owned>::const_iterator found = index.find(owner);
+        if (found == index.end()){
+            return empty();
+        }
+        return found->second.all;
+    }
+
+    const std::vector<Thing*> & get(const Owner & owner, int id) const {
+        typename std::map<Owner, Owned>::const_iterator found = index.find(owner);
+        if (found == index.end()){
+            return empty();
+        }
+
+        typename std::map<int, std::vector<Thing*> >::const_iterator same = found->second.byId.find(id);
+        if (same == found->second.byId.end()){
+            return empty();
+        }
+        return same->second;
+    }
+
+    int countAll(const Owner & owner) const {
+        return getAll(owner).size();
+    }
+
+    int count(const Owner & owner, int id) const {
+        return get(owner, id).size();
+    }
+
+    void clear(){
+        index.clear();
+    }
+
+protected:
+    struct Owned{
+        std::vector<Thing*> all;
+        std::map<int, std::vector<Thing*> > byId;
+    };
+
+    static void erase(std::vector<Thing*> & things, Thing * thing){
+        typename std::vector<Thing*>::iterator found = std::find(things.begin(), things.end(), thing);
+        if (found != things.end()){
+            things.erase(found);
+        }
+    }
+
+    static const std::vector<Thing*> & empty(){
+        static std::vector<Thing*> nothing;
+        return nothing;
+    }
+
+    std::map<Owner, Owned> index;
+};
+
+}
+
+#endif
@@ -106,6 +106,7 @@ Util::ReferenceCount<Ast::AstParse> Parser::loadFile(const Filesystem::AbsoluteP
 }
 
 void Parser::destroy(){
+    PaintownUtil::Thread::ScopedLock scoped(lock);
     cache.clear();
 }
 
@@ -133,12 +134,22 @@ static list<Ast::Section*> * copy(list<Ast::Section*> * input){
  * returns a new copy of the AST so you must delete it later.
  */
 Util::ReferenceCount<Ast::AstParse> Parser::parse(const Filesystem::AbsolutePath & path){
-    PaintownUtil::Thread::ScopedLock scoped(lock);
-    if (cache[path] == NULL){
-        cache[path] = loadFile(path);
+    Util::ReferenceCount<Entry> entry;
+    {
+        PaintownUtil::Thread::ScopedLock scoped(lock);
+        entry = cache[path];
+        if (entry == NULL){
+            entry = Util::ReferenceCount<Entry>(new Entry());
+            cache[path] = entry;
+        }
     }
 
-    return cache[path];
+    PaintownUtil::Thread::ScopedLock scoped(entry->lock);
+    if (entry->parsed == NULL){
+        entry->parsed = loadFile(path);
+    }
+
+    return entry->parsed;
 }
 
 CmdCache::CmdCache(){
@@ -210,31 +221,41 @@ Util::ReferenceCount<Ast::AstParse> DefCache::doParse(const Filesystem::Absolute
 }
 
 ParseCache * ParseCache::cache = NULL;
+PaintownUtil::Thread::LockObject ParseCache::cacheLock;
+
+ParseCache * ParseCache::current(){
+    PaintownUtil::Thread::ScopedLock scoped(cacheLock);
+    return cache;
+}
 
 Util::ReferenceCount<Ast::AstParse> ParseCache::parseCmd(const Filesystem::AbsolutePath & path){
-    if (cache == NULL){
+    ParseCache * use = current();
+    if (use == NULL){
         return Util::ReferenceCount<Ast::AstParse>(new Ast::AstParse(reallyParseCmd(path)));
     }
-    return cache->doParseCmd(path);
+    return use->doParseCmd(path);
 }
     
 Util::ReferenceCount<Ast::AstParse> ParseCache::parseAir(const Filesystem::AbsolutePath & path){
-    if (cache == NULL){
+    ParseCache * use = current();
+    if (use == NULL){
         return Util::ReferenceCount<Ast::AstParse>(new Ast::AstParse(reallyParseAir(path)));
     }
-    return cache->doParseAir(path);
+    return use->doParseAir(path);
 }
 
 Util::ReferenceCount<Ast::AstParse> ParseCache::parseDef(const Filesystem::AbsolutePath & path){
-    if (cache == NULL){
+    ParseCache * use = current();
+    if (use == NULL){
         return Util::ReferenceCount<Ast::AstParse>(new Ast::AstParse(reallyParseDef(path)));
     }
-    return cache->doParseDef(path);
+    return use->doParseDef(path);
 }
 
 void ParseCache::destroy(){
-    if (cache){
-        cache->destroyCache();
+    ParseCache * use = current();
+    if (use){
+        use->destroyCache();
     }
 }
 
@@ -242,10 +263,14 @@ ParseCache::ParseCache(){
     /* If there is already an existing cache then this object will not be the target of
      * static calls. If there is not an existing cache then this becomes the 'global' one.
      */
+    PaintownUtil::Thread::ScopedLock scoped(cacheLock);
     if (cache == NULL){
         cache = this;
     } else {
-        Global::debug(0) << "Minor bug: a parse cache already exists" << endl;
+        /* Expected when a stage is loaded while the team loader still
+         * holds the cache, the existing cache is shared.
+         */
+        Global::debug(1) << "A parse cache already exists" << endl;
     }
 }
 
@@ -256,6 +281,10 @@ void ParseCache::destroyCache(){
 }
 
 ParseCache::~ParseCache(){
+    /* The cache that owns the pointer outlives whatever it was handed to:
+     * the team loader waits for its member loaders before its cache goes.
+     */
+    PaintownUtil::Thread::ScopedLock scoped(cacheLock);
     if (cache == this){
         cache = NULL;
     }
@@ -30,7 +30,15 @@ protected:
     virtual PaintownUtil::ReferenceCount<Ast::AstParse> doParse(const Filesystem::AbsolutePath & path) = 0;
     PaintownUtil::ReferenceCount<Ast::AstParse> loadFile(const Filesystem::AbsolutePath & path);
 
-    std::map<const Filesystem::AbsolutePath, PaintownUtil::ReferenceCount<Ast::AstParse> > cache;
+    /* One per file so different files can be parsed at the same time while
+     * threads that want the same file wait for the first one to finish.
+     */
+    struct Entry{
+        PaintownUtil::Thread::LockObject lock;
+        PaintownUtil::ReferenceCount<Ast::AstParse> parsed;
+    };
+
+    std::map<const Filesystem::AbsolutePath, PaintownUtil::ReferenceCount<Entry> > cache;
     PaintownUtil::Thread::LockObject lock;
 };
 
@@ -78,7 +86,15 @@ protected:
     PaintownUtil::ReferenceCount<Ast::AstParse> doParseDef(const Filesystem::AbsolutePath & path);
     void destroyCache();
 
+    /* the cache the static calls go to, read under cacheLock */
+    static ParseCache * current();
+
+    /* Team members are loaded on their own threads while the menu thread
+     * can create and destroy caches, so the pointer is only touched with
+     * cacheLock held.
+     */
     static ParseCache * cache;
+    static PaintownUtil::Thread::LockObject cacheLock;
 
     CmdCache cmdCache;
     AirCache airCache;
@@ -0,0 +1,73 @@
+#include "pause-schedule.h"
+#include "character-state.h"
+
+namespace Mugen{
+
+PauseSchedule::PauseSchedule():
+dirty(true),
+mode(Everyone),
+pauser(NULL){
+}
+
+void PauseSchedule::charactersChanged(){
+    dirty = true;
+}
+
+const std::vector<Character*> & PauseSchedule::running(const std::vector<Character*> & all, const StageStateData & data, Character * pauser){
+    Mode now = Everyone;
+    if (data.pause.time > 0){
+        /* the character that paused keeps going until its movetime is up */
+        if (data.pause.moveTime > 0 && pauser != NULL){
+            now = OnlyPauser;
+        } else {
+            now = Nobody;
+        }
+    } else {
+        pauser = NULL;
+    }
+
+    if (!dirty && now == mode && pauser == this->pauser){
+        return list;
+    }
+
+    dirty = false;
+    mode = now;
+    this->pauser = pauser;
+
+    list.clear();
+    switch (mode){
+        case Everyone: {
+            list = all;
+            break;
+        }
+        case OnlyPauser: {
+            for (std::vector<Character*>::const_iterator it = all.begin(); it != all.end(); it++){
+                if (*it == pauser){
+                    list.push_back(*it);
+                }
+            }
+            break;
+        }
+        case Nobody: {
+            break;
+        }
+    }
+
+    return list;
+}
+
+unsigned int PauseSchedule::after(const std::vector<Character*> & all, const Character * last) const {
+    /* the list is in the same order as all, so count the entries up to last */
+    unsigned int next = 0;
+    for (std::vector<Character*>::const_iterator it = all.begin(); it != all.end() && next < list.size(); it++){
+        if (*it == list[next]){
+            next += 1;
+        }
+        if (*it == last){
+            break;
+        }
+    }
+    return next;
+}
+
+}
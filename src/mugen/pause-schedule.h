@@ -0,0 +1,58 @@
+#ifndef _paintown_mugen_pause_schedule_h
+#define _paintown_mugen_pause_schedule_h
+
+#include <vector>
+
+namespace Mugen{
+
+class Character;
+struct StageStateData;
+
+/* Which characters act and move on a tick while a Pause is going on.
+ *
+ * Rather than every character checking the pause on every tick, the schedule
+ * keeps the list of characters that run. The list only changes when a pause
+ * starts or ends, when the movetime of the character that paused runs out, or
+ * when characters come and go. A SuperPause stops everything, so the stage
+ * doesn't ask the schedule during one.
+ */
+class PauseSchedule{
+public:
+    PauseSchedule();
+
+    /* characters were added to or removed from the stage */
+    void charactersChanged();
+
+    /* The characters out of `all' that run this tick, in the same order.
+     * `pauser' is the character that started the current pause, if there is
+     * one and it is still on the stage.
+     *
+     * The list stays the same until the next call.
+     */
+    const std::vector<Character*> & running(const std::vector<Character*> & all, const StageStateData & data, Character * pauser);
+
+    /* Where to carry on in the list from running() once `last' has run and
+     * the list was asked for again. Entries of the list that come after
+     * `last' in `all' have not run yet.
+     */
+    unsigned int after(const std::vector<Character*> & all, const Character * last) const;
+
+protected:
+    enum Mode{
+        /* no pause */
+        Everyone,
+        /* paused, only the character that paused moves */
+        OnlyPauser,
+        /* paused and nobody moves */
+        Nobody
+    };
+
+    bool dirty;
+    Mode mode;
+    Character * pauser;
+    std::vector<Character*> list;
+};
+
+}
+
+#endif
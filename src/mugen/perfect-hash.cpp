@@ -0,0 +1,99 @@
+#include "perfect-hash.h"
+#include "exception.h"
+#include <ctype.h>
+
+using std::string;
+using std::vector;
+
+namespace Mugen{
+
+/* give up on a table size after this many seeds and try one twice as big */
+static const unsigned int SEEDS_PER_SIZE = 2000;
+
+static inline unsigned char lower(char letter){
+    return tolower((unsigned char) letter);
+}
+
+PerfectHash::PerfectHash(const char * const * names, int count):
+seed(0){
+    for (int i = 0; i < count; i++){
+        string name = names[i];
+        for (unsigned int letter = 0; letter < name.size(); letter++){
+            name[letter] = lower(name[letter]);
+        }
+        this->names.push_back(name);
+    }
+
+    unsigned int size = 1;
+    while (size < this->names.size() * 2){
+        size *= 2;
+    }
+
+    while (true){
+        slots.assign(size, -1);
+        for (unsigned int seed = 1; seed <= SEEDS_PER_SIZE; seed++){
+            if (tryTable(seed)){
+                this->seed = seed;
+                return;
+            }
+        }
+
+        /* two names that are the same never get their own slots */
+        if (size > this->names.size() * 1024){
+            throw MugenException("The names given to a perfect hash are not all different", __FILE__, __LINE__);
+        }
+        size *= 2;
+    }
+}
+
+/* FNV-1a of the lower case name, mixed with the seed */
+unsigned int PerfectHash::hash(const char * name, unsigned int seed) const {
+    unsigned int value = 2166136261u ^ (seed * 0x9e3779b9u);
+    for (; *name != '\0'; name++){
+        value ^= lower(*name);
+        value *= 16777619u;
+    }
+    value ^= value >> 15;
+    return value;
+}
+
+bool PerfectHash::tryTable(unsigned int seed){
+    unsigned int mask = slots.size() - 1;
+    for (unsigned int i = 0; i < names.size(); i++){
+        int & slot = slots[hash(names[i].c_str(), seed) & mask];
+        if (slot != -1){
+            slots.assign(slots.size(), -1);
+            return false;
+        }
+        slot = i;
+    }
+    return true;
+}
+
+int PerfectHash::find(const char * name) const {
+    int index = slots[hash(name, seed) & (slots.size() - 1)];
+    if (index == -1){
+        return -1;
+    }
+
+    const char * want = names[index].c_str();
+    while (*want != '\0' && *want == lower(*name)){
+        want++;
+        name++;
+    }
+
+    if (*want == '\0' && *name == '\0'){
+        return index;
+    }
+    return -1;
+}
+
+int PerfectHash::find(const string & name) const {
+    return find(name.c_str());
+}
+
+int PerfectHash::size() const {
+    return names.size();
+}
+
+}
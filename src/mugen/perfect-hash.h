@@ -0,0 +1,39 @@
+#ifndef _paintown_mugen_perfect_hash_h
+#define _paintown_mugen_perfect_hash_h
+
+#include <string>
+#include <vector>
+
+namespace Mugen{
+
+/* Turns one of a fixed list of names into its position in the list with one
+ * hash and one string compare, ignoring case like the mugen files do.
+ *
+ * The table is made once when it is created: it tries seeds until every name
+ * lands in its own slot, so a lookup never has to look at a second slot.
+ */
+class PerfectHash{
+public:
+    /* the names have to be different from each other once they are lower case */
+    PerfectHash(const char * const * names, int count);
+
+    /* the position of the name in the list or -1 if it isn't one of them */
+    int find(const std::string & name) const;
+    int find(const char * name) const;
+
+    int size() const;
+
+protected:
+    unsigned int hash(const char * name, unsigned int seed) const;
+    bool tryTable(unsigned int seed);
+
+    /* lower case */
+    std::vector<std::string> names;
+    /* an index into names or -1, always a power of two long */
+    std::vector<int> slots;
+    unsigned int seed;
+};
+
+}
+
+#endif
@@ -0,0 +1,193 @@
+#include <r-tech1/graphics/bitmap.h>
+#include <r-tech1/font.h>
+#include <r-tech1/funcs.h>
+#include <r-tech1/system.h>
+#include <sys/time.h>
+#include <string>
+#include "profile.h"
+#include "stage.h"
+
+namespace PaintownUtil = ::Util;
+
+namespace Mugen{
+
+/* 60 ticks is one second of game time */
+static const unsigned int WINDOW = 60;
+
+bool Profile::timing = false;
+bool Profile::spriteCounts = false;
+unsigned int Profile::spriteHits = 0;
+unsigned int Profile::spriteMisses = 0;
+
+static uint64_t sectionTotal[Profile::MaxSection];
+static int currentSection = -1;
+static uint64_t sectionStart = 0;
+
+uint64_t Profile::currentMicroseconds(){
+    struct timeval time;
+    gettimeofday(&time, NULL);
+    return (uint64_t) time.tv_sec * 1000000 + time.tv_usec;
+}
+
+int Profile::enter(int section){
+    uint64_t time = currentMicroseconds();
+    if (currentSection != -1){
+        sectionTotal[currentSection] += time - sectionStart;
+    }
+    int previous = currentSection;
+    currentSection = section;
+    sectionStart = time;
+    return previous;
+}
+
+void Profile::enableTiming(bool enable){
+    timing = enable;
+    currentSection = -1;
+}
+
+void Profile::enableSpriteCounts(bool enable){
+    spriteCounts = enable;
+}
+
+uint64_t Profile::getTime(Section section){
+    return sectionTotal[section];
+}
+
+unsigned int Profile::getSpriteHits(){
+    return spriteHits;
+}
+
+unsigned int Profile::getSpriteMisses(){
+    return spriteMisses;
+}
+
+void Profile::reset(){
+    for (int i = 0; i < MaxSection; i++){
+        sectionTotal[i] = 0;
+    }
+    spriteHits = 0;
+    spriteMisses = 0;
+}
+
+PerformanceOverlay::PerformanceOverlay():
+ticks(0),
+frames(0),
+helpers(0),
+explods(0),
+projectiles(0),
+spriteHits(0),
+spriteMisses(0),
+heap(0){
+    for (int i = 0; i < MaxKind; i++){
+        shown[i] = false;
+    }
+    for (int i = 0; i < Profile::MaxSection; i++){
+        sectionTime[i] = 0;
+    }
+}
+
+PerformanceOverlay::~PerformanceOverlay(){
+    Profile::enableTiming(false);
+    Profile::enableSpriteCounts(false);
+}
+
+bool PerformanceOverlay::toggle(Kind kind){
+    shown[kind] = !shown[kind];
+
+    /* start every overlay with a clean slate */
+    ticks = 0;
+    frames = 0;
+    Profile::reset();
+    Profile::enableTiming(shown[Timing]);
+    Profile::enableSpriteCounts(shown[Sprites]);
+
+    return shown[kind];
+}
+
+bool PerformanceOverlay::isShown(Kind kind) const {
+    return shown[kind];
+}
+
+void PerformanceOverlay::logic(const Stage & stage){
+    if (!shown[Timing] && !shown[Objects] && !shown[Sprites] && !shown[Heap]){
+        return;
+    }
+
+    ticks += 1;
+    if (ticks < WINDOW){
+        return;
+    }
+
+    if (shown[Objects]){
+        helpers = stage.countHelpers();
+        explods = stage.countExplods();
+        projectiles = stage.countProjectiles();
+    }
+
+    if (shown[Heap]){
+        /* reading the memory usage can mean reading a file so only do it once a second */
+        heap = System::memoryUsage();
+    }
+
+    publish();
+}
+
+void PerformanceOverlay::frame(){
+    if (shown[Timing]){
+        frames += 1;
+    }
+}
+
+void PerformanceOverlay::publish(){
+    for (int i = 0; i < Profile::MaxSection; i++){
+        /* rendering happens once per frame, everything else once per tick */
+        unsigned int count = i == Profile::Render ? frames : ticks;
+        if (count > 0){
+            sectionTime[i] = Profile::getTime((Profile::Section) i) / 1000.0 / count;
+        } else {
+            sectionTime[i] = 0;
+        }
+    }
+
+    spriteHits = Profile::getSpriteHits();
+    spriteMisses = Profile::getSpriteMisses();
+
+    ticks = 0;
+    frames = 0;
+    Profile::reset();
+}
+
+void PerformanceOverlay::draw(const Graphics::Bitmap & screen){
+    const ::Font & font = ::Font::getDefaultFont(15, 15);
+    Graphics::Color white = Graphics::makeColor(255, 255, 255);
+    int x = 1;
+    int y = screen.getHeight() / 4;
+
+    if (shown[Timing]){
+        font.printf(x, y, white, screen, "Triggers %.3fms Controllers %.3fms", 0, sectionTime[Profile::Triggers], sectionTime[Profile::Controllers]);
+        y += font.getHeight();
+        font.printf(x, y, white, screen, "Physics %.3fms Collision %.3fms", 0, sectionTime[Profile::Physics], sectionTime[Profile::Collision]);
+        y += font.getHeight();
+        font.printf(x, y, white, screen, "Render %.3fms per frame", 0, sectionTime[Profile::Render]);
+        y += font.getHeight();
+    }
+
+    if (shown[Objects]){
+        font.printf(x, y, white, screen, "Helpers %d Explods %d Projectiles %d", 0, helpers, explods, projectiles);
+        y += font.getHeight();
+    }
+
+    if (shown[Sprites]){
+        unsigned int total = spriteHits + spriteMisses;
+        double rate = total > 0 ? spriteHits * 100.0 / total : 100;
+        font.printf(x, y, white, screen, "Sprite cache %.1f%% hits %u misses %u", 0, rate, spriteHits, spriteMisses);
+        y += font.getHeight();
+    }
+
+    if (shown[Heap]){
+        font.printf(x, y, white, screen, "Memory usage %s", 0, PaintownUtil::niceSize(heap).c_str());
+        y += font.getHeight();
+    }
+}
+
+}
@@ -0,0 +1,139 @@
+#ifndef _paintown_mugen_profile_h
+#define _paintown_mugen_profile_h
+
+#include <stdint.h>
+
+namespace Graphics{
+class Bitmap;
+}
+
+namespace Mugen{
+
+class Stage;
+
+/* Timing and counters for the performance overlays in the console. The hooks
+ * in the engine only check a flag unless an overlay that needs them is shown,
+ * so normal play doesn't pay for any of this.
+ */
+class Profile{
+public:
+    enum Section{
+        Triggers,
+        Controllers,
+        Physics,
+        Collision,
+        Render,
+        MaxSection
+    };
+
+    /* Counts the time until the end of the scope towards a section. A nested
+     * scope stops the clock of the enclosing one so every section only gets
+     * its own time.
+     */
+    class Scope{
+    public:
+        inline Scope(Section section):
+        active(timing){
+            if (active){
+                previous = enter(section);
+            }
+        }
+
+        inline ~Scope(){
+            if (active){
+                enter(previous);
+            }
+        }
+
+    protected:
+        bool active;
+        int previous;
+    };
+
+    /* Wall clock time with microsecond resolution */
+    static uint64_t currentMicroseconds();
+
+    static void enableTiming(bool enable);
+    static void enableSpriteCounts(bool enable);
+
+    static inline void spriteHit(){
+        if (spriteCounts){
+            spriteHits += 1;
+        }
+    }
+
+    static inline void spriteMiss(){
+        if (spriteCounts){
+            spriteMisses += 1;
+        }
+    }
+
+    /* Microseconds spent in each section since the last reset */
+    static uint64_t getTime(Section section);
+    static unsigned int getSpriteHits();
+    static unsigned int getSpriteMisses();
+
+    static void reset();
+
+protected:
+    /* returns the section that was running before */
+    static int enter(int section);
+
+    static bool timing;
+    static bool spriteCounts;
+    static unsigned int spriteHits;
+    static unsigned int spriteMisses;
+};
+
+/* The overlays that the console commands turn on and off. Each one only
+ * collects its data while it is shown. Numbers are averaged over a second
+ * worth of ticks so they can actually be read.
+ */
+class PerformanceOverlay{
+public:
+    PerformanceOverlay();
+    virtual ~PerformanceOverlay();
+
+    enum Kind{
+        Timing,
+        Objects,
+        Sprites,
+        Heap,
+        MaxKind
+    };
+
+    /* returns true if the overlay is now shown */
+    bool toggle(Kind kind);
+    bool isShown(Kind kind) const;
+
+    /* Call once per logic tick */
+    void logic(const Stage & stage);
+    /* Call once per rendered frame */
+    void frame();
+
+    void draw(const Graphics::Bitmap & screen);
+
+protected:
+    void publish();
+
+    bool shown[MaxKind];
+
+    unsigned int ticks;
+    unsigned int frames;
+
+    /* averages from the last full second, in milliseconds */
+    double sectionTime[Profile::MaxSection];
+
+    int helpers;
+    int explods;
+    int projectiles;
+
+    unsigned int spriteHits;
+    unsigned int spriteMisses;
+
+    unsigned long heap;
+};
+
+}
+
+#endif
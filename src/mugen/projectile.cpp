@@ -83,18 +83,18 @@ void Projectile::draw(const Graphics::Bitmap & work, double x, double y){
     }
 }
     
-const std::vector<Area> Projectile::getAttackBoxes() const {
+const AreaList Projectile::getAttackBoxes() const {
     if (!shouldRemove && animation != NULL){
         return animation->getAttackBoxes(facing == FacingLeft, scaleX, scaleY);
     }
-    return vector<Area>();
+    return AreaList();
 }
     
-const std::vector<Area> Projectile::getDefenseBoxes() const {
+const AreaList Projectile::getDefenseBoxes() const {
     if (!shouldRemove && animation != NULL){
         return animation->getDefenseBoxes(facing == FacingLeft, scaleX, scaleY);
     }
-    return vector<Area>();
+    return AreaList();
 }
     
 void Projectile::doCollision(Object * mugen, const Stage & stage){
@@ -63,8 +63,8 @@ public:
 
     virtual const CharacterId & getOwner() const;
         
-    const std::vector<Area> getAttackBoxes() const;
-    const std::vector<Area> getDefenseBoxes() const;
+    const AreaList getAttackBoxes() const;
+    const AreaList getDefenseBoxes() const;
 
     void doCollision(Object * mugen, const Stage & stage);
     void wasGuarded(Object * mugen, const Stage & stage);
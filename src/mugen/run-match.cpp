@@ -1,5 +1,6 @@
 #include <string>
 #include <ostream>
+#include <fstream>
 
 #include <r-tech1/graphics/bitmap.h>
 #include <r-tech1/sound/music.h>
@@ -12,12 +13,16 @@
 #include "game.h"
 #include "stage.h"
 #include "factory/font_render.h"
+#include "factory/presenter.h"
 #include "options.h"
 #include "behavior.h"
 #include "exception.h"
 #include "config.h"
 #include "character.h"
 #include "world.h"
+#include "frame-data.h"
+#include "profile.h"
+#include "trace.h"
 
 using std::string;
 using std::ostringstream;
@@ -330,18 +335,20 @@ static Token * filterTokens(Token * start){
 
 class LogicDraw: public PaintownUtil::Logic, public PaintownUtil::Draw {
     public:
-        LogicDraw(Mugen::Stage * stage, bool & show_fps, Console::Console & console, RunMatchOptions & options):
+        LogicDraw(Mugen::Stage * stage, bool & show_fps, Console::Console & console, PerformanceOverlay & performance, RunMatchOptions & options):
         endMatch(false),
         gameSpeed(Data::getInstance().getGameSpeed()),
         stage(stage),
         show_fps(show_fps),
         console(console),
+        performance(performance),
         gameTicks(0),
         totalTicks(0),
         options(options),
         show(true),
         showGameSpeed(0),
-        escapeMenu(options){
+        escapeMenu(options),
+        presenter(DEFAULT_WIDTH, DEFAULT_HEIGHT){
             gameInput.set(Keyboard::Key_F1, SlowDown);
             gameInput.set(Keyboard::Key_F2, SpeedUp);
             gameInput.set(Keyboard::Key_F3, NormalSpeed);
@@ -388,6 +395,7 @@ class LogicDraw: public PaintownUtil::Logic, public PaintownUtil::Draw {
         Mugen::Stage * stage;
         bool & show_fps;
         Console::Console & console;
+        PerformanceOverlay & performance;
         /* global info messages will appear in the console */
         MessageQueue messages;
     
@@ -412,6 +420,8 @@ class LogicDraw: public PaintownUtil::Logic, public PaintownUtil::Draw {
         int showGameSpeed;
         
         EscapeMenu escapeMenu;
+        /* keeps the work surfaces and the upscale thread between frames */
+        Presenter presenter;
 
         void doReplay(){
             if (replay.enabled){
@@ -605,6 +615,7 @@ class LogicDraw: public PaintownUtil::Logic, public PaintownUtil::Draw {
                     if (observer != NULL){
                         observer->afterLogic(*stage);
                     }
+                    performance.logic(*stage);
                 }
             }
             /* Check if some time actually passed */
@@ -664,21 +675,36 @@ class LogicDraw: public PaintownUtil::Logic, public PaintownUtil::Draw {
                 }
             }
 
+            PaintownUtil::ReferenceCount<StageObserver> observer = stage->getObserver();
+            performance.frame();
             if (stage->isZoomed()){
-                Graphics::Bitmap work(DEFAULT_WIDTH, DEFAULT_HEIGHT);
-                stage->render(&work);
+                Graphics::Bitmap & work = presenter.surface();
+                work.clear();
+                {
+                    Profile::Scope renderTime(Profile::Render);
+                    stage->render(&work);
+                }
+                if (observer != NULL){
+                    observer->draw(*stage, work);
+                }
                 // Global::debug(0) << "X1 " << stage->zoomX1() << " Y1 " << stage->zoomY1() << " X2 " << stage->zoomX2() << " Y2 " << stage->zoomY2() << std::endl;
                 work.Stretch(screen, stage->zoomX1(), stage->zoomY1(), stage->zoomX2() - stage->zoomX1(), stage->zoomY2() - stage->zoomY1(), 0, 0, screen.getWidth(), screen.getHeight());
             } else {
-                Graphics::StretchedBitmap work(DEFAULT_WIDTH, DEFAULT_HEIGHT, screen, Graphics::StretchedBitmap::NoClear, Graphics::qualityFilterName(::Configuration::getQualityFilter()));
-                work.start();
-                stage->render(&work);
+                Graphics::Bitmap & work = presenter.start(screen);
+                {
+                    Profile::Scope renderTime(Profile::Render);
+                    stage->render(&work);
+                }
+                if (observer != NULL){
+                    observer->draw(*stage, work);
+                }
                 options.draw(work);
-                work.finish();
+                presenter.finish(screen);
             }
 
             FontRender * render = FontRender::getInstance();
             render->render(&screen);
+            performance.draw(screen);
             console.draw(screen);
             if (showGameSpeed > 0){
                 const ::Font & font = ::Font::getDefaultFont(15, 15);
@@ -729,6 +755,7 @@ void Game::runMatch(Mugen::Stage * stage, const std::string & musicOverride, Run
     */
 
     Console::Console console(150);
+    PerformanceOverlay performance;
     {
         class CommandQuit: public Console::Command {
         public:
@@ -897,6 +924,97 @@ void Game::runMatch(Mugen::Stage * stage, const std::string & musicOverride, Run
             }
         };
 
+        class CommandFrameData: public Console::Command {
+        public:
+            CommandFrameData(Mugen::Stage * stage):
+            stage(stage){
+            }
+
+            Mugen::Stage * stage;
+
+            string getDescription() const {
+                return "frame-data - Show/hide hitboxes and frame data";
+            }
+
+            string act(const string & line){
+                PaintownUtil::ReferenceCount<StageObserver> observer = stage->getObserver();
+                if (observer == NULL){
+                    stage->setObserver(PaintownUtil::ReferenceCount<StageObserver>(new FrameDataObserver()));
+                    return "Frame data enabled";
+                }
+
+                /* Don't replace some other observer, like the network one */
+                if (dynamic_cast<FrameDataObserver*>(observer.raw()) != NULL){
+                    stage->setObserver(PaintownUtil::ReferenceCount<StageObserver>(NULL));
+                    return "Frame data disabled";
+                }
+
+                return "Frame data is not available";
+            }
+        };
+
+        class CommandOverlay: public Console::Command {
+        public:
+            CommandOverlay(PerformanceOverlay & performance, PerformanceOverlay::Kind kind, const string & description, const string & name):
+            performance(performance),
+            kind(kind),
+            description(description),
+            name(name){
+            }
+
+            PerformanceOverlay & performance;
+            PerformanceOverlay::Kind kind;
+            string description;
+            string name;
+
+            string getDescription() const {
+                return description;
+            }
+
+            string act(const string & line){
+                if (performance.toggle(kind)){
+                    return name + " enabled";
+                }
+                return name + " disabled";
+            }
+        };
+
+        class CommandTrace: public Console::Command {
+        public:
+            string getDescription() const {
+                return "trace [level | dump [file]] - Set the trace level, 0 is off, or write the trace to a file";
+            }
+
+            string act(const string & line){
+                std::istringstream input(line);
+                string command;
+                string argument;
+                input >> command >> argument;
+
+                if (argument == "dump"){
+                    string file = "mugen-trace.txt";
+                    input >> file;
+                    std::ofstream out(file.c_str());
+                    if (!out){
+                        return "Could not write to " + file;
+                    }
+                    Trace::dump(out);
+                    return "Wrote the trace to " + file;
+                }
+
+                std::istringstream number(argument);
+                int level = 0;
+                if (!(number >> level)){
+                    /* no level toggles between off and everything */
+                    level = Trace::getLevel() == 0 ? MUGEN_TRACE_MAXIMUM : 0;
+                }
+                Trace::setLevel(level);
+                std::ostringstream out;
+                out << "Trace level " << level;
+                return out.str();
+            }
+        };
+
         console.addCommand("quit", PaintownUtil::ReferenceCount<Console::Command>(new CommandQuit()));
         console.addAlias("exit", "quit");
         console.addCommand("help", PaintownUtil::ReferenceCount<Console::Command>(new CommandHelp(console)));
@@ -905,11 +1023,17 @@ void Game::runMatch(Mugen::Stage * stage, const std::string & musicOverride, Run
         console.addCommand("record", PaintownUtil::ReferenceCount<Console::Command>(new CommandRecord(stage)));
         console.addCommand("debug", PaintownUtil::ReferenceCount<Console::Command>(new CommandDebug(stage)));
         console.addCommand("change-state", PaintownUtil::ReferenceCount<Console::Command>(new CommandChangeState(stage)));
+        console.addCommand("frame-data", PaintownUtil::ReferenceCount<Console::Command>(new CommandFrameData(stage)));
+        console.addCommand("profile", PaintownUtil::ReferenceCount<Console::Command>(new CommandOverlay(performance, PerformanceOverlay::Timing, "profile - Show/hide time per tick spent in triggers, controllers, physics, collision and rendering", "Profiling")));
+        console.addCommand("objects", PaintownUtil::ReferenceCount<Console::Command>(new CommandOverlay(performance, PerformanceOverlay::Objects, "objects - Show/hide the number of live helpers, explods and projectiles", "Object counts")));
+        console.addCommand("sprites", PaintownUtil::ReferenceCount<Console::Command>(new CommandOverlay(performance, PerformanceOverlay::Sprites, "sprites - Show/hide the sprite cache hit rate", "Sprite cache stats")));
+        console.addCommand("heap", PaintownUtil::ReferenceCount<Console::Command>(new CommandOverlay(performance, PerformanceOverlay::Heap, "heap - Show/hide memory usage", "Memory usage")));
+        console.addCommand("trace", PaintownUtil::ReferenceCount<Console::Command>(new CommandTrace()));
     }
 
     bool show_fps = false;
 
-    LogicDraw all(stage, show_fps, console, options);
+    LogicDraw all(stage, show_fps, console, performance, options);
 
     PaintownUtil::standardLoop(all, all);
 }
@@ -1,10 +1,12 @@
 #include <r-tech1/file-system.h>
 #include "search.h"
 #include "config.h"
+#include "directory-watch.h"
 #include <r-tech1/debug.h>
 
 #include <algorithm>
 #include <iostream>
+#include <set>
 #include <vector>
 
 using std::endl;
@@ -18,13 +20,84 @@ Searcher::Subscriber::Subscriber(){
 Searcher::Subscriber::~Subscriber(){
 }
 
+void Searcher::Subscriber::removeCharacters(const std::vector<Filesystem::AbsolutePath> & paths){
+}
+
+void Searcher::Subscriber::removeStages(const std::vector<Filesystem::AbsolutePath> & paths){
+}
+
+Searcher::Snapshot::Shared::Shared(const vector<Filesystem::AbsolutePath> & paths):
+paths(paths),
+count(1){
+}
+
+Searcher::Snapshot::Snapshot():
+shared(NULL){
+}
+
+Searcher::Snapshot::Snapshot(const vector<Filesystem::AbsolutePath> & paths):
+shared(new Shared(paths)){
+}
+
+Searcher::Snapshot::Snapshot(const Snapshot & copy):
+shared(copy.shared){
+    if (shared != NULL){
+        __sync_add_and_fetch(&shared->count, 1);
+    }
+}
+
+Searcher::Snapshot & Searcher::Snapshot::operator=(const Snapshot & copy){
+    if (copy.shared != NULL){
+        __sync_add_and_fetch(&copy.shared->count, 1);
+    }
+    release();
+    shared = copy.shared;
+    return *this;
+}
+
+Searcher::Snapshot::~Snapshot(){
+    release();
+}
+
+void Searcher::Snapshot::release(){
+    if (shared != NULL && __sync_sub_and_fetch(&shared->count, 1) == 0){
+        delete shared;
+    }
+    shared = NULL;
+}
+
+const vector<Filesystem::AbsolutePath> & Searcher::Snapshot::operator*() const {
+    return shared->paths;
+}
+
+const vector<Filesystem::AbsolutePath> * Searcher::Snapshot::operator->() const {
+    return &shared->paths;
+}
+
+bool Searcher::Snapshot::operator==(const void * what) const {
+    if (shared == NULL){
+        return what == NULL;
+    }
+    return what == &shared->paths;
+}
+
+bool Searcher::Snapshot::operator!=(const void * what) const {
+    return !(*this == what);
+}
+
 Searcher::Searcher():
 characterSearch(*this),
 stageSearch(*this){
 }
 
+Searcher::Searcher(const vector<Filesystem::AbsolutePath> & characterPaths, const vector<Filesystem::AbsolutePath> & stagePaths):
+characterSearch(*this, characterPaths),
+stageSearch(*this, stagePaths){
+}
+
 Searcher::~Searcher(){
     characterSearch.pause();
+    stageSearch.pause();
 }
     
 void Searcher::start(){
@@ -47,10 +120,47 @@ void Searcher::start(){
     */
 }
     
+bool Searcher::charactersDone(){
+    return characterSearch.done();
+}
+
 bool Searcher::stagesDone(){
     return stageSearch.done();
 }
 
+Searcher::Snapshot Searcher::getCharacters(){
+    PaintownUtil::Thread::ScopedLock scoped(publishLock);
+    if (characterSnapshot == NULL){
+        characterSnapshot = makeSnapshot(characters);
+    }
+    return characterSnapshot;
+}
+
+Searcher::Snapshot Searcher::getStages(){
+    PaintownUtil::Thread::ScopedLock scoped(publishLock);
+    if (stageSnapshot == NULL){
+        stageSnapshot = makeSnapshot(stages);
+    }
+    return stageSnapshot;
+}
+
+/* hold the publish lock when this method is called */
+Searcher::Snapshot Searcher::makeSnapshot(const vector<Filesystem::AbsolutePath> & files){
+    return Snapshot(files);
+}
+
+static void removeFiles(vector<Filesystem::AbsolutePath> & from, const vector<Filesystem::AbsolutePath> & files){
+    std::set<Filesystem::AbsolutePath> gone(files.begin(), files.end());
+    vector<Filesystem::AbsolutePath> kept;
+    kept.reserve(from.size());
+    for (vector<Filesystem::AbsolutePath>::iterator it = from.begin(); it != from.end(); it++){
+        if (gone.find(*it) == gone.end()){
+            kept.push_back(*it);
+        }
+    }
+    from.swap(kept);
+}
+
 void Searcher::pause(){
     characterSearch.pause();
     stageSearch.pause();
@@ -77,53 +187,77 @@ bool Searcher::existsSubscription(Subscriber * who){
 }
 
 void Searcher::subscribe(Subscriber * who){
-    PaintownUtil::Thread::ScopedLock scoped1(subscriptionLock);
+    PaintownUtil::Thread::ScopedLock scoped(publishLock);
     if (! existsSubscription(who)){
         subscriptions.push_back(who);
 
-        PaintownUtil::Thread::ScopedLock characterScoped(addCharactersLock);
-        PaintownUtil::Thread::ScopedLock stageScoped(addStagesLock);
         who->receiveCharacters(characters);
         who->receiveStages(stages);
     }
 }
 
 void Searcher::unsubscribe(Subscriber * who){
-    PaintownUtil::Thread::ScopedLock lock(subscriptionLock);
+    PaintownUtil::Thread::ScopedLock scoped(publishLock);
     vector<Subscriber*>::iterator which = std::find(subscriptions.begin(), subscriptions.end(), who);
     if (which != subscriptions.end()){
         subscriptions.erase(which);
     }
 }
 
-void Searcher::publishCharacters(const std::vector<Filesystem::AbsolutePath> & files){
-    PaintownUtil::Thread::ScopedLock scoped(subscriptionLock);
+void Searcher::addCharacters(const std::vector<Filesystem::AbsolutePath> & files){
+    if (files.size() == 0){
+        return;
+    }
+
+    PaintownUtil::Thread::ScopedLock scoped(publishLock);
+    characters.insert(characters.end(), files.begin(), files.end());
+    characterSnapshot = Snapshot();
     for (vector<Subscriber*>::iterator it = subscriptions.begin(); it != subscriptions.end(); it++){
         Subscriber * who = *it;
         who->receiveCharacters(files);
     }
 }
 
-void Searcher::publishStages(const std::vector<Filesystem::AbsolutePath> & files){
-    PaintownUtil::Thread::ScopedLock scoped(subscriptionLock);
+void Searcher::removeCharacters(const std::vector<Filesystem::AbsolutePath> & files){
+    if (files.size() == 0){
+        return;
+    }
+
+    PaintownUtil::Thread::ScopedLock scoped(publishLock);
+    removeFiles(characters, files);
+    characterSnapshot = Snapshot();
     for (vector<Subscriber*>::iterator it = subscriptions.begin(); it != subscriptions.end(); it++){
         Subscriber * who = *it;
-        who->receiveStages(files);
+        who->removeCharacters(files);
     }
 }
 
-void Searcher::addCharacters(const std::vector<Filesystem::AbsolutePath> & files){
-    PaintownUtil::Thread::ScopedLock scoped(addCharactersLock);
-    characters.insert(characters.end(), files.begin(), files.end());
+void Searcher::addStages(const std::vector<Filesystem::AbsolutePath> & files){
+    if (files.size() == 0){
+        return;
+    }
 
-    publishCharacters(files);
+    PaintownUtil::Thread::ScopedLock scoped(publishLock);
+    stages.insert(stages.end(), files.begin(), files.end());
+    stageSnapshot = Snapshot();
+    for (vector<Subscriber*>::iterator it = subscriptions.begin(); it != subscriptions.end(); it++){
+        Subscriber * who = *it;
+        who->receiveStages(files);
+    }
 }
 
-void Searcher::addStages(const std::vector<Filesystem::AbsolutePath> & files){
-    PaintownUtil::Thread::ScopedLock scoped(addStagesLock);
-    stages.insert(stages.end(), files.begin(), files.end());
+void Searcher::removeStages(const std::vector<Filesystem::AbsolutePath> & files){
+    if (files.size() == 0){
+        return;
+    }
 
-    publishStages(files);
+    PaintownUtil::Thread::ScopedLock scoped(publishLock);
+    removeFiles(stages, files);
+    stageSnapshot = Snapshot();
+    for (vector<Subscriber*>::iterator it = subscriptions.begin(); it != subscriptions.end(); it++){
+        Subscriber * who = *it;
+        who->removeStages(files);
+    }
 }
 
 static vector<Filesystem::AbsolutePath> findFiles(const Filesystem::AbsolutePath & path, const std::string & extension){
@@ -141,12 +275,31 @@ static vector<Filesystem::AbsolutePath> findFiles(const Filesystem::RelativePath
         return vector<Filesystem::AbsolutePath>();
     }
 }   
+
+/* characters are either a def or a container with a def inside */
+static vector<std::string> characterExtensions(){
+    vector<std::string> extensions;
+    extensions.push_back("def");
+    vector<std::string> containers = Storage::containerTypes();
+    extensions.insert(extensions.end(), containers.begin(), containers.end());
+    return extensions;
+}
+
+/* Once the first search is done the directories are watched so characters
+ * and stages copied in while the game runs show up without a restart. The
+ * directories have to be left alone for WATCH_QUIET milliseconds before the
+ * changes are published.
+ */
+static const uint64_t WATCH_QUIET = 1000;
+/* how often the watch stops waiting to see if the search was paused */
+static const int WATCH_TIMEOUT = 100;
         
 Searcher::CharacterSearch::CharacterSearch(Searcher & owner):
 owner(owner),
 thread(PaintownUtil::Thread::uninitializedValue),
 searching(false),
-searchingCheck(searching, searchingLock.getLock()){
+searchingCheck(searching, searchingLock.getLock()),
+isDone(false){
     /* data/<motif>/chars */
     try{
         paths.push_back(Data::getInstance().getMotifDirectory().join(Filesystem::RelativePath("chars")));
@@ -164,6 +317,18 @@ searchingCheck(searching, searchingLock.getLock()){
         paths.push_back(Storage::instance().userDirectory().join(Filesystem::RelativePath("mugen/chars")));
     } catch (const Filesystem::NotFound & fail){
     }
+
+    roots = paths;
+}
+
+Searcher::CharacterSearch::CharacterSearch(Searcher & owner, const vector<Filesystem::AbsolutePath> & paths):
+owner(owner),
+thread(PaintownUtil::Thread::uninitializedValue),
+paths(paths),
+roots(paths),
+searching(false),
+searchingCheck(searching, searchingLock.getLock()),
+isDone(false){
 }
 
 void Searcher::CharacterSearch::search(){
@@ -173,12 +338,46 @@ void Searcher::CharacterSearch::search(){
     while (paths.size() > 0 && searchingCheck.get()){
         Filesystem::AbsolutePath path = paths.front();
         paths.erase(paths.begin());
-        owner.addCharacters(findFiles(path, "def"));
-        vector<std::string> containers = Storage::containerTypes();
-        for (vector<std::string>::iterator it = containers.begin(); it != containers.end(); it++){
-            owner.addCharacters(findFiles(path, *it));
+        /* publish the whole directory as one batch */
+        vector<Filesystem::AbsolutePath> found;
+        vector<std::string> extensions = characterExtensions();
+        for (vector<std::string>::iterator it = extensions.begin(); it != extensions.end(); it++){
+            vector<Filesystem::AbsolutePath> more = findFiles(path, *it);
+            found.insert(found.end(), more.begin(), more.end());
         }
+        owner.addCharacters(found);
     }
+
+    {
+        PaintownUtil::Thread::ScopedLock scoped1(searchingLock);
+        isDone = paths.size() == 0;
+        if (!isDone){
+            return;
+        }
+    }
+
+    watchForChanges();
+}
+
+void Searcher::CharacterSearch::watchForChanges(){
+    if (watch == NULL){
+        watch = PaintownUtil::ReferenceCount<DirectoryWatch>(new DirectoryWatch(roots, characterExtensions(), WATCH_QUIET));
+        watch->setKnown(*owner.getCharacters());
+    }
+
+    while (searchingCheck.get()){
+        vector<Filesystem::AbsolutePath> added;
+        vector<Filesystem::AbsolutePath> removed;
+        if (watch->check(WATCH_TIMEOUT, added, removed)){
+            owner.removeCharacters(removed);
+            owner.addCharacters(added);
+        }
+    }
+}
+
+bool Searcher::CharacterSearch::done(){
+    PaintownUtil::Thread::ScopedLock scoped1(searchingLock);
+    return isDone;
 }
 
 void * Searcher::CharacterSearch::runSearch(void * self_){
@@ -228,6 +427,8 @@ isDone(false){
         paths.push_back(Storage::instance().userDirectory().join(Filesystem::RelativePath("mugen/stages")));
     } catch (const Filesystem::NotFound & fail){
     }
+
+    roots = paths;
 }
 
 void Searcher::StageSearch::start(){
@@ -247,6 +448,16 @@ void Searcher::StageSearch::pause(){
     }
 }
 
+Searcher::StageSearch::StageSearch(Searcher & owner, const vector<Filesystem::AbsolutePath> & paths):
+owner(owner),
+thread(PaintownUtil::Thread::uninitializedValue),
+paths(paths),
+roots(paths),
+searching(false),
+searchingCheck(searching, searchingLock.getLock()),
+isDone(false){
+}
+
 Searcher::StageSearch::~StageSearch(){
     pause();
 }
@@ -269,8 +480,31 @@ void Searcher::StageSearch::search(){
         owner.addStages(findFiles(path, "def"));
     }
 
-    PaintownUtil::Thread::ScopedLock scoped1(searchingLock);
-    isDone = paths.size() == 0;
+    {
+        PaintownUtil::Thread::ScopedLock scoped1(searchingLock);
+        isDone = paths.size() == 0;
+        if (!isDone){
+            return;
+        }
+    }
+
+    watchForChanges();
+}
+
+void Searcher::StageSearch::watchForChanges(){
+    if (watch == NULL){
+        watch = PaintownUtil::ReferenceCount<DirectoryWatch>(new DirectoryWatch(roots, vector<std::string>(1, "def"), WATCH_QUIET));
+        watch->setKnown(*owner.getStages());
+    }
+
+    while (searchingCheck.get()){
+        vector<Filesystem::AbsolutePath> added;
+        vector<Filesystem::AbsolutePath> removed;
+        if (watch->check(WATCH_TIMEOUT, added, removed)){
+            owner.removeStages(removed);
+            owner.addStages(added);
+        }
+    }
 }
 
 }
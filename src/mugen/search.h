@@ -4,6 +4,7 @@
 #include <vector>
 
 #include <r-tech1/thread.h>
+#include <r-tech1/pointer.h>
 #include <r-tech1/file-system.h>
 
 namespace PaintownUtil = ::Util;
@@ -12,26 +13,79 @@ namespace PaintownUtil = ::Util;
 
 namespace Mugen{
 
+class DirectoryWatch;
+
 class Searcher{
 public:
     Searcher();
+    /* search only the given directories instead of the usual chars/stages */
+    Searcher(const std::vector<Filesystem::AbsolutePath> & characterPaths, const std::vector<Filesystem::AbsolutePath> & stagePaths);
     virtual ~Searcher();
 
+    /* Everything found so far. A snapshot is never modified once it has been
+     * published, newly found paths go into a new snapshot, so its contents can
+     * be read without holding any lock. Copies share the paths and the last
+     * one to go away frees them. Snapshots are passed between the search
+     * threads and the game so the count is changed atomically.
+     */
+    class Snapshot{
+    public:
+        /* holds no paths, compares equal to NULL */
+        Snapshot();
+        Snapshot(const Snapshot & copy);
+        Snapshot & operator=(const Snapshot & copy);
+        virtual ~Snapshot();
+
+        const std::vector<Filesystem::AbsolutePath> & operator*() const;
+        const std::vector<Filesystem::AbsolutePath> * operator->() const;
+
+        bool operator==(const void * what) const;
+        bool operator!=(const void * what) const;
+
+    protected:
+        friend class Searcher;
+        explicit Snapshot(const std::vector<Filesystem::AbsolutePath> & paths);
+
+        void release();
+
+        struct Shared{
+            Shared(const std::vector<Filesystem::AbsolutePath> & paths);
+
+            const std::vector<Filesystem::AbsolutePath> paths;
+            volatile int count;
+        };
+
+        Shared * shared;
+    };
+
     /* gets updates from the searcher */
     class Subscriber{
     public:
         Subscriber();
         virtual ~Subscriber();
 
-        /* receive data from the searcher */
+        /* receive data from the searcher. These are called while the searcher
+         * holds its publish lock so they should only queue the paths.
+         */
         virtual void receiveCharacters(const std::vector<Filesystem::AbsolutePath> & paths) = 0;
 
         virtual void receiveStages(const std::vector<Filesystem::AbsolutePath> & paths) = 0;
+
+        /* files that were deleted after being received, does nothing by default */
+        virtual void removeCharacters(const std::vector<Filesystem::AbsolutePath> & paths);
+        virtual void removeStages(const std::vector<Filesystem::AbsolutePath> & paths);
     };
 
+    bool charactersDone();
     bool stagesDone();
 
-    /* either start searching or unpause */
+    Snapshot getCharacters();
+    Snapshot getStages();
+
+    /* Either start searching or unpause. Once everything was searched the
+     * directories are watched for characters and stages being added or
+     * removed until the searcher is paused.
+     */
     void start();
     /* pause searching */
     void pause();
@@ -39,33 +93,41 @@ public:
     void subscribe(Subscriber * who);
     void unsubscribe(Subscriber * who);
 
-    // std::vector<Filesystem::AbsolutePath> characters
-
 protected:
 
     /* Saves the search state so it can be paused/resumed */
     class CharacterSearch{
     public:
         CharacterSearch(Searcher & owner);
+        CharacterSearch(Searcher & owner, const std::vector<Filesystem::AbsolutePath> & paths);
         void start();
         void pause();
+        /* True if there are no more paths to search */
+        bool done();
         virtual ~CharacterSearch();
 
         Searcher & owner;
         PaintownUtil::Thread::Id thread;
         std::vector<Filesystem::AbsolutePath> paths;
+        /* all the paths, paths is emptied by the search */
+        std::vector<Filesystem::AbsolutePath> roots;
         volatile bool searching;
         /* Searching lock *must be* initialized before searchingCheck */
         PaintownUtil::Thread::LockObject searchingLock;
         PaintownUtil::ThreadBoolean searchingCheck;
+        bool isDone;
+
+        PaintownUtil::ReferenceCount<DirectoryWatch> watch;
 
         static void * runSearch(void * self_);
         void search();
+        void watchForChanges();
     };
 
     class StageSearch{
     public:
         StageSearch(Searcher & owner);
+        StageSearch(Searcher & owner, const std::vector<Filesystem::AbsolutePath> & paths);
         void start();
         void pause();
         /* True if there are no more paths to search */
@@ -75,14 +137,19 @@ protected:
         Searcher & owner;
         PaintownUtil::Thread::Id thread;
         std::vector<Filesystem::AbsolutePath> paths;
+        /* all the paths, paths is emptied by the search */
+        std::vector<Filesystem::AbsolutePath> roots;
         volatile bool searching;
         /* Searching lock *must be* initialized before searchingCheck */
         PaintownUtil::Thread::LockObject searchingLock;
         PaintownUtil::ThreadBoolean searchingCheck;
         bool isDone;
 
+        PaintownUtil::ReferenceCount<DirectoryWatch> watch;
+
         static void * runSearch(void * self_);
         void search();
+        void watchForChanges();
     };
 
     CharacterSearch characterSearch;
@@ -90,21 +157,27 @@ protected:
 
     static void * searchForCharacters(void * arg);
     static void * searchStages(void * arg);
+    /* publish a batch of paths found in one directory */
     void addCharacters(const std::vector<Filesystem::AbsolutePath> & files);
     void addStages(const std::vector<Filesystem::AbsolutePath> & files);
+    void removeCharacters(const std::vector<Filesystem::AbsolutePath> & files);
+    void removeStages(const std::vector<Filesystem::AbsolutePath> & files);
     bool existsSubscription(Subscriber * who);
+    Snapshot makeSnapshot(const std::vector<Filesystem::AbsolutePath> & files);
 
-    void publishCharacters(const std::vector<Filesystem::AbsolutePath> & files);
-    void publishStages(const std::vector<Filesystem::AbsolutePath> & files);
-        
-    PaintownUtil::Thread::LockObject addCharactersLock;
+    /* Guards everything below. It is only held long enough to update the
+     * paths and hand the batch to the subscribers.
+     */
+    PaintownUtil::Thread::LockObject publishLock;
     std::vector<Filesystem::AbsolutePath> characters;
-    
-    PaintownUtil::Thread::LockObject addStagesLock;
     std::vector<Filesystem::AbsolutePath> stages;
-
-    PaintownUtil::Thread::LockObject subscriptionLock;
     std::vector<Subscriber*> subscriptions;
+
+    /* The last snapshots handed out, NULL once the paths change. A new one
+     * is only made when somebody asks for it.
+     */
+    Snapshot characterSnapshot;
+    Snapshot stageSnapshot;
 };
 
 }
@@ -0,0 +1,227 @@
+#include <r-tech1/debug.h>
+#include <r-tech1/file-system.h>
+#include <r-tech1/funcs.h>
+#include <r-tech1/graphics/bitmap.h>
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "sff.h"
+#include "exception.h"
+
+namespace PaintownUtil = ::Util;
+
+using std::endl;
+using std::map;
+using std::string;
+using std::vector;
+
+namespace Mugen{
+namespace Sff{
+
+static void usage(){
+    Global::debug(0) << "Usage: mugen:sff <command> <file.sff> [arguments]" << endl;
+    Global::debug(0) << "  list <file.sff> : list the sprites and palettes" << endl;
+    Global::debug(0) << "  extract <file.sff> <directory> : write every sprite as group-item.png into an existing directory" << endl;
+    Global::debug(0) << "  verify <file.sff> : decode every sprite and report the ones that fail" << endl;
+    Global::debug(0) << "  bench <file.sff> : report the decode speed of each sprite format" << endl;
+    Global::debug(0) << "  repack <file.sff> <output.sff> : convert an sffv1 file to sffv2 with duplicate sprites linked" << endl;
+}
+
+static string describeSprite(const SpriteInfo & sprite){
+    std::ostringstream out;
+    out << sprite.index << ": " << sprite.group << ", " << sprite.item << " " << sprite.width << "x" << sprite.height << " axis " << sprite.axisX << ", " << sprite.axisY;
+    if (sprite.linked != -1){
+        out << " linked to " << sprite.linked;
+    } else {
+        out << " " << sprite.format << " " << sprite.length << " bytes";
+    }
+    if (sprite.palette != -1){
+        out << " palette " << sprite.palette;
+    }
+    return out.str();
+}
+
+static void listContents(const Filesystem::AbsolutePath & path){
+    Contents contents = describe(path);
+    Global::debug(0) << path.path() << ": SFF version " << contents.version << ", " << contents.sprites.size() << " sprites, " << contents.palettes.size() << " palettes" << endl;
+    for (vector<SpriteInfo>::iterator it = contents.sprites.begin(); it != contents.sprites.end(); it++){
+        Global::debug(0) << "  sprite " << describeSprite(*it) << endl;
+    }
+
+    for (vector<PaletteInfo>::iterator it = contents.palettes.begin(); it != contents.palettes.end(); it++){
+        const PaletteInfo & palette = *it;
+        if (palette.linked != -1){
+            Global::debug(0) << "  palette " << palette.index << ": " << palette.group << ", " << palette.item << " linked to " << palette.linked << endl;
+        } else {
+            Global::debug(0) << "  palette " << palette.index << ": " << palette.group << ", " << palette.item << " " << palette.colors << " colors" << endl;
+        }
+    }
+}
+
+/* 1 if any sprite could not be written */
+static int extract(const Filesystem::AbsolutePath & path, const string & directory){
+    class Extract: public Visitor {
+    public:
+        Extract(const string & directory):
+        directory(directory),
+        written(0),
+        failures(0){
+        }
+
+        const string directory;
+        int written;
+        int failures;
+
+        virtual void decoded(const SpriteInfo & sprite, const Graphics::Bitmap & image, uint64_t microseconds){
+            std::ostringstream name;
+            name << directory << "/" << sprite.group << "-" << sprite.item << ".png";
+            Graphics::Bitmap copy(image);
+            copy.save(name.str());
+            written += 1;
+        }
+
+        virtual void failed(const SpriteInfo & sprite, const string & reason){
+            Global::debug(0) << "Could not decode sprite " << describeSprite(sprite) << ": " << reason << endl;
+            failures += 1;
+        }
+    };
+
+    Extract visitor(directory);
+    decode(path, visitor);
+    Global::debug(0) << "Wrote " << visitor.written << " sprites to " << directory << ", " << visitor.failures << " could not be decoded" << endl;
+    return visitor.failures == 0 ? 0 : 1;
+}
+
+/* 1 if any sprite failed to decode */
+static int verify(const Filesystem::AbsolutePath & path){
+    class Verify: public Visitor {
+    public:
+        Verify():
+        good(0),
+        failures(0){
+        }
+
+        int good;
+        int failures;
+
+        virtual void decoded(const SpriteInfo & sprite, const Graphics::Bitmap & image, uint64_t microseconds){
+            if (image.getWidth() != sprite.width || image.getHeight() != sprite.height){
+                std::ostringstream out;
+                out << "decoded to " << image.getWidth() << "x" << image.getHeight();
+                failed(sprite, out.str());
+                return;
+            }
+            good += 1;
+        }
+
+        virtual void failed(const SpriteInfo & sprite, const string & reason){
+            Global::debug(0) << "Bad sprite " << describeSprite(sprite) << ": " << reason << endl;
+            failures += 1;
+        }
+    };
+
+    Verify visitor;
+    decode(path, visitor);
+    if (visitor.failures == 0){
+        Global::debug(0) << path.path() << ": all " << visitor.good << " sprites decoded" << endl;
+        return 0;
+    }
+
+    Global::debug(0) << path.path() << ": " << visitor.failures << " of " << (visitor.good + visitor.failures) << " sprites failed to decode" << endl;
+    return 1;
+}
+
+/* Decoding time of one sprite format. Has to be outside of benchmark() to be
+ * used in a map.
+ */
+struct FormatTotals{
+    FormatTotals():
+    sprites(0),
+    bytes(0),
+    pixels(0),
+    microseconds(0){
+    }
+
+    int sprites;
+    uint64_t bytes;
+    uint64_t pixels;
+    uint64_t microseconds;
+};
+
+static void benchmark(const Filesystem::AbsolutePath & path){
+    class Benchmark: public Visitor {
+    public:
+        map<string, FormatTotals> formats;
+
+        virtual void decoded(const SpriteInfo & sprite, const Graphics::Bitmap & image, uint64_t microseconds){
+            /* linked sprites are just a copy so they would make the
+             * format look faster than it is
+             */
+            string format = sprite.linked != -1 ? "linked" : sprite.format;
+            FormatTotals & totals = formats[format];
+            totals.sprites += 1;
+            totals.bytes += sprite.length;
+            totals.pixels += sprite.width * sprite.height;
+            totals.microseconds += microseconds;
+        }
+
+        virtual void failed(const SpriteInfo & sprite, const string & reason){
+        }
+    };
+
+    Benchmark visitor;
+    decode(path, visitor);
+    for (map<string, FormatTotals>::iterator it = visitor.formats.begin(); it != visitor.formats.end(); it++){
+        const FormatTotals & totals = it->second;
+        double seconds = totals.microseconds / 1000000.0;
+        std::ostringstream out;
+        out << it->first << ": " << totals.sprites << " sprites, " << PaintownUtil::niceSize(totals.bytes) << " in " << (totals.microseconds / 1000.0) << "ms";
+        if (seconds > 0){
+            out << ", " << (totals.sprites / seconds) << " sprites/s, " << (totals.pixels / seconds / 1000000.0) << " megapixels/s";
+        }
+        Global::debug(0) << out.str() << endl;
+    }
+}
+
+int runTool(const vector<string> & arguments){
+    if (arguments.size() < 2){
+        usage();
+        return 1;
+    }
+
+    const string & command = arguments[0];
+    const Filesystem::AbsolutePath path(arguments[1]);
+
+    try{
+        if (command == "list"){
+            listContents(path);
+            return 0;
+        } else if (command == "extract" && arguments.size() == 3){
+            return extract(path, arguments[2]);
+        } else if (command == "verify"){
+            return verify(path);
+        } else if (command == "bench"){
+            benchmark(path);
+            return 0;
+        } else if (command == "repack" && arguments.size() == 3){
+            RepackResult result = repack(path, arguments[2]);
+            Global::debug(0) << "Wrote " << arguments[2] << ": " << result.sprites << " sprites, " << result.linked << " were already linked and " << result.deduplicated << " more were linked as duplicates, " << result.palettes << " palettes, " << PaintownUtil::niceSize(result.size) << endl;
+            return 0;
+        }
+    } catch (const MugenException & fail){
+        Global::debug(0) << "Error: " << fail.getReason() << endl;
+        return 1;
+    } catch (const Filesystem::Exception & fail){
+        Global::debug(0) << "Error: " << fail.getTrace() << endl;
+        return 1;
+    }
+
+    usage();
+    return 1;
+}
+
+}
+}
@@ -4,8 +4,11 @@
 
 #include "util.h"
 #include "sprite.h"
+#include "sff.h"
+#include "profile.h"
 
 #include <sstream>
+#include <fstream>
 #include <map>
 #include <string>
 #include <vector>
@@ -49,6 +52,7 @@ public:
         if (readPalette(palette, palsave1)){
             useact = true;
         }
+        actCurrent = useact;
 
         /* 16 skips the header stuff */
         sffStream = Storage::instance().open(filename);
@@ -142,13 +146,30 @@ public:
                 }
                 sprite->copyImage(temp);
             } else {
-                bool islinked = false;
-                sprite->loadPCX(sffStream, islinked, useact, palsave1, mask);
+                loadPCX(sprite, mask);
             }
         }
         return sprite;
     }
 
+    /* Sprites that end up with the act palette are marked so the palette can
+     * be changed later without reading the file again. The act palette
+     * carries on until a sprite brings its own.
+     */
+    void loadPCX(const PaintownUtil::ReferenceCount<Mugen::SpriteV1> & sprite, bool mask){
+        bool islinked = false;
+        bool isAct = sprite->getGroupNumber() == 0 && sprite->getImageNumber() == 0;
+        bool shared = sprite->getSamePalette() || (useact && isAct);
+        sprite->loadPCX(sffStream, islinked, useact, palsave1, mask);
+        if (useact && sprite->getGroupNumber() != 9000){
+            if (shared){
+                sprite->setActPalette(actCurrent);
+            } else {
+                actCurrent = false;
+            }
+        }
+    }
+
     PaintownUtil::ReferenceCount<Mugen::Sprite> findSprite(int group, int item, bool mask){
         if (spriteIndex.size() == 0){
             quickReadSprites(mask);
@@ -165,7 +186,10 @@ public:
     }
 
     PaintownUtil::ReferenceCount<Mugen::Sprite> readSprite(bool mask){
-        bool islinked = false;
+        return readSpriteV1(mask);
+    }
+
+    PaintownUtil::ReferenceCount<Mugen::SpriteV1> readSpriteV1(bool mask){
         if (location > filesize){
             std::ostringstream out;
             out << "Error in SFF file: " << filename.path() << ". Offset of image (" << location << ") beyond the end of the file (" << filesize << ").";
@@ -185,7 +209,7 @@ public:
             }
             sprite->copyImage(temp);
         } else {
-            sprite->loadPCX(sffStream, islinked, useact, palsave1, mask);
+            loadPCX(sprite, mask);
         }
             
         spriteIndex[currentSprite] = sprite;
@@ -205,6 +229,8 @@ protected:
     int totalSprites;
     map<int, PaintownUtil::ReferenceCount<Mugen::SpriteV1> > spriteIndex;
     bool useact;
+    /* palsave1 still holds the act palette */
+    bool actCurrent;
     int filesize;
     int location;
     uint32_t totalImages;
@@ -309,7 +335,8 @@ public:
 
     SffV2Reader(const Filesystem::AbsolutePath & filename):
     filename(filename),
-    currentSprite(0){
+    currentSprite(0),
+    strict(false){
         /* 16 skips the header stuff */
         sffStream = Storage::instance().open(filename);
         if (!sffStream){
@@ -410,6 +437,15 @@ public:
         return this->sprites;
     }
 
+    const vector<PaletteHeader> & getPalettes() const {
+        return this->palettes;
+    }
+
+    /* throw decoding errors instead of ignoring them */
+    void setStrict(bool strict){
+        this->strict = strict;
+    }
+
     const SpriteHeader & findSpriteHeader(unsigned int index){
         for (vector<SpriteHeader>::iterator it = sprites.begin(); it != sprites.end(); it++){
             const SpriteHeader & sprite = *it;
@@ -485,11 +521,15 @@ public:
                 case 4: readLZ5(reader, length, pixels, sprite.width * sprite.height); break;
                 default: {
                     std::ostringstream out;
-                    out << "Don't understand SffV2 format " << sprite.format;
+                    out << "Don't understand SffV2 format " << (int) sprite.format;
                     throw MugenException(out.str(), __FILE__, __LINE__);
                 }
             }
         } catch (...){
+            if (strict){
+                delete[] pixels;
+                throw;
+            }
             Global::debug(1) << "Ignoring Sffv2 sprite error... " << std::endl;
         }
 
@@ -833,6 +873,8 @@ protected:
     uint32_t tdataLength;
     
     map< int, map<uint8_t, Graphics::Color> > paletteCache;
+
+    bool strict;
 };
 
 struct Image{
@@ -1121,6 +1163,27 @@ void Mugen::Util::readSprites(const Filesystem::AbsolutePath & filename, const F
     }*/
 }
 
+bool Mugen::Util::applyPalette(const Filesystem::AbsolutePath & palette, const Mugen::SpriteMap & sprites){
+    unsigned char colors[768];
+    if (!readPalette(palette, colors)){
+        return false;
+    }
+
+    PaintownUtil::ReferenceCount<Mugen::Palette> act(new Mugen::Palette(colors));
+    bool any = false;
+    for (Mugen::SpriteMap::const_iterator group = sprites.begin(); group != sprites.end(); group++){
+        for (std::map<unsigned int, PaintownUtil::ReferenceCount<Mugen::Sprite> >::const_iterator it = group->second.begin(); it != group->second.end(); it++){
+            Mugen::SpriteV1 * sprite = dynamic_cast<Mugen::SpriteV1*>(it->second.raw());
+            if (sprite != NULL && sprite->usesActPalette()){
+                sprite->setPalette(act);
+                any = true;
+            }
+        }
+    }
+
+    return any;
+}
+
 PaintownUtil::ReferenceCount<Mugen::Sprite> Mugen::Util::probeSff(const Filesystem::AbsolutePath &file, int groupNumber, int spriteNumber, bool mask, const Filesystem::AbsolutePath & actFile){
     PaintownUtil::ReferenceCount<SffReaderInterface> reader = getSffReader(file, actFile);
     PaintownUtil::ReferenceCount<Mugen::Sprite> found = reader->findSprite(groupNumber, spriteNumber, mask);
@@ -1152,3 +1215,396 @@ void Mugen::Util::getIconAndPortrait(const Filesystem::AbsolutePath & sffPath, c
         throw MugenException(out.str(), __FILE__, __LINE__);
     }
 }
+
+namespace Mugen{
+namespace Sff{
+
+SpriteInfo::SpriteInfo():
+index(0),
+group(0),
+item(0),
+width(0),
+height(0),
+axisX(0),
+axisY(0),
+linked(-1),
+palette(-1),
+length(0){
+}
+
+PaletteInfo::PaletteInfo():
+index(0),
+group(0),
+item(0),
+colors(0),
+linked(-1){
+}
+
+Contents::Contents():
+version(0){
+}
+
+Visitor::Visitor(){
+}
+
+Visitor::~Visitor(){
+}
+
+RepackResult::RepackResult():
+sprites(0),
+linked(0),
+deduplicated(0),
+palettes(0),
+size(0){
+}
+
+static SpriteInfo describeV1(const PaintownUtil::ReferenceCount<Mugen::SpriteV1> & sprite, unsigned int index){
+    SpriteInfo info;
+    info.index = index;
+    info.group = sprite->getGroupNumber();
+    info.item = sprite->getImageNumber();
+    info.width = sprite->getWidth();
+    info.height = sprite->getHeight();
+    info.axisX = sprite->getX();
+    info.axisY = sprite->getY();
+    info.length = sprite->getLength();
+    info.linked = sprite->getLength() == 0 ? sprite->getPrevious() : -1;
+    info.format = "PCX";
+    return info;
+}
+
+static SpriteInfo describeV2(Mugen::Util::SffV2Reader & reader, const Mugen::Util::SffV2Reader::SpriteHeader & header){
+    SpriteInfo info;
+    info.index = header.index;
+    info.group = header.group;
+    info.item = header.item;
+    info.width = header.width;
+    info.height = header.height;
+    info.axisX = (int16_t) header.axisx;
+    info.axisY = (int16_t) header.axisy;
+    info.length = header.dataLength;
+    info.linked = header.dataLength == 0 ? header.linked : -1;
+    info.palette = header.palette;
+    info.format = reader.formatName(header.format);
+    return info;
+}
+
+Contents describe(const Filesystem::AbsolutePath & path){
+    Contents contents;
+    contents.version = Mugen::Util::majorVersion(path);
+    if (contents.version == 1){
+        Mugen::Util::SffReader reader(path, Filesystem::AbsolutePath());
+        unsigned int index = 0;
+        while (reader.moreSprites()){
+            contents.sprites.push_back(describeV1(reader.readSpriteV1(false), index));
+            index += 1;
+        }
+    } else if (contents.version == 2){
+        Mugen::Util::SffV2Reader reader(path);
+        vector<Mugen::Util::SffV2Reader::SpriteHeader> sprites = reader.getSprites();
+        for (vector<Mugen::Util::SffV2Reader::SpriteHeader>::iterator it = sprites.begin(); it != sprites.end(); it++){
+            contents.sprites.push_back(describeV2(reader, *it));
+        }
+
+        const vector<Mugen::Util::SffV2Reader::PaletteHeader> & palettes = reader.getPalettes();
+        for (vector<Mugen::Util::SffV2Reader::PaletteHeader>::const_iterator it = palettes.begin(); it != palettes.end(); it++){
+            PaletteInfo info;
+            info.index = it->index;
+            info.group = it->group;
+            info.item = it->item;
+            info.colors = it->colors;
+            info.linked = it->length == 0 ? it->linked : -1;
+            contents.palettes.push_back(info);
+        }
+    } else {
+        std::ostringstream out;
+        out << "Unknown SFF version " << contents.version << " in " << path.path();
+        throw MugenException(out.str(), __FILE__, __LINE__);
+    }
+
+    return contents;
+}
+
+void decode(const Filesystem::AbsolutePath & path, Visitor & visitor){
+    int version = Mugen::Util::majorVersion(path);
+    if (version == 1){
+        Mugen::Util::SffReader reader(path, Filesystem::AbsolutePath());
+        unsigned int index = 0;
+        while (reader.moreSprites()){
+            /* a broken sffv1 sprite usually means the offsets can't be
+             * trusted anymore so stop at the first one
+             */
+            uint64_t start = Profile::currentMicroseconds();
+            PaintownUtil::ReferenceCount<Mugen::SpriteV1> sprite = reader.readSpriteV1(false);
+            PaintownUtil::ReferenceCount<Graphics::Bitmap> image = sprite->load(false);
+            uint64_t end = Profile::currentMicroseconds();
+            SpriteInfo info = describeV1(sprite, index);
+            if (image == NULL){
+                visitor.failed(info, "No pcx data");
+            } else {
+                visitor.decoded(info, *image, end - start);
+            }
+            index += 1;
+        }
+    } else if (version == 2){
+        Mugen::Util::SffV2Reader reader(path);
+        reader.setStrict(true);
+        vector<Mugen::Util::SffV2Reader::SpriteHeader> sprites = reader.getSprites();
+        for (vector<Mugen::Util::SffV2Reader::SpriteHeader>::iterator it = sprites.begin(); it != sprites.end(); it++){
+            SpriteInfo info = describeV2(reader, *it);
+            try{
+                uint64_t start = Profile::currentMicroseconds();
+                Graphics::Bitmap image = reader.readBitmap(*it);
+                uint64_t end = Profile::currentMicroseconds();
+                visitor.decoded(info, image, end - start);
+            } catch (const MugenException & fail){
+                visitor.failed(info, fail.getReason());
+            }
+        }
+    } else {
+        std::ostringstream out;
+        out << "Cannot decode SFF version " << version << " in " << path.path();
+        throw MugenException(out.str(), __FILE__, __LINE__);
+    }
+}
+
+/* The inverse of SffV2Reader::readRLE8. A byte of the form 01xxxxxx is a run
+ * so colors in that range have to be written as a run of one.
+ */
+static string encodeRLE8(const vector<uint8_t> & pixels){
+    string out;
+    unsigned int position = 0;
+    while (position < pixels.size()){
+        uint8_t color = pixels[position];
+        unsigned int run = 1;
+        while (position + run < pixels.size() && run < 0x3f && pixels[position + run] == color){
+            run += 1;
+        }
+
+        if (run > 1 || (color & 0xc0) == 0x40){
+            out += (char) (0x40 | run);
+            out += (char) color;
+        } else {
+            out += (char) color;
+        }
+        position += run;
+    }
+    return out;
+}
+
+static void write1(std::ostream & out, uint8_t value){
+    out.put((char) value);
+}
+
+static void write2(std::ostream & out, uint16_t value){
+    write1(out, value & 0xff);
+    write1(out, (value >> 8) & 0xff);
+}
+
+static void write4(std::ostream & out, uint32_t value){
+    write2(out, value & 0xffff);
+    write2(out, (value >> 16) & 0xffff);
+}
+
+struct PackedSprite{
+    PackedSprite():
+        group(0),
+        item(0),
+        width(0),
+        height(0),
+        axisX(0),
+        axisY(0),
+        linked(0),
+        palette(0),
+        offset(0),
+        length(0){
+        }
+
+    uint16_t group;
+    uint16_t item;
+    uint16_t width;
+    uint16_t height;
+    int16_t axisX;
+    int16_t axisY;
+    uint16_t linked;
+    uint16_t palette;
+    uint32_t offset;
+    /* 0 for linked sprites */
+    uint32_t length;
+};
+
+RepackResult repack(const Filesystem::AbsolutePath & input, const std::string & output){
+    if (Mugen::Util::majorVersion(input) != 1){
+        throw MugenException(input.path() + " is not an sffv1 file", __FILE__, __LINE__);
+    }
+
+    RepackResult result;
+    Mugen::Util::SffReader reader(input, Filesystem::AbsolutePath());
+
+    vector<PackedSprite> sprites;
+    /* palette colors to palette index */
+    map<string, int> paletteIndex;
+    vector<string> palettes;
+    /* palette, size and pixels to the sprite that has them */
+    map<string, int> images;
+    /* all the compressed sprites, each starts with the uncompressed size */
+    string tdata;
+
+    while (reader.moreSprites()){
+        PaintownUtil::ReferenceCount<Mugen::SpriteV1> sprite = reader.readSpriteV1(false);
+        PackedSprite packed;
+        packed.group = sprite->getGroupNumber();
+        packed.item = sprite->getImageNumber();
+        packed.axisX = sprite->getX();
+        packed.axisY = sprite->getY();
+
+        if (sprite->getLength() == 0){
+            unsigned int previous = sprite->getPrevious();
+            if (previous >= sprites.size()){
+                std::ostringstream out;
+                out << "Sprite " << packed.group << ", " << packed.item << " is linked to sprite " << previous << " which comes after it";
+                throw MugenException(out.str(), __FILE__, __LINE__);
+            }
+            packed.linked = previous;
+            packed.width = sprites[previous].width;
+            packed.height = sprites[previous].height;
+            packed.palette = sprites[previous].palette;
+            result.linked += 1;
+        } else {
+            const unsigned char * pcx = (const unsigned char *) sprite->getPCX();
+            if (pcx == NULL){
+                std::ostringstream out;
+                out << "Sprite " << packed.group << ", " << packed.item << " has no pcx data";
+                throw MugenException(out.str(), __FILE__, __LINE__);
+            }
+
+            int width = 0;
+            int height = 0;
+            vector<uint8_t> pixels;
+            decodePCX(pcx, sprite->getNewLength(), width, height, pixels);
+            packed.width = width;
+            packed.height = height;
+
+            string colors((const char *) pcx + sprite->getNewLength() - 768, 768);
+            if (paletteIndex.find(colors) == paletteIndex.end()){
+                paletteIndex[colors] = palettes.size();
+                palettes.push_back(colors);
+            }
+            packed.palette = paletteIndex[colors];
+
+            std::ostringstream key;
+            key << packed.palette << " " << width << " " << height << " ";
+            string image = key.str() + string(pixels.begin(), pixels.end());
+            if (images.find(image) != images.end()){
+                packed.linked = images[image];
+                result.deduplicated += 1;
+            } else {
+                images[image] = sprites.size();
+                string encoded = encodeRLE8(pixels);
+                packed.offset = tdata.size();
+                packed.length = encoded.size() + 4;
+                std::ostringstream size;
+                write4(size, pixels.size());
+                tdata += size.str();
+                tdata += encoded;
+            }
+        }
+
+        sprites.push_back(packed);
+    }
+
+    const uint32_t headerSize = 512;
+    const uint32_t spriteOffset = headerSize;
+    const uint32_t paletteOffset = spriteOffset + sprites.size() * 28;
+    const uint32_t ldataOffset = paletteOffset + palettes.size() * 16;
+    /* 4 bytes per color */
+    const uint32_t ldataLength = palettes.size() * 256 * 4;
+    const uint32_t tdataOffset = ldataOffset + ldataLength;
+
+    std::ofstream out(output.c_str(), std::ios::out | std::ios::binary);
+    if (!out.good()){
+        throw MugenException("Could not open " + output + " for writing", __FILE__, __LINE__);
+    }
+
+    out.write("ElecbyteSpr\0", 12);
+    /* version 2.01 */
+    write1(out, 0);
+    write1(out, 1);
+    write1(out, 0);
+    write1(out, 2);
+    write4(out, 0);
+    write4(out, 0);
+    /* compatible version */
+    write1(out, 0);
+    write1(out, 1);
+    write1(out, 0);
+    write1(out, 2);
+    write4(out, 0);
+    write4(out, 0);
+    write4(out, spriteOffset);
+    write4(out, sprites.size());
+    write4(out, paletteOffset);
+    write4(out, palettes.size());
+    write4(out, ldataOffset);
+    write4(out, ldataLength);
+    write4(out, tdataOffset);
+    write4(out, tdata.size());
+    write4(out, 0);
+    write4(out, 0);
+    for (uint32_t i = 76; i < headerSize; i++){
+        write1(out, 0);
+    }
+
+    for (vector<PackedSprite>::iterator it = sprites.begin(); it != sprites.end(); it++){
+        const PackedSprite & sprite = *it;
+        write2(out, sprite.group);
+        write2(out, sprite.item);
+        write2(out, sprite.width);
+        write2(out, sprite.height);
+        write2(out, (uint16_t) sprite.axisX);
+        write2(out, (uint16_t) sprite.axisY);
+        write2(out, sprite.linked);
+        /* RLE8 with 8 bit color */
+        write1(out, 2);
+        write1(out, 8);
+        write4(out, sprite.offset);
+        write4(out, sprite.length);
+        write2(out, sprite.palette);
+        /* compressed data lives in tdata */
+        write2(out, 1);
+    }
+
+    for (unsigned int index = 0; index < palettes.size(); index++){
+        /* palettes are numbered 1,1 1,2 .. like a character's color choices */
+        write2(out, 1);
+        write2(out, index + 1);
+        write2(out, 256);
+        write2(out, 0);
+        write4(out, index * 256 * 4);
+        write4(out, 256 * 4);
+    }
+
+    for (vector<string>::iterator it = palettes.begin(); it != palettes.end(); it++){
+        const string & colors = *it;
+        for (int color = 0; color < 256; color++){
+            write1(out, colors[color * 3]);
+            write1(out, colors[color * 3 + 1]);
+            write1(out, colors[color * 3 + 2]);
+            write1(out, 0);
+        }
+    }
+
+    out.write(tdata.data(), tdata.size());
+
+    if (!out.good()){
+        throw MugenException("Failed to write " + output, __FILE__, __LINE__);
+    }
+
+    result.sprites = sprites.size();
+    result.palettes = palettes.size();
+    result.size = tdataOffset + tdata.size();
+    return result;
+}
+
+}
+}
@@ -0,0 +1,117 @@
+#ifndef paintown_mugen_sff_h
+#define paintown_mugen_sff_h
+
+/* Offline access to sff files for the mugen:sff command line tool. The game
+ * itself loads sprites with Mugen::Util::readSprites, this goes through the
+ * same readers but also exposes the headers and the per sprite errors.
+ */
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Filesystem{
+    class AbsolutePath;
+}
+
+namespace Graphics{
+class Bitmap;
+}
+
+namespace Mugen{
+namespace Sff{
+
+struct SpriteInfo{
+    SpriteInfo();
+
+    /* position in the file */
+    unsigned int index;
+    int group;
+    int item;
+    int width;
+    int height;
+    int axisX;
+    int axisY;
+    /* index of the sprite whose image this one uses, -1 if it has its own */
+    int linked;
+    /* palette index, -1 for sffv1 where the palette is in the pcx */
+    int palette;
+    /* pcx for sffv1, RLE8, RLE5, LZ5 etc for sffv2 */
+    std::string format;
+    /* size of the compressed data */
+    uint32_t length;
+};
+
+struct PaletteInfo{
+    PaletteInfo();
+
+    unsigned int index;
+    int group;
+    int item;
+    int colors;
+    /* index of the palette this one uses, -1 if it has its own colors */
+    int linked;
+};
+
+struct Contents{
+    Contents();
+
+    int version;
+    std::vector<SpriteInfo> sprites;
+    std::vector<PaletteInfo> palettes;
+};
+
+/* Reads the headers of an sffv1 or sffv2 file. Sffv1 doesn't have the sprite
+ * size in the header so every pcx is read, but none are decoded.
+ */
+Contents describe(const Filesystem::AbsolutePath & path);
+
+class Visitor{
+public:
+    Visitor();
+    virtual ~Visitor();
+
+    /* Called for every sprite that could be decoded along with how long the
+     * decoding took. Linked sprites are not decoded again.
+     */
+    virtual void decoded(const SpriteInfo & sprite, const Graphics::Bitmap & image, uint64_t microseconds) = 0;
+
+    /* Called for a sprite that could not be decoded, decoding continues with
+     * the next sprite.
+     */
+    virtual void failed(const SpriteInfo & sprite, const std::string & reason) = 0;
+};
+
+/* Decodes every sprite in the file. Unlike the game this doesn't paper over
+ * broken sffv2 sprites.
+ */
+void decode(const Filesystem::AbsolutePath & path, Visitor & visitor);
+
+struct RepackResult{
+    RepackResult();
+
+    int sprites;
+    /* sprites that were already linked in the sffv1 */
+    int linked;
+    /* sprites that turned out to have the same image as an earlier one */
+    int deduplicated;
+    int palettes;
+    /* bytes written */
+    uint32_t size;
+};
+
+/* Writes an sffv1 file as an sffv2 file with RLE8 sprites. Palettes that are
+ * the same are only written once and sprites with the same pixels and palette
+ * are linked to the first one.
+ */
+RepackResult repack(const Filesystem::AbsolutePath & input, const std::string & output);
+
+/* The mugen:sff command, arguments are the subcommand and its arguments.
+ * Returns the exit status, 0 if everything worked.
+ */
+int runTool(const std::vector<std::string> & arguments);
+
+}
+}
+
+#endif
@@ -2,10 +2,15 @@
 #include <r-tech1/file-system.h>
 #include <string.h>
 #include "sprite.h"
+#include "profile.h"
 #include <r-tech1/funcs.h>
 #include <r-tech1/pointer.h>
 #include <r-tech1/debug.h>
+#include <r-tech1/thread.h>
 #include <math.h>
+#include <list>
+#include <map>
+#include "exception.h"
 
 namespace PaintownUtil = ::Util;
 
@@ -13,6 +18,257 @@ using namespace std;
 
 namespace Mugen{
 
+/* Bitmaps made from an indexed image and a palette. The least recently drawn
+ * ones are dropped once they add up to too many pixels. Something that is
+ * still drawing a dropped bitmap keeps it alive through its reference count.
+ *
+ * Sprites are loaded on other threads so everything goes through the lock.
+ */
+class SurfaceCache{
+public:
+    struct Key{
+        Key(unsigned int image, unsigned int palette, bool mask):
+        image(image),
+        palette(palette),
+        mask(mask){
+        }
+
+        unsigned int image;
+        unsigned int palette;
+        bool mask;
+
+        bool operator<(const Key & other) const {
+            if (image != other.image){
+                return image < other.image;
+            }
+            if (palette != other.palette){
+                return palette < other.palette;
+            }
+            return mask < other.mask;
+        }
+    };
+
+    struct Entry{
+        PaintownUtil::ReferenceCount<Graphics::Bitmap> bitmap;
+        uint64_t pixels;
+        std::list<Key>::iterator used;
+    };
+
+    /* 128mb of 32-bit pixels */
+    SurfaceCache():
+    limit(32 * 1024 * 1024),
+    pixels(0),
+    lastId(0),
+    evictions(0){
+    }
+
+    /* Never deleted, sprites in other static objects can outlive anything
+     * that is destroyed at exit.
+     */
+    static SurfaceCache & instance(){
+        static SurfaceCache * cache = new SurfaceCache();
+        return *cache;
+    }
+
+    /* ids for images and palettes */
+    unsigned int nextId(){
+        PaintownUtil::Thread::ScopedLock scoped(lock);
+        lastId += 1;
+        return lastId;
+    }
+
+    PaintownUtil::ReferenceCount<Graphics::Bitmap> get(const Key & key){
+        PaintownUtil::Thread::ScopedLock scoped(lock);
+        map<Key, Entry>::iterator found = entries.find(key);
+        if (found == entries.end()){
+            return PaintownUtil::ReferenceCount<Graphics::Bitmap>(NULL);
+        }
+        /* most recently used go to the front */
+        order.splice(order.begin(), order, found->second.used);
+        return found->second.bitmap;
+    }
+
+    void put(const Key & key, const PaintownUtil::ReferenceCount<Graphics::Bitmap> & bitmap){
+        if (bitmap == NULL){
+            return;
+        }
+
+        PaintownUtil::Thread::ScopedLock scoped(lock);
+        remove(key);
+        Entry & entry = entries[key];
+        entry.bitmap = bitmap;
+        entry.pixels = (uint64_t) bitmap->getWidth() * bitmap->getHeight();
+        order.push_front(key);
+        entry.used = order.begin();
+        pixels += entry.pixels;
+        trim();
+    }
+
+    /* the image is gone so its bitmaps can never be asked for again */
+    void forget(unsigned int image){
+        PaintownUtil::Thread::ScopedLock scoped(lock);
+        map<Key, Entry>::iterator it = entries.lower_bound(Key(image, 0, false));
+        while (it != entries.end() && it->first.image == image){
+            pixels -= it->second.pixels;
+            order.erase(it->second.used);
+            entries.erase(it++);
+        }
+    }
+
+    void setLimit(uint64_t limit){
+        PaintownUtil::Thread::ScopedLock scoped(lock);
+        this->limit = limit;
+        trim();
+    }
+
+    uint64_t getPixels(){
+        PaintownUtil::Thread::ScopedLock scoped(lock);
+        return pixels;
+    }
+
+    /* Goes up every time a bitmap is dropped to stay under the limit. Read
+     * without the lock, a stale count only means a sprite keeps drawing the
+     * bitmap it already has for one more frame.
+     */
+    unsigned int getEvictions() const {
+        return evictions;
+    }
+
+protected:
+    void remove(const Key & key){
+        map<Key, Entry>::iterator found = entries.find(key);
+        if (found != entries.end()){
+            pixels -= found->second.pixels;
+            order.erase(found->second.used);
+            entries.erase(found);
+        }
+    }
+
+    /* always keeps the newest bitmap even if it is bigger than the limit */
+    void trim(){
+        while (pixels > limit && order.size() > 1){
+            remove(order.back());
+            evictions += 1;
+        }
+    }
+
+    PaintownUtil::Thread::LockObject lock;
+    uint64_t limit;
+    uint64_t pixels;
+    unsigned int lastId;
+    volatile unsigned int evictions;
+    map<Key, Entry> entries;
+    std::list<Key> order;
+};
+
+Palette::Palette(const unsigned char * colors):
+id(SurfaceCache::instance().nextId()){
+    memcpy(this->colors, colors, sizeof(this->colors));
+}
+
+Palette::~Palette(){
+}
+
+void decodePCX(const unsigned char * pcx, uint32_t length, int & width, int & height, vector<uint8_t> & pixels){
+    if (length < 128 + 768 || pcx[0] != 10 || pcx[3] != 8 || pcx[65] != 1){
+        throw MugenException("Only 8-bit pcx images with one color plane can be decoded", __FILE__, __LINE__);
+    }
+
+    int xmin = pcx[4] | (pcx[5] << 8);
+    int ymin = pcx[6] | (pcx[7] << 8);
+    int xmax = pcx[8] | (pcx[9] << 8);
+    int ymax = pcx[10] | (pcx[11] << 8);
+    int bytesPerLine = pcx[66] | (pcx[67] << 8);
+    width = xmax - xmin + 1;
+    height = ymax - ymin + 1;
+    if (width <= 0 || height <= 0 || bytesPerLine < width){
+        throw MugenException("Bad pcx dimensions", __FILE__, __LINE__);
+    }
+
+    pixels.assign(width * height, 0);
+
+    /* The palette is at the end. Sprites that share the previous palette
+     * don't have the marker byte in front of it, but decoding stops once
+     * every line is read anyway.
+     */
+    uint32_t position = 128;
+    const uint32_t end = length - 768;
+    for (int y = 0; y < height; y++){
+        int x = 0;
+        while (x < bytesPerLine && position < end){
+            uint8_t byte = pcx[position];
+            position += 1;
+            int count = 1;
+            if ((byte & 0xc0) == 0xc0){
+                count = byte & 0x3f;
+                if (position >= end){
+                    break;
+                }
+                byte = pcx[position];
+                position += 1;
+            }
+            for (int i = 0; i < count && x < bytesPerLine; i++){
+                if (x < width){
+                    pixels[y * width + x] = byte;
+                }
+                x += 1;
+            }
+        }
+    }
+}
+
+IndexedImage::IndexedImage(const char * pcx, uint32_t length):
+id(SurfaceCache::instance().nextId()),
+decoded(false),
+width(0),
+height(0){
+    try{
+        decodePCX((const unsigned char *) pcx, length, width, height, pixels);
+        decoded = true;
+    } catch (const MugenException & fail){
+        Global::debug(1) << "Could not decode pcx: " << fail.getReason() << endl;
+    }
+}
+
+IndexedImage::~IndexedImage(){
+    SurfaceCache::instance().forget(id);
+}
+
+PaintownUtil::ReferenceCount<Graphics::Bitmap> IndexedImage::palettize(const Palette & palette, bool mask) const {
+    Graphics::Color lookup[256];
+    const unsigned char * colors = palette.getColors();
+    for (int color = 0; color < 256; color++){
+        lookup[color] = Graphics::makeColor(colors[color * 3], colors[color * 3 + 1], colors[color * 3 + 2]);
+    }
+
+    if (mask){
+        lookup[0] = Graphics::MaskColor();
+    }
+
+    /* locked once for the whole image, each row is written straight from
+     * its line of indexes
+     */
+    PaintownUtil::ReferenceCount<Graphics::Bitmap> out(new Graphics::Bitmap(width, height));
+    out->lock();
+    for (int y = 0; y < height; y++){
+        const unsigned char * row = &pixels[y * width];
+        for (int x = 0; x < width; x++){
+            out->putPixelNormal(x, y, lookup[row[x]]);
+        }
+    }
+    out->unlock();
+
+    return out;
+}
+
+void SpriteV1::setCacheLimit(uint64_t pixels){
+    SurfaceCache::instance().setLimit(pixels);
+}
+
+uint64_t SpriteV1::cachedPixels(){
+    return SurfaceCache::instance().getPixels();
+}
+
 Sprite::Sprite(){
 }
 
@@ -35,7 +291,12 @@ pcx(NULL),
 width(0),
 height(0),
 loaded(false),
-defaultMask(mask){
+defaultMask(mask),
+actPalette(false),
+lastImage(0),
+lastPalette(0),
+lastMask(false),
+lastEvictions(0){
 }
 
 SpriteV1::SpriteV1(const SpriteV1 &copy){
@@ -69,8 +330,9 @@ SpriteV1::SpriteV1(const SpriteV1 &copy){
         this->pcx = NULL;
     }
 
-    this->unmaskedBitmap = copy.unmaskedBitmap;
-    this->maskedBitmap = copy.maskedBitmap;
+    this->image = copy.image;
+    this->palette = copy.palette;
+    this->actPalette = copy.actPalette;
 }
 
 SpriteV1 & SpriteV1::operator=(const SpriteV1 &copy){
@@ -104,8 +366,9 @@ SpriteV1 & SpriteV1::operator=(const SpriteV1 &copy){
         memcpy(this->pcx, copy.pcx, this->reallength);
     }
 
-    this->unmaskedBitmap = copy.unmaskedBitmap;
-    this->maskedBitmap = copy.maskedBitmap;
+    this->image = copy.image;
+    this->palette = copy.palette;
+    this->actPalette = copy.actPalette;
     
     return *this;
 }
@@ -126,8 +389,9 @@ void SpriteV1::copyImage(const PaintownUtil::ReferenceCount<Mugen::SpriteV1> cop
 
     this->width = copy->width;
     this->height = copy->height;
-    this->unmaskedBitmap = copy->unmaskedBitmap;
-    this->maskedBitmap = copy->maskedBitmap;
+    this->image = copy->image;
+    this->palette = copy->palette;
+    this->actPalette = copy->actPalette;
     this->loaded = copy->loaded;
     this->defaultMask = copy->defaultMask;
 }
@@ -149,8 +413,9 @@ void SpriteV1::cleanup(){
 
     loaded = false;
 
-    unmaskedBitmap = NULL;
-    maskedBitmap = NULL;
+    image = NULL;
+    palette = NULL;
+    lastBitmap = NULL;
 }
 
 SpriteV1::~SpriteV1(){
@@ -261,37 +526,70 @@ PaintownUtil::ReferenceCount<Graphics::Bitmap> SpriteV1::load(bool mask){
 }
 
 void SpriteV1::reload(bool mask){
-    maskedBitmap = NULL;
-    unmaskedBitmap = NULL;
+    /* throw away the old bitmaps */
+    image = NULL;
+    getBitmap(mask);
+}
 
-    if (mask){
-        maskedBitmap = load(mask);
-    } else {
-        unmaskedBitmap = load(mask);
-    }
+void SpriteV1::setPalette(const PaintownUtil::ReferenceCount<Palette> & palette){
+    this->palette = palette;
 }
 
 PaintownUtil::ReferenceCount<Graphics::Bitmap> SpriteV1::getBitmap(bool mask){
-    if (mask){
-        if (maskedBitmap != NULL){
-            return maskedBitmap;
-        }
-        if (unmaskedBitmap != NULL){
-            maskedBitmap = PaintownUtil::ReferenceCount<Graphics::Bitmap>(new Graphics::Bitmap(*unmaskedBitmap, true));
-            maskedBitmap->replaceColor(maskedBitmap->get8BitMaskColor(), Graphics::MaskColor());
-            return maskedBitmap;
-        }
+    if (pcx == NULL || palette == NULL){
+        return PaintownUtil::ReferenceCount<Graphics::Bitmap>(NULL);
+    }
+
+    /* the unmasked bitmap used to be loaded with the default mask */
+    mask = mask || defaultMask;
+
+    if (image == NULL){
+        image = PaintownUtil::ReferenceCount<IndexedImage>(new IndexedImage(pcx, newlength));
+    }
+
+    SurfaceCache & cache = SurfaceCache::instance();
+    const bool sameAsLast = lastBitmap != NULL &&
+                            lastImage == image->getId() &&
+                            lastPalette == palette->getId() &&
+                            lastMask == mask;
+
+    /* Almost every draw asks for the same bitmap as the last one. Only go
+     * to the shared cache when the palette or mask changed, or when the cache
+     * dropped something since then so its limit and order stay right.
+     */
+    if (sameAsLast && lastEvictions == cache.getEvictions()){
+        Profile::spriteHit();
+        return lastBitmap;
+    }
+
+    SurfaceCache::Key key(image->getId(), palette->getId(), mask);
+    lastEvictions = cache.getEvictions();
+    PaintownUtil::ReferenceCount<Graphics::Bitmap> bitmap = cache.get(key);
+    if (bitmap == NULL && sameAsLast){
+        /* the cache dropped the bitmap while we were still drawing it */
+        cache.put(key, lastBitmap);
+        bitmap = lastBitmap;
+    }
 
-        maskedBitmap = load(true);
-        return maskedBitmap;
+    if (bitmap != NULL){
+        Profile::spriteHit();
     } else {
-        if (unmaskedBitmap != NULL){
-            return unmaskedBitmap;
+        Profile::spriteMiss();
+        if (image->isDecoded()){
+            bitmap = image->palettize(*palette, mask);
+        } else {
+            /* some other kind of pcx, this ignores the palette */
+            bitmap = load(mask);
         }
-        unmaskedBitmap = load(defaultMask);
-        return unmaskedBitmap;
+
+        cache.put(key, bitmap);
     }
-    return PaintownUtil::ReferenceCount<Graphics::Bitmap>(NULL);
+
+    lastBitmap = bitmap;
+    lastImage = image->getId();
+    lastPalette = palette->getId();
+    lastMask = mask;
+    return bitmap;
 }
 
 int SpriteV1::getWidth() const {
@@ -396,6 +694,9 @@ void SpriteV1::loadPCX(const PaintownUtil::ReferenceCount<Storage::File> & ifile
     width = (xmax - xmin) + 1;
     height = (ymax - ymin) + 1;
 
+    image = NULL;
+    palette = PaintownUtil::ReferenceCount<Palette>(new Palette((unsigned char *) pcx + newlength - 768));
+
     loaded = true;
 
     /*
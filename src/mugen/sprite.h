@@ -11,6 +11,7 @@
 #include <string>
 #include <fstream>
 #include <iostream>
+#include <vector>
 
 #include "util.h"
 #include "common.h"
@@ -42,6 +43,60 @@ public:
     virtual void drawPartStretched(int sourceX1, int sourceY, int sourceWidth, int sourceHeight, int destX, int destY, int destWidth, int destHeight, const Mugen::Effects & effects, const Graphics::Bitmap & work) = 0;
 };
 
+/* 256 rgb colors in the order a pcx stores them */
+class Palette{
+public:
+    /* 768 bytes */
+    Palette(const unsigned char * colors);
+    virtual ~Palette();
+
+    /* every palette gets its own id, so equal colors don't mean equal ids */
+    inline unsigned int getId() const {
+        return id;
+    }
+
+    inline const unsigned char * getColors() const {
+        return colors;
+    }
+
+protected:
+    unsigned char colors[768];
+    unsigned int id;
+};
+
+/* The palette indexes of a pcx image. The pcx is decoded once and the
+ * indexes are turned into a bitmap for each palette the sprite is drawn with.
+ */
+class IndexedImage{
+public:
+    IndexedImage(const char * pcx, uint32_t length);
+    virtual ~IndexedImage();
+
+    inline unsigned int getId() const {
+        return id;
+    }
+
+    /* false if the pcx is not an 8-bit image */
+    inline bool isDecoded() const {
+        return decoded;
+    }
+
+    /* index 0 becomes the mask color if mask is true */
+    PaintownUtil::ReferenceCount<Graphics::Bitmap> palettize(const Palette & palette, bool mask) const;
+
+protected:
+    unsigned int id;
+    bool decoded;
+    int width;
+    int height;
+    std::vector<uint8_t> pixels;
+};
+
+/* Pulls the palette indexes out of an 8-bit single plane pcx. Throws
+ * MugenException if the pcx is some other kind.
+ */
+void decodePCX(const unsigned char * pcx, uint32_t length, int & width, int & height, std::vector<uint8_t> & pixels);
+
 class SpriteV1: public Sprite {
     public:
 	SpriteV1(bool defaultMask);
@@ -65,7 +120,7 @@ class SpriteV1: public Sprite {
         /* for parallax support */
         void drawPartStretched(int sourceX1, int sourceY, int sourceWidth, int sourceHeight, int destX, int destY, int destWidth, int destHeight, const Mugen::Effects & effects, const Graphics::Bitmap & work);
 	
-	// load/reload sprite
+	// load/reload sprite. load() always decodes a new bitmap from the pcx
         PaintownUtil::ReferenceCount<Graphics::Bitmap> load(bool mask);
 	void reload(bool mask=true);
 
@@ -90,6 +145,23 @@ class SpriteV1: public Sprite {
 	inline void setImageNumber(const unsigned short in){ imageNumber = in; }
 	inline void setPrevious(const unsigned short p){ prev = p; }
 	inline void setSamePalette(const bool p){ samePalette = p; };
+
+        /* Sprites that were loaded with the palette from the act file, these
+         * change palette along with the character.
+         */
+        inline void setActPalette(bool act){ actPalette = act; }
+        inline bool usesActPalette() const { return actPalette; }
+
+        /* Draw with a different palette. Bitmaps are made for the palette
+         * the first time the sprite is drawn with it.
+         */
+        void setPalette(const PaintownUtil::ReferenceCount<Palette> & palette);
+
+        /* Bitmaps for each (sprite, palette) are kept until they add up to
+         * this many pixels, then the least recently drawn are thrown away.
+         */
+        static void setCacheLimit(uint64_t pixels);
+        static uint64_t cachedPixels();
 	
 	void loadPCX(const PaintownUtil::ReferenceCount<Storage::File> & file, bool islinked, bool useact, unsigned char palsave1[], bool mask);
 	
@@ -105,6 +177,10 @@ class SpriteV1: public Sprite {
 	inline unsigned short getPrevious() const { return prev; }
 	inline bool getSamePalette() const { return samePalette; }
 	inline const char *getComments() const { return comments; }
+        /* the whole pcx file with the palette that is used at the end, only
+         * valid after loadPCX
+         */
+	inline const char *getPCX() const { return pcx; }
 	
         // static void draw(const Graphics::Bitmap &bmp, const int xaxis, const int yaxis, const int x, const int y, const Graphics::Bitmap &where, const Mugen::Effects &effects);
 
@@ -139,10 +215,22 @@ class SpriteV1: public Sprite {
         bool loaded;
 
         bool defaultMask;
-	
+
+        /* decoded from the pcx the first time the sprite is drawn */
+        PaintownUtil::ReferenceCount<IndexedImage> image;
+
         /* Loaded with a palette that may not be our own */
-        PaintownUtil::ReferenceCount<Graphics::Bitmap> unmaskedBitmap;
-        PaintownUtil::ReferenceCount<Graphics::Bitmap> maskedBitmap;
+        PaintownUtil::ReferenceCount<Palette> palette;
+        bool actPalette;
+
+        /* The bitmap from the last getBitmap and what it was made from, so
+         * drawing the same thing again skips the shared cache.
+         */
+        PaintownUtil::ReferenceCount<Graphics::Bitmap> lastBitmap;
+        unsigned int lastImage;
+        unsigned int lastPalette;
+        bool lastMask;
+        unsigned int lastEvictions;
         
         void draw(const PaintownUtil::ReferenceCount<Graphics::Bitmap> &, const int xaxis, const int yaxis, const Graphics::Bitmap &, const Mugen::Effects &);
 };
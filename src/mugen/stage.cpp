@@ -32,6 +32,7 @@
 #include "globals.h"
 #include <r-tech1/debug.h>
 #include "factory/font_render.h"
+#include "factory/presenter.h"
 #include "ast/all.h"
 #include <r-tech1/timedifference.h>
 #include "character.h"
@@ -44,6 +45,9 @@
 #include "background.h"
 #include "config.h"
 #include "effect.h"
+#include "fixed-point.h"
+#include "hit-queue.h"
+#include "profile.h"
 #include "item.h"
 #include "item-content.h"
 #include "section.h"
@@ -134,6 +138,14 @@ p2startx(70),
 p2starty(0),
 p2startz(0),
 p2facing(-1),
+p3startx(-100),
+p3starty(0),
+p3startz(0),
+p3facing(1),
+p4startx(100),
+p4starty(0),
+p4startz(0),
+p4facing(-1),
 leftbound(-1000),
 rightbound(1000),
 topbound(-25),
@@ -174,8 +186,11 @@ loaded(false),
 gameHUD(NULL),
 gameOver(false),
 objectId(0),
-replay(false){
+replay(false),
+fixedPhysics(false){
     getStateData().gameRate = 1;
+    cameraBounds.setLimits(boundleft, boundright, tension, verticalfollow);
+    updateCameraBounds();
 }
 
 #if 0
@@ -201,6 +216,14 @@ p2startx(70),
 p2starty(0),
 p2startz(0),
 p2facing(-1),
+p3startx(-100),
+p3starty(0),
+p3startz(0),
+p3facing(1),
+p4startx(100),
+p4starty(0),
+p4startz(0),
+p4facing(-1),
 leftbound(-1000),
 rightbound(1000),
 topbound(-25),
@@ -340,6 +363,22 @@ void Mugen::Stage::loadSectionPlayerInfo(Ast::Section * section){
                 simple->view() >> p2startz;
             } else if (*simple == "p2facing"){
                 simple->view() >> p2facing;
+            } else if (*simple == "p3startx"){
+                simple->view() >> p3startx;
+            } else if (*simple == "p3starty"){
+                simple->view() >> p3starty;
+            } else if (*simple == "p3startz"){
+                simple->view() >> p3startz;
+            } else if (*simple == "p3facing"){
+                simple->view() >> p3facing;
+            } else if (*simple == "p4startx"){
+                simple->view() >> p4startx;
+            } else if (*simple == "p4starty"){
+                simple->view() >> p4starty;
+            } else if (*simple == "p4startz"){
+                simple->view() >> p4startz;
+            } else if (*simple == "p4facing"){
+                simple->view() >> p4facing;
             } else if (*simple == "leftbound"){
                 simple->view() >> leftbound;
             } else if (*simple == "rightbound"){
@@ -573,6 +612,8 @@ void Mugen::Stage::load(){
     // board = new Graphics::Bitmap(DEFAULT_WIDTH, DEFAULT_HEIGHT);
     getStateData().camerax = startx;
     getStateData().cameray = starty;
+    cameraBounds.setLimits(boundleft, boundright, tension, verticalfollow);
+    updateCameraBounds();
     // xaxis = (abs(boundleft) + boundright + DEFAULT_WIDTH)/2;//abs(boundleft);
     // yaxis = abs(boundhigh);
     /* FIXME: do we need xaxis and yaxis anymore? I don't think so */
@@ -664,6 +705,8 @@ void Mugen::Stage::setCamera( const double x, const double y ){
     } else if (getStateData().cameray > boundlow){
         getStateData().cameray = boundlow;
     }
+
+    updateCameraBounds();
 }
 void Mugen::Stage::moveCamera(const double x, const double y){ 
     getStateData().camerax += x;
@@ -681,12 +724,14 @@ void Mugen::Stage::moveCamera(const double x, const double y){
     } else if (getStateData().cameray > boundlow){
         getStateData().cameray = boundlow;
     }
+
+    updateCameraBounds();
 }
 
-static bool anyCollisions(const vector<Mugen::Area> & boxes1, int x1, int y1, const vector<Mugen::Area> & boxes2, int x2, int y2){
+static bool anyCollisions(const Mugen::AreaList & boxes1, int x1, int y1, const Mugen::AreaList & boxes2, int x2, int y2){
 
-    for (vector<Mugen::Area>::const_iterator attack_i = boxes1.begin(); attack_i != boxes1.end(); attack_i++){
-        for (vector<Mugen::Area>::const_iterator defense_i = boxes2.begin(); defense_i != boxes2.end(); defense_i++){
+    for (Mugen::AreaList::const_iterator attack_i = boxes1.begin(); attack_i != boxes1.end(); attack_i++){
+        for (Mugen::AreaList::const_iterator defense_i = boxes2.begin(); defense_i != boxes2.end(); defense_i++){
             const Mugen::Area & attack = *attack_i;
             const Mugen::Area & defense = *defense_i;
             if (attack.collision(x1, y1, defense, x2, y2)){
@@ -699,9 +744,9 @@ static bool anyCollisions(const vector<Mugen::Area> & boxes1, int x1, int y1, co
 
 }
 
-static bool anyBlocking(const vector<Mugen::Area> & boxes1, int x1, int y1, int attackDist, const vector<Mugen::Area> & boxes2, int x2, int y2){
-    for (vector<Mugen::Area>::const_iterator attack_i = boxes1.begin(); attack_i != boxes1.end(); attack_i++){
-        for (vector<Mugen::Area>::const_iterator defense_i = boxes2.begin(); defense_i != boxes2.end(); defense_i++){
+static bool anyBlocking(const Mugen::AreaList & boxes1, int x1, int y1, int attackDist, const Mugen::AreaList & boxes2, int x2, int y2){
+    for (Mugen::AreaList::const_iterator attack_i = boxes1.begin(); attack_i != boxes1.end(); attack_i++){
+        for (Mugen::AreaList::const_iterator defense_i = boxes2.begin(); defense_i != boxes2.end(); defense_i++){
             const Mugen::Area & attack = *attack_i;
             Mugen::Area defense = *defense_i;
 	    defense.x1 -= attackDist;
@@ -736,6 +781,14 @@ void Mugen::Stage::setReplay(bool what){
     this->replay = what;
 }
 
+bool Mugen::Stage::fixedPhysicsEnabled() const {
+    return fixedPhysics;
+}
+
+void Mugen::Stage::setFixedPhysics(bool what){
+    this->fixedPhysics = what;
+}
+
 PaintownUtil::ReferenceCount<Mugen::Animation> Mugen::Stage::getFightAnimation(int id){
     if (sparks[id] == 0){
         ostringstream out;
@@ -764,7 +817,7 @@ void Mugen::Stage::addSpark(int x, int y, int sparkNumber, bool own, Character *
     }
     /* FIXME: sprite priority */
     Mugen::Spark * spark = new Mugen::Spark(x, y, 0, PaintownUtil::ReferenceCount<Mugen::Animation>(sprite->copy()));
-    showSparks.push_back(spark);
+    addEffect(spark);
 }
 
 void Mugen::Stage::addSpark(int x, int y, const ResourceEffect & resource, const ResourceEffect & default_, Character * owner){
@@ -801,74 +854,90 @@ void Mugen::Stage::playSound(Character * owner, int group, int item, bool own){
     }
 }
 
+/* the projectile touched mugen */
 void Mugen::Stage::doProjectileCollision(Projectile * projectile, Character * mugen){
-    if (anyCollisions(mugen->getDefenseBoxes(), (int) mugen->getX(), (int) mugen->getRY(),
-                      projectile->getAttackBoxes(), (int) projectile->getX(), (int) projectile->getY())){
-        projectile->doCollision(mugen, *this);
+    projectile->doCollision(mugen, *this);
 
-        Character * owner = getCharacter(projectile->getOwner());
+    Character * owner = getCharacter(projectile->getOwner());
 
-        bool block = mugen->isBlocking(projectile->getHitDefinition());
+    bool block = mugen->isBlocking(projectile->getHitDefinition());
 
-        if (block){
-            /* add guard spark and play guard sound */
-            addSpark((int)(projectile->getHitDefinition().sparkPosition.x + projectile->getX()),
-                     (int)(projectile->getHitDefinition().sparkPosition.y + projectile->getY()),
-                     projectile->getHitDefinition().guardSpark,
-                     owner->getDefaultGuardSpark(),
-                     getCharacter(projectile->getOwner()));
+    if (block){
+        /* add guard spark and play guard sound */
+        addSpark((int)(projectile->getHitDefinition().sparkPosition.x + projectile->getX()),
+                 (int)(projectile->getHitDefinition().sparkPosition.y + projectile->getY()),
+                 projectile->getHitDefinition().guardSpark,
+                 owner->getDefaultGuardSpark(),
+                 getCharacter(projectile->getOwner()));
 
-            playSound(owner, projectile->getHitDefinition().guardHitSound.group, projectile->getHitDefinition().guardHitSound.item, projectile->getHitDefinition().guardHitSound.own);
-            mugen->guarded(*this, owner, projectile->getHitDefinition());
-            projectile->wasGuarded(mugen, *this);
-            /* TODO: Should we call didHitGuarded on owner? */
-        } else {
-            addSpark((int)(projectile->getHitDefinition().sparkPosition.x + projectile->getX()),
-                     (int)(projectile->getHitDefinition().sparkPosition.y + projectile->getY()),
-                     projectile->getHitDefinition().spark,
-                     owner->getDefaultSpark(),
-                     getCharacter(projectile->getOwner()));
+        playSound(owner, projectile->getHitDefinition().guardHitSound.group, projectile->getHitDefinition().guardHitSound.item, projectile->getHitDefinition().guardHitSound.own);
+        mugen->guarded(*this, owner, projectile->getHitDefinition());
+        projectile->wasGuarded(mugen, *this);
+        /* TODO: Should we call didHitGuarded on owner? */
+    } else {
+        addSpark((int)(projectile->getHitDefinition().sparkPosition.x + projectile->getX()),
+                 (int)(projectile->getHitDefinition().sparkPosition.y + projectile->getY()),
+                 projectile->getHitDefinition().spark,
+                 owner->getDefaultSpark(),
+                 getCharacter(projectile->getOwner()));
 
-            playSound(owner, projectile->getHitDefinition().hitSound.group, projectile->getHitDefinition().hitSound.item, projectile->getHitDefinition().hitSound.own);
-            mugen->wasHit(*this, owner, projectile->getHitDefinition());
-            /* TODO: Should we call didHit on owner? */
-        }
+        playSound(owner, projectile->getHitDefinition().hitSound.group, projectile->getHitDefinition().hitSound.item, projectile->getHitDefinition().hitSound.own);
+        mugen->wasHit(*this, owner, projectile->getHitDefinition());
+        /* TODO: Should we call didHit on owner? */
     }
 }
 
+/* his attack boxes touched mine */
 void Mugen::Stage::doProjectileToProjectileCollision(Projectile * mine, Projectile * his){
-    if (anyCollisions(mine->getDefenseBoxes(), (int) mine->getX(), (int) mine->getY(),
-                      his->getAttackBoxes(), (int) his->getX(), (int) his->getY())){
-        if (mine->getPriority() > his->getPriority()){
-            his->canceled(*this, mine);
-        } else if (his->getPriority() > mine->getPriority()){
-            mine->canceled(*this, his);
-        } else {
-            /* Both cancel if priorities are the same */
-            mine->canceled(*this, his);
-            his->canceled(*this, mine);
-        }
+    if (mine->getPriority() > his->getPriority()){
+        his->canceled(*this, mine);
+    } else if (his->getPriority() > mine->getPriority()){
+        mine->canceled(*this, his);
+    } else {
+        /* Both cancel if priorities are the same */
+        mine->canceled(*this, his);
+        his->canceled(*this, mine);
     }
 }
 
+/* a * b, rounded to the fixed point grid if `fixed' is set */
+static double physicsMultiply(double a, double b, bool fixed){
+    if (fixed){
+        return (Mugen::FixedPoint(a) * Mugen::FixedPoint(b)).toDouble();
+    }
+    return a * b;
+}
+
+static double physicsAdd(double a, double b, bool fixed){
+    if (fixed){
+        return (Mugen::FixedPoint(a) + Mugen::FixedPoint(b)).toDouble();
+    }
+    return a + b;
+}
+
+void Mugen::Stage::snapToGrid(Character * mugen){
+    mugen->setX(FixedPoint(mugen->getX()).toDouble());
+    mugen->setY(FixedPoint(mugen->getY()).toDouble());
+    mugen->setXVelocity(FixedPoint(mugen->getXVelocity()).toDouble());
+    mugen->setYVelocity(FixedPoint(mugen->getYVelocity()).toDouble());
+}
+
 /* for helpers and players */
 void Mugen::Stage::physics(Character * mugen){
-    // Z/Y offset
-    mugen->setZ(currentZOffset());
-
     /* ignore physics while the player is paused */
     if (mugen->isPaused()){
         return;
     }
 
-    if (getStateData().pause.time > 0){
-        if (getStateData().pause.moveTime == 0){
-            return;
-        }
+    Profile::Scope physicsTime(Profile::Physics);
 
-        if (getCharacter(getStateData().pause.who) != mugen){
-            return;
-        }
+    /* With fixed physics the position and velocity start out on the grid, so
+     * moving by the velocity adds two numbers on the grid, which is exact.
+     * Whatever the state controllers computed this tick is rounded to the
+     * grid here too.
+     */
+    if (fixedPhysics){
+        snapToGrid(mugen);
     }
 
     mugen->doMovement(*this);
@@ -878,7 +947,7 @@ void Mugen::Stage::physics(Character * mugen){
         // mugen->setY(0);
         /* friction */
         if (mugen->getY() == 0){
-            mugen->setXVelocity(mugen->getXVelocity() * mugen->getGroundFriction());
+            mugen->setXVelocity(physicsMultiply(mugen->getXVelocity(), mugen->getGroundFriction(), fixedPhysics));
             if (mugen->getMoveType() == Mugen::Move::Hit && 
                 mugen->getXVelocity() < 0 &&
                 getTicks() % 5 == 0){
@@ -888,90 +957,92 @@ void Mugen::Stage::physics(Character * mugen){
     } else if (mugen->getCurrentPhysics() == Mugen::Physics::Air){
         /* gravity */
         if (mugen->getY() < 0){
-            mugen->setYVelocity(mugen->getYVelocity() + mugen->getGravity());
+            mugen->setYVelocity(physicsAdd(mugen->getYVelocity(), mugen->getGravity(), fixedPhysics));
         }
     }
 
-    if (mugen->isAttacking() && mugen->getHit().alive){
+    /* The hits are looked for once everyone has moved, so they see where the
+     * players end up after pushing each other apart. With fixed physics the
+     * pushes move by halves, which stay on the grid, and the bounds runCycle
+     * puts the players in right after this are whole numbers.
+     */
+    pushPlayers(mugen);
+    if (fixedPhysics){
+        snapToGrid(mugen);
+    }
+}
+
+/* Finds every hit of this tick without applying any of them, so which hit
+ * wins doesn't depend on who happened to be looked at first.
+ */
+void Mugen::Stage::gatherHits(const vector<Character*> & running, HitQueue & hits){
+    for (vector<Mugen::Character*>::const_iterator it = running.begin(); it != running.end(); ++it){
+        Mugen::Character * mugen = *it;
+        if (mugen->isPaused() || !mugen->isAttacking() || !mugen->getHit().alive){
+            continue;
+        }
+
+        const HitDefinition & hit = mugen->getHit();
+        HitPriority::Type type = HitPriority::parse(hit.priority.type);
 
         for (vector<Mugen::Character*>::iterator enem = objects.begin(); enem != objects.end(); ++enem){
             Mugen::Character * enemy = *enem;
-            if (enemy->getAlliance() != mugen->getAlliance() && enemy->canBeHit((Character*) mugen)){
-		// Check attack distance to make sure we begin block at the correct distance
-                /*
-		if (doBlockingDetection(mugen, enemy) && enemy->isBlocking(*mugen->getHit())){
-		    enemy->guarded(mugen);
-		}
-                */
+            if (enemy->getAlliance() == mugen->getAlliance() || !enemy->canBeHit(mugen)){
+                continue;
+            }
 
-                /* Checks attack boxes vs defense boxes */
-                bool collision = doCollisionDetection(mugen, enemy);
+            /* Checks attack boxes vs defense boxes */
+            bool collision = doCollisionDetection(mugen, enemy);
 
-                /* blocking collision extends a little further than a a normal collision */
-                bool blockingCollision = doBlockingDetection(mugen, enemy);
+            /* blocking collision extends a little further than a a normal collision */
+            bool blockingCollision = doBlockingDetection(mugen, enemy);
 
-                /* Checks attack boxes vs attack boxes */
-                bool reversalCollision = doReversalDetection(mugen, enemy);
+            /* Checks attack boxes vs attack boxes */
+            bool reversalCollision = doReversalDetection(mugen, enemy);
 
-                /* If enemy is doing a reversal then that takes precedence
-                 * over everything else here, I think.
-                 */
-                if (enemy->canReverse(mugen) && reversalCollision){
-
-                    /* Add the spark at mugen->hitdef's sparkxy +
-                     *  enemy->reversal­>sparkxy as an offset.
-                     */
-
-                    addSpark((int)(mugen->getHit().sparkPosition.x + enemy->getReversal().sparkX),
-                             (int)(mugen->getHit().sparkPosition.y + enemy->getReversal().sparkY),
-                                 enemy->getReversal().spark,
-                                 enemy->getReversal().spark,
-                                 enemy);
-
-                    playSound(enemy, enemy->getReversal().hitSound.group, enemy->getReversal().hitSound.item, enemy->getReversal().hitSound.own);
-
-                    enemy->didReverse(*this, mugen, enemy->getReversal());
-                    mugen->wasReversed(*this, enemy, enemy->getReversal());
-                } else if ((collision || blockingCollision) &&
-                           enemy->isBlocking(mugen->getHit()) &&
-                           enemy->compatibleHitFlag(mugen->getHit().guardFlag)){
-                    /* guarding */
-
-                    /* FIXME: why do we differentiate between blocking collision and a
-                     * regular collision?
-                     */
-                    if (collision){
-                        addSpark((int)(mugen->getHit().sparkPosition.x + enemy->getX()),
-                                 (int)(mugen->getHit().sparkPosition.y + enemy->getRY()),
-                                 mugen->getHit().guardSpark, mugen->getDefaultGuardSpark(),
-                                 mugen);
-
-                        playSound(mugen, mugen->getHit().guardHitSound.group, mugen->getHit().guardHitSound.item, mugen->getHit().guardHitSound.own);
-                    }
-                    mugen->didHitGuarded(enemy, *this);
-                    enemy->guarded(*this, mugen, mugen->getHit());
-                } else if (collision && enemy->compatibleHitFlag(mugen->getHit().hitFlag)){
-                    addSpark((int)(mugen->getHit().sparkPosition.x + enemy->getX()),
-                             (int)(mugen->getHit().sparkPosition.y + enemy->getRY()),
-                             mugen->getHit().spark, mugen->getDefaultSpark(),
-                             mugen);
-
-                    playSound(mugen, mugen->getHit().hitSound.group, mugen->getHit().hitSound.item, mugen->getHit().hitSound.own);
-
-                    /* order matters here, the guy attacking needs to know that
-                     * he hit enemy so the guy can update his combo stuff.
-                     */
-                    mugen->didHit(enemy, *this);
-                    enemy->wasHit(*this, mugen, mugen->getHit());
-                }
+            /* If enemy is doing a reversal then that takes precedence
+             * over everything else here, I think.
+             */
+            HitCandidate::Kind kind;
+            if (enemy->canReverse(mugen) && reversalCollision){
+                kind = HitCandidate::Reversal;
+            } else if ((collision || blockingCollision) &&
+                       enemy->isBlocking(hit) &&
+                       enemy->compatibleHitFlag(hit.guardFlag)){
+                kind = HitCandidate::Guard;
+            } else if (collision && enemy->compatibleHitFlag(hit.hitFlag)){
+                kind = HitCandidate::Hit;
+            } else {
+                continue;
             }
+
+            HitCandidate candidate(kind, mugen, enemy, hit.priority.hit, type);
+            candidate.touched = collision;
+            candidate.attackerId = mugen->getId().intValue();
+            candidate.defenderId = enemy->getId().intValue();
+            hits.add(candidate);
         }
     }
 
     for (vector<Projectile*>::iterator it = projectiles.begin(); it != projectiles.end(); it++){
         Projectile * projectile = *it;
-        if (projectile->getOwner() != mugen->getId() && projectile->canCollide()){
-            doProjectileCollision(projectile, mugen);
+        const HitDefinition & hit = projectile->getHitDefinition();
+        Character * owner = getCharacter(projectile->getOwner());
+
+        if (projectile->canCollide()){
+            for (vector<Mugen::Character*>::const_iterator enem = running.begin(); enem != running.end(); ++enem){
+                Mugen::Character * enemy = *enem;
+                if (projectile->getOwner() != enemy->getId() &&
+                    !enemy->isPaused() &&
+                    anyCollisions(enemy->getDefenseBoxes(), (int) enemy->getX(), (int) enemy->getRY(),
+                                  projectile->getAttackBoxes(), (int) projectile->getX(), (int) projectile->getY())){
+                    HitCandidate candidate(HitCandidate::ProjectileHit, owner, enemy, hit.priority.hit, HitPriority::parse(hit.priority.type));
+                    candidate.projectile = projectile;
+                    candidate.attackerId = projectile->getOwner().intValue();
+                    candidate.defenderId = enemy->getId().intValue();
+                    hits.add(candidate);
+                }
+            }
         }
 
         for (vector<Projectile*>::iterator it2 = projectiles.begin(); it2 != projectiles.end(); it2++){
@@ -980,15 +1051,128 @@ void Mugen::Stage::physics(Character * mugen){
             /* FIXME: should we test to see if both projectiles can collide or will they
              * cancel each other even if one has its miss time active?
              */
-            if (other != projectile && other->getOwner() != projectile->getOwner()){
-                doProjectileToProjectileCollision(projectile, other);
+            if (other != projectile && other->getOwner() != projectile->getOwner() &&
+                anyCollisions(other->getDefenseBoxes(), (int) other->getX(), (int) other->getY(),
+                              projectile->getAttackBoxes(), (int) projectile->getX(), (int) projectile->getY())){
+                HitCandidate candidate(HitCandidate::ProjectileCancel, owner, getCharacter(other->getOwner()), projectile->getPriority(), HitPriority::Hit);
+                candidate.projectile = projectile;
+                candidate.other = other;
+                candidate.attackerId = projectile->getOwner().intValue();
+                candidate.defenderId = other->getOwner().intValue();
+                hits.add(candidate);
+            }
+        }
+    }
+}
+
+void Mugen::Stage::applyHits(const HitQueue & hits){
+    /* attackers that already connected with someone this tick */
+    set<Character*> connected;
+    vector<HitCandidate> resolved = hits.resolve();
+    for (vector<HitCandidate>::iterator it = resolved.begin(); it != resolved.end(); it++){
+        const bool hitdef = it->kind != HitCandidate::ProjectileHit && it->kind != HitCandidate::ProjectileCancel;
+        if (applyHit(*it, connected) && hitdef){
+            connected.insert(it->attacker);
+        }
+    }
+}
+
+/* The hits were all found before any of them were applied, so an earlier hit
+ * might have changed things. The defender might not be hittable or blocking
+ * anymore, and the attacker might have been hit or reversed. Everything is
+ * checked again like it was when hits were applied as they were found. A
+ * hitdef that connected goes on to the other characters it touched this
+ * tick even though the first hit disabled it. Returns true if the hit
+ * happened.
+ */
+bool Mugen::Stage::applyHit(const HitCandidate & candidate, const set<Character*> & connected){
+    Character * mugen = candidate.attacker;
+    Character * enemy = candidate.defender;
+    switch (candidate.kind){
+        case HitCandidate::Reversal: {
+            if (!(mugen->getHit().alive || connected.find(mugen) != connected.end()) ||
+                !enemy->canReverse(mugen)){
+                return false;
+            }
+
+            /* Add the spark at mugen->hitdef's sparkxy +
+             *  enemy->reversal­>sparkxy as an offset.
+             */
+            addSpark((int)(mugen->getHit().sparkPosition.x + enemy->getReversal().sparkX),
+                     (int)(mugen->getHit().sparkPosition.y + enemy->getReversal().sparkY),
+                     enemy->getReversal().spark,
+                     enemy->getReversal().spark,
+                     enemy);
+
+            playSound(enemy, enemy->getReversal().hitSound.group, enemy->getReversal().hitSound.item, enemy->getReversal().hitSound.own);
+
+            enemy->didReverse(*this, mugen, enemy->getReversal());
+            mugen->wasReversed(*this, enemy, enemy->getReversal());
+            return true;
+        }
+        case HitCandidate::Guard:
+        case HitCandidate::Hit: {
+            if (!(mugen->getHit().alive || connected.find(mugen) != connected.end()) ||
+                !enemy->canBeHit(mugen)){
+                return false;
+            }
+
+            const HitDefinition & hit = mugen->getHit();
+            if (enemy->isBlocking(hit) && enemy->compatibleHitFlag(hit.guardFlag)){
+                /* FIXME: why do we differentiate between blocking collision and a
+                 * regular collision?
+                 */
+                if (candidate.touched){
+                    addSpark((int)(mugen->getHit().sparkPosition.x + enemy->getX()),
+                             (int)(mugen->getHit().sparkPosition.y + enemy->getRY()),
+                             mugen->getHit().guardSpark, mugen->getDefaultGuardSpark(),
+                             mugen);
+
+                    playSound(mugen, mugen->getHit().guardHitSound.group, mugen->getHit().guardHitSound.item, mugen->getHit().guardHitSound.own);
+                }
+                mugen->didHitGuarded(enemy, *this);
+                enemy->guarded(*this, mugen, mugen->getHit());
+                return true;
+            }
+
+            /* only blocking reaches past the attack boxes */
+            if (!candidate.touched || !enemy->compatibleHitFlag(hit.hitFlag)){
+                return false;
+            }
+
+            addSpark((int)(mugen->getHit().sparkPosition.x + enemy->getX()),
+                     (int)(mugen->getHit().sparkPosition.y + enemy->getRY()),
+                     mugen->getHit().spark, mugen->getDefaultSpark(),
+                     mugen);
+
+            playSound(mugen, mugen->getHit().hitSound.group, mugen->getHit().hitSound.item, mugen->getHit().hitSound.own);
+
+            /* order matters here, the guy attacking needs to know that
+             * he hit enemy so the guy can update his combo stuff.
+             */
+            mugen->didHit(enemy, *this);
+            enemy->wasHit(*this, mugen, mugen->getHit());
+            return true;
+        }
+        case HitCandidate::ProjectileHit: {
+            /* an earlier hit this tick might have used up the projectile */
+            if (candidate.projectile->canCollide()){
+                doProjectileCollision(candidate.projectile, enemy);
+                return true;
             }
+            return false;
+        }
+        case HitCandidate::ProjectileCancel: {
+            doProjectileToProjectileCollision(candidate.other, candidate.projectile);
+            return true;
         }
     }
 
-    /* TODO: projectile collisions with other projectiles */
+    return false;
+}
 
-    // Check collisions
+/* keep players from standing inside each other */
+void Mugen::Stage::pushPlayers(Character * mugen){
     for (vector<Mugen::Character*>::iterator enem = objects.begin(); enem != objects.end(); ++enem){
         Mugen::Character *enemy = *enem;
         if (mugen->getAlliance() != enemy->getAlliance()){
@@ -1183,6 +1367,7 @@ void Mugen::Stage::runCycle(){
     updateZoom();
 
     getStateData().screenBound.clear();
+    cameraBounds.clearScreenBounds();
 
     if (paletteEffects.time > 0){
         paletteEffects.time = 0;
@@ -1194,12 +1379,17 @@ void Mugen::Stage::runCycle(){
         getStateData().quake_time--;
     }
 
+    explods.logic();
+
     for (vector<Mugen::Effect*>::iterator it = showSparks.begin(); it != showSparks.end(); /**/){ 
         Mugen::Effect * spark = *it;
-        spark->logic();
+        if (!spark->isBatched()){
+            spark->logic();
+        }
 
         /* if the spark looped then kill it */
         if (spark->isDead()){
+            effectIndex.remove(spark->getOwner(), spark->getId(), spark);
             delete spark;
             it = showSparks.erase(it);
         } else {
@@ -1213,6 +1403,7 @@ void Mugen::Stage::runCycle(){
         projectile->logic(*this);
 
         if (projectile->isDead()){
+            projectileIndex.remove(projectile->getOwner(), projectile->getId(), projectile);
             delete projectile;
             it = projectiles.erase(it);
         } else {
@@ -1259,24 +1450,43 @@ void Mugen::Stage::runCycle(){
        
         // Players go in here
         std::vector<Mugen::Character *> add;
+
+        /* If a pause is occuring then only the player who started the pause
+         * moves, and only while moveTime is > 0.
+         */
+        const vector<Mugen::Character*> & acting = schedule.running(objects, getStateData(), getCharacter(getStateData().pause.who));
+
         /* Do all states first */
-        for (vector<Mugen::Character*>::iterator it = objects.begin(); it != objects.end(); it++){
+        for (unsigned int index = 0; index < acting.size(); /**/){
             /* use local variables more often, iterators can be easily confused */
-            Mugen::Character * player = *it;
+            Mugen::Character * player = acting[index];
+            const Pause before = getStateData().pause;
+            player->act(this);
+            index += 1;
 
-            /* If a pause is occuring then only allow the player who started the pause
-             * to move if moveTime is > 0.
+            /* A state controller might have just started a pause, then the
+             * characters after this one only act if the pause lets them.
              */
-            if (getStateData().pause.time <= 0 || (getStateData().pause.time > 0 && getStateData().pause.moveTime > 0 && getCharacter(getStateData().pause.who) == player)){
-                player->act(this);
+            if (before.time != getStateData().pause.time ||
+                before.moveTime != getStateData().pause.moveTime ||
+                before.who != getStateData().pause.who){
+                schedule.running(objects, getStateData(), getCharacter(getStateData().pause.who));
+                index = schedule.after(objects, player);
             }
         }
 
-        /* Then do physics/collision detection */
+        /* Then do physics. A state controller might have just started a pause. */
+        const vector<Mugen::Character*> & moving = schedule.running(objects, getStateData(), getCharacter(getStateData().pause.who));
+        for (vector<Mugen::Character*>::const_iterator it = moving.begin(); it != moving.end(); it++){
+            physics(*it);
+        }
+
         for (vector<Mugen::Character*>::iterator it = objects.begin(); it != objects.end(); /**/ ){
             bool next = true;
             Mugen::Character * player = *it;
-            physics(player);
+
+            // Z/Y offset
+            player->setZ(currentZOffset());
 
             /* Debug crap put it on console */
             // *console << "Object: " << player << " x: " << player->getX() << " y: " << player->getY() << cend;
@@ -1293,6 +1503,7 @@ void Mugen::Stage::runCycle(){
             } else if (!isaPlayer(player) && player->getHealth() <= 0){
                 player->destroyed(*this);
                 // unbind(player);
+                removeCharacter(player);
                 delete player;
                 it = objects.erase(it);
                 next = false;
@@ -1303,17 +1514,39 @@ void Mugen::Stage::runCycle(){
             }
         }
 
+        /* Then the hits, once everyone has moved. Characters that were just
+         * removed are gone from the schedule too.
+         */
+        {
+            Profile::Scope collisionTime(Profile::Collision);
+            HitQueue hits;
+            gatherHits(schedule.running(objects, getStateData(), getCharacter(getStateData().pause.who)), hits);
+            applyHits(hits);
+        }
+
+        /* hits change the velocity of characters whose physics already ran,
+         * so put everyone back on the grid at the end
+         */
+        if (fixedPhysics){
+            for (vector<Mugen::Character*>::iterator it = objects.begin(); it != objects.end(); it++){
+                snapToGrid(*it);
+            }
+        }
+
         /* Have to insert objects at the front of the vector because new helpers should
          * have their states executed before players. At least this is the only way
          * I can get MVC2_IronMan's intro to work properly.
          */
         objects.insert(objects.begin(), add.begin(), add.end());
         objects.insert(objects.begin(), addedObjects.begin(), addedObjects.end());
+        addCharacters(add);
+        addCharacters(addedObjects);
         addedObjects.clear();
     }
 }
 
 void Mugen::Stage::logic(){
+    Arena::Use useArena(arena);
 
     /* This must be the first thing done in this function! */
     /*
@@ -1334,11 +1567,18 @@ void Mugen::Stage::logic(){
     // Correct camera
     if ((verticalfollow > 0) && !getStateData().inabove && (getCameraY() < 0)){
         /* FIXME: where did 3.2 come from? */
-	moveCamera(0, verticalfollow * 3.2);
+	moveCamera(0, cameraBounds.followStep());
     }
     
-    // Player HUD Need to make this more elegant than casting and passing from array
-    gameHUD->act(*this, *((Mugen::Character *)players[0]),*((Mugen::Character *)players[1]));
+    /* The HUD follows the team leaders, for simul teams that is whoever is
+     * still standing so a side only loses the round when all of it is down.
+     */
+    gameHUD->act(*this, *getTeamLeader(Player1Side), *getTeamLeader(Player2Side));
+    shareTeamWins();
+    updatePartnerBehavior();
+
+    /* the lists made during the tick are all gone by now */
+    arena.reset();
 
     /* This must be the last thing done in this function! */
     /*
@@ -1583,12 +1823,18 @@ void Mugen::Stage::updateState(const Mugen::World & world){
         }
     }
 
-    gameHUD->getRound().updatePlayerBehavior(*players[0], *players[1]);
+    gameHUD->getRound().updatePlayerBehavior(*getTeamLeader(Player1Side), *getTeamLeader(Player2Side));
+    updatePartnerBehavior();
+}
+
+Mugen::Arena & Mugen::Stage::getArena(){
+    return arena;
 }
 
 /* Returns a sorted listed of sprite priorties */
-vector<int> Mugen::Stage::allSpritePriorities(){
-    vector<int> priorities;
+Mugen::TickVector<int>::type Mugen::Stage::allSpritePriorities(){
+    TickVector<int>::type priorities;
+    priorities.reserve(objects.size() + projectiles.size() + showSparks.size());
 
     for (vector<Mugen::Character*>::iterator it = objects.begin(); it != objects.end(); it++){
         Mugen::Character * object = *it;
@@ -1606,14 +1852,14 @@ vector<int> Mugen::Stage::allSpritePriorities(){
     }
 
     std::sort(priorities.begin(), priorities.end());
-    vector<int>::iterator newEnd = std::unique(priorities.begin(), priorities.end());
+    TickVector<int>::type::iterator newEnd = std::unique(priorities.begin(), priorities.end());
     priorities.resize(newEnd - priorities.begin());
 
     return priorities;
 }
 
 int Mugen::Stage::findMinimumSpritePriority(){
-    vector<int> priorities = allSpritePriorities();
+    TickVector<int>::type priorities = allSpritePriorities();
     std::sort(priorities.begin(), priorities.end());
 
     if (priorities.size() > 0){
@@ -1624,7 +1870,7 @@ int Mugen::Stage::findMinimumSpritePriority(){
 }
 
 int Mugen::Stage::findMaximumSpritePriority(){
-    vector<int> priorities = allSpritePriorities();
+    TickVector<int>::type priorities = allSpritePriorities();
     std::sort(priorities.begin(), priorities.end());
 
     if (priorities.size() > 0){
@@ -1635,6 +1881,11 @@ int Mugen::Stage::findMaximumSpritePriority(){
 }
 
 void Mugen::Stage::render(Graphics::Bitmap *work){
+    /* a paused game draws without running ticks, so a frame starts the
+     * arena over too
+     */
+    Arena::Use useArena(arena);
+    arena.reset();
 
     if (getStateData().environmentColor.time == 0){
         if (paletteEffects.time > 0){
@@ -1667,8 +1918,8 @@ void Mugen::Stage::render(Graphics::Bitmap *work){
     int maximumSpritePriority = findMaximumSpritePriority();
     */
 
-    vector<int> priorities = allSpritePriorities();
-    for (vector<int>::iterator spritePriority = priorities.begin(); spritePriority != priorities.end(); spritePriority++){
+    TickVector<int>::type priorities = allSpritePriorities();
+    for (TickVector<int>::type::iterator spritePriority = priorities.begin(); spritePriority != priorities.end(); spritePriority++){
         // Players go in here
         for (vector<Mugen::Character*>::iterator it = objects.begin(); it != objects.end(); it++){
             Mugen::Character *obj = *it;
@@ -1782,6 +2033,7 @@ void Mugen::Stage::setMatchWins(int wins){
 void Mugen::Stage::reset(){
     getStateData().camerax = startx;
     getStateData().cameray = starty;
+    updateCameraBounds();
     originalMaxLeft = maximumLeft(NULL);
     originalMaxRight = maximumRight(NULL);
     gameOver = false;
@@ -1811,6 +2063,7 @@ void Mugen::Stage::reset(){
         if (!isaPlayer(player)){
             player->destroyed(*this);
             // unbind(player);
+            removeCharacter(player);
             delete player;
             it = objects.erase(it);
         } else {
@@ -1818,33 +2071,7 @@ void Mugen::Stage::reset(){
             vector<string> inputs;
             //character->changeState(*this, Mugen::Intro, inputs);
             character->setHealth(character->getMaxHealth());
-            if (player->getAlliance() == Player1Side){
-                //((Player *)player)->deathReset();
-                player->setX(p1startx);
-                player->setY(p1starty);
-                player->setZ(currentZOffset());
-                player->setFacing(FacingRight);
-                playerInfo[player].oldx = player->getX();
-                playerInfo[player].oldy = player->getY();
-                playerInfo[player].leftTension = false;
-                playerInfo[player].rightTension = false;
-                playerInfo[player].leftSide = false;
-                playerInfo[player].rightSide = false;
-                playerInfo[player].jumped = false;
-            } else if (player->getAlliance() == Player2Side){
-                //((Player *)player)->deathReset();
-                player->setX(p2startx);
-                player->setY(p2starty);
-                player->setZ(currentZOffset());
-                player->setFacing(FacingLeft);
-                playerInfo[player].oldx = player->getX();
-                playerInfo[player].oldy = player->getY();
-                playerInfo[player].leftTension = false;
-                playerInfo[player].rightTension = false;
-                playerInfo[player].leftSide = false;
-                playerInfo[player].rightSide = false;
-                playerInfo[player].jumped = false;
-            }
+            resetPosition(player, isPartner(player));
             it++;
         }
     }
@@ -1858,53 +2085,143 @@ void Mugen::Stage::reset(){
         throw MugenException("Internal error: Stage not loaded, call load()", __FILE__, __LINE__);
     }
 
-    gameHUD->reset(*this, *((Mugen::Character *)players[0]),*((Mugen::Character *)players[1]));
+    Mugen::Character * leader1 = getTeamLeader(Player1Side);
+    Mugen::Character * leader2 = getTeamLeader(Player2Side);
+    if (leader1 == NULL || leader2 == NULL){
+        throw MugenException("Need a player on each side", __FILE__, __LINE__);
+    }
+
+    gameHUD->reset(*this, *leader1, *leader2);
+    updatePartnerBehavior();
 }
 
 std::vector<Mugen::Character *> Mugen::Stage::getPlayers() const {
     return players;
 }
 
+void Mugen::Stage::resetPosition(Mugen::Character * player, bool partner){
+    if (player->getAlliance() == Player1Side){
+        //((Player *)player)->deathReset();
+        player->setX(partner ? p3startx : p1startx);
+        player->setY(partner ? p3starty : p1starty);
+        player->setFacing(partner && p3facing < 0 ? FacingLeft : FacingRight);
+    } else if (player->getAlliance() == Player2Side){
+        //((Player *)player)->deathReset();
+        player->setX(partner ? p4startx : p2startx);
+        player->setY(partner ? p4starty : p2starty);
+        player->setFacing(partner && p4facing > 0 ? FacingRight : FacingLeft);
+    }
+    player->setZ(currentZOffset());
+    playerInfo[player].oldx = player->getX();
+    playerInfo[player].oldy = player->getY();
+    playerInfo[player].leftTension = false;
+    playerInfo[player].rightTension = false;
+    playerInfo[player].leftSide = false;
+    playerInfo[player].rightSide = false;
+    playerInfo[player].jumped = false;
+}
+
+Mugen::Character * Mugen::Stage::getTeamLeader(teams side) const {
+    Mugen::Character * first = NULL;
+    for (vector<Mugen::Character*>::const_iterator it = players.begin(); it != players.end(); it++){
+        Mugen::Character * player = *it;
+        if (player->getAlliance() == side){
+            if (player->getHealth() > 0){
+                return player;
+            }
+            if (first == NULL){
+                first = player;
+            }
+        }
+    }
+
+    return first;
+}
+
+bool Mugen::Stage::isPartner(const Mugen::Character * who) const {
+    for (vector<Mugen::Character*>::const_iterator it = players.begin(); it != players.end(); it++){
+        Mugen::Character * player = *it;
+        if (player->getAlliance() == who->getAlliance()){
+            return player != who;
+        }
+    }
+
+    return false;
+}
+
+void Mugen::Stage::updatePartnerBehavior(){
+    if (players.size() <= 2){
+        return;
+    }
+
+    bool playing = gameHUD->getRound().getState() == Round::PlayingGame;
+    for (vector<Mugen::Character*>::iterator it = players.begin(); it != players.end(); it++){
+        Mugen::Character * player = *it;
+        if (!isPartner(player)){
+            continue;
+        }
+
+        /* The first time a partner is seen it still has the behavior it was
+         * given before the match started, after that the round might have
+         * changed it while the partner was standing in for a fallen leader.
+         */
+        if (partnerBehaviors.find(player) == partnerBehaviors.end()){
+            partnerBehaviors[player] = player->getBehavior();
+        }
+
+        if (playing){
+            player->setBehavior(partnerBehaviors[player]);
+        } else {
+            player->setBehavior(&partnerDummy);
+        }
+    }
+}
+
+void Mugen::Stage::shareTeamWins(){
+    if (players.size() <= 2){
+        return;
+    }
+
+    for (vector<Mugen::Character*>::iterator it = players.begin(); it != players.end(); it++){
+        Mugen::Character * player = *it;
+        const vector<WinGame> & wins = player->getWins();
+        for (vector<Mugen::Character*>::iterator mate_it = players.begin(); mate_it != players.end(); mate_it++){
+            Mugen::Character * mate = *mate_it;
+            if (mate != player && mate->getAlliance() == player->getAlliance()){
+                for (unsigned int win = mate->getWins().size(); win < wins.size(); win++){
+                    mate->addWin(wins[win]);
+                }
+            }
+        }
+    }
+}
+
 // Add player1 people
 void Mugen::Stage::addPlayer1(Mugen::Character * o){
+    /* anyone after the first player on a side is a simul partner */
+    bool partner = getTeamLeader(Player1Side) != NULL;
     o->setAlliance(Player1Side);
-    o->setX(p1startx);
-    o->setY(p1starty);
-    o->setZ(currentZOffset());
-    o->setFacing(FacingRight);
     o->setId(nextId());
     objects.push_back(o);
+    objectTable.add(o);
+    schedule.charactersChanged();
     players.push_back(o);
-
-    playerInfo[o].oldx = o->getX();
-    playerInfo[o].oldy = o->getY();
-    playerInfo[o].leftTension = false;
-    playerInfo[o].rightTension = false;
-    playerInfo[o].leftSide = false;
-    playerInfo[o].rightSide = false;
-    playerInfo[o].jumped = false;
+    resetPosition(o, partner);
 
     o->setCommonSounds(&sounds);
 }
 
 // Add player2 people
 void Mugen::Stage::addPlayer2(Mugen::Character * o){
+    /* anyone after the first player on a side is a simul partner */
+    bool partner = getTeamLeader(Player2Side) != NULL;
     o->setAlliance(Player2Side);
-    o->setX(p2startx);
-    o->setY(p2starty);
-    o->setZ(currentZOffset());
-    o->setFacing(FacingLeft);
     o->setId(nextId());
     objects.push_back(o);
+    objectTable.add(o);
+    schedule.charactersChanged();
     players.push_back(o);
-    
-    playerInfo[o].oldx = o->getX();
-    playerInfo[o].oldy = o->getY();
-    playerInfo[o].leftTension = false;
-    playerInfo[o].rightTension = false;
-    playerInfo[o].leftSide = false;
-    playerInfo[o].rightSide = false;
-    playerInfo[o].jumped = false;
+    resetPosition(o, partner);
 
     o->setCommonSounds(&sounds);
 }
@@ -2047,6 +2364,7 @@ void Mugen::Stage::cleanup(){
             delete *it;
         }
         showSparks.clear();
+        effectIndex.clear();
 /*
         for (map<unsigned int, map<unsigned int, Mugen::Sound*> >::iterator it1 = sounds.begin(); it1 != sounds.end(); it1++){
             map<unsigned int, Mugen::Sound*> & group = (*it1).second;
@@ -2061,6 +2379,7 @@ void Mugen::Stage::cleanup(){
             delete *it;
         }
         projectiles.clear();
+        projectileIndex.clear();
 
         for (vector<Mugen::Character*>::iterator it = objects.begin(); it != objects.end(); /**/){
             Mugen::Character * object = *it;
@@ -2069,6 +2388,7 @@ void Mugen::Stage::cleanup(){
             if (!isaPlayer(object)){
                 object->destroyed(*this);
                 // unbind(object);
+                removeCharacter(object);
                 delete object;
                 it = objects.erase(it);
             } else {
@@ -2095,39 +2415,45 @@ int Mugen::Stage::getStartingRight() const {
     return originalMaxRight;
 }
 
+/* called whenever the camera moves so the edges are never out of date */
+void Mugen::Stage::updateCameraBounds(){
+    cameraBounds.update(getStateData().camerax, getStateData().cameray);
+}
+
 int Mugen::Stage::maximumRight(const Character * who) const {
     if (who != NULL){
-        map<CharacterId, ScreenBound>::const_iterator find = getStateData().screenBound.find(who->getId());
-        if (find != getStateData().screenBound.end() &&
-            find->second.enabled && find->second.offScreen){
-            return boundright + DEFAULT_WIDTH / 2;
-        }
+        return cameraBounds.right(who->getId());
     }
-    return (int)(getStateData().camerax + DEFAULT_WIDTH / 2);
+    return cameraBounds.right();
 }
 
 int Mugen::Stage::maximumLeft(const Character * who) const {
     if (who != NULL){
-        map<CharacterId, ScreenBound>::const_iterator find = getStateData().screenBound.find(who->getId());
-        if (find != getStateData().screenBound.end() &&
-            find->second.enabled && find->second.offScreen){
-            return boundleft - DEFAULT_WIDTH / 2;
-        }
+        return cameraBounds.left(who->getId());
     }
-    return (int)(getStateData().camerax - DEFAULT_WIDTH / 2);
+    return cameraBounds.left();
+}
+
+int Mugen::Stage::leftTension(const Character * who) const {
+    return cameraBounds.leftTension(who->getId());
+}
+
+int Mugen::Stage::rightTension(const Character * who) const {
+    return cameraBounds.rightTension(who->getId());
 }
 
 /* FIXME: I think screenbound should deal with maximumUp/Down */
 int Mugen::Stage::maximumUp() const {
-    return getStateData().cameray;
+    return cameraBounds.up();
 }
 
 int Mugen::Stage::maximumDown() const {
-    return getStateData().cameray + DEFAULT_HEIGHT;
+    return cameraBounds.down();
 }
     
 void Mugen::Stage::addProjectile(Projectile * projectile){
     projectiles.push_back(projectile);
+    projectileIndex.add(projectile->getOwner(), projectile->getId(), projectile);
 }
 
 void Mugen::Stage::updatePlayer(Mugen::Character * player){
@@ -2147,8 +2473,8 @@ void Mugen::Stage::updatePlayer(Mugen::Character * player){
        const double screenLeft = abs(boundleft) + camerax;
        const double screenRight = abs(boundleft) + camerax + DEFAULT_WIDTH;
        */
-    const double leftTension = screenLeft + tension;
-    const double rightTension = screenRight - tension;
+    const double leftTension = this->leftTension(player);
+    const double rightTension = this->rightTension(player);
     // Check leftbound rightbound
     if (px < leftbound){
         player->setX(leftbound);
@@ -2227,8 +2553,7 @@ void Mugen::Stage::updatePlayer(Mugen::Character * player){
     //Global::debug(0) << "Left Tension: " << inleft << " | Right Tension: "<< inright << endl;
     //Global::debug(0) << "Left Screen Edge: " << onLeftSide << " | Right Screen Edge: "<< onRightSide << endl;
 
-    if (!getStateData().screenBound[player->getId()].enabled ||
-        getStateData().screenBound[player->getId()].panX){
+    if (cameraBounds.panX(player->getId())){
         if (playerInfo[player].leftTension){
             if (pdiffx < 0){
                 if (!getStateData().onRightSide){
@@ -2252,8 +2577,7 @@ void Mugen::Stage::updatePlayer(Mugen::Character * player){
         }
     }
 
-    if (!getStateData().screenBound[player->getId()].enabled ||
-        getStateData().screenBound[player->getId()].panY){
+    if (cameraBounds.panY(player->getId())){
         // Vertical movement of camera
         if (playerInfo[player].oldy != py){
             if (verticalfollow > 0){
@@ -2268,9 +2592,9 @@ void Mugen::Stage::updatePlayer(Mugen::Character * player){
                     getStateData().inabove--;
                 }
                 if (playerInfo[player].above && pdiffy < 0){
-                    moveCamera( 0, verticalfollow * -3.2 );
+                    moveCamera( 0, -cameraBounds.followStep() );
                 } else if (playerInfo[player].above && pdiffy > 0){
-                    moveCamera( 0, verticalfollow * 3.2 );
+                    moveCamera( 0, cameraBounds.followStep() );
                 }
             }
         }
@@ -2419,7 +2743,8 @@ bool Mugen::Stage::doContinue(const Mugen::PlayerType & type, InputMap<Mugen::Ke
         shadowFadeRangeHigh(shadowFadeRangeHigh),
         shadowFadeRangeMid(shadowFadeRangeMid),
         font(font),
-        logic(logic){
+        logic(logic),
+        presenter(320, 240){
         }
 
         Mugen::Background * background;
@@ -2435,10 +2760,10 @@ bool Mugen::Stage::doContinue(const Mugen::PlayerType & type, InputMap<Mugen::Ke
     
         Font & font;
         const Logic & logic;
+        Presenter presenter;
 
         void draw(const Graphics::Bitmap & screen){
-            Graphics::StretchedBitmap board(320, 240, screen, Graphics::StretchedBitmap::NoClear, Graphics::qualityFilterName(::Configuration::getQualityFilter()));
-            board.start();
+            Graphics::Bitmap & board = presenter.start(screen);
             // Render background
             background->renderBackground(0, 0, board);
         
@@ -2473,7 +2798,7 @@ bool Mugen::Stage::doContinue(const Mugen::PlayerType & type, InputMap<Mugen::Ke
             // Foreground
             background->renderForeground(0, 0, board);
 
-            board.finish();
+            presenter.finish(screen);
             // board->Stretch(buffer);
             // screen.BlitToScreen();
         }
@@ -2487,15 +2812,26 @@ bool Mugen::Stage::doContinue(const Mugen::PlayerType & type, InputMap<Mugen::Ke
     return logic.getAnswer();
 }
     
+/* With simul teams there can be more than one enemy, the closest one that is
+ * still standing is picked.
+ */
 Mugen::Character * Mugen::Stage::getEnemy(const Mugen::Character * who) const {
+    Mugen::Character * found = NULL;
+    double distance = 0;
     for (vector<Mugen::Character*>::const_iterator enem = objects.begin(); enem != objects.end(); ++enem){
         Mugen::Character * enemy = *enem;
         if (who->getAlliance() != enemy->getAlliance() && isaPlayer(enemy)){
-            return enemy;
+            double away = fabs(enemy->getX() - who->getX());
+            if (found == NULL ||
+                (found->getHealth() <= 0 && enemy->getHealth() > 0) ||
+                ((found->getHealth() > 0) == (enemy->getHealth() > 0) && away < distance)){
+                found = enemy;
+                distance = away;
+            }
         }
     }
 
-    return NULL;
+    return found;
 }
 
 int Mugen::Stage::getGameTime() const {
@@ -2535,22 +2871,35 @@ void Mugen::Stage::createDust(int x, int y){
         
 void Mugen::Stage::addEffect(Mugen::Effect * effect){
     showSparks.push_back(effect);
+    effectIndex.add(effect->getOwner(), effect->getId(), effect);
 }
 
 int Mugen::Stage::countMyHelpers(const Mugen::Character * owner) const {
+    return helperIndex.countAll(owner->getId());
+}
+
+int Mugen::Stage::countHelpers() const {
     int count = 0;
     for (vector<Mugen::Character*>::const_iterator it = objects.begin(); it != objects.end(); it++){
-        Mugen::Character * who = *it;
-        if (who->isHelper()){
-            Mugen::Helper * helper = (Mugen::Helper*) who;
-            if (helper->getParent() == owner->getId()){
-                count += 1;
-            }
+        if ((*it)->isHelper()){
+            count += 1;
         }
     }
     return count;
 }
 
+Mugen::ExplodStore & Mugen::Stage::getExplods(){
+    return explods;
+}
+
+int Mugen::Stage::countExplods() const {
+    return explods.size();
+}
+
+int Mugen::Stage::countProjectiles() const {
+    return projectiles.size();
+}
+
 vector<Mugen::Character *> Mugen::Stage::getTargets(int id, const Mugen::Character * from) const {
     vector<Mugen::Character *> targets;
     if (id == -1){
@@ -2591,6 +2940,8 @@ void Mugen::Stage::removeHelper(Mugen::Character * who){
         removeEffects(who, -1);
 
         vector<Mugen::Helper*> children = findHelpers(who);
+        /* the children won't be found through this helper anymore */
+        helperIndex.removeOwner(who->getId());
         for (vector<Mugen::Helper*>::iterator it = children.begin(); it != children.end(); it++){
             Mugen::Helper * helper = *it;
             /* lose parent association, still has root though */
@@ -2601,9 +2952,15 @@ void Mugen::Stage::removeHelper(Mugen::Character * who){
 }
 
 void Mugen::Stage::removeEffects(const Mugen::Character * owner, int id){
+    /* usually there is nothing to remove */
+    if ((id == -1 ? effectIndex.countAll(owner) : effectIndex.count(owner, id)) == 0){
+        return;
+    }
+
     for (vector<Mugen::Effect*>::iterator it = showSparks.begin(); it != showSparks.end(); /**/ ){ 
         Mugen::Effect * effect = *it;
         if (effect->getOwner() == owner && (id == -1 || id == effect->getId())){
+            effectIndex.remove(effect->getOwner(), effect->getId(), effect);
             delete effect;
             it = showSparks.erase(it);
         } else {
@@ -2613,52 +2970,41 @@ void Mugen::Stage::removeEffects(const Mugen::Character * owner, int id){
 }
 
 Mugen::Character * Mugen::Stage::getCharacter(const CharacterId & id) const {
-    for (vector<Mugen::Character*>::const_iterator it = objects.begin(); it != objects.end(); it++){
-        Mugen::Character * object = *it;
-        if (object->getId() == id){
-            return object;
-        }
-    }
-    return NULL;
+    return objectTable.find(id);
 }
 
 std::vector<Mugen::Effect*> Mugen::Stage::findExplode(int id, const Character * owner) const {
-    vector<Effect*> found;
+    return getExplods(id, owner);
+}
 
-    for (vector<Effect*>::const_iterator it = showSparks.begin(); it != showSparks.end(); it++){
-        Effect * effect = *it;
-        if ((id == 0 || effect->getId() == id) && effect->getOwner() == owner){
-            found.push_back(effect);
-        }
+const std::vector<Mugen::Effect*> & Mugen::Stage::getExplods(int id, const Character * owner) const {
+    if (id == 0){
+        return effectIndex.getAll(owner);
     }
+    return effectIndex.get(owner, id);
+}
 
-    return found;
+int Mugen::Stage::countExplods(int id, const Character * owner) const {
+    return getExplods(id, owner).size();
 }
 
 vector<Mugen::Projectile*> Mugen::Stage::findProjectile(int id, const Character * owner) const {
-    vector<Projectile*> found;
+    return getProjectiles(id, owner);
+}
 
-    for (vector<Projectile*>::const_iterator it = projectiles.begin(); it != projectiles.end(); it++){
-        Projectile * projectile = *it;
-        if ((id == 0 || projectile->getId() == id) && projectile->getOwner() == owner->getId()){
-            found.push_back(projectile);
-        }
+const vector<Mugen::Projectile*> & Mugen::Stage::getProjectiles(int id, const Character * owner) const {
+    if (id == 0){
+        return projectileIndex.getAll(owner->getId());
     }
+    return projectileIndex.get(owner->getId(), id);
+}
 
-    return found;
+int Mugen::Stage::countProjectiles(int id, const Character * owner) const {
+    return getProjectiles(id, owner).size();
 }
 
 vector<Mugen::Helper*> Mugen::Stage::findHelpers(const Mugen::Character * owner, int id) const {
-    vector<Mugen::Helper*> out;
-    for (vector<Mugen::Character*>::const_iterator it = objects.begin(); it != objects.end(); it++){
-        Mugen::Character * who = *it;
-        if (who->isHelper()){
-            Mugen::Helper * helper = (Mugen::Helper*) who;
-            if (helper->getHelperId() == id && helper->getParent() == owner->getId()){
-                out.push_back(helper);
-            }
-        }
-    }
+    vector<Mugen::Helper*> out = helperIndex.get(owner->getId(), id);
 
     /* Have to check the addedObjects vector in case the player adds a helper and then
      * immediately checks for its existence in the same tick. `Guy' does this.
@@ -2676,8 +3022,9 @@ vector<Mugen::Helper*> Mugen::Stage::findHelpers(const Mugen::Character * owner,
 }
 
 vector<Mugen::Helper*> Mugen::Stage::findHelpers(const Mugen::Character * owner) const {
-    vector<Mugen::Helper*> out;
-    for (vector<Mugen::Character*>::const_iterator it = objects.begin(); it != objects.end(); it++){
+    vector<Mugen::Helper*> out = helperIndex.getAll(owner->getId());
+
+    for (vector<Mugen::Character*>::const_iterator it = addedObjects.begin(); it != addedObjects.end(); it++){
         Mugen::Character * who = *it;
         if (who->isHelper()){
             Mugen::Helper * helper = (Mugen::Helper*) who;
@@ -2686,40 +3033,142 @@ vector<Mugen::Helper*> Mugen::Stage::findHelpers(const Mugen::Character * owner)
             }
         }
     }
+    return out;
+}
 
+int Mugen::Stage::countHelpers(const Mugen::Character * owner, int id) const {
+    int count = helperIndex.count(owner->getId(), id);
     for (vector<Mugen::Character*>::const_iterator it = addedObjects.begin(); it != addedObjects.end(); it++){
         Mugen::Character * who = *it;
         if (who->isHelper()){
             Mugen::Helper * helper = (Mugen::Helper*) who;
-            if (helper->getParent() == owner->getId()){
-                out.push_back(helper);
+            if (helper->getHelperId() == id && helper->getParent() == owner->getId()){
+                count += 1;
             }
         }
     }
-    return out;
+    return count;
 }
     
 Mugen::Effect * Mugen::Stage::findEffect(const Mugen::Character * owner, int id){
-    for (vector<Mugen::Effect*>::iterator it = showSparks.begin(); it != showSparks.end(); it++){ 
-        Mugen::Effect * effect = *it;
-        if (effect->getOwner() == owner && id == effect->getId()){
-            return effect;
+    const vector<Mugen::Effect*> & effects = effectIndex.get(owner, id);
+    if (effects.empty()){
+        return NULL;
+    }
+    return effects[0];
+}
+
+vector<Mugen::Effect *> Mugen::Stage::findEffects(const Mugen::Character * owner, int id){
+    if (id == -1){
+        return effectIndex.getAll(owner);
+    }
+    return effectIndex.get(owner, id);
+}
+
+/* Only the stage's own characters are put in the index, helpers that were just
+ * made are in addedObjects until the end of the tick.
+ */
+void Mugen::Stage::addCharacters(const vector<Mugen::Character*> & characters){
+    schedule.charactersChanged();
+    for (vector<Mugen::Character*>::const_iterator it = characters.begin(); it != characters.end(); it++){
+        objectTable.add(*it);
+    }
+
+    /* the characters went in front of the others, so they go in front in the
+     * index too, in the same order
+     */
+    for (vector<Mugen::Character*>::const_reverse_iterator it = characters.rbegin(); it != characters.rend(); it++){
+        Mugen::Character * who = *it;
+        if (who->isHelper()){
+            Mugen::Helper * helper = (Mugen::Helper*) who;
+            helperIndex.addFront(helper->getParent(), helper->getHelperId(), helper);
         }
     }
+}
 
-    return NULL;
+void Mugen::Stage::removeCharacter(Mugen::Character * who){
+    schedule.charactersChanged();
+    objectTable.remove(who->getId());
+    if (who->isHelper()){
+        Mugen::Helper * helper = (Mugen::Helper*) who;
+        helperIndex.remove(helper->getParent(), helper->getHelperId(), helper);
+    }
 }
 
-vector<Mugen::Effect *> Mugen::Stage::findEffects(const Mugen::Character * owner, int id){
-    vector<Mugen::Effect*> effects;
-    for (vector<Mugen::Effect*>::iterator it = showSparks.begin(); it != showSparks.end(); it++){ 
-        Mugen::Effect * effect = *it;
-        if (effect->getOwner() == owner && (id == effect->getId() || id == -1)){
-            effects.push_back(effect);
+template <class Thing>
+static bool sameList(const vector<Thing*> & indexed, const vector<Thing*> & searched){
+    return indexed.size() == searched.size() && std::equal(indexed.begin(), indexed.end(), searched.begin());
+}
+
+bool Mugen::Stage::checkIndexes() const {
+    for (vector<Mugen::Character*>::const_iterator owner = objects.begin(); owner != objects.end(); owner++){
+        const Mugen::Character * who = *owner;
+        if (getCharacter(who->getId()) != who){
+            return false;
+        }
+
+        vector<Effect*> allEffects;
+        map<int, vector<Effect*> > effectsById;
+        for (vector<Effect*>::const_iterator it = showSparks.begin(); it != showSparks.end(); it++){
+            if ((*it)->getOwner() == who){
+                allEffects.push_back(*it);
+                effectsById[(*it)->getId()].push_back(*it);
+            }
+        }
+
+        if (!sameList(effectIndex.getAll(who), allEffects)){
+            return false;
+        }
+
+        for (map<int, vector<Effect*> >::iterator it = effectsById.begin(); it != effectsById.end(); it++){
+            if (!sameList(effectIndex.get(who, it->first), it->second)){
+                return false;
+            }
+        }
+
+        vector<Projectile*> allProjectiles;
+        map<int, vector<Projectile*> > projectilesById;
+        for (vector<Projectile*>::const_iterator it = projectiles.begin(); it != projectiles.end(); it++){
+            if ((*it)->getOwner() == who->getId()){
+                allProjectiles.push_back(*it);
+                projectilesById[(*it)->getId()].push_back(*it);
+            }
+        }
+
+        if (!sameList(projectileIndex.getAll(who->getId()), allProjectiles)){
+            return false;
+        }
+
+        for (map<int, vector<Projectile*> >::iterator it = projectilesById.begin(); it != projectilesById.end(); it++){
+            if (!sameList(projectileIndex.get(who->getId(), it->first), it->second)){
+                return false;
+            }
+        }
+
+        vector<Helper*> allHelpers;
+        map<int, vector<Helper*> > helpersById;
+        for (vector<Mugen::Character*>::const_iterator it = objects.begin(); it != objects.end(); it++){
+            if ((*it)->isHelper()){
+                Mugen::Helper * helper = (Mugen::Helper*) *it;
+                if (helper->getParent() == who->getId()){
+                    allHelpers.push_back(helper);
+                    helpersById[helper->getHelperId()].push_back(helper);
+                }
+            }
+        }
+
+        if (!sameList(helperIndex.getAll(who->getId()), allHelpers)){
+            return false;
+        }
+
+        for (map<int, vector<Helper*> >::iterator it = helpersById.begin(); it != helpersById.end(); it++){
+            if (!sameList(helperIndex.get(who->getId(), it->first), it->second)){
+                return false;
+            }
         }
     }
 
-    return effects;
+    return true;
 }
 
 void Mugen::Stage::setPaletteEffects(int time, int addRed, int addGreen, int addBlue, int multiplyRed, int multiplyGreen, int multiplyBlue, int sinRed, int sinGreen, int sinBlue, int period, int invert, int color){
@@ -2749,6 +3198,7 @@ void Mugen::Stage::enableScreenBound(Character * who, bool offScreen, bool panX,
     getStateData().screenBound[id].offScreen = offScreen;
     getStateData().screenBound[id].panX = panX;
     getStateData().screenBound[id].panY = panY;
+    cameraBounds.setScreenBound(id, offScreen, panX, panY);
 }
 
 void Mugen::Stage::doZoom(double x, double y, int zoomTime, int zoomOutTime, int time,
@@ -2846,6 +3296,8 @@ const Mugen::StageStateData & Mugen::Stage::getStateData() const {
     
 void Mugen::Stage::setStateData(const Mugen::StageStateData & data){
     this->stateData = data;
+    cameraBounds.setScreenBounds(getStateData().screenBound);
+    updateCameraBounds();
 }
 
 Mugen::StageObserver::StageObserver(){
@@ -2854,6 +3306,9 @@ Mugen::StageObserver::StageObserver(){
 Mugen::StageObserver::~StageObserver(){
 }
 
+void Mugen::StageObserver::draw(const Stage & stage, const Graphics::Bitmap & work){
+}
+
 void Mugen::Stage::setObserver(const PaintownUtil::ReferenceCount<StageObserver> & observer){
     this->observer = observer;
 }
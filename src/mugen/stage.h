@@ -5,12 +5,20 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
 #include <deque>
 #include "exception.h"
 #include "util.h"
 #include <r-tech1/graphics/bitmap.h>
 #include "common.h"
 #include "stage-state.h"
+#include "behavior.h"
+#include "character-table.h"
+#include "owner-index.h"
+#include "explod-store.h"
+#include "pause-schedule.h"
+#include "camera-bounds.h"
+#include "arena.h"
 
 namespace Graphics{
 class Bitmap;
@@ -24,6 +32,8 @@ namespace Mugen{
     class Character;
     struct ResourceEffect;
     class Projectile;
+    class HitQueue;
+    struct HitCandidate;
     class Helper;
     class Object;
     class Background;
@@ -66,6 +76,9 @@ public:
 
     virtual void beforeLogic(Stage & stage) = 0;
     virtual void afterLogic(Stage & stage) = 0;
+
+    /* Called after the stage has been rendered, draws in stage coordinates */
+    virtual void draw(const Stage & stage, const Graphics::Bitmap & work);
 };
 
 class Stage{
@@ -141,6 +154,16 @@ public:
     virtual bool replayEnabled() const;
     virtual void setReplay(bool what);
 
+    /* Rounds character positions and velocities to a 1/65536 grid during
+     * physics and does the physics for each character in one ordered step:
+     * movement, pushing other players away, then the stage bounds. Movement
+     * and friction on the grid are exact, so rounding errors don't pile up
+     * from tick to tick. State controllers still work in doubles, so two
+     * builds can still round the same value differently. Off by default.
+     */
+    virtual bool fixedPhysicsEnabled() const;
+    virtual void setFixedPhysics(bool what);
+
     //! Set match
     virtual void setMatchOver(bool over){
         this->gameOver = over;
@@ -228,15 +251,42 @@ public:
 
     virtual void addProjectile(Projectile * projectile);
     virtual void addEffect(Effect * effect);
+
+    /* Applies the hits found in one tick in the order the queue resolves
+     * them. Every hit is checked again right before it is applied since an
+     * earlier hit can stop a later one from connecting.
+     */
+    virtual void applyHits(const HitQueue & hits);
+
+    /* where the explods on this stage keep their positions and timers */
+    virtual ExplodStore & getExplods();
     virtual void removeEffects(const Character * owner, int id);
 
     virtual int countMyHelpers(const Character * owner) const;
+    /* Live objects on the stage, for the performance overlay */
+    virtual int countHelpers() const;
+    virtual int countExplods() const;
+    virtual int countProjectiles() const;
     virtual std::vector<Projectile*> findProjectile(int id, const Character * owner) const;
     virtual std::vector<Effect*> findExplode(int id, const Character * owner) const;
     virtual std::vector<Helper*> findHelpers(const Character * owner) const;
     virtual std::vector<Helper*> findHelpers(const Character * owner, int id) const;
     virtual Effect * findEffect(const Character * owner, int id);
     virtual std::vector<Effect *> findEffects(const Character * owner, int id);
+
+    /* Like findProjectile and findExplode, an id of 0 means any id, but the
+     * list belongs to the stage. Don't add or remove anything on the stage
+     * while going through it.
+     */
+    virtual const std::vector<Projectile*> & getProjectiles(int id, const Character * owner) const;
+    virtual const std::vector<Effect*> & getExplods(int id, const Character * owner) const;
+    virtual int countProjectiles(int id, const Character * owner) const;
+    virtual int countExplods(int id, const Character * owner) const;
+    /* includes helpers that were made this tick */
+    virtual int countHelpers(const Character * owner, int id) const;
+
+    /* Compares the owner indexes with a search through the whole stage, for tests */
+    virtual bool checkIndexes() const;
     
     virtual void setObserver(const PaintownUtil::ReferenceCount<StageObserver> & observer);
     virtual PaintownUtil::ReferenceCount<StageObserver> getObserver();
@@ -251,12 +301,22 @@ public:
         Player2Side
     };
 
+    /* Simul teams: the first player added to a side leads the team and any
+     * player added to that side afterwards is a partner. The leader is the
+     * first member of the side that is still standing.
+     */
+    virtual Character * getTeamLeader(teams side) const;
+    virtual bool isPartner(const Character * who) const;
+
     /* Edges of the visible screen */
     int maximumRight(const Character * who) const;
     int maximumLeft(const Character * who) const;
     /* Highest visible point on the screen */
     int maximumUp() const;
     int maximumDown() const;
+    /* A character past one of these pulls the camera along, see tension */
+    int leftTension(const Character * who) const;
+    int rightTension(const Character * who) const;
 
     /* These two methods are hacks to support the mugen bug in the Explod controller
      * when bindtime is 0. If the postype is left, right, back, or front then the
@@ -273,6 +333,9 @@ public:
     /* Remove references from this object to other objects, like through targetting */
     virtual void unbind(Character * what);
 
+    /* the arena in use during logic() and render() */
+    Arena & getArena();
+
 protected:
     struct cymk_holder{
         cymk_holder():c(0),m(0),y(0),k(0){}
@@ -348,6 +411,10 @@ protected:
 
     void updatePlayer(Character *o);
     void physics(Character * o);
+    void gatherHits(const std::vector<Character*> & running, HitQueue & hits);
+    bool applyHit(const HitCandidate & hit, const std::set<Character*> & connected);
+    void pushPlayers(Character * who);
+    void snapToGrid(Character * who);
     bool doBlockingDetection(Character * obj1, Character * obj2);
     bool doCollisionDetection(Character * obj1, Character * obj2);
     bool doReversalDetection(Character * obj1, Character * obj2);
@@ -372,7 +439,7 @@ protected:
 
     int findMaximumSpritePriority();
     int findMinimumSpritePriority();
-    std::vector<int> allSpritePriorities();
+    TickVector<int>::type allSpritePriorities();
 
     std::vector<Character*> getOpponents(Object * who);
 
@@ -450,6 +517,17 @@ protected:
     int p2startz;
     int p2facing;
 
+    /*;--- Simul partners of player 1 and player 2 --- */
+    int p3startx;
+    int p3starty;
+    int p3startz;
+    int p3facing;
+
+    int p4startx;
+    int p4starty;
+    int p4startz;
+    int p4facing;
+
     /*;--- Common ---
       ;Don't change these values.*/
     int leftbound; // ;Left bound (x-movement)
@@ -623,6 +701,17 @@ private:
     std::vector<Projectile*> projectiles;
 
     std::vector<Character*> objects;
+    /* the same characters as `objects' by id, for getCharacter */
+    CharacterTable objectTable;
+    /* which of `objects' act and move while the stage is paused */
+    PauseSchedule schedule;
+    void addCharacters(const std::vector<Character*> & characters);
+    void removeCharacter(Character * who);
+
+    /* the effects, projectiles and helpers by who owns them */
+    OwnerIndex<const Character*, Effect> effectIndex;
+    OwnerIndex<CharacterId, Projectile> projectileIndex;
+    OwnerIndex<CharacterId, Helper> helperIndex;
 
     // player list so we can distinguish
     std::vector<Character *> players;
@@ -637,6 +726,16 @@ private:
     // Hold information for players
     std::map<void *, PlayerData> playerInfo;
 
+    /* Behaviors of simul partners. The round only knows about the team
+     * leaders so partners get control from the stage.
+     */
+    std::map<Character *, Behavior *> partnerBehaviors;
+    DummyBehavior partnerDummy;
+    void updatePartnerBehavior();
+    /* wins belong to the whole team, not just whoever was leading */
+    void shareTeamWins();
+    void resetPosition(Character * player, bool partner);
+
     bool loaded;
 
     // Controllers
@@ -650,6 +749,8 @@ private:
     SpriteMap effects;
     std::map<int, PaintownUtil::ReferenceCount<Animation> > sparks;
     std::vector<Effect*> showSparks;
+    /* the moving parts of the explods in showSparks */
+    ExplodStore explods;
 
     // Character huds
     GameInfo *gameHUD;
@@ -663,9 +764,18 @@ private:
     const StageStateData & getStateData() const;
     void setStateData(const StageStateData & data);
 
+    /* the screen edges for the current camera and this tick's ScreenBounds */
+    CameraBounds cameraBounds;
+
+    /* lists made during a tick or a frame, emptied after each one */
+    Arena arena;
+    void updateCameraBounds();
+
     PaintownUtil::ReferenceCount<StageObserver> observer;
     /* true if doing in-game replay */
     bool replay;
+    /* see setFixedPhysics */
+    bool fixedPhysics;
 };
 
 }
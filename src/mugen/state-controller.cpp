@@ -2,6 +2,7 @@
 #include <r-tech1/message-queue.h>
 #include <r-tech1/parameter.h>
 #include <r-tech1/debug.h>
+#include <r-tech1/thread.h>
 #include "ast/all.h"
 #include "state-controller.h"
 #include "random.h"
@@ -15,6 +16,8 @@
 #include "sound.h"
 #include <sstream>
 #include "exception.h"
+#include "trace.h"
+#include "hit-queue.h"
 
 using namespace std;
 
@@ -252,19 +255,19 @@ bool StateController::canTrigger(const Compiler::Value * expression, const Envir
 }
 
 bool StateController::canTrigger(const vector<Compiler::Value*> & expressions, const Environment & environment) const {
-    for (vector<Compiler::Value*>::const_iterator it = expressions.begin(); it != expressions.end(); it++){
-        const Compiler::Value * value = *it;
+    for (unsigned int index = 0; index < expressions.size(); index++){
+        const Compiler::Value * value = expressions[index];
         if (!canTrigger(value, environment)){
-            // Global::debug(2*!getDebug()) << "'" << value->toString() << "' did not trigger" << endl;
-            if (getDebug() || Global::getDebug() >= 2){
-                Global::debug(2*!getDebug()) << "'" << value->toString() << "' did not trigger" << endl;
+            if (getDebug()){
+                Global::debug(0) << "'" << value->toString() << "' did not trigger" << endl;
             }
+            MUGEN_TRACE(2, Trace::TriggerFailed, environment.getCharacter().getId().intValue(), state, getId(), index, name);
             return false;
         } else {
-            // Global::debug(2*!getDebug()) << "'" << value->toString() << "' did trigger" << endl;
-            if (getDebug() || Global::getDebug() >= 2){
-                Global::debug(2*!getDebug()) << "'" << value->toString() << "' did trigger" << endl;
+            if (getDebug()){
+                Global::debug(0) << "'" << value->toString() << "' did trigger" << endl;
             }
+            MUGEN_TRACE(2, Trace::TriggerPassed, environment.getCharacter().getId().intValue(), state, getId(), index, name);
         }
     }
     return true;
@@ -2486,7 +2489,7 @@ static void parseHitDefinition(Ast::Section * section, HitDefinitionData & hit){
             } else if (type == "diagup"){
                 return AttackType::DiagonalUp;
             } else {
-                Global::debug(0) << "Unknown hitdef animation type '" << type << "' in file " << stateFileParameter.current().path() << " at line " << simple.getLine() << " column " << simple.getColumn() << endl;
+                Global::debug(0) << "Unknown hitdef animation type '" << type << "' in file " << CurrentStateFile::path() << " at line " << simple.getLine() << " column " << simple.getColumn() << endl;
             }
             return AttackType::NoAnimation;
         }
@@ -2915,6 +2918,8 @@ static void evaluateHitDefinition(const HitDefinitionData & hit, HitDefinition &
     his.animationType = hit.animationType;
     his.animationTypeAir = hit.animationTypeAir;
     his.animationTypeFall = hit.animationTypeFall;
+    his.priority.hit = (int) evaluateNumberLocal(hit.priority.hit, HitPriority::Default);
+    his.priority.type = hit.priority.type;
     his.airHitTime = evaluateNumberLocal(hit.airHitTime, 20);
     his.airVelocity.x = evaluateNumberLocal(hit.airVelocity.x, 0);
     his.airVelocity.y = evaluateNumberLocal(hit.airVelocity.y, 0);
@@ -8084,6 +8089,113 @@ static string toString(StateController::Type type){
     return "???";
 }
 
+static map<string, StateController::Type> types;
+static bool typesSetup = false;
+static PaintownUtil::Thread::LockObject typesLock;
+
+StateController::Type StateController::typeFromName(const string & name){
+    PaintownUtil::Thread::ScopedLock scoped(typesLock);
+    if (!typesSetup){
+        types["afterimage"] = StateController::AfterImage;
+        types["afterimagetime"] = StateController::AfterImageTime;
+        types["allpalfx"] = StateController::AllPalFX;
+        types["angleadd"] = StateController::AngleAdd;
+        types["angledraw"] = StateController::AngleDraw;
+        types["anglemul"] = StateController::AngleMul;
+        types["angleset"] = StateController::AngleSet;
+        types["appendtoclipboard"] = StateController::AppendToClipboard;
+        types["assertspecial"] = StateController::AssertSpecial;
+        types["attackdist"] = StateController::AttackDist;
+        types["attackmulset"] = StateController::AttackMulSet;
+        types["bgpalfx"] = StateController::BGPalFX;
+        types["bindtoparent"] = StateController::BindToParent;
+        types["bindtoroot"] = StateController::BindToRoot;
+        types["bindtotarget"] = StateController::BindToTarget;
+        types["changeanim"] = StateController::ChangeAnim;
+        types["changeanim2"] = StateController::ChangeAnim2;
+        types["changestate"] = StateController::ChangeState;
+        types["clearclipboard"] = StateController::ClearClipboard;
+        types["ctrlset"] = StateController::CtrlSet;
+        types["defencemulset"] = StateController::DefenceMulSet;
+        types["destroyself"] = StateController::DestroySelf;
+        types["displaytoclipboard"] = StateController::DisplayToClipboard;
+        types["envcolor"] = StateController::EnvColor;
+        types["envshake"] = StateController::EnvShake;
+        types["explod"] = StateController::Explod;
+        types["explodbindtime"] = StateController::ExplodBindTime;
+        types["forcefeedback"] = StateController::ForceFeedback;
+        types["fallenvshake"] = StateController::FallEnvShake;
+        types["gamemakeanim"] = StateController::GameMakeAnim;
+        types["gravity"] = StateController::Gravity;
+        types["helper"] = StateController::Helper;
+        types["hitadd"] = StateController::HitAdd;
+        types["hitby"] = StateController::HitBy;
+        types["hitdef"] = StateController::HitDef;
+        types["hitfalldamage"] = StateController::HitFallDamage;
+        types["hitfallset"] = StateController::HitFallSet;
+        types["hitfallvel"] = StateController::HitFallVel;
+        types["hitoverride"] = StateController::HitOverride;
+        types["hitvelset"] = StateController::HitVelSet;
+        types["lifeadd"] = StateController::LifeAdd;
+        types["lifeset"] = StateController::LifeSet;
+        types["makedust"] = StateController::MakeDust;
+        types["modifyexplod"] = StateController::ModifyExplod;
+        types["movehitreset"] = StateController::MoveHitReset;
+        types["nothitby"] = StateController::NotHitBy;
+        types["null"] = StateController::Null;
+        types["offset"] = StateController::Offset;
+        types["palfx"] = StateController::PalFX;
+        types["parentvaradd"] = StateController::ParentVarAdd;
+        types["parentvarset"] = StateController::ParentVarSet;
+        types["pause"] = StateController::Pause;
+        types["playerpush"] = StateController::PlayerPush;
+        types["playsnd"] = StateController::PlaySnd;
+        types["posadd"] = StateController::PosAdd;
+        types["posfreeze"] = StateController::PosFreeze;
+        types["posset"] = StateController::PosSet;
+        types["poweradd"] = StateController::PowerAdd;
+        types["powerset"] = StateController::PowerSet;
+        types["projectile"] = StateController::Projectile;
+        types["removeexplod"] = StateController::RemoveExplod;
+        types["reversaldef"] = StateController::ReversalDef;
+        types["screenbound"] = StateController::ScreenBound;
+        types["selfstate"] = StateController::SelfState;
+        types["sprpriority"] = StateController::SprPriority;
+        types["statetypeset"] = StateController::StateTypeSet;
+        types["sndpan"] = StateController::SndPan;
+        types["stopsnd"] = StateController::StopSnd;
+        types["superpause"] = StateController::SuperPause;
+        types["targetbind"] = StateController::TargetBind;
+        types["targetdrop"] = StateController::TargetDrop;
+        types["targetfacing"] = StateController::TargetFacing;
+        types["targetlifeadd"] = StateController::TargetLifeAdd;
+        types["targetpoweradd"] = StateController::TargetPowerAdd;
+        types["targetstate"] = StateController::TargetState;
+        types["targetveladd"] = StateController::TargetVelAdd;
+        types["targetvelset"] = StateController::TargetVelSet;
+        types["trans"] = StateController::Trans;
+        types["turn"] = StateController::Turn;
+        types["varadd"] = StateController::VarAdd;
+        types["varrandom"] = StateController::VarRandom;
+        types["varrangeset"] = StateController::VarRangeSet;
+        types["varset"] = StateController::VarSet;
+        types["veladd"] = StateController::VelAdd;
+        types["velmul"] = StateController::VelMul;
+        types["velset"] = StateController::VelSet;
+        types["width"] = StateController::Width;
+        types["zoom"] = StateController::Zoom;
+        types["debug"] = StateController::Debug;
+        /* only mark the table as ready once it is filled in */
+        typesSetup = true;
+    }
+
+    map<string, StateController::Type>::iterator what = types.find(name);
+    if (what != types.end()){
+        return what->second;
+    }
+    return StateController::Unknown;
+}
+
 StateController * StateController::compile(Ast::Section * section, const string & name, int state, unsigned int id, StateController::Type type){
     switch (type){
         case StateController::ChangeAnim : return new ControllerChangeAnim(section, name, state, id);
@@ -138,6 +138,9 @@ public:
     
     static StateController * compile(Ast::Section * section, const std::string & name, int state, unsigned int id,Type type);
 
+    /* the type for a lower case controller name, Unknown if there is no such controller */
+    static Type typeFromName(const std::string & name);
+
     virtual bool canTrigger(const Environment & environment) const;
 
     virtual void activate(Mugen::Stage & stage, Character & who, const std::vector<std::string> & commands) const = 0;
@@ -7,6 +7,7 @@
 #include <r-tech1/init.h>
 #include "globals.h"
 #include "factory/font_render.h"
+#include "factory/presenter.h"
 #include "parse-cache.h"
 
 #include "animation.h"
@@ -505,17 +506,18 @@ void Storyboard::run(bool repeat){
     class Draw: public PaintownUtil::Draw {
     public:
         Draw(Scene *& scene):
-        scene(scene){
+        scene(scene),
+        presenter(320, 240){
         }
 
         Scene *& scene;
+        Presenter presenter;
 
         void draw(const Graphics::Bitmap & screen){
             if (scene != NULL){
-                Graphics::StretchedBitmap work(320, 240, screen, Graphics::StretchedBitmap::NoClear, Graphics::qualityFilterName(::Configuration::getQualityFilter()));
-                work.start();
+                Graphics::Bitmap & work = presenter.start(screen);
                 scene->render(work);
-                work.finish();
+                presenter.finish(screen);
                 // work.Stretch(screen);
                 if (Global::getDebug() > 0){
                     ::Font::getDefaultFont().printf( 15, 310, Graphics::makeColor(0,255,128), screen, "Scene: Time(%i) : EndTime(%i) : Fade in(%i) : Fade out(%i)",0, scene->getTicker(),scene->getEndTime(),scene->getFadeTool().getFadeInTime(),scene->getFadeTool().getFadeOutTime() );
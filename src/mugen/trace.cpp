@@ -0,0 +1,250 @@
+#include "trace.h"
+#include "profile.h"
+
+#include <r-tech1/thread.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <algorithm>
+
+namespace PaintownUtil = ::Util;
+
+using std::string;
+using std::vector;
+
+namespace Mugen{
+namespace Trace{
+
+int currentLevel = 0;
+
+/* Threads after this many don't get a buffer and aren't traced. The game only
+ * has a handful of threads.
+ */
+static const int MaxThreads = 32;
+
+struct Ring{
+    /* how many records were ever written, the oldest one is overwritten once
+     * this goes past RingSize
+     */
+    uint32_t written;
+    uint16_t thread;
+    Record records[RingSize];
+};
+
+/* The rings are never freed so a dump can still see what a thread did after
+ * it stopped. A plain array so the crash handler can walk it without locking.
+ */
+static Ring * rings[MaxThreads];
+static volatile int ringCount = 0;
+static PaintownUtil::Thread::LockObject ringLock;
+
+/* gcc, clang and mingw all have __thread */
+static __thread Ring * localRing = NULL;
+static __thread bool noRing = false;
+
+static const char * names[MaxEvent] = {
+    "check controller",
+    "activate controller",
+    "trigger passed",
+    "trigger failed",
+    "command pressed"
+};
+
+const char * eventName(int event){
+    if (event >= 0 && event < MaxEvent){
+        return names[event];
+    }
+    return "unknown";
+}
+
+static Ring * getRing(){
+    if (localRing != NULL || noRing){
+        return localRing;
+    }
+
+    PaintownUtil::Thread::ScopedLock scoped(ringLock);
+    if (ringCount >= MaxThreads){
+        noRing = true;
+        return NULL;
+    }
+
+    Ring * ring = new Ring();
+    ring->written = 0;
+    ring->thread = ringCount;
+    rings[ringCount] = ring;
+    /* the crash handler only looks at rings before ringCount */
+    ringCount += 1;
+    localRing = ring;
+    return ring;
+}
+
+void record(Event event, int object, int first, int second, int third, const char * text){
+    Ring * ring = getRing();
+    if (ring == NULL){
+        return;
+    }
+
+    Record & next = ring->records[ring->written % RingSize];
+    next.time = Profile::currentMicroseconds();
+    next.event = event;
+    next.thread = ring->thread;
+    next.object = object;
+    next.values[0] = first;
+    next.values[1] = second;
+    next.values[2] = third;
+    if (text != NULL){
+        strncpy(next.text, text, TextLength - 1);
+        next.text[TextLength - 1] = '\0';
+    } else {
+        next.text[0] = '\0';
+    }
+    ring->written += 1;
+}
+
+void record(Event event, int object, int first, int second, int third, const string & text){
+    record(event, object, first, second, third, text.c_str());
+}
+
+static bool earlier(const Record & first, const Record & second){
+    return first.time < second.time;
+}
+
+vector<Record> getRecords(){
+    vector<Record> out;
+    int count = ringCount;
+    for (int i = 0; i < count; i++){
+        const Ring * ring = rings[i];
+        uint32_t written = ring->written;
+        uint32_t start = written > RingSize ? written - RingSize : 0;
+        for (uint32_t index = start; index < written; index++){
+            out.push_back(ring->records[index % RingSize]);
+        }
+    }
+    std::stable_sort(out.begin(), out.end(), earlier);
+    return out;
+}
+
+static int format(char * buffer, int size, const Record & record){
+    return snprintf(buffer, size, "%llu thread %d %s object %d values %d %d %d '%s'\n",
+                    (unsigned long long) record.time, record.thread, eventName(record.event),
+                    record.object, record.values[0], record.values[1], record.values[2], record.text);
+}
+
+void dump(std::ostream & out){
+    vector<Record> records = getRecords();
+    char buffer[256];
+    for (vector<Record>::iterator it = records.begin(); it != records.end(); it++){
+        format(buffer, sizeof(buffer), *it);
+        out << buffer;
+    }
+}
+
+void clear(){
+    PaintownUtil::Thread::ScopedLock scoped(ringLock);
+    for (int i = 0; i < ringCount; i++){
+        rings[i]->written = 0;
+    }
+}
+
+#ifndef _WIN32
+static const int crashSignals[] = {SIGSEGV, SIGABRT, SIGFPE, SIGILL, SIGBUS};
+static const int crashSignalCount = sizeof(crashSignals) / sizeof(int);
+
+/* whatever handled the signals before tracing was turned on */
+static struct sigaction previousActions[crashSignalCount];
+static bool installed = false;
+
+/* Writes every thread's records straight to stderr, one thread after another.
+ * Sorting would mean allocating which isn't safe after a crash.
+ */
+static void dumpRing(const Ring * ring){
+    char buffer[256];
+    uint32_t written = ring->written;
+    uint32_t start = written > RingSize ? written - RingSize : 0;
+    for (uint32_t index = start; index < written; index++){
+        int length = format(buffer, sizeof(buffer), ring->records[index % RingSize]);
+        if (length > (int) sizeof(buffer) - 1){
+            length = sizeof(buffer) - 1;
+        }
+        if (write(2, buffer, length) < 0){
+            return;
+        }
+    }
+}
+
+static void dumpCrash(int signal){
+    char buffer[64];
+    int length = snprintf(buffer, sizeof(buffer), "Caught signal %d, trace follows\n", signal);
+    if (write(2, buffer, length) >= 0){
+        int count = ringCount;
+        for (int i = 0; i < count; i++){
+            dumpRing(rings[i]);
+        }
+    }
+
+    /* Put back the handler from before and raise the signal again for it.
+     * The signal is blocked while this runs so it gets there once this
+     * returns, and if that handler is the default it kills the process.
+     */
+    for (int i = 0; i < crashSignalCount; i++){
+        sigaction(crashSignals[i], &previousActions[i], NULL);
+    }
+    installed = false;
+    raise(signal);
+}
+
+static void installCrashHandler(){
+    if (installed){
+        return;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = dumpCrash;
+    sigemptyset(&action.sa_mask);
+    for (int i = 0; i < crashSignalCount; i++){
+        sigaction(crashSignals[i], &action, &previousActions[i]);
+    }
+    installed = true;
+}
+
+static void removeCrashHandler(){
+    if (!installed){
+        return;
+    }
+
+    for (int i = 0; i < crashSignalCount; i++){
+        /* leave alone a handler that was put in after this one */
+        struct sigaction current;
+        if (sigaction(crashSignals[i], NULL, &current) == 0 && current.sa_handler == dumpCrash){
+            sigaction(crashSignals[i], &previousActions[i], NULL);
+        }
+    }
+    installed = false;
+}
+#else
+static void installCrashHandler(){
+}
+
+static void removeCrashHandler(){
+}
+#endif
+
+void setLevel(int level){
+    currentLevel = level;
+    /* only take over crashes while there is something to show */
+    if (level > 0){
+        installCrashHandler();
+    } else {
+        removeCrashHandler();
+    }
+}
+
+int getLevel(){
+    return currentLevel;
+}
+
+}
+}
@@ -0,0 +1,92 @@
+#ifndef _paintown_mugen_trace_h
+#define _paintown_mugen_trace_h
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <ostream>
+
+/* Traces at a level above this are compiled out completely. Builds that want
+ * every trace in the hot paths can pass -DMUGEN_TRACE_MAXIMUM=3.
+ */
+#ifndef MUGEN_TRACE_MAXIMUM
+#define MUGEN_TRACE_MAXIMUM 2
+#endif
+
+/* Records an event if tracing is on at the given level. None of the arguments
+ * are evaluated otherwise, so it is fine to pass something like
+ * controller->getName() in code that runs every tick.
+ *
+ *   MUGEN_TRACE(2, Mugen::Trace::ControllerCheck, id, state, index, 0, name);
+ */
+#define MUGEN_TRACE(level, event, object, first, second, third, text) \
+    do { \
+        if ((level) <= MUGEN_TRACE_MAXIMUM && ::Mugen::Trace::isEnabled(level)){ \
+            ::Mugen::Trace::record(event, object, first, second, third, text); \
+        } \
+    } while (0)
+
+namespace Mugen{
+
+/* A cheap replacement for Global::debug in code that runs every tick. Events
+ * are written as fixed size records into a ring buffer that belongs to the
+ * thread, so nothing is formatted and nothing is locked while the game runs.
+ * The buffers are turned into text with dump(), either from the console or
+ * when the game crashes while tracing is on.
+ */
+namespace Trace{
+
+enum Event{
+    ControllerCheck,
+    ControllerActivate,
+    TriggerPassed,
+    TriggerFailed,
+    CommandPressed,
+    MaxEvent
+};
+
+/* Every record is the same size, text longer than this is cut off */
+static const unsigned int TextLength = 20;
+
+struct Record{
+    uint64_t time;
+    uint16_t event;
+    uint16_t thread;
+    int32_t object;
+    int32_t values[3];
+    char text[TextLength];
+};
+
+/* Number of records each thread keeps before overwriting the oldest */
+static const unsigned int RingSize = 4096;
+
+/* 0 turns tracing off */
+void setLevel(int level);
+int getLevel();
+
+/* The current level, read directly so checking it costs a load and a compare */
+extern int currentLevel;
+
+inline bool isEnabled(int level){
+    return currentLevel >= level;
+}
+
+void record(Event event, int object, int first, int second, int third, const char * text);
+void record(Event event, int object, int first, int second, int third, const std::string & text);
+
+/* All the records that are still in the buffers ordered by time. Threads that
+ * are still tracing can overwrite records while this runs.
+ */
+std::vector<Record> getRecords();
+void dump(std::ostream & out);
+
+/* Drops all the records */
+void clear();
+
+const char * eventName(int event);
+
+}
+
+}
+
+#endif
@@ -822,6 +822,110 @@ PaintownUtil::ReferenceCount<Ast::AstParse> Mugen::Util::parseCmd(const Filesyst
     }
 }
 
+Mugen::Util::StateHeader::StateHeader():
+kind(Other),
+state(0){
+}
+
+/* true if `head' has `word' at `position', ignoring case */
+static bool startsWith(const string & head, unsigned int position, const char * word){
+    for (; *word != '\0'; word++, position++){
+        if (position >= head.size() || lowerCase((unsigned char) head[position]) != *word){
+            return false;
+        }
+    }
+    return true;
+}
+
+static unsigned int skipSpaces(const string & head, unsigned int position){
+    while (position < head.size() && head[position] == ' '){
+        position += 1;
+    }
+    return position;
+}
+
+/* Reads the same things the regexes used to:
+ *   statedef *(-?[0-9]+)
+ *   state *(-?[0-9]+) *, *(.*)
+ * A header without a number is state 0 and one without a comma has no name.
+ */
+Mugen::Util::StateHeader Mugen::Util::scanStateHeader(const string & head){
+    StateHeader header;
+    unsigned int position = 0;
+    while (position < head.size() && isspace((unsigned char) head[position])){
+        position += 1;
+    }
+
+    if (startsWith(head, position, "statedef")){
+        header.kind = StateHeader::Definition;
+        position += 8;
+    } else if (startsWith(head, position, "state ")){
+        header.kind = StateHeader::Controller;
+        position += 5;
+    } else {
+        return header;
+    }
+
+    position = skipSpaces(head, position);
+    bool negative = false;
+    if (position < head.size() && head[position] == '-'){
+        negative = true;
+        position += 1;
+    }
+
+    unsigned int digits = position;
+    while (position < head.size() && isdigit((unsigned char) head[position])){
+        header.state = header.state * 10 + (head[position] - '0');
+        position += 1;
+    }
+
+    if (position == digits){
+        header.state = 0;
+        return header;
+    }
+
+    if (negative){
+        header.state = -header.state;
+    }
+
+    if (header.kind == StateHeader::Controller){
+        position = skipSpaces(head, position);
+        if (position < head.size() && head[position] == ','){
+            position = skipSpaces(head, position + 1);
+            header.name = fixCase(head.substr(position));
+        }
+    }
+
+    return header;
+}
+
+/* Reads the same thing as the regex begin action ([0-9]+), anything can
+ * come after the number.
+ */
+int Mugen::Util::scanActionHeader(const string & head){
+    unsigned int position = 0;
+    while (position < head.size() && isspace((unsigned char) head[position])){
+        position += 1;
+    }
+
+    if (!startsWith(head, position, "begin action ")){
+        return -1;
+    }
+
+    position = skipSpaces(head, position + 13);
+    int action = 0;
+    unsigned int digits = position;
+    while (position < head.size() && isdigit((unsigned char) head[position])){
+        action = action * 10 + (head[position] - '0');
+        position += 1;
+    }
+
+    if (position == digits){
+        return -1;
+    }
+    return action;
+}
+
 std::map<int, PaintownUtil::ReferenceCount<Mugen::Animation> > Mugen::Util::loadAnimations(const Filesystem::AbsolutePath & filename, const SpriteMap sprites, bool mask){
     AstRef parsed(parseAir(filename));
     // Global::debug(2, __FILE__) << "Parsing animations. Number of sections is " << parsed->getSections()->size() << endl;
@@ -76,6 +76,11 @@ namespace Util{
     std::vector<Ast::Section*> collectBackgroundStuff(std::list<Ast::Section*>::iterator & section_it, const std::list<Ast::Section*>::iterator & end, const std::string & name = "bg");
     bool readPalette(const Filesystem::AbsolutePath &filename, unsigned char *pal);
     void readSprites(const Filesystem::AbsolutePath & filename, const Filesystem::AbsolutePath & palette, Mugen::SpriteMap & sprites, bool sprite);
+    /* Gives the sprites that were read with an act palette the colors from
+     * another palette file without reading the sff again. Returns false if
+     * the palette can't be read or none of the sprites use an act palette.
+     */
+    bool applyPalette(const Filesystem::AbsolutePath & palette, const Mugen::SpriteMap & sprites);
     void readSounds(const Filesystem::AbsolutePath & filename, SoundMap & sounds);
 
     // Get background: The background must be deleted if used outside of stage/menus (Note: we give the background a ticker to whatever is running it)
@@ -112,6 +117,31 @@ namespace Util{
     AstRef parseDef(const Filesystem::AbsolutePath & filename);
     AstRef parseCmd(const Filesystem::AbsolutePath & filename);
 
+    /* What a [Statedef 200] or [State 200, name] section header says. A
+     * character can have thousands of these so they are read by hand instead
+     * of with regexes. The name is lower case like the rest of the header.
+     */
+    struct StateHeader{
+        enum Kind{
+            Other,
+            Definition,
+            Controller
+        };
+
+        StateHeader();
+
+        Kind kind;
+        int state;
+        std::string name;
+    };
+
+    StateHeader scanStateHeader(const std::string & head);
+
+    /* The number in a [Begin Action 200] header of an air file, or -1 if the
+     * header is something else.
+     */
+    int scanActionHeader(const std::string & head);
+
     /* returns the number of game ticks that have passed by.
      * speed adjusts the rate. lower values slow the game down,
      * higher values speed it up.
@@ -0,0 +1,871 @@
+#include <r-tech1/debug.h>
+#include <r-tech1/file-system.h>
+#include <r-tech1/funcs.h>
+#include <r-tech1/parameter.h>
+#include <r-tech1/system.h>
+#include <r-tech1/thread.h>
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "validate.h"
+#include "ast/all.h"
+#include "character.h"
+#include "compiler.h"
+#include "exception.h"
+#include "parse-cache.h"
+#include "profile.h"
+#include "sff.h"
+#include "stage.h"
+#include "state-controller.h"
+#include "util.h"
+
+namespace PaintownUtil = ::Util;
+
+using std::endl;
+using std::map;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace Mugen{
+namespace Validate{
+
+typedef PaintownUtil::ReferenceCount<Ast::AstParse> AstRef;
+typedef set<std::pair<int, int> > SpriteSet;
+
+Issue::Issue(const string & kind, const string & file, int line, const string & message):
+kind(kind),
+file(file),
+line(line),
+message(message){
+}
+
+Report::Report():
+loaded(false),
+microseconds(0),
+memoryGrowth(0),
+spriteMemory(0),
+computedStateChanges(0){
+}
+
+static string describePath(const Filesystem::AbsolutePath & path){
+    return Storage::instance().cleanse(path).path();
+}
+
+/* Collects the simple attributes of a section by their lower case name, the
+ * triggers are kept separately since there can be any number of them.
+ */
+class Attributes: public Ast::Walker {
+public:
+    vector<const Ast::AttributeSimple *> triggers;
+    map<string, const Ast::AttributeSimple *> values;
+
+    virtual void onAttributeSimple(const Ast::AttributeSimple & simple){
+        string name = PaintownUtil::lowerCaseAll(simple.idString());
+        /* same test as StateController::handled */
+        if (name.find("trigger") == 0){
+            triggers.push_back(&simple);
+        } else {
+            values[name] = &simple;
+        }
+    }
+
+    const Ast::AttributeSimple * find(const string & name) const {
+        map<string, const Ast::AttributeSimple *>::const_iterator found = values.find(name);
+        if (found != values.end()){
+            return found->second;
+        }
+        return NULL;
+    }
+};
+
+/* Everything the state files are checked against */
+struct Resources{
+    Resources():
+    haveSprites(false),
+    haveAnimations(false),
+    sounds(NULL){
+    }
+
+    bool haveSprites;
+    SpriteSet sprites;
+    bool haveAnimations;
+    set<int> animations;
+    /* NULL if the character could not be loaded */
+    const SoundMap * sounds;
+};
+
+/* Which states change to which, for finding states nothing can get to */
+struct StateGraph{
+    map<int, set<int> > changes;
+    set<int> defined;
+    /* defined in the character's own files rather than the common states */
+    set<int> own;
+};
+
+/* Reads the sprite headers, sprites that can't be read are reported and the
+ * rest is still checked against them.
+ */
+static void readSprites(const Filesystem::AbsolutePath & path, Resources & resources, Report & report){
+    try{
+        Sff::Contents contents = Sff::describe(path);
+        for (vector<Sff::SpriteInfo>::iterator it = contents.sprites.begin(); it != contents.sprites.end(); it++){
+            resources.sprites.insert(std::make_pair(it->group, it->item));
+            /* linked sprites share the bitmap of the one they link to */
+            if (it->linked == -1){
+                report.spriteMemory += (uint64_t) it->width * it->height * 4;
+            }
+        }
+        resources.haveSprites = true;
+    } catch (const MugenException & fail){
+        report.issues.push_back(Issue("parse", describePath(path), 0, fail.getReason()));
+    } catch (const Exception::Base & fail){
+        report.issues.push_back(Issue("parse", describePath(path), 0, fail.getTrace()));
+    }
+}
+
+static void checkAnimations(const Filesystem::AbsolutePath & path, Resources & resources, Report & report){
+    const string file = describePath(path);
+    AstRef parsed;
+    try{
+        parsed = Util::parseAir(path);
+    } catch (const MugenException & fail){
+        report.issues.push_back(Issue("parse", file, 0, fail.getReason()));
+        return;
+    }
+
+    class Frames: public Ast::Walker {
+    public:
+        Frames(int action, const string & file, const Resources & resources, Report & report):
+        action(action),
+        file(file),
+        resources(resources),
+        report(report){
+        }
+
+        const int action;
+        const string & file;
+        const Resources & resources;
+        Report & report;
+
+        virtual void onValueList(const Ast::ValueList & values){
+            int group = 0;
+            int item = 0;
+            try{
+                values.view() >> group >> item;
+            } catch (const Ast::Exception & fail){
+                report.issues.push_back(Issue("parse", file, values.getLine(), fail.getReason()));
+                return;
+            }
+
+            /* -1 is an empty frame */
+            if (group >= 0 && resources.haveSprites && resources.sprites.find(std::make_pair(group, item)) == resources.sprites.end()){
+                std::ostringstream out;
+                out << "Action " << action << " uses sprite " << group << ", " << item << " which is not in the sprite file";
+                report.issues.push_back(Issue("sprite", file, values.getLine(), out.str()));
+            }
+        }
+    };
+
+    for (Ast::AstParse::section_iterator it = parsed->getSections()->begin(); it != parsed->getSections()->end(); it++){
+        Ast::Section * section = *it;
+        int action = Util::scanActionHeader(section->getName());
+        if (action != -1){
+            resources.animations.insert(action);
+            Frames frames(action, file, resources, report);
+            section->walk(frames);
+        }
+    }
+    resources.haveAnimations = true;
+}
+
+/* Records a change to the state in `name' unless its computed at runtime */
+static void addStateChange(const Attributes & attributes, const string & name, int from, StateGraph & graph, Report & report){
+    const Ast::AttributeSimple * simple = attributes.find(name);
+    if (simple == NULL){
+        return;
+    }
+
+    int state = 0;
+    try{
+        simple->view() >> state;
+        graph.changes[from].insert(state);
+    } catch (const Ast::Exception & computed){
+        report.computedStateChanges += 1;
+    }
+}
+
+static void checkAnimation(const Attributes & attributes, const string & name, const string & file, const Resources & resources, Report & report){
+    const Ast::AttributeSimple * simple = attributes.find(name);
+    if (simple == NULL || !resources.haveAnimations){
+        return;
+    }
+
+    int animation = 0;
+    try{
+        simple->view() >> animation;
+    } catch (const Ast::Exception & computed){
+        return;
+    }
+
+    if (resources.animations.find(animation) == resources.animations.end()){
+        std::ostringstream out;
+        out << "Animation " << animation << " does not exist";
+        report.issues.push_back(Issue("animation", file, simple->getLine(), out.str()));
+    }
+}
+
+static void checkSound(const Attributes & attributes, const string & file, const Resources & resources, Report & report){
+    const Ast::AttributeSimple * simple = attributes.find("value");
+    if (simple == NULL || resources.sounds == NULL){
+        return;
+    }
+
+    int group = 0;
+    int item = 0;
+    try{
+        simple->view() >> group >> item;
+    } catch (const Ast::Exception & fail){
+        /* F prefixed sounds come from the common sounds and S prefixed ones
+         * are spelled out as strings, neither are checked
+         */
+        return;
+    }
+
+    SoundMap::const_iterator found = resources.sounds->find(group);
+    if (found == resources.sounds->end() || found->second.find(item) == found->second.end()){
+        std::ostringstream out;
+        out << "Sound " << group << ", " << item << " is not in the sound file";
+        report.issues.push_back(Issue("sound", file, simple->getLine(), out.str()));
+    }
+}
+
+/* Compiles the expressions of a [Statedef] the same way the character does
+ * when it loads the state.
+ */
+static void checkStatedef(Ast::Section * section, const string & file, const Resources & resources, Report & report){
+    class Walker: public Ast::Walker {
+    public:
+        Walker(const string & file, Report & report):
+        file(file),
+        report(report){
+        }
+
+        const string & file;
+        Report & report;
+
+        void compile(const Ast::Value * value, int line){
+            try{
+                delete Compiler::compile(value);
+            } catch (const MugenException & fail){
+                report.issues.push_back(Issue("state", file, line, fail.getReason()));
+            }
+        }
+
+        virtual void onAttributeSimple(const Ast::AttributeSimple & simple){
+            try{
+                if (simple == "type" || simple == "statetype"){
+                    string type;
+                    simple.view() >> type;
+                    type = PaintownUtil::lowerCaseAll(type);
+                    if (type != "s" && type != "c" && type != "a" && type != "l" && type != "u"){
+                        report.issues.push_back(Issue("state", file, simple.getLine(), "Unknown statedef type: '" + type + "'"));
+                    }
+                } else if (simple == "velset"){
+                    const Ast::Value * x;
+                    const Ast::Value * y;
+                    simple.view() >> x >> y;
+                    compile(x, simple.getLine());
+                    compile(y, simple.getLine());
+                } else if (simple == "anim" || simple == "ctrl" || simple == "poweradd" ||
+                           simple == "juggle" || simple == "sprpriority"){
+                    compile(simple.getValue(), simple.getLine());
+                }
+            } catch (const Ast::Exception & fail){
+                report.issues.push_back(Issue("state", file, simple.getLine(), fail.getReason()));
+            }
+        }
+    };
+
+    Walker walker(file, report);
+    section->walk(walker);
+
+    Attributes attributes;
+    section->walk(attributes);
+    checkAnimation(attributes, "anim", file, resources, report);
+}
+
+static void checkController(Ast::Section * section, int state, const string & file, const Resources & resources, StateGraph & graph, Report & report){
+    const string name = Util::scanStateHeader(section->getName()).name;
+
+    Attributes attributes;
+    section->walk(attributes);
+
+    bool triggersCompiled = true;
+    for (vector<const Ast::AttributeSimple *>::iterator it = attributes.triggers.begin(); it != attributes.triggers.end(); it++){
+        const Ast::AttributeSimple * trigger = *it;
+        try{
+            delete Compiler::compile(trigger->getValue());
+        } catch (const MugenException & fail){
+            report.issues.push_back(Issue("trigger", file, trigger->getLine(), fail.getReason()));
+            triggersCompiled = false;
+        } catch (const Ast::Exception & fail){
+            report.issues.push_back(Issue("trigger", file, trigger->getLine(), fail.getReason()));
+            triggersCompiled = false;
+        }
+    }
+
+    const Ast::AttributeSimple * typeAttribute = attributes.find("type");
+    if (typeAttribute == NULL){
+        report.issues.push_back(Issue("controller", file, section->getLine(), "No type given for controller '" + name + "'"));
+        return;
+    }
+
+    string type;
+    try{
+        typeAttribute->view() >> type;
+    } catch (const Ast::Exception & fail){
+        report.issues.push_back(Issue("controller", file, typeAttribute->getLine(), fail.getReason()));
+        return;
+    }
+    type = Util::fixCase(type);
+    StateController::Type kind = StateController::typeFromName(type);
+    if (kind == StateController::Unknown){
+        report.issues.push_back(Issue("controller", file, typeAttribute->getLine(), "Unknown controller type '" + type + "' in '" + name + "'"));
+        return;
+    }
+
+    /* a bad trigger would make the whole controller fail again */
+    if (triggersCompiled){
+        try{
+            delete StateController::compile(section, name, state, 0, kind);
+        } catch (const MugenException & fail){
+            report.issues.push_back(Issue("controller", file, section->getLine(), fail.getReason()));
+        } catch (const Ast::Exception & fail){
+            report.issues.push_back(Issue("controller", file, section->getLine(), fail.getReason()));
+        }
+    }
+
+    switch (kind){
+        case StateController::ChangeState:
+        case StateController::SelfState:
+        case StateController::TargetState: {
+            addStateChange(attributes, "value", state, graph, report);
+            break;
+        }
+        case StateController::HitDef:
+        case StateController::ReversalDef: {
+            addStateChange(attributes, "p1stateno", state, graph, report);
+            addStateChange(attributes, "p2stateno", state, graph, report);
+            break;
+        }
+        case StateController::Helper: {
+            addStateChange(attributes, "stateno", state, graph, report);
+            break;
+        }
+        case StateController::ChangeAnim: {
+            checkAnimation(attributes, "value", file, resources, report);
+            break;
+        }
+        case StateController::PlaySnd: {
+            checkSound(attributes, file, resources, report);
+            break;
+        }
+        default: break;
+    }
+}
+
+static void checkStateFile(const Filesystem::AbsolutePath & path, bool own, const Resources & resources, StateGraph & graph, Report & report){
+    const string file = describePath(path);
+    AstRef parsed;
+    try{
+        parsed = Util::parseCmd(path);
+    } catch (const MugenException & fail){
+        report.issues.push_back(Issue("parse", file, 0, fail.getReason()));
+        return;
+    }
+
+    CurrentStateFile currentFile(Storage::instance().cleanse(path));
+
+    bool inState = false;
+    int state = 0;
+    for (Ast::AstParse::section_iterator it = parsed->getSections()->begin(); it != parsed->getSections()->end(); it++){
+        Ast::Section * section = *it;
+        Util::StateHeader header = Util::scanStateHeader(section->getName());
+        if (header.kind == Util::StateHeader::Definition){
+            state = header.state;
+            inState = true;
+            graph.defined.insert(state);
+            if (own){
+                graph.own.insert(state);
+            }
+
+            checkStatedef(section, file, resources, report);
+        } else if (header.kind == Util::StateHeader::Controller){
+            if (!inState){
+                report.issues.push_back(Issue("state", file, section->getLine(), "Controller '" + section->getName() + "' comes before any statedef"));
+                continue;
+            }
+            checkController(section, state, file, resources, graph, report);
+        }
+    }
+}
+
+/* The engine puts characters in the basic states (standing, walking, intro,
+ * win poses and so on) and the get hit states itself, and the negative
+ * states run every tick. Everything else has to be changed to.
+ */
+static bool engineState(int state){
+    return state < 200 || (state >= 5000 && state < 6000);
+}
+
+static void findUnreachable(const StateGraph & graph, Report & report){
+    set<int> reachable;
+    std::deque<int> pending;
+    for (set<int>::const_iterator it = graph.defined.begin(); it != graph.defined.end(); it++){
+        if (engineState(*it)){
+            reachable.insert(*it);
+            pending.push_back(*it);
+        }
+    }
+
+    while (!pending.empty()){
+        int state = pending.front();
+        pending.pop_front();
+        map<int, set<int> >::const_iterator changes = graph.changes.find(state);
+        if (changes == graph.changes.end()){
+            continue;
+        }
+        for (set<int>::const_iterator it = changes->second.begin(); it != changes->second.end(); it++){
+            if (reachable.insert(*it).second){
+                pending.push_back(*it);
+            }
+        }
+    }
+
+    for (set<int>::const_iterator it = graph.own.begin(); it != graph.own.end(); it++){
+        if (reachable.find(*it) == reachable.end()){
+            report.unreachableStates.push_back(*it);
+        }
+    }
+}
+
+/* Same lookup as the character uses, the common states live in mugen/data */
+static Filesystem::AbsolutePath findStateFile(const Filesystem::AbsolutePath & base, const string & path){
+    try{
+        return Storage::instance().findInsensitive(Storage::instance().cleanse(base).join(Filesystem::RelativePath(path)));
+    } catch (const Filesystem::NotFound & fail){
+        return Storage::instance().findInsensitive(Filesystem::RelativePath("mugen/data/" + path));
+    }
+}
+
+/* st, st0, st1 and so on */
+static bool isStateFile(const string & name){
+    if (name.compare(0, 2, "st") != 0){
+        return false;
+    }
+    for (unsigned int i = 2; i < name.size(); i++){
+        if (!isdigit((unsigned char) name[i])){
+            return false;
+        }
+    }
+    return true;
+}
+
+static void checkCharacterFiles(const Filesystem::AbsolutePath & path, const SoundMap * sounds, Report & report){
+    AstRef parsed;
+    try{
+        parsed = Util::parseDef(path);
+    } catch (const MugenException & fail){
+        report.issues.push_back(Issue("parse", report.path, 0, fail.getReason()));
+        return;
+    }
+
+    Ast::Section * files = parsed->findSection("files");
+    if (files == NULL){
+        report.issues.push_back(Issue("file", report.path, 0, "No [Files] section"));
+        return;
+    }
+
+    Attributes attributes;
+    files->walk(attributes);
+    const Filesystem::AbsolutePath base = path.getDirectory();
+
+    /* stcommon is shared by every character so its states are not reported
+     * as unreachable
+     */
+    vector<std::pair<string, bool> > stateFiles;
+    string sprite;
+    string animation;
+    for (map<string, const Ast::AttributeSimple *>::iterator it = attributes.values.begin(); it != attributes.values.end(); it++){
+        const string & name = it->first;
+        string value;
+        try{
+            it->second->view() >> value;
+        } catch (const Ast::Exception & empty){
+            continue;
+        }
+
+        if (name == "cmd" || name == "cns" || isStateFile(name)){
+            stateFiles.push_back(std::make_pair(value, true));
+        } else if (name == "stcommon"){
+            stateFiles.push_back(std::make_pair(value, false));
+        } else if (name == "sprite"){
+            sprite = value;
+        } else if (name == "anim"){
+            animation = value;
+        }
+    }
+
+    Resources resources;
+    resources.sounds = sounds;
+
+    if (sprite != ""){
+        try{
+            readSprites(Util::findFile(base, Filesystem::RelativePath(sprite)), resources, report);
+        } catch (const Filesystem::NotFound & fail){
+            report.issues.push_back(Issue("file", report.path, files->getLine(), "Sprite file " + sprite + " does not exist"));
+        }
+    }
+
+    if (animation != ""){
+        try{
+            checkAnimations(Util::findFile(base, Filesystem::RelativePath(animation)), resources, report);
+        } catch (const Filesystem::NotFound & fail){
+            report.issues.push_back(Issue("file", report.path, files->getLine(), "Animation file " + animation + " does not exist"));
+        }
+    }
+
+    StateGraph graph;
+    for (vector<std::pair<string, bool> >::iterator it = stateFiles.begin(); it != stateFiles.end(); it++){
+        try{
+            checkStateFile(findStateFile(base, it->first), it->second, resources, graph, report);
+        } catch (const Filesystem::NotFound & fail){
+            report.issues.push_back(Issue("file", report.path, files->getLine(), "State file " + it->first + " does not exist"));
+        }
+    }
+
+    findUnreachable(graph, report);
+}
+
+Report validateCharacter(const Filesystem::AbsolutePath & path){
+    Report report;
+    report.kind = "character";
+    report.path = describePath(path);
+
+    PaintownUtil::ReferenceCount<Character> character;
+    const unsigned long memory = System::memoryUsage();
+    const uint64_t start = Profile::currentMicroseconds();
+    try{
+        character = PaintownUtil::ReferenceCount<Character>(new Character(path, Stage::Player1Side));
+        character->load();
+        report.loaded = true;
+    } catch (const MugenException & fail){
+        report.issues.push_back(Issue("load", report.path, 0, fail.getReason()));
+    } catch (const Exception::Base & fail){
+        report.issues.push_back(Issue("load", report.path, 0, fail.getTrace()));
+    }
+    report.microseconds = Profile::currentMicroseconds() - start;
+    report.memoryGrowth = (long) System::memoryUsage() - (long) memory;
+
+    checkCharacterFiles(path, report.loaded ? &character->getSounds() : NULL, report);
+    return report;
+}
+
+static void checkStageFiles(const Filesystem::AbsolutePath & path, Report & report){
+    AstRef parsed;
+    try{
+        parsed = Util::parseDef(path);
+    } catch (const MugenException & fail){
+        report.issues.push_back(Issue("parse", report.path, 0, fail.getReason()));
+        return;
+    }
+
+    Ast::Section * definition = parsed->findSection("bgdef");
+    if (definition == NULL){
+        report.issues.push_back(Issue("file", report.path, 0, "No [BGdef] section"));
+        return;
+    }
+
+    Attributes attributes;
+    definition->walk(attributes);
+    const Ast::AttributeSimple * sprite = attributes.find("spr");
+    if (sprite == NULL){
+        report.issues.push_back(Issue("file", report.path, definition->getLine(), "No sprite file in [BGdef]"));
+        return;
+    }
+
+    Resources resources;
+    string file;
+    try{
+        sprite->view() >> file;
+    } catch (const Ast::Exception & fail){
+        report.issues.push_back(Issue("parse", report.path, sprite->getLine(), fail.getReason()));
+        return;
+    }
+
+    try{
+        readSprites(Util::findFile(path.getDirectory(), Filesystem::RelativePath(file)), resources, report);
+    } catch (const Filesystem::NotFound & fail){
+        report.issues.push_back(Issue("file", report.path, sprite->getLine(), "Sprite file " + file + " does not exist"));
+        return;
+    }
+
+    if (!resources.haveSprites){
+        return;
+    }
+
+    for (Ast::AstParse::section_iterator it = parsed->getSections()->begin(); it != parsed->getSections()->end(); it++){
+        Ast::Section * section = *it;
+        /* the backgrounds of a stage are all named BG something */
+        string head = Util::fixCase(section->getName());
+        if (head.compare(0, 3, "bg ") != 0){
+            continue;
+        }
+
+        Attributes background;
+        section->walk(background);
+        const Ast::AttributeSimple * number = background.find("spriteno");
+        if (number == NULL){
+            continue;
+        }
+
+        int group = 0;
+        int item = 0;
+        try{
+            number->view() >> group >> item;
+        } catch (const Ast::Exception & fail){
+            report.issues.push_back(Issue("parse", report.path, number->getLine(), fail.getReason()));
+            continue;
+        }
+
+        if (group >= 0 && resources.sprites.find(std::make_pair(group, item)) == resources.sprites.end()){
+            std::ostringstream out;
+            out << "Background '" << section->getName() << "' uses sprite " << group << ", " << item << " which is not in the sprite file";
+            report.issues.push_back(Issue("sprite", report.path, number->getLine(), out.str()));
+        }
+    }
+}
+
+Report validateStage(const Filesystem::AbsolutePath & path){
+    Report report;
+    report.kind = "stage";
+    report.path = describePath(path);
+
+    const unsigned long memory = System::memoryUsage();
+    const uint64_t start = Profile::currentMicroseconds();
+    try{
+        Stage stage(path);
+        stage.load();
+        report.loaded = true;
+    } catch (const MugenException & fail){
+        report.issues.push_back(Issue("load", report.path, 0, fail.getReason()));
+    } catch (const Exception::Base & fail){
+        report.issues.push_back(Issue("load", report.path, 0, fail.getTrace()));
+    }
+    report.microseconds = Profile::currentMicroseconds() - start;
+    report.memoryGrowth = (long) System::memoryUsage() - (long) memory;
+
+    checkStageFiles(path, report);
+    return report;
+}
+
+/* Work shared by the validation threads. Each thread takes the next file
+ * until there are none left, the reports go in the slot of the file so the
+ * output doesn't depend on the timing.
+ */
+struct Work{
+    Work(const vector<Filesystem::AbsolutePath> & characters, const vector<Filesystem::AbsolutePath> & stages):
+    characters(characters),
+    stages(stages),
+    reports(characters.size() + stages.size()),
+    next(0){
+    }
+
+    const vector<Filesystem::AbsolutePath> & characters;
+    const vector<Filesystem::AbsolutePath> & stages;
+    vector<Report> reports;
+    unsigned int next;
+    PaintownUtil::Thread::LockObject lock;
+};
+
+static void * validateWork(void * arg){
+    Work & work = *(Work*) arg;
+    while (true){
+        unsigned int index = 0;
+        {
+            PaintownUtil::Thread::ScopedLock scoped(work.lock);
+            if (work.next >= work.reports.size()){
+                return NULL;
+            }
+            index = work.next;
+            work.next += 1;
+        }
+
+        Report report;
+        if (index < work.characters.size()){
+            report = validateCharacter(work.characters[index]);
+        } else {
+            report = validateStage(work.stages[index - work.characters.size()]);
+        }
+
+        {
+            PaintownUtil::Thread::ScopedLock scoped(work.lock);
+            Global::debug(0) << (report.issues.size() == 0 ? "Ok " : "Problems in ") << report.path << " (" << (report.microseconds / 1000) << "ms)" << endl;
+            work.reports[index] = report;
+        }
+    }
+    return NULL;
+}
+
+vector<Report> validateAll(const vector<Filesystem::AbsolutePath> & characters, const vector<Filesystem::AbsolutePath> & stages, int jobs){
+    /* shared by every thread so common1.cns and friends are only parsed once */
+    ParseCache cache;
+    Work work(characters, stages);
+
+    vector<PaintownUtil::Thread::Id> threads;
+    for (int i = 1; i < jobs; i++){
+        PaintownUtil::Thread::Id thread;
+        if (PaintownUtil::Thread::createThread(&thread, NULL, (PaintownUtil::Thread::ThreadFunction) validateWork, &work)){
+            threads.push_back(thread);
+        }
+    }
+
+    /* the calling thread does its share too */
+    validateWork(&work);
+
+    for (vector<PaintownUtil::Thread::Id>::iterator it = threads.begin(); it != threads.end(); it++){
+        PaintownUtil::Thread::joinThread(*it);
+    }
+
+    return work.reports;
+}
+
+static string quote(const string & input){
+    std::ostringstream out;
+    out << '"';
+    for (unsigned int i = 0; i < input.size(); i++){
+        unsigned char c = input[i];
+        switch (c){
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            default: {
+                if (c < 0x20){
+                    char buffer[8];
+                    snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    out << buffer;
+                } else {
+                    out << c;
+                }
+                break;
+            }
+        }
+    }
+    out << '"';
+    return out.str();
+}
+
+void writeJson(std::ostream & out, const vector<Report> & reports){
+    out << "[" << endl;
+    for (vector<Report>::const_iterator it = reports.begin(); it != reports.end(); it++){
+        const Report & report = *it;
+        out << "  {\"kind\": " << quote(report.kind)
+            << ", \"path\": " << quote(report.path)
+            << ", \"loaded\": " << (report.loaded ? "true" : "false")
+            << ", \"loadMilliseconds\": " << (report.microseconds / 1000.0)
+            << ", \"memoryGrowth\": " << report.memoryGrowth
+            << ", \"spriteMemory\": " << report.spriteMemory
+            << ", \"computedStateChanges\": " << report.computedStateChanges
+            << ", \"unreachableStates\": [";
+        for (unsigned int i = 0; i < report.unreachableStates.size(); i++){
+            out << (i > 0 ? ", " : "") << report.unreachableStates[i];
+        }
+        out << "], \"issues\": [";
+        for (unsigned int i = 0; i < report.issues.size(); i++){
+            const Issue & issue = report.issues[i];
+            out << (i > 0 ? "," : "") << endl;
+            out << "    {\"kind\": " << quote(issue.kind) << ", \"file\": " << quote(issue.file) << ", \"line\": " << issue.line << ", \"message\": " << quote(issue.message) << "}";
+        }
+        if (report.issues.size() > 0){
+            out << endl << "  ";
+        }
+        out << "]}" << (it + 1 != reports.end() ? "," : "") << endl;
+    }
+    out << "]" << endl;
+}
+
+static bool isCharacter(const Filesystem::AbsolutePath & path){
+    try{
+        return Util::probeDef(path, "Files", "cmd") != "";
+    } catch (...){
+    }
+    return false;
+}
+
+int runTool(const vector<string> & arguments){
+    string output = "mugen-validate.json";
+    int jobs = 4;
+    if (arguments.size() > 0){
+        output = arguments[0];
+    }
+    if (arguments.size() > 1){
+        jobs = atoi(arguments[1].c_str());
+        if (jobs < 1){
+            jobs = 1;
+        }
+    }
+
+    vector<Filesystem::AbsolutePath> characters;
+    vector<Filesystem::AbsolutePath> stages;
+    try{
+        vector<Filesystem::AbsolutePath> defs = Storage::instance().getFilesRecursive(Storage::instance().find(Filesystem::RelativePath("mugen/chars/")), "*.def");
+        for (vector<Filesystem::AbsolutePath>::iterator it = defs.begin(); it != defs.end(); it++){
+            if (isCharacter(*it)){
+                characters.push_back(*it);
+            }
+        }
+        stages = Storage::instance().getFilesRecursive(Storage::instance().find(Filesystem::RelativePath("mugen/stages/")), "*.def");
+    } catch (const Filesystem::NotFound & fail){
+        Global::debug(0) << "Could not find the mugen directories: " << fail.getTrace() << endl;
+        return 1;
+    }
+
+    Global::debug(0) << "Validating " << characters.size() << " characters and " << stages.size() << " stages with " << jobs << " threads" << endl;
+    const uint64_t start = Profile::currentMicroseconds();
+    vector<Report> reports = validateAll(characters, stages, jobs);
+    const uint64_t took = Profile::currentMicroseconds() - start;
+
+    int problems = 0;
+    for (vector<Report>::iterator it = reports.begin(); it != reports.end(); it++){
+        if (!it->loaded || it->issues.size() > 0){
+            problems += 1;
+        }
+    }
+
+    std::ofstream out(output.c_str());
+    if (!out.good()){
+        Global::debug(0) << "Could not write " << output << endl;
+        return 1;
+    }
+    writeJson(out, reports);
+    out.close();
+    Global::debug(0) << "Validated " << reports.size() << " files in " << (took / 1000) << "ms, " << problems << " have problems. Wrote " << output << endl;
+    return problems > 0 ? 1 : 0;
+}
+
+}
+}
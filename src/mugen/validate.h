@@ -0,0 +1,77 @@
+#ifndef paintown_mugen_validate_h
+#define paintown_mugen_validate_h
+
+/* Loads characters and stages without starting the game and reports the
+ * problems that would otherwise only show up as exceptions or debug output in
+ * the middle of a match. Used by the mugen:validate command.
+ */
+
+#include <stdint.h>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Filesystem{
+    class AbsolutePath;
+}
+
+namespace Mugen{
+namespace Validate{
+
+struct Issue{
+    Issue(const std::string & kind, const std::string & file, int line, const std::string & message);
+
+    /* parse, file, load, trigger, controller, sprite, sound, animation or state */
+    std::string kind;
+    std::string file;
+    /* 0 if the problem isn't on a particular line */
+    int line;
+    std::string message;
+};
+
+struct Report{
+    Report();
+
+    /* character or stage */
+    std::string kind;
+    std::string path;
+    /* true if the game could load it */
+    bool loaded;
+    uint64_t microseconds;
+    /* growth of the process while loading. Only exact when nothing else is
+     * being loaded at the same time.
+     */
+    long memoryGrowth;
+    /* size of every sprite once decoded */
+    uint64_t spriteMemory;
+    /* state numbers that nothing changes to, only listed for the states the
+     * character defines itself
+     */
+    std::vector<int> unreachableStates;
+    /* state changes to a computed state number, if there are any the
+     * unreachable states might be reachable after all
+     */
+    int computedStateChanges;
+    std::vector<Issue> issues;
+};
+
+Report validateCharacter(const Filesystem::AbsolutePath & path);
+Report validateStage(const Filesystem::AbsolutePath & path);
+
+/* Validates everything on jobs threads that share one parse cache. Reports
+ * are in the same order as the input, characters first.
+ */
+std::vector<Report> validateAll(const std::vector<Filesystem::AbsolutePath> & characters, const std::vector<Filesystem::AbsolutePath> & stages, int jobs);
+
+void writeJson(std::ostream & out, const std::vector<Report> & reports);
+
+/* The mugen:validate command, the arguments are an optional output file and
+ * number of threads. Returns the exit status, 1 if anything had problems or
+ * the report couldn't be written.
+ */
+int runTool(const std::vector<std::string> & arguments);
+
+}
+}
+
+#endif
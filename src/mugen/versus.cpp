@@ -7,6 +7,7 @@
 #include "ast/all.h"
 #include "sound.h"
 #include "font.h"
+#include "factory/presenter.h"
 
 using namespace Mugen;
 
@@ -347,17 +348,18 @@ public:
 class VersusDraw: public PaintownUtil::Draw {
 public:
     VersusDraw(Mugen::VersusMenu & versus):
-    versus(versus){
+    versus(versus),
+    presenter(320, 240){
     }
     
     Mugen::VersusMenu & versus;
+    Presenter presenter;
 
     void draw(const Graphics::Bitmap & buffer){
         buffer.clear();
-        Graphics::StretchedBitmap work(320, 240, buffer, Graphics::StretchedBitmap::NoClear, Graphics::qualityFilterName(::Configuration::getQualityFilter()));
-        work.start();
+        Graphics::Bitmap & work = presenter.start(buffer);
         versus.draw(work);
-        work.finish();
+        presenter.finish(buffer);
         // buffer.BlitToScreen();
     }
 };
@@ -23,6 +23,7 @@
 #include "../factory/object_factory.h"
 #include "../level/utils.h"
 #include "factory/font_render.h"
+#include "factory/presenter.h"
 #include <r-tech1/token.h>
 #include <r-tech1/tokenreader.h>
 #include <r-tech1/input/input-source.h>
@@ -284,12 +285,15 @@ public:
     Draw(Console::Console & console, World & world, GameState & state):
         console(console),
         world(world),
-        state(state){
+        state(state),
+        presenter(320, 240){
         }
 
     Console::Console & console;
     World & world;
     GameState & state;
+    /* FIXME: replace these constants */
+    Presenter presenter;
 
     void draw(const Graphics::Bitmap & screen_buffer){
         run(screen_buffer, state);
@@ -297,32 +301,30 @@ public:
 
     void run(const Graphics::Bitmap & screen_buffer, GameState & state){
         Graphics::RestoreState graphicsState;
-        /* FIXME: replace these constants */
-        Graphics::StretchedBitmap work(320, 240, screen_buffer, Graphics::StretchedBitmap::NoClear, Graphics::qualityFilterName(Configuration::getQualityFilter()));
         Graphics::TranslatedBitmap screen(world.getX(), world.getY(), screen_buffer);
         // updateFrames();
 
-        work.start();
+        Graphics::Bitmap & work = presenter.start(screen_buffer);
         work.clear();
         world.draw(&work);
 
-        work.finish();
+        presenter.finish(screen_buffer);
         // work.Stretch(screen_buffer);
         FontRender * render = FontRender::getInstance();
-        render->render(&screen_buffer, work.getScaleWidth() / 2, work.getScaleHeight() / 2);
+        render->render(&screen_buffer, presenter.getScaleWidth() / 2, presenter.getScaleHeight() / 2);
 
-        const Font & font = Font::getDefaultFont((int) (20 * work.getScaleWidth() / 2), (int)(20 * work.getScaleHeight() / 2));
+        const Font & font = Font::getDefaultFont((int) (20 * presenter.getScaleWidth() / 2), (int)(20 * presenter.getScaleHeight() / 2));
 
         if (state.helpTime > 0){
-            int x = (int)(100 * work.getScaleWidth() / 2);
-            int y = (screen_buffer.getHeight() / 5 * work.getScaleHeight() / 2);
+            int x = (int)(100 * presenter.getScaleWidth() / 2);
+            int y = (screen_buffer.getHeight() / 5 * presenter.getScaleHeight() / 2);
             Graphics::Color color = Graphics::makeColor(255, 255, 255);
             Graphics::Bitmap::transBlender( 0, 0, 0, (int)(state.helpTime > 255 ? 255 : state.helpTime));
             drawHelp(font, x, y, color, screen_buffer.translucent());
         }
 
         if (state.show_fps){
-            font.printf((int)(screen_buffer.getWidth() - 120 * work.getScaleWidth() / 2), (int)(10 * work.getScaleHeight() / 2), Graphics::makeColor(255,255,255), screen_buffer, "FPS: %0.2f", 0, getFps());
+            font.printf((int)(screen_buffer.getWidth() - 120 * presenter.getScaleWidth() / 2), (int)(10 * presenter.getScaleHeight() / 2), Graphics::makeColor(255,255,255), screen_buffer, "FPS: %0.2f", 0, getFps());
         }
         console.draw(screen_buffer);
 
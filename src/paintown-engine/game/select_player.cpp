@@ -26,6 +26,7 @@
 #include "../level/utils.h"
 #include "world.h"
 #include "character-select.h"
+#include "factory/presenter.h"
 #include <iostream>
 #include <vector>
 #include <algorithm>
@@ -47,7 +48,8 @@ class Selecter: public Util::Logic, public Util::Draw {
         Selecter(CharacterSelect & select, const InputSource & source, const string & message):
         select(select),
         source(source),
-        is_done(false){
+        is_done(false),
+        presenter(640, 480){
             // input.set(Keyboard::Key_ESC, 0, true, Quit);
             for (vector<int>::const_iterator it = source.getKeyboard().begin(); it != source.getKeyboard().end(); it++){
                 int player = *it;
@@ -86,6 +88,7 @@ class Selecter: public Util::Logic, public Util::Draw {
         const InputSource & source;
         bool is_done;
         Filesystem::AbsolutePath chosen;
+        Presenter presenter;
 
         bool done(){
             return is_done;
@@ -129,10 +132,9 @@ class Selecter: public Util::Logic, public Util::Draw {
 
         void draw(const Graphics::Bitmap & buffer){
             buffer.clear();
-            Graphics::StretchedBitmap work(640, 480, buffer, Graphics::StretchedBitmap::NoClear, Graphics::qualityFilterName(Configuration::getQualityFilter()));
-            work.start();
+            Graphics::Bitmap & work = presenter.start(buffer);
             select.draw(work);
-            work.finish();
+            presenter.finish(buffer);
             // buffer.BlitToScreen();
         }
 };
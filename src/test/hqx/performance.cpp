@@ -1,10 +1,12 @@
-#include "util/debug.h"
-#include "util/init.h"
-#include "util/graphics/bitmap.h"
-#include "util/timedifference.h"
+#include <r-tech1/debug.h>
+#include <r-tech1/init.h>
+#include <r-tech1/graphics/bitmap.h>
+#include <r-tech1/timedifference.h>
+#include "factory/band-scaler.h"
 #include <stdlib.h>
 
 #include <math.h>
+#include <sstream>
 #include <string>
 
 using std::string;
@@ -37,26 +39,96 @@ static void testxbr(Graphics::Bitmap input, string size, int increase){
     }
 }
 
-static void run(string path){
+/* Number of pixels that are different between the two bitmaps */
+static int compare(const Graphics::Bitmap & expected, const Graphics::Bitmap & actual){
+    int different = 0;
+    for (int y = 0; y < expected.getHeight(); y++){
+        for (int x = 0; x < expected.getWidth(); x++){
+            Graphics::Color pixel1 = expected.getPixel(x, y);
+            Graphics::Color pixel2 = actual.getPixel(x, y);
+            if (Graphics::getRed(pixel1) != Graphics::getRed(pixel2) ||
+                Graphics::getGreen(pixel1) != Graphics::getGreen(pixel2) ||
+                Graphics::getBlue(pixel1) != Graphics::getBlue(pixel2)){
+                different += 1;
+            }
+        }
+    }
+    return different;
+}
+
+/* Times the band scaler with different numbers of bands and checks that it
+ * comes up with the same picture as the serial filter. Returns false if it
+ * didn't.
+ */
+static bool testBands(const Graphics::Bitmap & input, Graphics::QualityFilter filter, const string & name, int increase){
+    Graphics::Bitmap expected(Graphics::Bitmap::createMemoryBitmap(input.getWidth() * increase, input.getHeight() * increase));
+    BandScaler::scaleSerial(input, expected, filter);
+
+    bool ok = true;
+    const int max = 100;
+    const int counts[] = {1, 2, 4, 8};
+    for (unsigned int i = 0; i < sizeof(counts) / sizeof(int); i++){
+        BandScaler scaler(counts[i]);
+        Graphics::Bitmap output(Graphics::Bitmap::createMemoryBitmap(input.getWidth() * increase, input.getHeight() * increase));
+
+        TimeDifference timer;
+        timer.startTime();
+        for (int x = 0; x < max; x++){
+            scaler.scale(input, output, filter);
+        }
+        timer.endTime();
+
+        std::ostringstream out;
+        out << input.getWidth() << "x" << input.getHeight() << " " << increase << name << " " << counts[i] << " bands";
+        Global::debug(0) << timer.printAverageTime(out.str(), max) << std::endl;
+
+        int different = compare(expected, output);
+        if (different != 0){
+            Global::debug(0) << "  " << different << " pixels differ from the serial output" << std::endl;
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+static bool run(string path){
     Graphics::Bitmap image(path);
 
     testhqx(image, "hq2x", 2);
     testhqx(image, "hq3x", 3);
     testhqx(image, "hq4x", 4);
-    
+
     testxbr(image, "2xbr", 2);
     testxbr(image, "3xbr", 3);
     testxbr(image, "4xbr", 4);
+
+    /* the size the games draw at and a larger one */
+    Graphics::Bitmap small(Graphics::Bitmap::createMemoryBitmap(320, 240));
+    image.Stretch(small);
+    Graphics::Bitmap large(Graphics::Bitmap::createMemoryBitmap(640, 480));
+    image.Stretch(large);
+
+    bool ok = true;
+    for (int increase = 2; increase <= 4; increase++){
+        ok = testBands(small, Graphics::HqxFilter, "hq", increase) && ok;
+        ok = testBands(small, Graphics::XbrFilter, "xbr", increase) && ok;
+    }
+    ok = testBands(large, Graphics::HqxFilter, "hq", 2) && ok;
+    ok = testBands(large, Graphics::XbrFilter, "xbr", 2) && ok;
+
+    return ok;
 }
 
 int main(int argc, char ** argv){
     Global::InitConditions conditions;
     Global::init(conditions);
     Global::setDebug(0);
+    bool ok;
     if (argc > 1){
-        run(argv[1]);
+        ok = run(argv[1]);
     } else {
-        run("src/test/hqx/test.png");
+        ok = run("src/test/hqx/test.png");
     }
-    return 0;
+    return ok ? 0 : 1;
 }
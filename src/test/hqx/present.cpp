@@ -0,0 +1,77 @@
+#include <r-tech1/debug.h>
+#include <r-tech1/init.h>
+#include <r-tech1/graphics/bitmap.h>
+#include <r-tech1/timedifference.h>
+#include "factory/presenter.h"
+
+#include <string>
+
+using std::string;
+
+static const int FRAMES = 200;
+
+/* Stand in for a frame of the game: some logic on the cpu and some drawing */
+static void game(const Graphics::Bitmap & image, const Graphics::Bitmap & work){
+    volatile double logic = 0;
+    for (int i = 0; i < 200000; i++){
+        logic += i * 0.5;
+    }
+
+    for (int i = 0; i < 10; i++){
+        image.Blit(i * 4, i * 4, work);
+    }
+}
+
+/* A new stretched bitmap every frame with the filter done on this thread */
+static void synchronous(const Graphics::Bitmap & image, const Graphics::Bitmap & screen, Graphics::QualityFilter filter, const string & name){
+    TimeDifference timer;
+    timer.startTime();
+    for (int frame = 0; frame < FRAMES; frame++){
+        Graphics::StretchedBitmap work(320, 240, screen, Graphics::StretchedBitmap::NoClear, filter);
+        work.start();
+        game(image, work);
+        work.finish();
+    }
+    timer.endTime();
+    Global::debug(0) << timer.printAverageTime(name + " synchronous", FRAMES) << std::endl;
+}
+
+static void pipelined(const Graphics::Bitmap & image, const Graphics::Bitmap & screen, Graphics::QualityFilter filter, const string & name){
+    Presenter presenter(320, 240, filter);
+    TimeDifference timer;
+    timer.startTime();
+    for (int frame = 0; frame < FRAMES; frame++){
+        Graphics::Bitmap & work = presenter.start(screen);
+        game(image, work);
+        presenter.finish(screen);
+    }
+    presenter.flush(screen);
+    timer.endTime();
+    Global::debug(0) << timer.printAverageTime(name + (presenter.isPipelined() ? " pipelined" : " presenter"), FRAMES) << std::endl;
+}
+
+static void run(string path){
+    Graphics::Bitmap image(path);
+    Graphics::Bitmap screen(640, 480);
+
+    synchronous(image, screen, Graphics::NoFilter, "none");
+    pipelined(image, screen, Graphics::NoFilter, "none");
+
+    synchronous(image, screen, Graphics::HqxFilter, "hqx");
+    pipelined(image, screen, Graphics::HqxFilter, "hqx");
+
+    synchronous(image, screen, Graphics::XbrFilter, "xbr");
+    pipelined(image, screen, Graphics::XbrFilter, "xbr");
+}
+
+int main(int argc, char ** argv){
+    Global::InitConditions conditions;
+    Global::init(conditions);
+    Global::setDebug(0);
+    if (argc > 1){
+        run(argv[1]);
+    } else {
+        run("src/test/hqx/test.png");
+    }
+    return 0;
+}
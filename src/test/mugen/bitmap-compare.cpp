@@ -0,0 +1,17 @@
+#include <r-tech1/graphics/bitmap.h>
+#include "bitmap-compare.h"
+
+bool samePixels(const Graphics::Bitmap & first, const Graphics::Bitmap & second){
+    if (first.getWidth() != second.getWidth() || first.getHeight() != second.getHeight()){
+        return false;
+    }
+
+    for (int y = 0; y < first.getHeight(); y++){
+        for (int x = 0; x < first.getWidth(); x++){
+            if (first.getPixel(x, y) != second.getPixel(x, y)){
+                return false;
+            }
+        }
+    }
+    return true;
+}
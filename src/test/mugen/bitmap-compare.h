@@ -0,0 +1,11 @@
+#ifndef _paintown_test_mugen_bitmap_compare_h
+#define _paintown_test_mugen_bitmap_compare_h
+
+namespace Graphics{
+    class Bitmap;
+}
+
+/* true if the two bitmaps are the same size and every pixel matches */
+bool samePixels(const Graphics::Bitmap & first, const Graphics::Bitmap & second);
+
+#endif
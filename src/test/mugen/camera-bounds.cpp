@@ -0,0 +1,123 @@
+#include <r-tech1/debug.h>
+#include "mugen/character.h"
+#include "mugen/profile.h"
+#include "mugen/stage.h"
+#include "kfm-match.h"
+#include "play-replay.h"
+
+using namespace std;
+
+/* Plays the recorded inputs in replay.txt and checks on every tick that the
+ * edges and tension lines the stage hands out are the ones the stage used to
+ * work out from the camera position every time it was asked. The camera only
+ * moves by what those answers tell it, so if they are the same on every tick
+ * the camera moves the same as it did before they were cached. ScreenBound
+ * has to move the edges of only the character that used it, for one tick.
+ */
+
+static const int QUERIES = 1000000;
+static const int DEFAULT_WIDTH = 320;
+static const int DEFAULT_HEIGHT = 240;
+
+/* the edges worked out straight from the camera, the way the stage used to */
+static bool checkEdges(const Mugen::Stage & stage, const Mugen::Character * who, int tick){
+    if (stage.maximumLeft(who) != (int)(stage.getCameraX() - DEFAULT_WIDTH / 2) ||
+        stage.maximumRight(who) != (int)(stage.getCameraX() + DEFAULT_WIDTH / 2) ||
+        stage.maximumUp() != (int) stage.getCameraY() ||
+        stage.maximumDown() != (int)(stage.getCameraY() + DEFAULT_HEIGHT)){
+        Global::debug(0) << "The edges of the screen don't match the camera at tick " << tick << endl;
+        return false;
+    }
+    return true;
+}
+
+/* the tension lines worked out from the edges, the way the stage used to */
+static bool checkTension(const Mugen::Stage & stage, const Mugen::Character * who, int tick){
+    if (stage.leftTension(who) != stage.maximumLeft(who) + stage.getTension() ||
+        stage.rightTension(who) != stage.maximumRight(who) - stage.getTension()){
+        Global::debug(0) << "The tension lines don't match the camera at tick " << tick << endl;
+        return false;
+    }
+    return true;
+}
+
+/* while a character uses ScreenBound with value = 0 its edges are the whole
+ * stage, everyone else keeps the screen, and it is over on the next tick
+ */
+static bool checkScreenBound(Mugen::Stage & stage, Mugen::Character & player1, Mugen::Character & player2){
+    int left = stage.maximumLeft(NULL);
+    int right = stage.maximumRight(NULL);
+
+    /* the camera can be against one side of the stage, but not both */
+    stage.enableScreenBound(&player1, true, false, false);
+    int left1 = stage.maximumLeft(&player1);
+    int right1 = stage.maximumRight(&player1);
+    if (left1 > left || right1 < right || (left1 == left && right1 == right)){
+        Global::debug(0) << "ScreenBound didn't let player 1 off the screen" << endl;
+        return false;
+    }
+
+    if (stage.maximumLeft(&player2) != left || stage.maximumRight(&player2) != right){
+        Global::debug(0) << "ScreenBound on player 1 moved the edges of player 2" << endl;
+        return false;
+    }
+
+    stage.logic();
+    if (stage.maximumLeft(&player1) != stage.maximumLeft(NULL) ||
+        stage.maximumRight(&player1) != stage.maximumRight(NULL)){
+        Global::debug(0) << "ScreenBound lasted longer than a tick" << endl;
+        return false;
+    }
+
+    /* the edges follow the camera in the middle of a tick too */
+    stage.moveCamera(-10, 0);
+    return checkEdges(stage, &player1, -1);
+}
+
+static bool playMatch(uint64_t & queryTime){
+    ReplayMatch match;
+    Mugen::Stage & stage = match.getStage();
+    Mugen::Character & player1 = match.getPlayer1();
+    Mugen::Character & player2 = match.getPlayer2();
+
+    int tick = 0;
+    for (tick = 0; !match.done(tick); tick++){
+        stage.logic();
+        if (!checkEdges(stage, NULL, tick) ||
+            !checkTension(stage, &player1, tick) ||
+            !checkTension(stage, &player2, tick)){
+            return false;
+        }
+    }
+    Global::debug(0) << "The edges and tension lines matched the camera for all " << tick << " ticks" << endl;
+
+    if (!checkScreenBound(stage, player1, player2) ||
+        !checkTension(stage, &player1, -1)){
+        return false;
+    }
+
+    /* what the triggers and controllers of a busy tick ask for */
+    uint64_t start = Mugen::Profile::currentMicroseconds();
+    int sum = 0;
+    for (int i = 0; i < QUERIES; i++){
+        sum += stage.maximumLeft(&player1) + stage.maximumRight(&player2) + stage.maximumUp();
+    }
+    queryTime = Mugen::Profile::currentMicroseconds() - start;
+    Global::debug(1) << "Sum of the edges " << sum << endl;
+
+    return true;
+}
+
+static int run(){
+    uint64_t queryTime = 0;
+    if (!playMatch(queryTime)){
+        return 1;
+    }
+
+    Global::debug(0) << QUERIES << " rounds of screen edge queries took " << queryTime << "us" << endl;
+    return 0;
+}
+
+int main(int argc, char ** argv){
+    return runTest(run);
+}
@@ -0,0 +1,118 @@
+#include <string>
+#include <vector>
+#include <r-tech1/debug.h>
+#include "mugen/character.h"
+#include "mugen/helper.h"
+#include "mugen/stage.h"
+#include "mugen/profile.h"
+#include "kfm-match.h"
+
+using namespace std;
+
+/* Fills the stage with helpers, checks that every one of them can be found by
+ * id, that the ids of helpers that are gone find nothing, and compares looking
+ * them up against scanning all the characters like the stage used to.
+ */
+
+static const int HELPERS = 300;
+static const int LOOKUPS = 200000;
+
+/* what Stage::getCharacter used to do */
+static Mugen::Character * scan(const vector<Mugen::Character*> & all, const Mugen::CharacterId & id){
+    for (vector<Mugen::Character*>::const_iterator it = all.begin(); it != all.end(); it++){
+        if ((*it)->getId() == id){
+            return *it;
+        }
+    }
+    return NULL;
+}
+
+static int run(){
+    KfmMatch match;
+    Mugen::Stage & stage = match.getStage();
+    Mugen::Character * player1 = &match.getPlayer1();
+    Mugen::Character * player2 = &match.getPlayer2();
+
+    vector<Mugen::Character*> helpers;
+    for (int i = 0; i < HELPERS; i++){
+        Mugen::Helper * helper = new Mugen::Helper(player1, player1, i, "lookup");
+        stage.addObject(helper);
+        helper->changeState(stage, 0);
+        helpers.push_back(helper);
+    }
+
+    /* new helpers show up after the tick they were made in */
+    if (stage.getCharacter(helpers[0]->getId()) != NULL){
+        Global::debug(0) << "A helper was found before it was added to the stage" << endl;
+        return 1;
+    }
+    stage.logic();
+
+    for (vector<Mugen::Character*>::iterator it = helpers.begin(); it != helpers.end(); it++){
+        if (stage.getCharacter((*it)->getId()) != *it){
+            Global::debug(0) << "Helper " << (*it)->getId().intValue() << " was not found" << endl;
+            return 1;
+        }
+    }
+
+    /* get rid of every other helper */
+    vector<Mugen::CharacterId> gone;
+    vector<Mugen::Character*> live;
+    live.push_back(player1);
+    live.push_back(player2);
+    for (unsigned int i = 0; i < helpers.size(); i++){
+        if (i % 2 == 0){
+            gone.push_back(helpers[i]->getId());
+            helpers[i]->setHealth(0);
+        } else {
+            live.push_back(helpers[i]);
+        }
+    }
+    helpers.clear();
+    stage.logic();
+
+    for (vector<Mugen::CharacterId>::iterator it = gone.begin(); it != gone.end(); it++){
+        if (stage.getCharacter(*it) != NULL){
+            Global::debug(0) << "Helper " << it->intValue() << " was found after it was removed" << endl;
+            return 1;
+        }
+    }
+
+    for (vector<Mugen::Character*>::iterator it = live.begin(); it != live.end(); it++){
+        if (stage.getCharacter((*it)->getId()) != *it){
+            Global::debug(0) << "Character " << (*it)->getId().intValue() << " was lost when other helpers were removed" << endl;
+            return 1;
+        }
+    }
+
+    /* the helpers look up the root and parent far more than the players */
+    uint64_t start = Mugen::Profile::currentMicroseconds();
+    unsigned int found = 0;
+    for (int i = 0; i < LOOKUPS; i++){
+        if (scan(live, live[i % live.size()]->getId()) != NULL){
+            found += 1;
+        }
+    }
+    uint64_t scanTime = Mugen::Profile::currentMicroseconds() - start;
+
+    start = Mugen::Profile::currentMicroseconds();
+    for (int i = 0; i < LOOKUPS; i++){
+        if (stage.getCharacter(live[i % live.size()]->getId()) != NULL){
+            found += 1;
+        }
+    }
+    uint64_t tableTime = Mugen::Profile::currentMicroseconds() - start;
+
+    if (found != (unsigned int) LOOKUPS * 2){
+        Global::debug(0) << "Only " << found << " lookups out of " << (LOOKUPS * 2) << " found something" << endl;
+        return 1;
+    }
+
+    Global::debug(0) << LOOKUPS << " lookups with " << live.size() << " characters took " << scanTime << "us scanning and " << tableTime << "us with the table" << endl;
+
+    return 0;
+}
+
+int main(int argc, char ** argv){
+    return runTest(run);
+}
@@ -0,0 +1,143 @@
+#include <string>
+#include <vector>
+#include <r-tech1/debug.h>
+#include <r-tech1/pointer.h>
+#include "mugen/animation.h"
+#include "mugen/character.h"
+#include "mugen/effect.h"
+#include "mugen/explod-store.h"
+#include "mugen/profile.h"
+#include "mugen/stage.h"
+#include "kfm-match.h"
+
+using namespace std;
+
+/* Spawns 2000 explods, a third of them moving on their own, a third bound to
+ * the player and a third waiting for their remove time, and times moving them
+ * all through the stage's explod store against calling logic on each one.
+ * Both ways have to move an explod to the same place.
+ */
+
+static const int EXPLODS = 2000;
+static const int TICKS = 200;
+static const int REMOVE_TIME = 50;
+/* the id of the timed explods, the others use lower ones */
+static const int TIMED_ID = 100;
+
+enum Kind{
+    Moving,
+    Bound,
+    Timed
+};
+
+static Mugen::ExplodeEffect * addExplod(Mugen::Stage & stage, Mugen::Character & owner, Kind kind, int id){
+    PaintownUtil::ReferenceCount<Mugen::Animation> animation = owner.getAnimation(0);
+    int bindTime = kind == Bound ? -1 : -2;
+    int removeTime = kind == Timed ? REMOVE_TIME : -1;
+    Mugen::ExplodeEffect * effect = new Mugen::ExplodeEffect(&owner, stage, PaintownUtil::ReferenceCount<Mugen::Animation>(animation->copy()), id, 10, 20, 1.5, -0.5, 0.25, 0.125, removeTime, bindTime, Mugen::PositionPlayer1, 5, 0, 1, 1, 0, false, 0, false, false, false, false);
+    stage.addEffect(effect);
+    return effect;
+}
+
+/* where a moving explod should be after some ticks */
+static void expected(int ticks, double & x, double & y){
+    x = 10;
+    y = 20;
+    double velocityX = 1.5;
+    double velocityY = -0.5;
+    for (int i = 0; i < ticks; i++){
+        x += velocityX;
+        y += velocityY;
+        velocityX += 0.25;
+        velocityY += 0.125;
+    }
+}
+
+static bool check(const vector<Mugen::ExplodeEffect*> & explods, const Mugen::Character & owner, int ticks){
+    double x = 0;
+    double y = 0;
+    expected(ticks, x, y);
+    for (unsigned int i = 0; i < explods.size(); i++){
+        Mugen::ExplodeEffect * effect = explods[i];
+        switch ((Kind) (i % 3)){
+            case Moving: {
+                if (effect->getX() != x || effect->getY() != y){
+                    Global::debug(0) << "Explod " << i << " is at " << effect->getX() << ", " << effect->getY() << " instead of " << x << ", " << y << " after " << ticks << " ticks" << endl;
+                    return false;
+                }
+                break;
+            }
+            case Bound: {
+                if (effect->getX() != owner.getX() + 5 || effect->getY() != owner.getRY()){
+                    Global::debug(0) << "Explod " << i << " is not bound to its owner" << endl;
+                    return false;
+                }
+                break;
+            }
+            case Timed: {
+                if (effect->isDead() != (ticks >= REMOVE_TIME)){
+                    Global::debug(0) << "Explod " << i << " should " << (ticks >= REMOVE_TIME ? "" : "not ") << "be gone after " << ticks << " ticks" << endl;
+                    return false;
+                }
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+static int run(){
+    KfmMatch match;
+    Mugen::Stage & stage = match.getStage();
+    Mugen::Character * player1 = &match.getPlayer1();
+
+    vector<Mugen::ExplodeEffect*> explods;
+    for (int i = 0; i < EXPLODS; i++){
+        Kind kind = (Kind) (i % 3);
+        explods.push_back(addExplod(stage, *player1, kind, kind == Timed ? TIMED_ID : i % 10));
+    }
+
+    if (stage.countExplods() != EXPLODS){
+        Global::debug(0) << "Counted " << stage.countExplods() << " explods instead of " << EXPLODS << endl;
+        return 1;
+    }
+
+    /* the first half of the ticks move everything at once, the second half
+     * one explod at a time, and both have to end up in the same place
+     */
+    uint64_t start = Mugen::Profile::currentMicroseconds();
+    for (int tick = 0; tick < TICKS / 2; tick++){
+        stage.getExplods().logic();
+    }
+    uint64_t batched = Mugen::Profile::currentMicroseconds() - start;
+
+    if (!check(explods, *player1, TICKS / 2)){
+        return 1;
+    }
+
+    start = Mugen::Profile::currentMicroseconds();
+    for (int tick = 0; tick < TICKS / 2; tick++){
+        for (vector<Mugen::ExplodeEffect*>::iterator it = explods.begin(); it != explods.end(); it++){
+            (*it)->logic();
+        }
+    }
+    uint64_t single = Mugen::Profile::currentMicroseconds() - start;
+
+    if (!check(explods, *player1, TICKS)){
+        return 1;
+    }
+
+    /* the stage removes the timed out explods on the next tick */
+    stage.logic();
+    if (stage.countExplods(TIMED_ID, player1) != 0){
+        Global::debug(0) << "Explods that timed out are still on the stage" << endl;
+        return 1;
+    }
+
+    Global::debug(0) << EXPLODS << " explods for " << TICKS / 2 << " ticks: " << batched << "us together, " << single << "us one at a time" << endl;
+    return 0;
+}
+
+int main(int argc, char ** argv){
+    return runTest(run);
+}
@@ -0,0 +1,134 @@
+#include <string>
+#include <vector>
+#include <sstream>
+#include <r-tech1/debug.h>
+#include "mugen/character.h"
+#include "mugen/fixed-point.h"
+#include "mugen/stage.h"
+#include "mugen/world.h"
+#include "kfm-match.h"
+#include "play-replay.h"
+
+using namespace std;
+
+/* Plays the recorded inputs in replay.txt with fixed physics and checks what
+ * fixed physics promises within one build: every position and velocity stays
+ * on the grid, playing the match twice gives the same positions on every
+ * tick, and a match restored from a snapshot halfway through plays out the
+ * same as the one that kept going, which is what a network game does when it
+ * rolls back. The state controllers still work in doubles, so nothing is
+ * promised about matching a build made with another compiler or other flags,
+ * and there is no recording from another build to compare against.
+ */
+
+static bool onGrid(const Mugen::Character & character){
+    return Mugen::FixedPoint::exact(character.getX()) &&
+           Mugen::FixedPoint::exact(character.getY()) &&
+           Mugen::FixedPoint::exact(character.getXVelocity()) &&
+           Mugen::FixedPoint::exact(character.getYVelocity());
+}
+
+static string describe(int tick, const Mugen::Character & player1, const Mugen::Character & player2){
+    ostringstream out;
+    const Mugen::Character * players[] = {&player1, &player2};
+    out << tick;
+    for (int i = 0; i < 2; i++){
+        out << " " << Mugen::FixedPoint(players[i]->getX()).raw()
+            << " " << Mugen::FixedPoint(players[i]->getY()).raw()
+            << " " << Mugen::FixedPoint(players[i]->getXVelocity()).raw()
+            << " " << Mugen::FixedPoint(players[i]->getYVelocity()).raw();
+    }
+    return out.str();
+}
+
+/* plays until the match is over, one line per tick from `first' on, empty
+ * if a position fell off the grid
+ */
+static vector<string> playFrom(ReplayMatch & match, int first){
+    Mugen::Character & player1 = match.getPlayer1();
+    Mugen::Character & player2 = match.getPlayer2();
+
+    vector<string> ticks;
+    for (int tick = first; !match.done(tick); tick++){
+        match.getStage().logic();
+        if (!onGrid(player1) || !onGrid(player2)){
+            Global::debug(0) << "A position or velocity is not on the grid at tick " << tick << endl;
+            return vector<string>();
+        }
+        ticks.push_back(describe(tick, player1, player2));
+    }
+    return ticks;
+}
+
+static vector<string> playMatch(){
+    ReplayMatch match(true);
+    return playFrom(match, 0);
+}
+
+/* snapshots the stage halfway through the match given in `ticks', plays on,
+ * restores the snapshot and plays the rest again
+ */
+static bool checkRestore(const vector<string> & ticks){
+    int half = ticks.size() / 2;
+    ReplayMatch match(true);
+    for (int tick = 0; tick < half; tick++){
+        match.getStage().logic();
+    }
+
+    PaintownUtil::ReferenceCount<Mugen::World> snapshot = match.getStage().snapshotState();
+    vector<string> played = playFrom(match, half);
+    match.getStage().updateState(*snapshot);
+    vector<string> restored = playFrom(match, half);
+
+    vector<string> expected(ticks.begin() + half, ticks.end());
+    if (played != expected){
+        Global::debug(0) << "Taking a snapshot changed how the match played out" << endl;
+        return false;
+    }
+
+    if (restored != expected){
+        Global::debug(0) << "The match restored from tick " << half << " played out differently" << endl;
+        return false;
+    }
+
+    return true;
+}
+
+static bool checkFixedPoint(){
+    using Mugen::FixedPoint;
+    return FixedPoint(0.5).raw() == FixedPoint::One / 2 &&
+           FixedPoint(-1.25).raw() == -(FixedPoint::One + FixedPoint::One / 4) &&
+           (FixedPoint(1.5) * FixedPoint(-2)).toDouble() == -3 &&
+           (FixedPoint(3) * FixedPoint(0.85)).raw() == 3 * FixedPoint(0.85).raw() &&
+           FixedPoint::exact(FixedPoint(0.1).toDouble()) &&
+           !FixedPoint::exact(0.1);
+}
+
+static int run(){
+    if (!checkFixedPoint()){
+        Global::debug(0) << "Fixed point arithmetic is wrong" << endl;
+        return 1;
+    }
+
+    vector<string> first = playMatch();
+    if (first.empty()){
+        return 1;
+    }
+
+    vector<string> second = playMatch();
+    if (first != second){
+        Global::debug(0) << "Playing the match twice gave different positions" << endl;
+        return 1;
+    }
+
+    if (!checkRestore(first)){
+        return 1;
+    }
+
+    Global::debug(0) << "All " << first.size() << " ticks stayed on the grid and played out the same every time" << endl;
+    return 0;
+}
+
+int main(int argc, char ** argv){
+    return runTest(run);
+}
@@ -0,0 +1,169 @@
+#include <string>
+#include <vector>
+#include <r-tech1/debug.h>
+#include <r-tech1/pointer.h>
+#include "mugen/character.h"
+#include "mugen/animation.h"
+#include "mugen/behavior.h"
+#include "mugen/stage.h"
+#include "mugen/state.h"
+#include "mugen/frame-data.h"
+#include "kfm-match.h"
+
+using namespace std;
+
+static const int LIGHT_PUNCH = 200;
+
+/* Walks up to the enemy then does a light punch whenever it has control */
+class PunchBehavior: public Mugen::Behavior {
+public:
+    PunchBehavior():
+    punches(0){
+    }
+
+    int punches;
+
+    vector<string> currentCommands(const Mugen::Stage & stage, Mugen::Character * owner, const vector<Mugen::Command2*> & commands, bool reversed){
+        vector<string> out;
+        Mugen::Character * enemy = stage.getEnemy(owner);
+        if (enemy == NULL || !owner->hasControl() || enemy->getMoveType() == Mugen::Move::Hit){
+            return out;
+        }
+
+        double distance = enemy->getX() - owner->getX();
+        if (distance < 0){
+            distance = -distance;
+        }
+
+        if (distance > 50){
+            out.push_back("holdfwd");
+        } else if (owner->getCurrentState() == Mugen::Standing){
+            out.push_back("x");
+            punches += 1;
+        }
+
+        return out;
+    }
+
+    void flip(){
+    }
+};
+
+/* Holds back whenever the enemy attacks */
+class GuardBehavior: public Mugen::Behavior {
+public:
+    vector<string> currentCommands(const Mugen::Stage & stage, Mugen::Character * owner, const vector<Mugen::Command2*> & commands, bool reversed){
+        vector<string> out;
+        Mugen::Character * enemy = stage.getEnemy(owner);
+        if (enemy != NULL && enemy->getMoveType() == Mugen::Move::Attack){
+            out.push_back("holdback");
+        }
+        return out;
+    }
+
+    void flip(){
+    }
+};
+
+/* Number of ticks before the first frame with an attack box according to the AIR file */
+static int expectedStartup(const Mugen::Character & character){
+    PaintownUtil::ReferenceCount<Mugen::Animation> animation = character.getAnimation(LIGHT_PUNCH);
+    if (animation == NULL){
+        return -1;
+    }
+
+    int ticks = 0;
+    const vector<Mugen::Frame*> & frames = animation->getFrames();
+    for (vector<Mugen::Frame*>::const_iterator it = frames.begin(); it != frames.end(); it++){
+        const Mugen::Frame * frame = *it;
+        if (frame->getAttackBoxes().size() > 0){
+            return ticks;
+        }
+        ticks += frame->time;
+    }
+
+    return -1;
+}
+
+static int measure(bool guard){
+    KfmMatch match;
+    Mugen::Stage & stage = match.getStage();
+    Mugen::Character * player1 = &match.getPlayer1();
+    Mugen::Character * player2 = &match.getPlayer2();
+
+    /* player 2 is a dummy unless it guards */
+    PunchBehavior punch;
+    GuardBehavior guardBehavior;
+    player1->setBehavior(&punch);
+    if (guard){
+        player2->setBehavior(&guardBehavior);
+    }
+    player1->setRegeneration(true);
+    player2->setRegeneration(true);
+
+    Mugen::FrameDataObserver observer;
+    const int maxTicks = 60 * 30;
+    for (int tick = 0; tick < maxTicks && !stage.isMatchOver(); tick++){
+        stage.logic();
+        observer.afterLogic(stage);
+
+        const Mugen::FrameData * data = observer.getFrameData(player1);
+        if (data != NULL && data->getMoves() >= 3){
+            break;
+        }
+    }
+
+    const Mugen::FrameData * data = observer.getFrameData(player1);
+    if (data == NULL || data->getMoves() == 0){
+        Global::debug(0) << "No moves were recorded after " << punch.punches << " punches" << endl;
+        return 1;
+    }
+
+    const Mugen::FrameData::MoveData & move = data->getMove();
+    Global::debug(0) << (guard ? "Block: " : "Hit: ") << "state " << move.state << " startup " << move.startup << " active " << move.active << " recovery " << move.recovery << endl;
+
+    if (move.state != LIGHT_PUNCH){
+        Global::debug(0) << "Expected state " << LIGHT_PUNCH << " but got " << move.state << endl;
+        return 1;
+    }
+
+    if (!move.hasActive || move.active <= 0){
+        Global::debug(0) << "Light punch never had an attack box" << endl;
+        return 1;
+    }
+
+    /* Animation and state time can be one tick apart depending on when the
+     * animation was changed during the tick.
+     */
+    int startup = expectedStartup(*player1);
+    if (startup < 0 || move.startup < startup - 1 || move.startup > startup + 1){
+        Global::debug(0) << "Expected startup of " << startup << " but measured " << move.startup << endl;
+        return 1;
+    }
+
+    const Mugen::FrameData::Advantage & advantage = guard ? data->getBlockAdvantage() : data->getHitAdvantage();
+    if (!advantage.valid){
+        Global::debug(0) << "No frame advantage was computed" << endl;
+        return 1;
+    }
+    Global::debug(0) << "Advantage " << advantage.frames << endl;
+
+    /* The dummy never guards so nothing should be counted as blocked */
+    if (!guard && data->getBlockAdvantage().valid){
+        Global::debug(0) << "Got a block advantage for a dummy that doesn't guard" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+static int run(){
+    if (measure(false) != 0){
+        return 1;
+    }
+    return measure(true);
+}
+
+int main(int argc, char ** argv){
+    return runTest(run);
+}
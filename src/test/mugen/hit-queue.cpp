@@ -0,0 +1,234 @@
+#include <string>
+#include <vector>
+#include <r-tech1/debug.h>
+#include "mugen/character.h"
+#include "mugen/helper.h"
+#include "mugen/hit-queue.h"
+#include "mugen/stage.h"
+#include "kfm-match.h"
+
+using namespace std;
+
+/* Checks that the hits of a tick come out of the hit queue in priority order
+ * no matter what order they were found in, and that trades follow the mugen
+ * rules for hit_prior and the Hit, Miss and Dodge classes. Then applies hits
+ * on a real stage to check that a hit found in the same tick as an earlier
+ * one is checked again before it connects.
+ */
+
+/* the queue only compares the characters, it never looks at them */
+static char players[3];
+static Mugen::Character * const player1 = (Mugen::Character*) &players[0];
+static Mugen::Character * const player2 = (Mugen::Character*) &players[1];
+static Mugen::Character * const helper = (Mugen::Character*) &players[2];
+
+static int idOf(Mugen::Character * who){
+    return (char*) who - players;
+}
+
+static Mugen::HitCandidate make(Mugen::HitCandidate::Kind kind, Mugen::Character * attacker, Mugen::Character * defender, int priority, Mugen::HitPriority::Type type){
+    Mugen::HitCandidate hit(kind, attacker, defender, priority, type);
+    hit.attackerId = idOf(attacker);
+    hit.defenderId = idOf(defender);
+    return hit;
+}
+
+static Mugen::HitCandidate hit(Mugen::Character * attacker, Mugen::Character * defender, int priority, Mugen::HitPriority::Type type){
+    return make(Mugen::HitCandidate::Hit, attacker, defender, priority, type);
+}
+
+/* which of player1 hitting player2 and player2 hitting player1 connect */
+static bool checkTrade(int priority1, Mugen::HitPriority::Type type1, int priority2, Mugen::HitPriority::Type type2, bool hits1, bool hits2){
+    Mugen::HitQueue queue;
+    queue.add(hit(player1, player2, priority1, type1));
+    queue.add(hit(player2, player1, priority2, type2));
+
+    bool got1 = false;
+    bool got2 = false;
+    vector<Mugen::HitCandidate> resolved = queue.resolve();
+    for (vector<Mugen::HitCandidate>::iterator it = resolved.begin(); it != resolved.end(); it++){
+        got1 = got1 || it->attacker == player1;
+        got2 = got2 || it->attacker == player2;
+    }
+
+    if (got1 != hits1 || got2 != hits2){
+        Global::debug(0) << "Trade of " << priority1 << "," << type1 << " against " << priority2 << "," << type2 << " gave " << got1 << " " << got2 << " instead of " << hits1 << " " << hits2 << endl;
+        return false;
+    }
+    return true;
+}
+
+static bool checkTrades(){
+    using namespace Mugen::HitPriority;
+    return checkTrade(4, Hit, 4, Hit, true, true) &&
+           checkTrade(4, Hit, 4, Miss, true, false) &&
+           checkTrade(4, Miss, 4, Hit, false, true) &&
+           checkTrade(4, Hit, 4, Dodge, false, false) &&
+           checkTrade(4, Dodge, 4, Dodge, false, false) &&
+           checkTrade(4, Dodge, 4, Miss, false, false) &&
+           checkTrade(4, Miss, 4, Miss, false, false) &&
+           checkTrade(5, Dodge, 4, Hit, true, false) &&
+           checkTrade(1, Hit, 7, Miss, false, true);
+}
+
+static bool checkParse(){
+    using namespace Mugen::HitPriority;
+    return parse("Hit") == Hit &&
+           parse("MISS") == Miss &&
+           parse("dodge") == Dodge &&
+           parse("X") == Hit;
+}
+
+static bool sameOrder(const vector<Mugen::HitCandidate> & a, const vector<Mugen::HitCandidate> & b){
+    if (a.size() != b.size()){
+        return false;
+    }
+    for (unsigned int i = 0; i < a.size(); i++){
+        if (a[i].kind != b[i].kind || a[i].attacker != b[i].attacker || a[i].defender != b[i].defender){
+            return false;
+        }
+    }
+    return true;
+}
+
+/* the same hits added in a different order come out the same */
+static bool checkOrder(){
+    vector<Mugen::HitCandidate> hits;
+    hits.push_back(make(Mugen::HitCandidate::ProjectileHit, player2, player1, 4, Mugen::HitPriority::Hit));
+    hits.push_back(hit(helper, player2, 3, Mugen::HitPriority::Hit));
+    hits.push_back(make(Mugen::HitCandidate::Guard, player1, helper, 6, Mugen::HitPriority::Hit));
+    hits.push_back(hit(player1, player2, 3, Mugen::HitPriority::Hit));
+    hits.push_back(make(Mugen::HitCandidate::Reversal, player2, helper, 1, Mugen::HitPriority::Hit));
+    hits.push_back(make(Mugen::HitCandidate::ProjectileCancel, player1, player2, 2, Mugen::HitPriority::Hit));
+
+    Mugen::HitQueue forward;
+    Mugen::HitQueue backward;
+    for (unsigned int i = 0; i < hits.size(); i++){
+        forward.add(hits[i]);
+        backward.add(hits[hits.size() - 1 - i]);
+    }
+
+    vector<Mugen::HitCandidate> resolved = forward.resolve();
+    if (!sameOrder(resolved, backward.resolve())){
+        Global::debug(0) << "The order the hits were found in changed the order they were applied in" << endl;
+        return false;
+    }
+
+    vector<Mugen::HitCandidate> expected;
+    expected.push_back(hits[4]);
+    expected.push_back(hits[5]);
+    expected.push_back(hits[2]);
+    expected.push_back(hits[3]);
+    expected.push_back(hits[1]);
+    expected.push_back(hits[0]);
+    if (!sameOrder(resolved, expected)){
+        Global::debug(0) << "Hits were not applied in priority order" << endl;
+        return false;
+    }
+
+    return true;
+}
+
+/* stand the character in state 0 with a hitdef ready to hit anyone standing */
+static void arm(Mugen::Stage & stage, Mugen::Character & who, int damage){
+    who.changeState(stage, 0);
+    who.setCurrentJuggle(1);
+    Mugen::HitDefinition & hit = who.getHit();
+    hit.hitFlag.high = true;
+    hit.damage.damage = damage;
+    hit.player2State = -1;
+    who.enableHit();
+}
+
+static void ready(Mugen::Stage & stage, Mugen::Character & who){
+    who.changeState(stage, 0);
+    who.setHealth(who.getMaxHealth());
+    who.setJugglePoints(1);
+    who.resetJugglePoints();
+}
+
+static Mugen::HitCandidate stageHit(Mugen::Character & attacker, Mugen::Character & defender, int priority){
+    Mugen::HitCandidate hit(Mugen::HitCandidate::Hit, &attacker, &defender, priority, Mugen::HitPriority::Hit);
+    hit.attackerId = attacker.getId().intValue();
+    hit.defenderId = defender.getId().intValue();
+    return hit;
+}
+
+static bool checkHealth(const char * what, Mugen::Character & who, double expected){
+    if (who.getHealth() != expected){
+        Global::debug(0) << what << " has health " << who.getHealth() << " instead of " << expected << endl;
+        return false;
+    }
+    return true;
+}
+
+/* Player 1 and a helper of player 1 both touch player 2 in the same tick. The first
+ * hit puts player 2 in a get hit state with no juggle points left, so the
+ * helper's hit must not land even though it was found before player 2 was
+ * hit.
+ */
+static bool checkTwoAttackers(Mugen::Stage & stage, Mugen::Character & player1, Mugen::Character & player2){
+    Mugen::Helper * helper = new Mugen::Helper(&player1, &player1, 1, "attacker");
+    stage.addObject(helper);
+
+    ready(stage, player2);
+    arm(stage, player1, 10);
+    arm(stage, *helper, 7);
+
+    Mugen::HitQueue hits;
+    hits.add(stageHit(*helper, player2, 4));
+    hits.add(stageHit(player1, player2, 5));
+    stage.applyHits(hits);
+
+    bool ok = checkHealth("Player 2 hit by two attackers in one tick", player2, player2.getMaxHealth() - 10) &&
+              player1.getHitState().moveContact == 1 &&
+              helper->getHit().alive;
+    if (!ok){
+        Global::debug(0) << "The helper's hit landed on a player 2 that could not be hit anymore" << endl;
+    }
+
+    stage.removeHelper(helper);
+    return ok;
+}
+
+/* One hitdef still hits everyone it touched in a tick even though hitting
+ * the first of them disables it.
+ */
+static bool checkTwoDefenders(Mugen::Stage & stage, Mugen::Character & player1, Mugen::Character & player2){
+    Mugen::Helper * helper = new Mugen::Helper(&player2, &player2, 2, "defender");
+    stage.addObject(helper);
+
+    ready(stage, player2);
+    ready(stage, *helper);
+    arm(stage, player1, 10);
+
+    Mugen::HitQueue hits;
+    hits.add(stageHit(player1, player2, 4));
+    hits.add(stageHit(player1, *helper, 4));
+    stage.applyHits(hits);
+
+    bool ok = checkHealth("Player 2 hit alongside a helper", player2, player2.getMaxHealth() - 10) &&
+              checkHealth("A helper hit alongside player 2", *helper, helper->getMaxHealth() - 10);
+
+    stage.removeHelper(helper);
+    return ok;
+}
+
+static bool checkStage(){
+    KfmMatch match;
+    return checkTwoAttackers(match.getStage(), match.getPlayer1(), match.getPlayer2()) &&
+           checkTwoDefenders(match.getStage(), match.getPlayer1(), match.getPlayer2());
+}
+
+static int run(){
+    if (!checkParse() || !checkTrades() || !checkOrder() || !checkStage()){
+        return 1;
+    }
+
+    Global::debug(0) << "Hits are resolved in priority order" << endl;
+    return 0;
+}
+
+int main(int argc, char ** argv){
+    return runTest(run);
+}
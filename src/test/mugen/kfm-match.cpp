@@ -0,0 +1,79 @@
+#include <r-tech1/init.h>
+#include <r-tech1/debug.h>
+#include <r-tech1/file-system.h>
+#include <r-tech1/input/input-manager.h>
+#include "mugen/character.h"
+#include "mugen/exception.h"
+#include "mugen/parse-cache.h"
+#include "mugen/sound.h"
+#include "kfm-match.h"
+
+using namespace std;
+
+const char * KFM = "mugen/chars/kfm/kfm.def";
+static const char * KFM_STAGE = "mugen/stages/kfm.def";
+
+int runTest(int (*test)(int argc, char ** argv), int argc, char ** argv){
+    Global::InitConditions conditions;
+    conditions.graphics = Global::InitConditions::Disabled;
+    Global::init(conditions);
+    InputManager manager;
+    Mugen::Sound::disableSounds();
+    Global::setDebug(0);
+
+    try{
+        return test(argc, argv);
+    } catch (const MugenException & fail){
+        Global::debug(0) << fail.getFullReason() << endl;
+    } catch (const Filesystem::NotFound & fail){
+        Global::debug(0) << "Couldn't find a file: " << fail.getTrace() << endl;
+    }
+    return 1;
+}
+
+/* the test given to runTest() when it doesn't take any arguments */
+static int (*noArguments)() = NULL;
+
+static int runNoArguments(int argc, char ** argv){
+    return noArguments();
+}
+
+int runTest(int (*test)()){
+    noArguments = test;
+    return runTest(runNoArguments, 0, NULL);
+}
+
+PaintownUtil::ReferenceCount<Mugen::Character> loadKfm(Mugen::Stage::teams side, int palette){
+    PaintownUtil::ReferenceCount<Mugen::Character> kfm(new Mugen::Character(Storage::instance().find(Filesystem::RelativePath(KFM)), side));
+    kfm->load(palette);
+    return kfm;
+}
+
+KfmMatch::KfmMatch():
+stage(Storage::instance().find(Filesystem::RelativePath(KFM_STAGE))){
+    {
+        Mugen::ParseCache cache;
+        player1 = loadKfm(Mugen::Stage::Player1Side);
+        player2 = loadKfm(Mugen::Stage::Player2Side);
+    }
+
+    player1->setBehavior(&dummy1);
+    player2->setBehavior(&dummy2);
+
+    stage.addPlayer1(player1.raw());
+    stage.addPlayer2(player2.raw());
+    stage.load();
+    stage.reset();
+}
+
+Mugen::Stage & KfmMatch::getStage(){
+    return stage;
+}
+
+Mugen::Character & KfmMatch::getPlayer1(){
+    return *player1;
+}
+
+Mugen::Character & KfmMatch::getPlayer2(){
+    return *player2;
+}
@@ -0,0 +1,45 @@
+#ifndef _paintown_test_mugen_kfm_match_h
+#define _paintown_test_mugen_kfm_match_h
+
+#include <r-tech1/pointer.h>
+#include "mugen/behavior.h"
+#include "mugen/stage.h"
+
+namespace Mugen{
+    class Character;
+}
+
+/* The path of kfm in the data directory */
+extern const char * KFM;
+
+/* Starts the engine without graphics or sound, runs the test and returns its
+ * exit status. A file that can't be found or loaded fails the test.
+ */
+int runTest(int (*test)());
+int runTest(int (*test)(int argc, char ** argv), int argc, char ** argv);
+
+/* kfm with the given palette. Load a few of these inside the scope of one
+ * Mugen::ParseCache to only parse the files once.
+ */
+PaintownUtil::ReferenceCount<Mugen::Character> loadKfm(Mugen::Stage::teams side, int palette = 1);
+
+/* kfm against kfm on the kfm stage, ready for the first tick. Both players
+ * stand there until they are given some other behavior.
+ */
+class KfmMatch{
+public:
+    KfmMatch();
+
+    Mugen::Stage & getStage();
+    Mugen::Character & getPlayer1();
+    Mugen::Character & getPlayer2();
+
+protected:
+    PaintownUtil::ReferenceCount<Mugen::Character> player1;
+    PaintownUtil::ReferenceCount<Mugen::Character> player2;
+    Mugen::DummyBehavior dummy1;
+    Mugen::DummyBehavior dummy2;
+    Mugen::Stage stage;
+};
+
+#endif
@@ -0,0 +1,70 @@
+#include <string>
+#include <r-tech1/init.h>
+#include <r-tech1/debug.h>
+#include <r-tech1/file-system.h>
+#include <r-tech1/graphics/bitmap.h>
+#include "mugen/background.h"
+#include "mugen/exception.h"
+#include "mugen/profile.h"
+#include "bitmap-compare.h"
+
+using namespace std;
+
+/* Draws the stock motif's menu backgrounds with and without the static layer
+ * cache, checks that they look the same and reports how long a frame took.
+ */
+
+static const int FRAMES = 300;
+
+static uint64_t render(Mugen::Background & background, const Graphics::Bitmap & work){
+    uint64_t start = Mugen::Profile::currentMicroseconds();
+    background.renderBackground(0, 0, work);
+    background.renderForeground(0, 0, work);
+    return Mugen::Profile::currentMicroseconds() - start;
+}
+
+static int run(const Filesystem::AbsolutePath & system, const string & header){
+    Mugen::Background plain(system, header);
+    Mugen::Background cached(system, header);
+    cached.enableStaticCache(true);
+
+    Graphics::Bitmap plainWork(320, 240);
+    Graphics::Bitmap cachedWork(320, 240);
+
+    uint64_t plainTime = 0;
+    uint64_t cachedTime = 0;
+    for (int frame = 0; frame < FRAMES; frame++){
+        plain.act();
+        cached.act();
+
+        plainWork.clearToMask();
+        cachedWork.clearToMask();
+        plainTime += render(plain, plainWork);
+        cachedTime += render(cached, cachedWork);
+
+        if (frame % 30 == 0 && !samePixels(plainWork, cachedWork)){
+            Global::debug(0) << header << " looks different with the cache on frame " << frame << endl;
+            return 1;
+        }
+    }
+
+    Global::debug(0) << header << ": " << (plainTime / 1000.0 / FRAMES) << "ms a frame without the cache, " << (cachedTime / 1000.0 / FRAMES) << "ms with it" << endl;
+    return 0;
+}
+
+int main(int argc, char ** argv){
+    Global::InitConditions conditions;
+    conditions.graphics = Global::InitConditions::Disabled;
+    Global::init(conditions);
+    Global::setDebug(0);
+
+    try{
+        Filesystem::AbsolutePath system = Storage::instance().find(Filesystem::RelativePath("mugen/data/system.def"));
+        return run(system, "titlebg") || run(system, "optionbg");
+    } catch (const MugenException & fail){
+        Global::debug(0) << fail.getFullReason() << endl;
+    } catch (const Filesystem::NotFound & fail){
+        Global::debug(0) << "Couldn't find a file: " << fail.getTrace() << endl;
+    }
+    return 1;
+}
@@ -0,0 +1,98 @@
+#include <string>
+#include <vector>
+#include <r-tech1/debug.h>
+#include <r-tech1/pointer.h>
+#include "mugen/animation.h"
+#include "mugen/character.h"
+#include "mugen/behavior.h"
+#include "mugen/config.h"
+#include "mugen/effect.h"
+#include "mugen/helper.h"
+#include "mugen/stage.h"
+#include "kfm-match.h"
+
+using namespace std;
+
+/* Plays a match between two computer players while adding and removing
+ * explods and helpers, and checks every tick that the per-owner indexes give
+ * the same answers as searching through everything on the stage.
+ */
+
+static const int MAXIMUM_TICKS = 6000;
+
+static void addExplod(Mugen::Stage & stage, Mugen::Character & owner, int id, int removeTime){
+    PaintownUtil::ReferenceCount<Mugen::Animation> animation = owner.getAnimation(0);
+    stage.addEffect(new Mugen::ExplodeEffect(&owner, stage, PaintownUtil::ReferenceCount<Mugen::Animation>(animation->copy()), id, 0, 0, 0, 0, 0, 0, removeTime, 0, Mugen::PositionPlayer1, 0, 0, 1, 1, 0, false, 0, false, false, false, false));
+}
+
+static Mugen::Helper * addHelper(Mugen::Stage & stage, Mugen::Character & parent, int id){
+    Mugen::Helper * helper = new Mugen::Helper(&parent, &parent, id, "index");
+    stage.addObject(helper);
+    helper->changeState(stage, 0);
+    return helper;
+}
+
+static int run(){
+    KfmMatch match;
+    Mugen::Stage & stage = match.getStage();
+    Mugen::Character * player1 = &match.getPlayer1();
+    Mugen::Character * player2 = &match.getPlayer2();
+
+    Mugen::LearningAIBehavior behavior1(Mugen::Data::getInstance().getDifficulty());
+    Mugen::LearningAIBehavior behavior2(Mugen::Data::getInstance().getDifficulty());
+    player1->setBehavior(&behavior1);
+    player2->setBehavior(&behavior2);
+
+    /* helpers can die on their own so keep their ids instead of pointers */
+    vector<Mugen::CharacterId> helpers;
+    int tick = 0;
+    while (!stage.isMatchOver() && tick < MAXIMUM_TICKS){
+        if (tick % 20 == 0){
+            addExplod(stage, *player1, tick % 3, 30 + tick % 50);
+            addExplod(stage, *player2, 1, -1);
+            Mugen::Helper * helper = addHelper(stage, *player1, tick % 4);
+            helpers.push_back(helper->getId());
+            if (tick % 60 == 0){
+                /* a helper of a helper, it loses its parent if the parent goes */
+                helpers.push_back(addHelper(stage, *helper, 7)->getId());
+            }
+
+            /* the new helper is already counted in the same tick */
+            if (stage.countHelpers(player1, tick % 4) != (int) stage.findHelpers(player1, tick % 4).size()){
+                Global::debug(0) << "A helper made this tick was not counted" << endl;
+                return 1;
+            }
+        }
+
+        if (tick % 20 == 10 && helpers.size() > 3){
+            Mugen::Character * helper = stage.getCharacter(helpers[1]);
+            if (helper != NULL){
+                stage.removeHelper(helper);
+            }
+            helpers.erase(helpers.begin() + 1);
+        }
+
+        if (tick % 100 == 50){
+            stage.removeEffects(player2, 1);
+            if (stage.countExplods(1, player2) != 0){
+                Global::debug(0) << "Explods are still counted after they were removed" << endl;
+                return 1;
+            }
+        }
+
+        stage.logic();
+        tick += 1;
+
+        if (!stage.checkIndexes()){
+            Global::debug(0) << "The indexes don't match the stage at tick " << tick << endl;
+            return 1;
+        }
+    }
+
+    Global::debug(0) << "Indexes matched the stage for " << tick << " ticks" << endl;
+    return 0;
+}
+
+int main(int argc, char ** argv){
+    return runTest(run);
+}
@@ -0,0 +1,87 @@
+#include <string>
+#include <r-tech1/debug.h>
+#include <r-tech1/pointer.h>
+#include <r-tech1/graphics/bitmap.h>
+#include "mugen/character.h"
+#include "mugen/parse-cache.h"
+#include "mugen/sprite.h"
+#include "mugen/stage.h"
+#include "kfm-match.h"
+#include "bitmap-compare.h"
+
+using namespace std;
+
+/* Changes the palette of a character and checks that it looks the same as a
+ * character that was loaded with that palette, without the sff being read
+ * again.
+ */
+
+static void draw(const PaintownUtil::ReferenceCount<Mugen::Sprite> & sprite, const Graphics::Bitmap & work){
+    work.clearToMask();
+    sprite->render(work.getWidth() / 2, work.getHeight() - 10, work);
+}
+
+static int run(){
+    Mugen::ParseCache cache;
+    PaintownUtil::ReferenceCount<Mugen::Character> swapped = loadKfm(Mugen::Stage::Player1Side, 1);
+    PaintownUtil::ReferenceCount<Mugen::Character> second = loadKfm(Mugen::Stage::Player1Side, 2);
+
+    Graphics::Bitmap before(200, 200);
+    Graphics::Bitmap after(200, 200);
+    Graphics::Bitmap expected(200, 200);
+
+    PaintownUtil::ReferenceCount<Mugen::Sprite> sprite = swapped->getSprite(0, 0);
+    draw(sprite, before);
+
+    swapped->nextPalette();
+    if (swapped->getSprite(0, 0).raw() != sprite.raw()){
+        Global::debug(0) << "The sprites were read again to change the palette" << endl;
+        return 1;
+    }
+
+    draw(swapped->getSprite(0, 0), after);
+    draw(second->getSprite(0, 0), expected);
+
+    if (samePixels(before, after)){
+        Global::debug(0) << "Changing the palette did not change the sprite" << endl;
+        return 1;
+    }
+
+    if (!samePixels(after, expected)){
+        Global::debug(0) << "The sprite looks different from one loaded with the second palette" << endl;
+        return 1;
+    }
+
+    /* drawing a lot of sprites has to stay under the limit */
+    const uint64_t limit = 100 * 100;
+    Mugen::SpriteV1::setCacheLimit(limit);
+    Graphics::Bitmap work(320, 240);
+    for (int item = 0; item < 20; item++){
+        for (int group = 0; group < 1000; group += 5){
+            PaintownUtil::ReferenceCount<Mugen::Sprite> next = swapped->getSprite(group, item);
+            if (next != NULL){
+                draw(next, work);
+                /* the newest bitmap is kept even if it is bigger than the limit */
+                uint64_t newest = (uint64_t) next->getWidth() * next->getHeight();
+                if (Mugen::SpriteV1::cachedPixels() > limit + newest){
+                    Global::debug(0) << "The sprite cache has " << Mugen::SpriteV1::cachedPixels() << " pixels, more than the limit of " << limit << endl;
+                    return 1;
+                }
+            }
+        }
+    }
+    Mugen::SpriteV1::setCacheLimit(32 * 1024 * 1024);
+
+    /* evicted bitmaps are made again */
+    draw(swapped->getSprite(0, 0), before);
+    if (!samePixels(before, expected)){
+        Global::debug(0) << "The sprite looks different after its bitmap was thrown away" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char ** argv){
+    return runTest(run);
+}
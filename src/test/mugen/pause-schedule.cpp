@@ -0,0 +1,200 @@
+#include <string>
+#include <vector>
+#include <r-tech1/debug.h>
+#include <r-tech1/pointer.h>
+#include "mugen/ast/all.h"
+#include "mugen/character.h"
+#include "mugen/compiler.h"
+#include "mugen/helper.h"
+#include "mugen/profile.h"
+#include "mugen/stage.h"
+#include "mugen/state-controller.h"
+#include "kfm-match.h"
+
+using namespace std;
+
+/* Checks who gets to act during a Pause and a SuperPause, including a Pause
+ * started by a state controller in the middle of a tick, then times long
+ * pauses with a lot of helpers on the stage.
+ *
+ * A character that acts counts up its statetime, so standing still in state
+ * 0 the statetime says how many ticks the character ran.
+ */
+
+static const int HELPERS = 500;
+static const int PAUSE_TICKS = 5000;
+static const int PAUSE_STATE = 9000;
+
+static void tick(Mugen::Stage & stage, int ticks){
+    for (int i = 0; i < ticks; i++){
+        stage.logic();
+    }
+}
+
+static bool checkTime(const char * what, Mugen::Character & who, int expected){
+    if (who.getStateTime() != expected){
+        Global::debug(0) << what << " has statetime " << who.getStateTime() << " instead of " << expected << endl;
+        return false;
+    }
+    return true;
+}
+
+static void stand(Mugen::Stage & stage, Mugen::Character & who){
+    who.changeState(stage, 0);
+}
+
+static bool checkPause(Mugen::Stage & stage, Mugen::Character & player1, Mugen::Character & player2){
+    stand(stage, player1);
+    stand(stage, player2);
+    int time1 = player1.getStateTime();
+    int time2 = player2.getStateTime();
+
+    /* player1 moves for the 9 ticks before movetime runs out, player2 waits
+     * until the pause is over on the 30th tick
+     */
+    stage.doPause(30, 0, 10, false, &player1);
+    tick(stage, 29);
+    if (!checkTime("Player 1 during the pause", player1, time1 + 9) ||
+        !checkTime("Player 2 during the pause", player2, time2)){
+        return false;
+    }
+
+    tick(stage, 1);
+    if (!checkTime("Player 1 after the pause", player1, time1 + 10) ||
+        !checkTime("Player 2 after the pause", player2, time2 + 1)){
+        return false;
+    }
+
+    /* a pause without movetime stops the character that paused too */
+    stage.doPause(5, 0, 0, false, &player2);
+    tick(stage, 4);
+    if (!checkTime("Player 1 during a pause without movetime", player1, time1 + 10) ||
+        !checkTime("Player 2 during a pause without movetime", player2, time2 + 1)){
+        return false;
+    }
+    tick(stage, 1);
+
+    return checkTime("Player 1 after a pause without movetime", player1, time1 + 11) &&
+           checkTime("Player 2 after a pause without movetime", player2, time2 + 2);
+}
+
+static bool checkSuperPause(Mugen::Stage & stage, Mugen::Character & player1, Mugen::Character & player2){
+    stand(stage, player1);
+    stand(stage, player2);
+    int time1 = player1.getStateTime();
+    int time2 = player2.getStateTime();
+
+    /* nobody moves, including the tick the superpause runs out on */
+    stage.doSuperPause(20, player1, -1, false, 0, 0);
+    tick(stage, 20);
+    if (!checkTime("Player 1 during the superpause", player1, time1) ||
+        !checkTime("Player 2 during the superpause", player2, time2)){
+        return false;
+    }
+
+    tick(stage, 1);
+    return checkTime("Player 1 after the superpause", player1, time1 + 1) &&
+           checkTime("Player 2 after the superpause", player2, time2 + 1);
+}
+
+static Ast::Attribute * attribute(const char * name, double value){
+    return new Ast::AttributeSimple(new Ast::SimpleIdentifier(name), new Ast::Number(-1, -1, value));
+}
+
+/* a state that does nothing but start a pause without movetime, like
+ *   [State 9000, pause]
+ *   type = Pause
+ *   trigger1 = 1
+ *   time = 20
+ *   movetime = 0
+ */
+static void addPauseState(Mugen::Character & who){
+    Ast::Section section(new string("State 9000, pause"));
+    section.addAttribute(attribute("trigger1", 1));
+    section.addAttribute(attribute("time", 20));
+    section.addAttribute(attribute("movetime", 0));
+
+    PaintownUtil::ReferenceCount<Mugen::State> state(new Mugen::State(PAUSE_STATE));
+    state->addController(Mugen::StateController::compile(&section, "pause", PAUSE_STATE, 0, Mugen::StateController::Pause));
+    who.setState(PAUSE_STATE, state);
+}
+
+/* Player 1 acts before player 2, so when a state controller of player 1
+ * starts a pause player 2 must not get to act in the same tick.
+ */
+static bool checkControllerPause(Mugen::Stage & stage, Mugen::Character & player1, Mugen::Character & player2){
+    addPauseState(player1);
+    stand(stage, player2);
+    player1.changeState(stage, PAUSE_STATE);
+    int time2 = player2.getStateTime();
+
+    tick(stage, 1);
+    bool ok = checkTime("Player 2 in the tick player 1 paused", player2, time2);
+
+    /* let the pause run out */
+    stand(stage, player1);
+    tick(stage, 20);
+    return ok && checkTime("Player 2 after player 1's pause", player2, time2 + 1);
+}
+
+/* a helper made while the stage is paused waits like everyone else */
+static bool checkNewHelper(Mugen::Stage & stage, Mugen::Character & player1){
+    stage.doPause(10, 0, 0, false, &player1);
+    Mugen::Helper * helper = new Mugen::Helper(&player1, &player1, 1, "paused");
+    stage.addObject(helper);
+    helper->changeState(stage, 0);
+    tick(stage, 2);
+    int time = helper->getStateTime();
+    tick(stage, 5);
+    bool ok = checkTime("A helper made during the pause", *helper, time);
+    tick(stage, 3);
+    stage.removeHelper(helper);
+    tick(stage, 1);
+    return ok;
+}
+
+static uint64_t timePause(Mugen::Stage & stage, Mugen::Character & player1, bool super){
+    if (super){
+        stage.doSuperPause(PAUSE_TICKS, player1, -1, false, 0, 0);
+    } else {
+        stage.doPause(PAUSE_TICKS, 0, PAUSE_TICKS / 2, false, &player1);
+    }
+
+    uint64_t start = Mugen::Profile::currentMicroseconds();
+    tick(stage, PAUSE_TICKS);
+    return Mugen::Profile::currentMicroseconds() - start;
+}
+
+static int run(){
+    KfmMatch match;
+    Mugen::Stage & stage = match.getStage();
+    Mugen::Character * player1 = &match.getPlayer1();
+    Mugen::Character * player2 = &match.getPlayer2();
+
+    if (!checkPause(stage, *player1, *player2) ||
+        !checkSuperPause(stage, *player1, *player2) ||
+        !checkControllerPause(stage, *player1, *player2) ||
+        !checkNewHelper(stage, *player1)){
+        return 1;
+    }
+
+    for (int i = 0; i < HELPERS; i++){
+        Mugen::Helper * helper = new Mugen::Helper(player1, player1, i, "crowd");
+        stage.addObject(helper);
+        helper->changeState(stage, 0);
+    }
+    tick(stage, 1);
+
+    uint64_t pause = timePause(stage, *player1, false);
+    uint64_t superPause = timePause(stage, *player1, true);
+    uint64_t start = Mugen::Profile::currentMicroseconds();
+    tick(stage, PAUSE_TICKS / 10);
+    uint64_t unpaused = (Mugen::Profile::currentMicroseconds() - start) * 10;
+
+    Global::debug(0) << HELPERS << " helpers for " << PAUSE_TICKS << " ticks: " << pause << "us paused, " << superPause << "us superpaused, about " << unpaused << "us running" << endl;
+    return 0;
+}
+
+int main(int argc, char ** argv){
+    return runTest(run);
+}
@@ -0,0 +1,113 @@
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <stdlib.h>
+#include <r-tech1/funcs.h>
+#include <r-tech1/file-system.h>
+#include "mugen/character.h"
+#include "mugen/constraint.h"
+#include "mugen/parse-cache.h"
+#include "mugen/random.h"
+#include "kfm-match.h"
+#include "play-replay.h"
+
+using namespace std;
+
+static const char * INPUT_FILE = "src/test/mugen/replay.txt";
+/* the ai doesn't play, but states can still ask for random numbers */
+static const unsigned int RANDOM_SEED = 1234;
+
+PlayBehavior::PlayBehavior(const string & path){
+    ifstream file(path.c_str());
+    string line;
+    while (getline(file, line)){
+        size_t colon = line.find(':');
+        if (colon != string::npos){
+            inputs[atoi(line.substr(0, colon).c_str())] = parse(line.substr(colon + 1));
+        }
+    }
+}
+
+Mugen::Input PlayBehavior::parse(const string & line){
+    Mugen::Input input;
+    vector<string> keys = Util::splitString(line, ',');
+    for (vector<string>::iterator it = keys.begin(); it != keys.end(); it++){
+        string key = *it;
+        Mugen::Input::Key * which = &input.pressed;
+        if (key.size() > 1 && key[0] == '~'){
+            which = &input.released;
+            key = key.substr(1);
+        }
+
+        if (key == "F"){ which->forward = true; }
+        if (key == "B"){ which->back = true; }
+        if (key == "U"){ which->up = true; }
+        if (key == "D"){ which->down = true; }
+        if (key == "a"){ which->a = true; }
+        if (key == "b"){ which->b = true; }
+        if (key == "c"){ which->c = true; }
+        if (key == "x"){ which->x = true; }
+        if (key == "y"){ which->y = true; }
+        if (key == "z"){ which->z = true; }
+        if (key == "s"){ which->start = true; }
+    }
+    return input;
+}
+
+vector<string> PlayBehavior::currentCommands(const Mugen::Stage & stage, Mugen::Character * owner, const vector<Mugen::Command2*> & commands, bool reversed){
+    Mugen::Input input;
+    map<int, Mugen::Input>::iterator found = inputs.find(stage.getTicks());
+    if (found != inputs.end()){
+        input = found->second;
+    }
+
+    vector<string> out;
+    for (vector<Mugen::Command2*>::const_iterator it = commands.begin(); it != commands.end(); it++){
+        if ((*it)->handle(input, stage.getTicks())){
+            out.push_back((*it)->getName());
+        }
+    }
+    return out;
+}
+
+void PlayBehavior::flip(){
+}
+
+ReplayMatch::ReplayMatch(bool fixedPhysics):
+play(INPUT_FILE),
+stage(Storage::instance().find(Filesystem::RelativePath("mugen/stages/kfm.def"))){
+    srand(RANDOM_SEED);
+    Mugen::Random::setState(Mugen::Random());
+
+    {
+        Mugen::ParseCache cache;
+        player1 = loadKfm(Mugen::Stage::Player1Side);
+        player2 = loadKfm(Mugen::Stage::Player2Side);
+    }
+
+    player1->setBehavior(&play);
+    player2->setBehavior(&dummy);
+
+    stage.addPlayer1(player1.raw());
+    stage.addPlayer2(player2.raw());
+    stage.load();
+    stage.setFixedPhysics(fixedPhysics);
+    stage.reset();
+}
+
+bool ReplayMatch::done(int ticks) const {
+    return ticks >= MaximumTicks || stage.isMatchOver();
+}
+
+Mugen::Stage & ReplayMatch::getStage(){
+    return stage;
+}
+
+Mugen::Character & ReplayMatch::getPlayer1(){
+    return *player1;
+}
+
+Mugen::Character & ReplayMatch::getPlayer2(){
+    return *player2;
+}
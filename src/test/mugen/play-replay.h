@@ -0,0 +1,56 @@
+#ifndef _paintown_test_mugen_play_replay_h
+#define _paintown_test_mugen_play_replay_h
+
+#include <string>
+#include <vector>
+#include <map>
+#include <r-tech1/pointer.h>
+#include "mugen/behavior.h"
+#include "mugen/command.h"
+#include "mugen/stage.h"
+
+namespace Mugen{
+    class Character;
+}
+
+/* Presses whatever replay.txt says was pressed on the current tick. Each line
+ * is `tick:keys' where the keys look like F,U,~b
+ */
+class PlayBehavior: public Mugen::Behavior {
+public:
+    PlayBehavior(const std::string & path);
+
+    static Mugen::Input parse(const std::string & line);
+
+    virtual std::vector<std::string> currentCommands(const Mugen::Stage & stage, Mugen::Character * owner, const std::vector<Mugen::Command2*> & commands, bool reversed);
+    virtual void flip();
+
+    std::map<int, Mugen::Input> inputs;
+};
+
+/* kfm against kfm on the kfm stage with the random numbers seeded the same
+ * way every time. Player 1 plays the inputs in replay.txt and player 2 only
+ * stands there, so every match made this way plays out the same.
+ */
+class ReplayMatch{
+public:
+    ReplayMatch(bool fixedPhysics = false);
+
+    static const int MaximumTicks = 3000;
+
+    /* true once the match is over or has gone on for too long */
+    bool done(int ticks) const;
+
+    Mugen::Stage & getStage();
+    Mugen::Character & getPlayer1();
+    Mugen::Character & getPlayer2();
+
+protected:
+    PaintownUtil::ReferenceCount<Mugen::Character> player1;
+    PaintownUtil::ReferenceCount<Mugen::Character> player2;
+    PlayBehavior play;
+    Mugen::DummyBehavior dummy;
+    Mugen::Stage stage;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#include <string>
+#include <vector>
+#include <r-tech1/debug.h>
+#include "mugen/character.h"
+#include "mugen/stage.h"
+#include "mugen/profile.h"
+#include "kfm-match.h"
+
+using namespace std;
+
+static int run(){
+    KfmMatch match;
+    Mugen::Stage & stage = match.getStage();
+
+    /* Nothing should be measured until an overlay asks for it */
+    Mugen::Profile::reset();
+    for (int tick = 0; tick < 10; tick++){
+        stage.logic();
+    }
+
+    if (Mugen::Profile::getTime(Mugen::Profile::Triggers) != 0 || Mugen::Profile::getTime(Mugen::Profile::Physics) != 0){
+        Global::debug(0) << "Time was measured while profiling was off" << endl;
+        return 1;
+    }
+
+    Mugen::PerformanceOverlay overlay;
+    if (!overlay.toggle(Mugen::PerformanceOverlay::Timing)){
+        Global::debug(0) << "Timing overlay did not turn on" << endl;
+        return 1;
+    }
+
+    /* overlay.logic() is never called so the totals are not reset */
+    for (int tick = 0; tick < 50; tick++){
+        stage.logic();
+    }
+
+    Global::debug(0) << "Triggers " << Mugen::Profile::getTime(Mugen::Profile::Triggers) << "us controllers " << Mugen::Profile::getTime(Mugen::Profile::Controllers) << "us physics " << Mugen::Profile::getTime(Mugen::Profile::Physics) << "us collision " << Mugen::Profile::getTime(Mugen::Profile::Collision) << "us" << endl;
+
+    /* Every tick evaluates the -1 state triggers so that has to show up, the
+     * clock has microsecond resolution so nothing else is guaranteed to.
+     */
+    if (Mugen::Profile::getTime(Mugen::Profile::Triggers) == 0){
+        Global::debug(0) << "No time was spent in triggers" << endl;
+        return 1;
+    }
+
+    if (overlay.toggle(Mugen::PerformanceOverlay::Timing)){
+        Global::debug(0) << "Timing overlay did not turn off" << endl;
+        return 1;
+    }
+
+    if (stage.countHelpers() != 0 || stage.countExplods() != 0 || stage.countProjectiles() != 0){
+        Global::debug(0) << "Expected no helpers, explods or projectiles but got " << stage.countHelpers() << " " << stage.countExplods() << " " << stage.countProjectiles() << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char ** argv){
+    return runTest(run);
+}
@@ -0,0 +1,193 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <r-tech1/init.h>
+#include <r-tech1/debug.h>
+#include <r-tech1/file-system.h>
+#include <r-tech1/funcs.h>
+#include <r-tech1/system.h>
+#include <r-tech1/thread.h>
+#include "mugen/profile.h"
+#include "mugen/search.h"
+
+using namespace std;
+
+/* Creates and deletes characters while subscribed to the searcher and checks
+ * that the changes come through once the copying is done.
+ */
+
+struct Event{
+    Event(const Filesystem::AbsolutePath & path, bool removed, uint64_t when):
+    path(path),
+    removed(removed),
+    when(when){
+    }
+
+    Filesystem::AbsolutePath path;
+    bool removed;
+    uint64_t when;
+};
+
+class Recorder: public Mugen::Searcher::Subscriber {
+public:
+    virtual void receiveCharacters(const vector<Filesystem::AbsolutePath> & paths){
+        record(paths, false);
+    }
+
+    virtual void receiveStages(const vector<Filesystem::AbsolutePath> & paths){
+    }
+
+    virtual void removeCharacters(const vector<Filesystem::AbsolutePath> & paths){
+        record(paths, true);
+    }
+
+    void record(const vector<Filesystem::AbsolutePath> & paths, bool removed){
+        Util::Thread::ScopedLock scoped(lock);
+        for (vector<Filesystem::AbsolutePath>::const_iterator it = paths.begin(); it != paths.end(); it++){
+            events.push_back(Event(*it, removed, Mugen::Profile::currentMicroseconds()));
+        }
+    }
+
+    /* how many times the path was added or removed */
+    int count(const Filesystem::AbsolutePath & path, bool removed, uint64_t * last){
+        Util::Thread::ScopedLock scoped(lock);
+        int total = 0;
+        for (vector<Event>::iterator it = events.begin(); it != events.end(); it++){
+            if (it->path == path && it->removed == removed){
+                total += 1;
+                if (last != NULL){
+                    *last = it->when;
+                }
+            }
+        }
+        return total;
+    }
+
+    Util::Thread::LockObject lock;
+    vector<Event> events;
+};
+
+static void writeFile(const string & path, const string & contents){
+    ofstream out(path.c_str());
+    out << contents;
+}
+
+static string characterDef(const string & name){
+    return "[Info]\nname = \"" + name + "\"\n\n[Files]\nsprite = " + name + ".sff\n";
+}
+
+/* waits up to 20 seconds, enough for the polling fallback */
+static bool waitFor(Recorder & recorder, const Filesystem::AbsolutePath & path, bool removed){
+    uint64_t start = Mugen::Profile::currentMicroseconds();
+    while (Mugen::Profile::currentMicroseconds() - start < 20 * 1000 * 1000){
+        if (recorder.count(path, removed, NULL) > 0){
+            return true;
+        }
+        Util::rest(10);
+    }
+    return false;
+}
+
+static bool contains(Mugen::Searcher::Snapshot snapshot, const Filesystem::AbsolutePath & path){
+    for (vector<Filesystem::AbsolutePath>::const_iterator it = snapshot->begin(); it != snapshot->end(); it++){
+        if (*it == path){
+            return true;
+        }
+    }
+    return false;
+}
+
+static int run(const string & root){
+    System::makeAllDirectory(root + "/old");
+    writeFile(root + "/old/old.def", characterDef("old"));
+    const Filesystem::AbsolutePath old(root + "/old/old.def");
+    const Filesystem::AbsolutePath fresh(root + "/fresh/fresh.def");
+
+    Recorder recorder;
+    vector<Filesystem::AbsolutePath> roots;
+    roots.push_back(Filesystem::AbsolutePath(root));
+    Mugen::Searcher searcher(roots, vector<Filesystem::AbsolutePath>());
+    searcher.subscribe(&recorder);
+    searcher.start();
+
+    if (!waitFor(recorder, old, false)){
+        Global::debug(0) << "The existing character was not found" << endl;
+        return 1;
+    }
+
+    /* copy a character slowly, it should only show up after the last file */
+    System::makeAllDirectory(root + "/fresh");
+    writeFile(fresh.path(), characterDef("fresh"));
+    Util::rest(300);
+    writeFile(root + "/fresh/fresh.sff", "not really a sprite file");
+    uint64_t copied = Mugen::Profile::currentMicroseconds();
+
+    if (!waitFor(recorder, fresh, false)){
+        Global::debug(0) << "The new character was not noticed" << endl;
+        return 1;
+    }
+
+    uint64_t added = 0;
+    if (recorder.count(fresh, false, &added) != 1){
+        Global::debug(0) << "The new character was added more than once" << endl;
+        return 1;
+    }
+
+    if (added < copied){
+        Global::debug(0) << "The new character was published before it finished copying" << endl;
+        return 1;
+    }
+
+    if (!contains(searcher.getCharacters(), fresh)){
+        Global::debug(0) << "The new character is not in the snapshot" << endl;
+        return 1;
+    }
+
+    remove((root + "/fresh/fresh.sff").c_str());
+    remove(fresh.path().c_str());
+    rmdir((root + "/fresh").c_str());
+
+    if (!waitFor(recorder, fresh, true)){
+        Global::debug(0) << "The deleted character was not noticed" << endl;
+        return 1;
+    }
+
+    if (contains(searcher.getCharacters(), fresh) || !contains(searcher.getCharacters(), old)){
+        Global::debug(0) << "The snapshot is wrong after deleting a character" << endl;
+        return 1;
+    }
+
+    if (recorder.count(old, true, NULL) != 0){
+        Global::debug(0) << "A character that was not touched was removed" << endl;
+        return 1;
+    }
+
+    searcher.pause();
+    searcher.unsubscribe(&recorder);
+    return 0;
+}
+
+int main(int argc, char ** argv){
+    Global::InitConditions conditions;
+    conditions.graphics = Global::InitConditions::Disabled;
+    Global::init(conditions);
+    Global::setDebug(0);
+
+    char cwd[4096];
+    if (getcwd(cwd, sizeof(cwd)) == NULL){
+        return 1;
+    }
+    const string root = string(cwd) + "/search-watch-chars";
+
+    int die = run(root);
+
+    remove((root + "/old/old.def").c_str());
+    rmdir((root + "/old").c_str());
+    remove((root + "/fresh/fresh.sff").c_str());
+    remove((root + "/fresh/fresh.def").c_str());
+    rmdir((root + "/fresh").c_str());
+    rmdir(root.c_str());
+    return die;
+}
@@ -0,0 +1,248 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <r-tech1/init.h>
+#include <r-tech1/debug.h>
+#include <r-tech1/events.h>
+#include <r-tech1/file-system.h>
+#include <r-tech1/funcs.h>
+#include <r-tech1/system.h>
+#include <r-tech1/input/input-manager.h>
+#include <r-tech1/input/input-map.h>
+#include "mugen/character-select.h"
+#include "mugen/config.h"
+#include "mugen/exception.h"
+#include "mugen/parse-cache.h"
+#include "mugen/profile.h"
+#include "mugen/search.h"
+#include "mugen/sound.h"
+#include "mugen/util.h"
+
+using namespace std;
+
+/* Scans a directory full of characters while the select screen runs, like a
+ * big roster being found in the background.
+ */
+
+static const int CHARACTERS = 5000;
+
+static void copyFile(const string & from, const string & to){
+    ifstream in(from.c_str(), ios::binary);
+    ofstream out(to.c_str(), ios::binary);
+    out << in.rdbuf();
+}
+
+static string characterFile(const string & where, int index){
+    ostringstream out;
+    out << where << "/stress-" << index << ".def";
+    return out.str();
+}
+
+/* One directory of characters that all share kfm's sprites */
+static void makeRoster(const string & where){
+    Filesystem::AbsolutePath kfm = Storage::instance().find(Filesystem::RelativePath("mugen/chars/kfm/kfm.def"));
+    string sprite = Mugen::Util::probeDef(kfm, "files", "sprite");
+    string palette = Mugen::Util::probeDef(kfm, "files", "pal1");
+
+    System::makeAllDirectory(where);
+    copyFile(kfm.getDirectory().join(Filesystem::RelativePath(sprite)).path(), where + "/stress.sff");
+    copyFile(kfm.getDirectory().join(Filesystem::RelativePath(palette)).path(), where + "/stress.act");
+
+    for (int i = 0; i < CHARACTERS; i++){
+        ofstream def(characterFile(where, i).c_str());
+        def << "[Info]" << endl;
+        def << "name = \"Stress " << i << "\"" << endl;
+        def << endl;
+        def << "[Files]" << endl;
+        def << "sprite = stress.sff" << endl;
+        def << "pal1 = stress.act" << endl;
+    }
+}
+
+/* A character outside of the searched directory */
+static string lateFile(const string & where){
+    return where + "-late.def";
+}
+
+static void removeRoster(const string & where){
+    for (int i = 0; i < CHARACTERS; i++){
+        remove(characterFile(where, i).c_str());
+    }
+    remove(lateFile(where).c_str());
+    remove((where + "/stress.sff").c_str());
+    remove((where + "/stress.act").c_str());
+    rmdir(where.c_str());
+}
+
+static int countAdded(Mugen::CharacterSelect & select, Mugen::Searcher::Snapshot characters){
+    int added = 0;
+    for (vector<Filesystem::AbsolutePath>::const_iterator it = characters->begin(); it != characters->end(); it++){
+        if (!select.uniqueCharacter(*it)){
+            added += 1;
+        }
+    }
+    return added;
+}
+
+static int run(const string & where){
+    vector<Filesystem::AbsolutePath> characterPaths;
+    characterPaths.push_back(Filesystem::AbsolutePath(where));
+    Mugen::Searcher searcher(characterPaths, vector<Filesystem::AbsolutePath>());
+
+    Mugen::CharacterSelect select(Storage::instance().find(Filesystem::RelativePath("mugen/data/system.def")));
+    select.init();
+    select.setMode(Mugen::Arcade, Mugen::CharacterSelect::Player1);
+
+    InputMap<Mugen::Keys> input1;
+    InputMap<Mugen::Keys> input2;
+    Util::ReferenceCount<Util::Logic> logic = select.getLogic(input1, input2, searcher);
+    searcher.start();
+
+    const uint64_t start = Mugen::Profile::currentMicroseconds();
+    uint64_t slowest = 0;
+    int frames = 0;
+    Mugen::Searcher::Snapshot first;
+    unsigned int firstSize = 0;
+    unsigned int seen = 0;
+    int added = 0;
+    while (added < CHARACTERS){
+        if (Mugen::Profile::currentMicroseconds() - start > 120 * 1000 * 1000){
+            Global::debug(0) << "Only " << added << " of " << CHARACTERS << " characters were added after two minutes" << endl;
+            return 1;
+        }
+
+        uint64_t before = Mugen::Profile::currentMicroseconds();
+        logic->run();
+        if (frames % 2 == 0){
+            select.right(0);
+        } else {
+            select.left(0);
+        }
+        uint64_t took = Mugen::Profile::currentMicroseconds() - before;
+        if (took > slowest){
+            slowest = took;
+        }
+        frames += 1;
+
+        Mugen::Searcher::Snapshot characters = searcher.getCharacters();
+        if (characters->size() < seen){
+            Global::debug(0) << "The character snapshot went from " << seen << " to " << characters->size() << endl;
+            return 1;
+        }
+        seen = characters->size();
+
+        if (first == NULL && characters->size() > 0){
+            first = characters;
+            firstSize = characters->size();
+        }
+
+        /* checking every def is slow so only do it now and then */
+        if (searcher.charactersDone() && frames % 100 == 0){
+            added = countAdded(select, characters);
+        }
+
+        Util::rest(1);
+    }
+
+    if (seen != (unsigned int) CHARACTERS){
+        Global::debug(0) << "Expected " << CHARACTERS << " characters to be found but got " << seen << endl;
+        return 1;
+    }
+
+    if (first == NULL || first->size() != firstSize){
+        Global::debug(0) << "A published snapshot changed" << endl;
+        return 1;
+    }
+
+    /* a character that is added and removed before the select screen gets to
+     * it must stay out
+     */
+    {
+        ofstream def(lateFile(where).c_str());
+        def << "[Info]" << endl;
+        def << "name = \"Late\"" << endl;
+        def << endl;
+        def << "[Files]" << endl;
+        def << "sprite = select-stress-chars/stress.sff" << endl;
+        def << "pal1 = select-stress-chars/stress.act" << endl;
+    }
+    Filesystem::AbsolutePath late(lateFile(where));
+    select.addCharacter(Mugen::ArcadeData::CharacterInfo(late));
+    select.removeCharacter(late);
+    /* applies the pending changes */
+    select.act();
+    for (vector<Mugen::ArcadeData::CharacterInfo>::const_iterator it = select.getCharacters().begin(); it != select.getCharacters().end(); it++){
+        if (it->getDef() == late){
+            Global::debug(0) << "A character that was added and then removed is on the select screen" << endl;
+            return 1;
+        }
+    }
+
+    /* a stage counts as soon as it is added but only goes in the stage menu
+     * on the next act()
+     */
+    Filesystem::AbsolutePath stage = Storage::instance().find(Filesystem::RelativePath("mugen/stages/kfm.def"));
+    select.removeStage(stage);
+    select.act();
+    const unsigned int shown = select.getStages().size();
+    select.addStage(stage);
+    if (select.stageCount() != (int) shown + 1){
+        Global::debug(0) << "Expected " << (shown + 1) << " stages after adding one but got " << select.stageCount() << endl;
+        return 1;
+    }
+
+    if (select.getStages().size() != shown){
+        Global::debug(0) << "Counting the stages changed the stage menu" << endl;
+        return 1;
+    }
+
+    select.act();
+    if (select.getStages().size() != shown + 1){
+        Global::debug(0) << "The stage that was added is not in the stage menu after act()" << endl;
+        return 1;
+    }
+
+    Global::debug(0) << "Added " << added << " characters in " << frames << " frames, the slowest frame took " << (slowest / 1000.0) << "ms" << endl;
+    return 0;
+}
+
+int main(int argc, char ** argv){
+    Global::InitConditions conditions;
+    conditions.graphics = Global::InitConditions::Disabled;
+    Global::init(conditions);
+    InputManager manager;
+    Mugen::Sound::disableSounds();
+    Global::setDebug(0);
+    Mugen::ParseCache cache;
+
+    /* the select screen only subscribes to the searcher if searching is on */
+    Mugen::Data::SearchType search = Mugen::Data::getInstance().getSearchType();
+    if (!Mugen::Data::getInstance().autoSearch()){
+        Mugen::Data::getInstance().setSearchType(Mugen::Data::SelectDefAndAuto);
+    }
+
+    char cwd[4096];
+    if (getcwd(cwd, sizeof(cwd)) == NULL){
+        return 1;
+    }
+    const string where = string(cwd) + "/select-stress-chars";
+
+    int die = 0;
+    try{
+        makeRoster(where);
+        die = run(where);
+    } catch (const MugenException & fail){
+        Global::debug(0) << fail.getFullReason() << endl;
+        die = 1;
+    } catch (const Filesystem::NotFound & fail){
+        Global::debug(0) << "Couldn't find a file: " << fail.getTrace() << endl;
+        die = 1;
+    }
+
+    removeRoster(where);
+    Mugen::Data::getInstance().setSearchType(search);
+    return die;
+}
@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <r-tech1/init.h>
+#include <r-tech1/debug.h>
+#include <r-tech1/file-system.h>
+#include <r-tech1/graphics/bitmap.h>
+#include "mugen/exception.h"
+#include "mugen/sff.h"
+
+using namespace std;
+
+/* Remembers the size of every sprite that decoded */
+class Sizes: public Mugen::Sff::Visitor {
+public:
+    Sizes():
+    failures(0){
+    }
+
+    vector<int> widths;
+    vector<int> heights;
+    int failures;
+
+    virtual void decoded(const Mugen::Sff::SpriteInfo & sprite, const Graphics::Bitmap & image, uint64_t microseconds){
+        widths.push_back(image.getWidth());
+        heights.push_back(image.getHeight());
+    }
+
+    virtual void failed(const Mugen::Sff::SpriteInfo & sprite, const string & reason){
+        Global::debug(0) << "Sprite " << sprite.group << ", " << sprite.item << " failed: " << reason << endl;
+        failures += 1;
+    }
+};
+
+static int run(const string & path){
+    const string output = "sff-repack-test.sff";
+
+    Mugen::Sff::RepackResult result = Mugen::Sff::repack(Filesystem::AbsolutePath(path), output);
+    Global::debug(0) << "Repacked " << result.sprites << " sprites, " << result.linked << " linked, " << result.deduplicated << " deduplicated, " << result.palettes << " palettes" << endl;
+
+    Mugen::Sff::Contents before = Mugen::Sff::describe(Filesystem::AbsolutePath(path));
+    Mugen::Sff::Contents after = Mugen::Sff::describe(Filesystem::AbsolutePath(output));
+
+    if (after.version != 2){
+        Global::debug(0) << "Expected version 2 but got " << after.version << endl;
+        return 1;
+    }
+
+    if (before.sprites.size() != after.sprites.size()){
+        Global::debug(0) << "Expected " << before.sprites.size() << " sprites but got " << after.sprites.size() << endl;
+        return 1;
+    }
+
+    for (unsigned int i = 0; i < before.sprites.size(); i++){
+        if (before.sprites[i].group != after.sprites[i].group ||
+            before.sprites[i].item != after.sprites[i].item ||
+            before.sprites[i].axisX != after.sprites[i].axisX ||
+            before.sprites[i].axisY != after.sprites[i].axisY){
+            Global::debug(0) << "Sprite " << i << " changed from " << before.sprites[i].group << ", " << before.sprites[i].item << " to " << after.sprites[i].group << ", " << after.sprites[i].item << endl;
+            return 1;
+        }
+    }
+
+    Sizes original;
+    Mugen::Sff::decode(Filesystem::AbsolutePath(path), original);
+    Sizes repacked;
+    Mugen::Sff::decode(Filesystem::AbsolutePath(output), repacked);
+    remove(output.c_str());
+
+    if (repacked.failures != 0){
+        Global::debug(0) << repacked.failures << " repacked sprites did not decode" << endl;
+        return 1;
+    }
+
+    if (original.widths != repacked.widths || original.heights != repacked.heights){
+        Global::debug(0) << "Repacked sprites have different sizes" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char ** argv){
+    Global::InitConditions conditions;
+    conditions.graphics = Global::InitConditions::Disabled;
+    Global::init(conditions);
+    Global::setDebug(0);
+
+    try{
+        if (argc > 1){
+            return run(argv[1]);
+        }
+        return run("data/mugen/chars/kfm/kfm.sff");
+    } catch (const MugenException & fail){
+        Global::debug(0) << fail.getFullReason() << endl;
+        return 1;
+    }
+}
@@ -0,0 +1,106 @@
+#include <string>
+#include <vector>
+#include <r-tech1/debug.h>
+#include <r-tech1/pointer.h>
+#include <r-tech1/file-system.h>
+#include "mugen/character.h"
+#include "mugen/behavior.h"
+#include "mugen/stage.h"
+#include "mugen/characterhud.h"
+#include "mugen/parse-cache.h"
+#include "kfm-match.h"
+
+using namespace std;
+
+static int run(){
+    PaintownUtil::ReferenceCount<Mugen::Character> player1;
+    PaintownUtil::ReferenceCount<Mugen::Character> player2;
+    PaintownUtil::ReferenceCount<Mugen::Character> player3;
+    PaintownUtil::ReferenceCount<Mugen::Character> player4;
+    {
+        Mugen::ParseCache cache;
+        player1 = loadKfm(Mugen::Stage::Player1Side);
+        player2 = loadKfm(Mugen::Stage::Player2Side);
+        player3 = loadKfm(Mugen::Stage::Player1Side);
+        player4 = loadKfm(Mugen::Stage::Player2Side);
+    }
+
+    Mugen::DummyBehavior dummy;
+    player1->setBehavior(&dummy);
+    player2->setBehavior(&dummy);
+    player3->setBehavior(&dummy);
+    player4->setBehavior(&dummy);
+
+    Mugen::Stage stage(Storage::instance().find(Filesystem::RelativePath("mugen/stages/kfm.def")));
+    stage.addPlayer1(player1.raw());
+    stage.addPlayer2(player2.raw());
+    stage.addPlayer1(player3.raw());
+    stage.addPlayer2(player4.raw());
+    stage.load();
+    stage.reset();
+
+    if (stage.isPartner(player1.raw()) || !stage.isPartner(player3.raw()) ||
+        stage.isPartner(player2.raw()) || !stage.isPartner(player4.raw())){
+        Global::debug(0) << "Wrong partners" << endl;
+        return 1;
+    }
+
+    if (player1->getX() == player3->getX() || player2->getX() == player4->getX()){
+        Global::debug(0) << "Partners start on top of their leaders" << endl;
+        return 1;
+    }
+
+    /* player 4 starts furthest out so the closest enemy is player 2 */
+    if (stage.getEnemy(player1.raw()) != player2.raw()){
+        Global::debug(0) << "Expected player 2 to be the enemy of player 1" << endl;
+        return 1;
+    }
+
+    /* Knock out the leader of one team, the partner keeps the round going */
+    player2->setHealth(0);
+    for (int tick = 0; tick < 5; tick++){
+        stage.logic();
+    }
+
+    if (stage.getGameInfo()->getRound().isRoundOver()){
+        Global::debug(0) << "Round ended while player 4 was still standing" << endl;
+        return 1;
+    }
+
+    if (stage.getTeamLeader(Mugen::Stage::Player2Side) != player4.raw()){
+        Global::debug(0) << "Player 4 should lead after player 2 is knocked out" << endl;
+        return 1;
+    }
+
+    if (stage.getEnemy(player1.raw()) != player4.raw()){
+        Global::debug(0) << "Expected player 4 to be the enemy once player 2 is down" << endl;
+        return 1;
+    }
+
+    player1->setHealth(player1->getMaxHealth() / 2);
+    player4->setHealth(0);
+    for (int tick = 0; tick < 5; tick++){
+        stage.logic();
+    }
+
+    if (!stage.getGameInfo()->getRound().isRoundOver()){
+        Global::debug(0) << "Round should be over once the whole team is down" << endl;
+        return 1;
+    }
+
+    /* the win keeps the life the winner had left, Turns carries it over */
+    for (int tick = 0; tick < 1000 && player1->getWins().empty(); tick++){
+        stage.logic();
+    }
+
+    if (player1->getWins().empty() || player1->getWins().back().life != player1->getMaxHealth() / 2){
+        Global::debug(0) << "The win of player 1 doesn't have the life it had left" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char ** argv){
+    return runTest(run);
+}
@@ -0,0 +1,105 @@
+#include <string>
+#include <list>
+#include <r-tech1/debug.h>
+#include <r-tech1/file-system.h>
+#include "mugen/ast/all.h"
+#include "mugen/character.h"
+#include "mugen/compiler.h"
+#include "mugen/exception.h"
+#include "mugen/parse-cache.h"
+#include "mugen/profile.h"
+#include "mugen/util.h"
+#include "kfm-match.h"
+
+using namespace std;
+
+/* Checks that state headers and trigger names are read the way they used to
+ * be and reports how long it takes to load characters. The second load of a
+ * character finds its files in the parse cache so it is mostly the time spent
+ * compiling the states and triggers.
+ *
+ * Give more characters on the command line to time them too, for example
+ *   state-compile mugen/chars/somebody/somebody.def
+ */
+
+static bool checkHeader(const string & head, Mugen::Util::StateHeader::Kind kind, int state, const string & name){
+    Mugen::Util::StateHeader header = Mugen::Util::scanStateHeader(head);
+    if (header.kind != kind || header.state != state || header.name != name){
+        Global::debug(0) << "Header '" << head << "' was read as kind " << header.kind << " state " << header.state << " name '" << header.name << "'" << endl;
+        return false;
+    }
+    return true;
+}
+
+static bool checkHeaders(){
+    typedef Mugen::Util::StateHeader Header;
+    return checkHeader("Statedef 200", Header::Definition, 200, "") &&
+           checkHeader("StateDef -1", Header::Definition, -1, "") &&
+           checkHeader("statedef200", Header::Definition, 200, "") &&
+           checkHeader("State 200, 1", Header::Controller, 200, "1") &&
+           checkHeader("state -2 , Hit Sound", Header::Controller, -2, "hit sound") &&
+           checkHeader("State 200", Header::Controller, 200, "") &&
+           checkHeader("State abc", Header::Controller, 0, "") &&
+           checkHeader("States 5", Header::Other, 0, "") &&
+           checkHeader("Command", Header::Other, 0, "");
+}
+
+static bool compiles(const string & name){
+    list<string> names;
+    names.push_back(name);
+    Ast::Identifier identifier(names);
+    try{
+        delete Mugen::Compiler::compile(identifier);
+        return true;
+    } catch (const MugenException & fail){
+        return false;
+    }
+}
+
+static bool checkTriggers(){
+    const char * known[] = {"time", "Time", "STATETIME", "StateNo", "HitPauseTime", "hitpausetime", "I", "h", "name", "P1Name"};
+    for (unsigned int i = 0; i < sizeof(known) / sizeof(*known); i++){
+        if (!compiles(known[i])){
+            Global::debug(0) << "Trigger '" << known[i] << "' did not compile" << endl;
+            return false;
+        }
+    }
+
+    const char * unknown[] = {"tim", "timex", "statenumber", ""};
+    for (unsigned int i = 0; i < sizeof(unknown) / sizeof(*unknown); i++){
+        if (compiles(unknown[i])){
+            Global::debug(0) << "Trigger '" << unknown[i] << "' should not have compiled" << endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static uint64_t load(const char * path){
+    uint64_t start = Mugen::Profile::currentMicroseconds();
+    Mugen::Character character(Storage::instance().find(Filesystem::RelativePath(path)), 0);
+    character.load();
+    return Mugen::Profile::currentMicroseconds() - start;
+}
+
+static int run(int argc, char ** argv){
+    if (!checkHeaders() || !checkTriggers()){
+        return 1;
+    }
+
+    Mugen::ParseCache cache;
+    int paths = argc > 1 ? argc - 1 : 1;
+    for (int i = 0; i < paths; i++){
+        const char * path = argc > 1 ? argv[i + 1] : KFM;
+        uint64_t first = load(path);
+        uint64_t again = load(path);
+        Global::debug(0) << path << " loaded in " << first << "us, " << again << "us with the files already parsed" << endl;
+    }
+
+    return 0;
+}
+
+int main(int argc, char ** argv){
+    return runTest(run, argc, argv);
+}
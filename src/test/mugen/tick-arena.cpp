@@ -0,0 +1,168 @@
+#include <string>
+#include <vector>
+#include <new>
+#include <stdlib.h>
+#include <r-tech1/debug.h>
+#include "mugen/arena.h"
+#include "mugen/character.h"
+#include "mugen/profile.h"
+#include "mugen/stage.h"
+#include "kfm-match.h"
+#include "play-replay.h"
+
+using namespace std;
+
+/* Checks the tick arena, then plays the recorded inputs in replay.txt once
+ * with the arena turned off and once with it on, counting the calls to
+ * operator new and timing the ticks. Both matches have to end up the same.
+ */
+
+static unsigned long allocations = 0;
+
+void * operator new(size_t size) throw(std::bad_alloc){
+    allocations += 1;
+    void * memory = malloc(size == 0 ? 1 : size);
+    if (memory == NULL){
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void * memory) throw(){
+    free(memory);
+}
+
+static bool checkArena(){
+    Mugen::Arena arena;
+    Mugen::Arena::Use useArena(arena);
+
+    Mugen::TickVector<int>::type numbers;
+    for (int i = 0; i < 100000; i++){
+        numbers.push_back(i);
+    }
+    for (int i = 0; i < 100000; i++){
+        if (numbers[i] != i){
+            Global::debug(0) << "A vector in the arena lost its values" << endl;
+            return false;
+        }
+    }
+
+    if (numbers.get_allocator().getArena() != &arena || !arena.owns(&numbers[0]) || ((size_t) &numbers[0]) % 16 != 0){
+        Global::debug(0) << "The arena handed out memory that isn't its own or isn't aligned" << endl;
+        return false;
+    }
+
+    Mugen::TickVector<int>::type().swap(numbers);
+    arena.reset();
+
+    /* a tick as big as the last one doesn't need any more memory */
+    unsigned long before = allocations;
+    for (int i = 0; i < 100000; i++){
+        numbers.push_back(i);
+    }
+    Mugen::TickVector<int>::type().swap(numbers);
+    arena.reset();
+    if (allocations != before){
+        Global::debug(0) << "The arena allocated " << (allocations - before) << " times after a reset" << endl;
+        return false;
+    }
+
+    return true;
+}
+
+static bool checkWithoutArena(){
+    Mugen::TickVector<int>::type numbers;
+    numbers.push_back(1);
+    if (numbers.get_allocator().getArena() != NULL){
+        Global::debug(0) << "A list took an arena when none was in use" << endl;
+        return false;
+    }
+
+    Mugen::Arena disabled;
+    disabled.setEnabled(false);
+    Mugen::Arena::Use useArena(disabled);
+    Mugen::TickVector<int>::type more;
+    more.push_back(1);
+    if (more.get_allocator().getArena() != NULL || disabled.used() != 0){
+        Global::debug(0) << "A disabled arena handed out memory" << endl;
+        return false;
+    }
+
+    return true;
+}
+
+struct Result{
+    Result():
+    ticks(0),
+    allocations(0),
+    time(0),
+    finalX1(0),
+    finalX2(0),
+    life1(0),
+    life2(0){
+    }
+
+    int ticks;
+    unsigned long allocations;
+    uint64_t time;
+    double finalX1;
+    double finalX2;
+    double life1;
+    double life2;
+};
+
+static Result playMatch(bool useArena){
+    ReplayMatch match;
+    Mugen::Stage & stage = match.getStage();
+    stage.getArena().setEnabled(useArena);
+
+    Result result;
+    unsigned long before = allocations;
+    uint64_t start = Mugen::Profile::currentMicroseconds();
+    for (int tick = 0; !match.done(tick); tick++){
+        stage.logic();
+        result.ticks += 1;
+    }
+    result.time = Mugen::Profile::currentMicroseconds() - start;
+    result.allocations = allocations - before;
+    result.finalX1 = match.getPlayer1().getX();
+    result.finalX2 = match.getPlayer2().getX();
+    result.life1 = match.getPlayer1().getHealth();
+    result.life2 = match.getPlayer2().getHealth();
+
+    return result;
+}
+
+static int run(){
+    if (!checkArena() || !checkWithoutArena()){
+        return 1;
+    }
+
+    Result without = playMatch(false);
+    Result with = playMatch(true);
+
+    if (without.ticks != with.ticks ||
+        without.finalX1 != with.finalX1 ||
+        without.finalX2 != with.finalX2 ||
+        without.life1 != with.life1 ||
+        without.life2 != with.life2){
+        Global::debug(0) << "The match came out differently with the tick arena" << endl;
+        return 1;
+    }
+
+    if (with.allocations > without.allocations){
+        Global::debug(0) << "The tick arena made more allocations than it saved" << endl;
+        return 1;
+    }
+
+    Global::debug(0) << with.ticks << " ticks without the arena: " << without.allocations << " allocations, " << without.time << "us" << endl;
+    Global::debug(0) << with.ticks << " ticks with the arena: " << with.allocations << " allocations, " << with.time << "us" << endl;
+    if (with.ticks > 0){
+        Global::debug(0) << "Per tick: " << (without.allocations / with.ticks) << " allocations and " << (without.time / with.ticks) << "us before, " << (with.allocations / with.ticks) << " allocations and " << (with.time / with.ticks) << "us after" << endl;
+    }
+    return 0;
+}
+
+int main(int argc, char ** argv){
+    return runTest(run);
+}
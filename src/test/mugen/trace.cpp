@@ -0,0 +1,154 @@
+#include <string>
+#include <sstream>
+#include <vector>
+#include <signal.h>
+#include <r-tech1/debug.h>
+#include "mugen/character.h"
+#include "mugen/stage.h"
+#include "mugen/profile.h"
+#include "mugen/trace.h"
+#include "kfm-match.h"
+
+using namespace std;
+
+/* Runs a match with tracing off and on, checks what ends up in the trace and
+ * compares what a tick of state controller checks cost with the old
+ * Global::debug lines against the trace macro.
+ */
+
+static const int TICKS = 200;
+
+static int count(const vector<Mugen::Trace::Record> & records, Mugen::Trace::Event event){
+    int total = 0;
+    for (vector<Mugen::Trace::Record>::const_iterator it = records.begin(); it != records.end(); it++){
+        if (it->event == event){
+            total += 1;
+        }
+    }
+    return total;
+}
+
+/* what every controller check used to do, even with debugging off */
+static uint64_t timeDebug(int checks, const string & name){
+    uint64_t start = Mugen::Profile::currentMicroseconds();
+    for (int tick = 0; tick < TICKS; tick++){
+        for (int check = 0; check < checks; check++){
+            Global::debug(2) << "State " << check << " check state controller " << name << endl;
+        }
+    }
+    return Mugen::Profile::currentMicroseconds() - start;
+}
+
+static uint64_t timeTrace(int checks, const string & name){
+    uint64_t start = Mugen::Profile::currentMicroseconds();
+    for (int tick = 0; tick < TICKS; tick++){
+        for (int check = 0; check < checks; check++){
+            MUGEN_TRACE(2, Mugen::Trace::ControllerCheck, 0, check, 0, 0, name);
+        }
+    }
+    return Mugen::Profile::currentMicroseconds() - start;
+}
+
+#ifndef _WIN32
+static void testHandler(int signal){
+}
+
+static bool hasHandler(int signal, void (*handler)(int)){
+    struct sigaction current;
+    return sigaction(signal, NULL, &current) == 0 && current.sa_handler == handler;
+}
+
+/* tracing takes over the crash signals only while it is on */
+static bool checkHandlers(){
+    void (*old)(int) = signal(SIGFPE, testHandler);
+    Mugen::Trace::setLevel(2);
+    bool replaced = !hasHandler(SIGFPE, testHandler);
+    Mugen::Trace::setLevel(0);
+    bool restored = hasHandler(SIGFPE, testHandler);
+    signal(SIGFPE, old);
+
+    if (!replaced){
+        Global::debug(0) << "Turning tracing on did not install the crash handler" << endl;
+        return false;
+    }
+
+    if (!restored){
+        Global::debug(0) << "Turning tracing off did not put back the old handler" << endl;
+        return false;
+    }
+
+    return true;
+}
+#else
+static bool checkHandlers(){
+    return true;
+}
+#endif
+
+static int run(){
+    if (!checkHandlers()){
+        return 1;
+    }
+
+    KfmMatch match;
+    Mugen::Stage & stage = match.getStage();
+
+    Mugen::Trace::setLevel(0);
+    for (int tick = 0; tick < 10; tick++){
+        stage.logic();
+    }
+
+    if (Mugen::Trace::getRecords().size() != 0){
+        Global::debug(0) << "Something was traced while tracing was off" << endl;
+        return 1;
+    }
+
+    Mugen::Trace::setLevel(2);
+    stage.logic();
+    Mugen::Trace::setLevel(0);
+
+    vector<Mugen::Trace::Record> records = Mugen::Trace::getRecords();
+    int checks = count(records, Mugen::Trace::ControllerCheck);
+    if (checks == 0 || count(records, Mugen::Trace::TriggerPassed) + count(records, Mugen::Trace::TriggerFailed) == 0){
+        Global::debug(0) << "A tick did not trace any controllers or triggers" << endl;
+        return 1;
+    }
+
+    for (unsigned int i = 1; i < records.size(); i++){
+        if (records[i].time < records[i - 1].time){
+            Global::debug(0) << "The trace is not in order" << endl;
+            return 1;
+        }
+    }
+
+    std::ostringstream out;
+    Mugen::Trace::dump(out);
+    if (out.str().find("check controller") == string::npos){
+        Global::debug(0) << "The dump does not show the controller checks" << endl;
+        return 1;
+    }
+
+    /* only the newest records are kept */
+    Mugen::Trace::clear();
+    Mugen::Trace::setLevel(2);
+    for (unsigned int i = 0; i < Mugen::Trace::RingSize + 10; i++){
+        Mugen::Trace::record(Mugen::Trace::CommandPressed, 0, i, 0, 0, "a name that is too long to fit");
+    }
+    Mugen::Trace::setLevel(0);
+    records = Mugen::Trace::getRecords();
+    if (records.size() != Mugen::Trace::RingSize || records[0].values[0] != 10 || string(records[0].text).size() != Mugen::Trace::TextLength - 1){
+        Global::debug(0) << "The ring buffer kept " << records.size() << " records starting with " << records[0].values[0] << endl;
+        return 1;
+    }
+
+    string name = "run fwd";
+    uint64_t debugTime = timeDebug(checks, name);
+    uint64_t traceTime = timeTrace(checks, name);
+    Global::debug(0) << checks << " controller checks a tick cost " << (debugTime / (double) TICKS) << "us with Global::debug and " << (traceTime / (double) TICKS) << "us with tracing off" << endl;
+
+    return 0;
+}
+
+int main(int argc, char ** argv){
+    return runTest(run);
+}
@@ -0,0 +1,275 @@
+#include <string>
+#include <vector>
+#include <r-tech1/debug.h>
+#include <r-tech1/file-system.h>
+#include "mugen/ast/all.h"
+#include "mugen/character.h"
+#include "mugen/compiler.h"
+#include "mugen/parse-cache.h"
+#include "mugen/profile.h"
+#include "mugen/stage.h"
+#include "kfm-match.h"
+#include "play-replay.h"
+
+using namespace std;
+
+/* Checks that comparisons like `stateno = 200' or `command = "x"' compile to
+ * fused nodes that give the same answers as the generic ones on every tick of
+ * the match in replay.txt, and that the match plays the same with and without
+ * them. Reports how many of the comparisons in a character were fused and how
+ * much faster the fused ones are.
+ *
+ * Give more characters on the command line to count them too, for example
+ *   trigger-fusion mugen/chars/somebody/somebody.def
+ */
+
+static const int ROUNDS = 100000;
+
+static Ast::Value * number(double value){
+    return new Ast::Number(-1, -1, value);
+}
+
+static Ast::Value * text(const string & value){
+    return new Ast::String(-1, -1, new string(value));
+}
+
+static Ast::Value * identifier(const string & name){
+    return new Ast::SimpleIdentifier(name);
+}
+
+static Ast::Value * function(const string & name, Ast::Value * argument){
+    return new Ast::Function(-1, -1, name, new Ast::ValueList(argument));
+}
+
+static Ast::Value * infix(Ast::ExpressionInfix::InfixType type, Ast::Value * left, Ast::Value * right){
+    return new Ast::ExpressionInfix(-1, -1, type, left, right);
+}
+
+/* one trigger compiled both ways */
+struct Sample{
+    Sample(Mugen::Compiler::Value * fused, Mugen::Compiler::Value * generic):
+    fused(fused),
+    generic(generic){
+    }
+
+    Mugen::Compiler::Value * fused;
+    Mugen::Compiler::Value * generic;
+};
+
+/* compiles `trigger' with and without fusing and deletes it */
+static bool addSample(vector<Sample> & samples, Ast::Value * trigger, bool fusable){
+    Mugen::Compiler::enableFusedComparisons(true);
+    unsigned int before = Mugen::Compiler::comparisonsFused();
+    Mugen::Compiler::Value * fused = Mugen::Compiler::compile(trigger);
+    bool wasFused = Mugen::Compiler::comparisonsFused() != before;
+
+    Mugen::Compiler::enableFusedComparisons(false);
+    Mugen::Compiler::Value * generic = Mugen::Compiler::compile(trigger);
+    Mugen::Compiler::enableFusedComparisons(true);
+
+    samples.push_back(Sample(fused, generic));
+
+    if (wasFused != fusable){
+        Global::debug(0) << "'" << trigger->toString() << "' should" << (fusable ? "" : " not") << " have been fused" << endl;
+        delete trigger;
+        return false;
+    }
+
+    if (fused->toString() != generic->toString()){
+        Global::debug(0) << "The fused trigger prints as '" << fused->toString() << "' instead of '" << generic->toString() << "'" << endl;
+        delete trigger;
+        return false;
+    }
+
+    delete trigger;
+    return true;
+}
+
+static bool makeSamples(vector<Sample> & samples){
+    typedef Ast::ExpressionInfix Infix;
+    return addSample(samples, infix(Infix::Equals, identifier("stateno"), number(0)), true) &&
+           addSample(samples, infix(Infix::Unequals, identifier("StateNo"), number(200)), true) &&
+           addSample(samples, infix(Infix::GreaterThanEquals, identifier("time"), number(3)), true) &&
+           addSample(samples, infix(Infix::LessThan, number(5), identifier("Time")), true) &&
+           addSample(samples, infix(Infix::LessThanEquals, identifier("statetime"), number(10)), true) &&
+           addSample(samples, infix(Infix::Equals, function("var", number(1)), number(0)), true) &&
+           addSample(samples, infix(Infix::Unequals, function("var", number(50)), number(0)), true) &&
+           addSample(samples, infix(Infix::Equals, function("var", number(51)), number(1)), true) &&
+           addSample(samples, infix(Infix::GreaterThan, function("fvar", number(2)), number(0.5)), true) &&
+           addSample(samples, infix(Infix::Equals, function("animelemtime", number(1)), number(0)), true) &&
+           addSample(samples, infix(Infix::GreaterThanEquals, function("AnimElemTime", number(2)), number(0)), true) &&
+           addSample(samples, infix(Infix::Equals, identifier("command"), text("x")), true) &&
+           addSample(samples, infix(Infix::Unequals, text("holdfwd"), identifier("command")), true) &&
+           addSample(samples, infix(Infix::Equals, infix(Infix::Add, function("var", number(1)), number(1)), number(1)), false) &&
+           addSample(samples, infix(Infix::Equals, identifier("stateno"), identifier("time")), false);
+}
+
+static void deleteSamples(vector<Sample> & samples){
+    for (vector<Sample>::iterator it = samples.begin(); it != samples.end(); it++){
+        delete it->fused;
+        delete it->generic;
+    }
+    samples.clear();
+}
+
+/* variables that hold a string, a bool and a changing float */
+static void setVariables(Mugen::Character & character, int tick){
+    character.setVariable(50, Mugen::RuntimeValue(string("up")));
+    character.setVariable(51, Mugen::RuntimeValue(tick % 2 == 0));
+    character.setFloatVariable(2, Mugen::RuntimeValue((tick % 100) / 100.0));
+}
+
+static vector<string> someCommands(int tick){
+    vector<string> commands;
+    if (tick % 3 == 0){
+        commands.push_back("x");
+    }
+    if (tick % 5 == 0){
+        commands.push_back("holdfwd");
+    }
+    return commands;
+}
+
+static bool checkSamples(const vector<Sample> & samples, const Mugen::Environment & environment, int tick){
+    for (vector<Sample>::const_iterator it = samples.begin(); it != samples.end(); it++){
+        Mugen::RuntimeValue fused = it->fused->evaluate(environment);
+        Mugen::RuntimeValue generic = it->generic->evaluate(environment);
+        if (fused.getType() != generic.getType() || fused.toBool() != generic.toBool()){
+            Global::debug(0) << "'" << it->generic->toString() << "' is " << fused.toBool() << " fused but " << generic.toBool() << " otherwise at tick " << tick << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/* microseconds to evaluate all the samples ROUNDS times */
+static uint64_t timeSamples(const vector<Sample> & samples, const Mugen::Environment & environment, bool fused){
+    int sum = 0;
+    uint64_t start = Mugen::Profile::currentMicroseconds();
+    for (int round = 0; round < ROUNDS; round++){
+        for (vector<Sample>::const_iterator it = samples.begin(); it != samples.end(); it++){
+            const Mugen::Compiler::Value * value = fused ? it->fused : it->generic;
+            sum += value->evaluate(environment).toBool();
+        }
+    }
+    uint64_t time = Mugen::Profile::currentMicroseconds() - start;
+    Global::debug(1) << "True " << sum << " times" << endl;
+    return time;
+}
+
+struct Result{
+    Result():
+    ticks(0),
+    time(0),
+    finalX1(0),
+    finalX2(0),
+    life1(0),
+    life2(0),
+    same(true),
+    fusedTime(0),
+    genericTime(0){
+    }
+
+    int ticks;
+    uint64_t time;
+    double finalX1;
+    double finalX2;
+    double life1;
+    double life2;
+    /* the samples gave the same answers both ways on every tick */
+    bool same;
+    uint64_t fusedTime;
+    uint64_t genericTime;
+};
+
+static Result playMatch(bool fuse, const vector<Sample> & samples){
+    /* only the characters are compiled with or without fusing */
+    Mugen::Compiler::enableFusedComparisons(fuse);
+    ReplayMatch match;
+    Mugen::Compiler::enableFusedComparisons(true);
+
+    Mugen::Stage & stage = match.getStage();
+    Mugen::Character & player1 = match.getPlayer1();
+    Mugen::Character & player2 = match.getPlayer2();
+
+    Result result;
+    for (int tick = 0; !match.done(tick); tick++){
+        uint64_t start = Mugen::Profile::currentMicroseconds();
+        stage.logic();
+        result.time += Mugen::Profile::currentMicroseconds() - start;
+        result.ticks += 1;
+
+        /* both matches set the variables the samples read the same way */
+        setVariables(player2, tick);
+        vector<string> commands = someCommands(tick);
+        Mugen::FullEnvironment environment(stage, player2, commands);
+        if (result.same && !checkSamples(samples, environment, tick)){
+            result.same = false;
+        }
+    }
+
+    result.finalX1 = player1.getX();
+    result.finalX2 = player2.getX();
+    result.life1 = player1.getHealth();
+    result.life2 = player2.getHealth();
+
+    vector<string> commands = someCommands(0);
+    Mugen::FullEnvironment environment(stage, player2, commands);
+    result.genericTime = timeSamples(samples, environment, false);
+    result.fusedTime = timeSamples(samples, environment, true);
+
+    return result;
+}
+
+/* how many of the comparisons in a character are fused */
+static void countFused(const char * path){
+    Mugen::Compiler::resetComparisonCounts();
+    {
+        Mugen::ParseCache cache;
+        Mugen::Character character(Storage::instance().find(Filesystem::RelativePath(path)), Mugen::Stage::Player1Side);
+        character.load();
+    }
+
+    unsigned int compiled = Mugen::Compiler::comparisonsCompiled();
+    unsigned int fused = Mugen::Compiler::comparisonsFused();
+    Global::debug(0) << path << ": " << fused << " of " << compiled << " comparisons fused (" << (compiled > 0 ? fused * 100 / compiled : 0) << "%)" << endl;
+}
+
+static int run(int argc, char ** argv){
+    vector<Sample> samples;
+    if (!makeSamples(samples)){
+        deleteSamples(samples);
+        return 1;
+    }
+
+    Result generic = playMatch(false, samples);
+    Result fused = playMatch(true, samples);
+    deleteSamples(samples);
+
+    if (!generic.same || !fused.same){
+        return 1;
+    }
+
+    if (generic.ticks != fused.ticks ||
+        generic.finalX1 != fused.finalX1 ||
+        generic.finalX2 != fused.finalX2 ||
+        generic.life1 != fused.life1 ||
+        generic.life2 != fused.life2){
+        Global::debug(0) << "The match came out differently with fused comparisons" << endl;
+        return 1;
+    }
+
+    countFused(KFM);
+    for (int i = 1; i < argc; i++){
+        countFused(argv[i]);
+    }
+
+    double speedup = fused.fusedTime > 0 ? (double) fused.genericTime / fused.fusedTime : 0;
+    Global::debug(0) << ROUNDS << " rounds of the sample triggers took " << fused.genericTime << "us generic, " << fused.fusedTime << "us fused, " << speedup << "x faster" << endl;
+    Global::debug(0) << fused.ticks << " ticks took " << generic.time << "us generic, " << fused.time << "us fused" << endl;
+    return 0;
+}
+
+int main(int argc, char ** argv){
+    return runTest(run, argc, argv);
+}
@@ -0,0 +1,89 @@
+#include <sstream>
+#include <string>
+#include <vector>
+#include <r-tech1/init.h>
+#include <r-tech1/debug.h>
+#include <r-tech1/file-system.h>
+#include <r-tech1/input/input-manager.h>
+#include "mugen/exception.h"
+#include "mugen/sound.h"
+#include "mugen/validate.h"
+
+using namespace std;
+
+static bool check(const Mugen::Validate::Report & report, const string & kind){
+    if (report.kind != kind){
+        Global::debug(0) << "Expected a " << kind << " report for " << report.path << " but got " << report.kind << endl;
+        return false;
+    }
+
+    if (!report.loaded){
+        Global::debug(0) << report.path << " did not load" << endl;
+        return false;
+    }
+
+    for (vector<Mugen::Validate::Issue>::const_iterator it = report.issues.begin(); it != report.issues.end(); it++){
+        Global::debug(0) << report.path << ": " << it->kind << " " << it->file << ":" << it->line << " " << it->message << endl;
+        if (it->kind == "parse" || it->kind == "load" || it->kind == "file"){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static int run(){
+    /* the same character twice so both threads go through the parse cache
+     * for the same files
+     */
+    vector<Filesystem::AbsolutePath> characters;
+    characters.push_back(Storage::instance().find(Filesystem::RelativePath("mugen/chars/kfm/kfm.def")));
+    characters.push_back(Storage::instance().find(Filesystem::RelativePath("mugen/chars/kfm/kfm.def")));
+    vector<Filesystem::AbsolutePath> stages;
+    stages.push_back(Storage::instance().find(Filesystem::RelativePath("mugen/stages/kfm.def")));
+
+    vector<Mugen::Validate::Report> reports = Mugen::Validate::validateAll(characters, stages, 2);
+    if (reports.size() != 3){
+        Global::debug(0) << "Expected 3 reports but got " << reports.size() << endl;
+        return 1;
+    }
+
+    if (!check(reports[0], "character") || !check(reports[1], "character") || !check(reports[2], "stage")){
+        return 1;
+    }
+
+    if (reports[0].issues.size() != reports[1].issues.size() || reports[0].unreachableStates != reports[1].unreachableStates){
+        Global::debug(0) << "The same character was validated differently" << endl;
+        return 1;
+    }
+
+    if (reports[0].spriteMemory == 0){
+        Global::debug(0) << "No sprite memory was counted" << endl;
+        return 1;
+    }
+
+    std::ostringstream json;
+    Mugen::Validate::writeJson(json, reports);
+    if (json.str().find("\"kind\": \"stage\"") == string::npos || json.str()[0] != '['){
+        Global::debug(0) << "Unexpected json " << json.str() << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char ** argv){
+    Global::InitConditions conditions;
+    conditions.graphics = Global::InitConditions::Disabled;
+    Global::init(conditions);
+    InputManager manager;
+    Mugen::Sound::disableSounds();
+    Global::setDebug(0);
+
+    try{
+        return run();
+    } catch (const MugenException & fail){
+        Global::debug(0) << fail.getFullReason() << endl;
+        return 1;
+    }
+}
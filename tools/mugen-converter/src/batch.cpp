@@ -0,0 +1,348 @@
+#include "batch.h"
+#include "generator.h"
+#include "unsupported.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace Mugen;
+
+/* How often a trigger or controller was left untranslated across the roster */
+struct Usage{
+    Usage():
+    uses(0),
+    characters(0){
+    }
+
+    int uses;
+    int characters;
+};
+
+typedef std::map<std::string, Usage> UsageMap;
+
+/* A character being converted by a child process */
+struct Job{
+    Job():
+    process(-1),
+    pipe(-1),
+    started(0){
+    }
+
+    std::string definition;
+    pid_t process;
+    int pipe;
+    uint64_t started;
+};
+
+static uint64_t currentMicroseconds(){
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return (uint64_t) now.tv_sec * 1000000 + now.tv_usec;
+}
+
+static std::string absolute(const std::string & path){
+    if (!path.empty() && path[0] == '/'){
+        return path;
+    }
+    char buffer[4096];
+    if (getcwd(buffer, sizeof(buffer)) == NULL){
+        return path;
+    }
+    return std::string(buffer) + "/" + path;
+}
+
+/* A character def has a [Files] section that points at its cns, stage and
+ * storyboard defs don't.
+ */
+static bool isCharacter(const std::string & path){
+    std::ifstream file(path.c_str());
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    const std::string all = lowercase(contents.str());
+    return all.find("[files]") != std::string::npos && all.find(".cns") != std::string::npos;
+}
+
+static void findCharacters(const std::string & directory, std::vector<std::string> & found){
+    DIR * dir = opendir(directory.c_str());
+    if (dir == NULL){
+        std::cout << "Could not open " << directory << std::endl;
+        return;
+    }
+
+    std::vector<std::string> entries;
+    struct dirent * entry;
+    while ((entry = readdir(dir)) != NULL){
+        std::string name = entry->d_name;
+        if (name != "." && name != ".."){
+            entries.push_back(name);
+        }
+    }
+    closedir(dir);
+
+    /* keep the order stable between runs */
+    std::sort(entries.begin(), entries.end());
+    for (std::vector<std::string>::iterator it = entries.begin(); it != entries.end(); it++){
+        std::string path = directory + "/" + *it;
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0){
+            continue;
+        }
+        if (S_ISDIR(info.st_mode)){
+            findCharacters(path, found);
+        } else if (it->size() > 4 && lowercase(it->substr(it->size() - 4)) == ".def" && isCharacter(path)){
+            found.push_back(path);
+        }
+    }
+}
+
+static void writeAll(int fd, const std::string & data){
+    size_t written = 0;
+    while (written < data.size()){
+        ssize_t count = write(fd, data.c_str() + written, data.size() - written);
+        if (count < 0 && errno == EINTR){
+            continue;
+        }
+        if (count <= 0){
+            return;
+        }
+        written += count;
+    }
+}
+
+static std::string readAll(int fd){
+    std::string data;
+    char buffer[4096];
+    while (true){
+        ssize_t count = read(fd, buffer, sizeof(buffer));
+        if (count < 0 && errno == EINTR){
+            continue;
+        }
+        if (count <= 0){
+            break;
+        }
+        data.append(buffer, count);
+    }
+    return data;
+}
+
+/* Runs in the child. The generator is chatty so its output is thrown away,
+ * the untranslated names go back to the parent over the pipe as lines of
+ * "t|c count name".
+ */
+static void convertCharacter(const std::string & definition, const std::string & output, int pipe){
+    int null = open("/dev/null", O_WRONLY);
+    if (null != -1){
+        dup2(null, 1);
+        close(null);
+    }
+
+    /* the generator names the python class after the output file so it
+     * has to be written without a directory
+     */
+    if (chdir(output.c_str()) != 0){
+        _exit(2);
+    }
+
+    CharacterGenerator character(definition);
+    bool ok = character.output(stripDir(stripExtension(definition) + ".py"));
+    std::cout.flush();
+
+    std::ostringstream out;
+    for (Unsupported::Counts::const_iterator it = Unsupported::getTriggers().begin(); it != Unsupported::getTriggers().end(); it++){
+        out << "t " << it->second << " " << it->first << "\n";
+    }
+    for (Unsupported::Counts::const_iterator it = Unsupported::getControllers().begin(); it != Unsupported::getControllers().end(); it++){
+        out << "c " << it->second << " " << it->first << "\n";
+    }
+    writeAll(pipe, out.str());
+    close(pipe);
+
+    _exit(ok ? 0 : 1);
+}
+
+static bool startJob(Job & job, const std::string & output){
+    int fds[2];
+    if (::pipe(fds) != 0){
+        return false;
+    }
+
+    /* anything still buffered would be written twice */
+    std::cout.flush();
+
+    job.started = currentMicroseconds();
+    job.process = fork();
+    if (job.process == -1){
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+
+    if (job.process == 0){
+        close(fds[0]);
+        convertCharacter(job.definition, output, fds[1]);
+    }
+
+    close(fds[1]);
+    job.pipe = fds[0];
+    return true;
+}
+
+static void addUsage(const std::string & results, UsageMap & triggers, UsageMap & controllers){
+    std::istringstream in(results);
+    std::string line;
+    while (std::getline(in, line)){
+        std::istringstream fields(line);
+        std::string kind;
+        int count = 0;
+        fields >> kind >> count;
+        std::string name;
+        std::getline(fields, name);
+        if (!name.empty() && name[0] == ' '){
+            name = name.substr(1);
+        }
+        if (name.empty()){
+            continue;
+        }
+        Usage & usage = kind == "t" ? triggers[name] : controllers[name];
+        usage.uses += count;
+        usage.characters += 1;
+    }
+}
+
+static bool moreUses(const std::pair<std::string, Usage> & a, const std::pair<std::string, Usage> & b){
+    if (a.second.uses != b.second.uses){
+        return a.second.uses > b.second.uses;
+    }
+    return a.first < b.first;
+}
+
+static void printUsage(const std::string & title, const UsageMap & usages){
+    std::vector<std::pair<std::string, Usage> > sorted(usages.begin(), usages.end());
+    std::sort(sorted.begin(), sorted.end(), moreUses);
+    std::cout << title << " (" << sorted.size() << ")" << std::endl;
+    for (std::vector<std::pair<std::string, Usage> >::iterator it = sorted.begin(); it != sorted.end(); it++){
+        std::cout << "  " << it->first << ": " << it->second.uses << " uses in " << it->second.characters << " characters" << std::endl;
+    }
+}
+
+static bool slower(const std::pair<std::string, uint64_t> & a, const std::pair<std::string, uint64_t> & b){
+    return a.second > b.second;
+}
+
+int Mugen::defaultJobs(){
+#ifdef _SC_NPROCESSORS_ONLN
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    if (processors > 0){
+        return (int) processors;
+    }
+#endif
+    return 1;
+}
+
+int Mugen::convertRoster(const std::string & roster, const std::string & output, int jobs){
+    if (jobs < 1){
+        jobs = 1;
+    }
+
+    std::vector<std::string> characters;
+    findCharacters(absolute(roster), characters);
+    const std::string outputDirectory = absolute(output);
+    std::cout << "Converting " << characters.size() << " characters from " << roster << " into " << outputDirectory << " with " << jobs << " jobs" << std::endl;
+
+    const uint64_t start = currentMicroseconds();
+    std::map<pid_t, Job> running;
+    std::vector<std::pair<std::string, uint64_t> > times;
+    std::vector<std::string> failed;
+    UsageMap triggers;
+    UsageMap controllers;
+    unsigned int next = 0;
+
+    while (next < characters.size() || !running.empty()){
+        while ((int) running.size() < jobs && next < characters.size()){
+            Job job;
+            job.definition = characters[next];
+            next += 1;
+            if (startJob(job, outputDirectory)){
+                running[job.process] = job;
+            } else {
+                std::cout << "Could not start a process for " << job.definition << std::endl;
+                failed.push_back(job.definition);
+            }
+        }
+
+        if (running.empty()){
+            continue;
+        }
+
+        int status = 0;
+        pid_t done = waitpid(-1, &status, 0);
+        if (done == -1){
+            if (errno == EINTR){
+                continue;
+            }
+            break;
+        }
+
+        std::map<pid_t, Job>::iterator found = running.find(done);
+        if (found == running.end()){
+            continue;
+        }
+        Job job = found->second;
+        running.erase(found);
+
+        /* the results are a few kilobytes at most so they fit in the pipe
+         * buffer and the child could exit before anyone read them
+         */
+        addUsage(readAll(job.pipe), triggers, controllers);
+        close(job.pipe);
+
+        uint64_t took = currentMicroseconds() - job.started;
+        times.push_back(std::make_pair(job.definition, took));
+        bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        if (!ok){
+            failed.push_back(job.definition);
+        }
+        std::cout << (ok ? "Converted " : "Failed ") << job.definition << " in " << (took / 1000) << "ms" << std::endl;
+    }
+
+    const uint64_t total = currentMicroseconds() - start;
+    uint64_t sum = 0;
+    for (std::vector<std::pair<std::string, uint64_t> >::iterator it = times.begin(); it != times.end(); it++){
+        sum += it->second;
+    }
+
+    std::cout << std::endl;
+    std::cout << "Converted " << (characters.size() - failed.size()) << " of " << characters.size() << " characters in " << (total / 1000) << "ms, " << (sum / 1000) << "ms of conversion time over " << jobs << " jobs" << std::endl;
+
+    std::sort(times.begin(), times.end(), slower);
+    std::cout << "Slowest characters" << std::endl;
+    for (unsigned int i = 0; i < times.size() && i < 10; i++){
+        std::cout << "  " << times[i].first << ": " << (times[i].second / 1000) << "ms" << std::endl;
+    }
+
+    if (!failed.empty()){
+        std::cout << "Failed characters" << std::endl;
+        for (std::vector<std::string>::iterator it = failed.begin(); it != failed.end(); it++){
+            std::cout << "  " << *it << std::endl;
+        }
+    }
+
+    printUsage("Unsupported triggers", triggers);
+    printUsage("Unsupported controllers", controllers);
+
+    return failed.size();
+}
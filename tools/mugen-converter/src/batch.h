@@ -0,0 +1,20 @@
+#ifndef mugen_converter_batch
+#define mugen_converter_batch
+
+#include <string>
+
+namespace Mugen{
+
+/*! Converts every character under a roster directory. Each character is
+ * converted in its own process, up to jobs at a time, and afterwards the
+ * time each one took and the triggers and controllers that could not be
+ * translated are printed. Returns the number of characters that failed.
+ */
+int convertRoster(const std::string & roster, const std::string & output, int jobs);
+
+//! Number of processors, used when no job count is given
+int defaultJobs();
+
+}
+
+#endif
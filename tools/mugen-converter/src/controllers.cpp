@@ -1,5 +1,6 @@
 #include "controllers.h"
 #include "triggers.h"
+#include "unsupported.h"
 
 #include "ast/all.h"
 
@@ -222,6 +223,7 @@ Content getController(StateParameterMap & map){
         } else {
             std::cout << "Unhandled Controller Type: " << type << std::endl;
         }
+        Unsupported::controller(type);
     }
     // Set to pass if state controller can't be determined
     return Content(3, "pass");
@@ -54,7 +54,7 @@ directory(Mugen::stripFilename(filename)){
 CharacterGenerator::~CharacterGenerator(){
 }
 
-void CharacterGenerator::output(const std::string & file){
+bool CharacterGenerator::output(const std::string & file){
     try {
         std::cout << "Preparing character definition file " << filename << " for output to file: " << file << std::endl;
         
@@ -100,11 +100,13 @@ void CharacterGenerator::output(const std::string & file){
         character.output(out, 0);
         outputStateClasses(out);
         out.close();
+        return true;
     } catch (const Mugen::Cmd::ParseException & fail){
         std::cout << "Failed to parse " << filename << " because " << fail.getReason() << std::endl;
     } catch (...){
         std::cout << "Unknown Exception Caught!\nAborting..." << std::endl;
     }
+    return false;
 }
 
 void CharacterGenerator::addStateFile(const std::string & stateFile){
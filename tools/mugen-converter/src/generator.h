@@ -14,8 +14,8 @@ class CharacterGenerator{
         CharacterGenerator(const std::string &);
         virtual ~CharacterGenerator();
         
-        //! Pass in python output filename
-        void output(const std::string &);
+        //! Pass in python output filename, returns false if the character could not be parsed
+        bool output(const std::string &);
     
         //! Filename of the character definition file
         const std::string filename;
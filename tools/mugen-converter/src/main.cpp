@@ -1,15 +1,37 @@
 #include "generator.h"
+#include "batch.h"
+
+#include <stdlib.h>
 
 using namespace std;
 
+static void usage(){
+    std::cout << "Usage: ./converter character.def [character.py]\n     - Second parameter is optional, if ommited will default to the original filename" << endl;
+    std::cout << "       ./converter --batch roster-directory [output-directory] [-j jobs]\n     - Converts every character under the roster directory and reports the unsupported triggers and controllers" << endl;
+}
+
 int main(int argc, char ** argv){
-    if (argc > 2){
+    if (argc > 2 && string(argv[1]) == "--batch"){
+        string roster = argv[2];
+        string output = ".";
+        int jobs = Mugen::defaultJobs();
+        for (int i = 3; i < argc; i++){
+            string arg = argv[i];
+            if (arg == "-j" && i + 1 < argc){
+                jobs = atoi(argv[i + 1]);
+                i += 1;
+            } else {
+                output = arg;
+            }
+        }
+        return Mugen::convertRoster(roster, output, jobs) == 0 ? 0 : 1;
+    } else if (argc > 2){
         Mugen::CharacterGenerator character(argv[1]);
         character.output(argv[2]);
     } else if (argc > 1){
         Mugen::CharacterGenerator character(argv[1]);
         character.output(Mugen::stripDir(Mugen::stripExtension(argv[1]) + ".py"));
     } else {
-        std::cout << "Usage: ./converter character.def [character.py]\n     - Second parameter is optional, if ommited will default to the original filename" << endl;
+        usage();
     }
 }
@@ -1,4 +1,5 @@
 #include "triggers.h"
+#include "unsupported.h"
 
 #include <iostream>
 #include <sstream>
@@ -317,6 +318,7 @@ static std::string handleKeyWord(const Expression & expression){
         std::cout << "Unhandled keyword: " << keyword << std::endl;
     }
     
+    Unsupported::trigger(keyword);
     return keyword;
 }
 
@@ -0,0 +1,24 @@
+#include "unsupported.h"
+#include "tools.h"
+
+/* The converter is single threaded so these don't need a lock, batch mode
+ * runs every character in its own process.
+ */
+static Mugen::Unsupported::Counts triggers;
+static Mugen::Unsupported::Counts controllers;
+
+void Mugen::Unsupported::trigger(const std::string & name){
+    triggers[Mugen::lowercase(name)] += 1;
+}
+
+void Mugen::Unsupported::controller(const std::string & name){
+    controllers[Mugen::lowercase(name)] += 1;
+}
+
+const Mugen::Unsupported::Counts & Mugen::Unsupported::getTriggers(){
+    return triggers;
+}
+
+const Mugen::Unsupported::Counts & Mugen::Unsupported::getControllers(){
+    return controllers;
+}
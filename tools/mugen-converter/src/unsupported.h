@@ -0,0 +1,29 @@
+#ifndef mugen_converter_unsupported
+#define mugen_converter_unsupported
+
+#include <map>
+#include <string>
+
+namespace Mugen{
+
+/*! Counts the triggers and controllers the converter doesn't translate yet so
+ * batch mode can report which ones are worth implementing first.
+ */
+namespace Unsupported{
+
+typedef std::map<std::string, int> Counts;
+
+//! A trigger keyword that was passed through untranslated
+void trigger(const std::string &);
+
+//! A controller type that was converted to pass
+void controller(const std::string &);
+
+const Counts & getTriggers();
+const Counts & getControllers();
+
+}
+
+}
+
+#endif